@@ -0,0 +1,18 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// 用法: bench_event_loop [写入次数] [eventfd数]
+// 未以liburing编译时只测epoll后端
+int main(int argc, char* argv[]) {
+    size_t events = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+    uint32_t fds = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 16;
+    
+    if (event_loop_benchmark(events, fds) != 0) {
+        fprintf(stderr, "usage: %s [events] [fds <= %d]\n", argv[0], MAX_WORKERS);
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,12 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdlib.h>
+
+// 用法: bench_queue [每个生产者的操作数]
+int main(int argc, char* argv[]) {
+    uint32_t ops_per_producer = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 100000;
+    
+    queue_producer_benchmark(ops_per_producer);
+    
+    return 0;
+}
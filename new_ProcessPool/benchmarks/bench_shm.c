@@ -0,0 +1,17 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// 用法: bench_shm [消息数] [负载字节数]
+int main(int argc, char* argv[]) {
+    size_t operations = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+    size_t data_size = argc > 2 ? strtoull(argv[2], NULL, 10) : 64;
+    
+    if (shm_benchmark(operations, data_size) != 0) {
+        fprintf(stderr, "usage: %s [operations] [data_size <= %d]\n", argv[0], MAX_TASK_DATA_SIZE);
+        return 1;
+    }
+    
+    return 0;
+}
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,13 +8,15 @@
 #include "../include/process_pool.h"
 
 // 简单的计算任务：计算斐波那契数列
-static int fibonacci_task(void* input_data, size_t input_size, 
-                         void** output_data, size_t* output_size, void* user_data) {
+static int fibonacci_task(const void* input_data, size_t input_size,
+                         void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
     if (!input_data || input_size != sizeof(int)) {
         return -1;
     }
     
-    int n = *(int*)input_data;
+    int n = *(const int*)input_data;
     
     // 模拟一些计算时间
     usleep(10000); // 10ms
@@ -47,37 +50,44 @@ static int fibonacci_task(void* input_data, size_t input_size,
 }
 
 // 任务完成回调函数
-static void task_completion_callback(task_future_t* future, void* user_data) {
-    task_result_t result;
-    if (pool_future_wait(future, &result, 0) == 0) {
-        if (result.status == TASK_STATUS_COMPLETED && result.output_data) {
-            long long value = *(long long*)result.output_data;
-            printf("Task completed with result: %lld\n", value);
-            free(result.output_data);
-        } else {
-            printf("Task failed with error: %s\n", result.error_message);
-        }
-    }
+static void task_completion_callback(uint64_t task_id, task_state_t state,
+                                     const void* result_data, size_t result_size,
+                                     void* user_data) {
+    (void)user_data;
     
-    pool_future_destroy(future);
+    if (state == TASK_STATE_COMPLETED && result_size == sizeof(long long)) {
+        long long value;
+        memcpy(&value, result_data, sizeof(value));
+        printf("Task %lu completed with result: %lld\n", (unsigned long)task_id, value);
+    } else {
+        printf("Task %lu finished in state %d\n", (unsigned long)task_id, state);
+    }
+}
+
+static void print_result(const char* label, int index, const task_result_t* result) {
+    if (result->state == TASK_STATE_COMPLETED && result->result_data) {
+        long long value;
+        memcpy(&value, result->result_data, sizeof(value));
+        printf("%s %d: %lld\n", label, index, value);
+    } else {
+        printf("%s %d failed: %s\n", label, index, result->error_message);
+    }
 }
 
-int main(int argc, char* argv[]) {
+int main(void) {
     printf("=== Process Pool Basic Example ===\n");
     printf("Process Pool Version: %s\n", pool_get_version());
     
     // 创建进程池配置
     pool_config_t config = {
-        .worker_count = 4,
+        .min_workers = 4,
         .max_workers = 8,
-        .min_workers = 2,
-        .queue_size = 100,
-        .worker_idle_timeout = 30000,  // 30秒
-        .task_timeout = 10000,         // 10秒
-        .enable_dynamic_scaling = true,
-        .enable_worker_affinity = false,
-        .log_level = 2,  // INFO
-        .pool_name = "fibonacci_pool"
+        .queue_size = 128,
+        .worker_idle_timeout = 30,     // 30秒
+        .task_timeout = 10,            // 10秒
+        .enable_auto_scaling = false,
+        .pool_name = "fibonacci_pool",
+        .default_handler = fibonacci_task
     };
     
     // 创建进程池
@@ -90,31 +100,34 @@ int main(int argc, char* argv[]) {
     
     // 启动进程池
     printf("Starting process pool...\n");
-    if (pool_start(pool) != 0) {
-        fprintf(stderr, "Failed to start process pool: %s\n", strerror(errno));
+    pool_error_t err = pool_start(pool);
+    if (err != POOL_SUCCESS) {
+        fprintf(stderr, "Failed to start process pool: %s\n", pool_error_string(err));
         pool_destroy(pool);
         return 1;
     }
     
     printf("Process pool started successfully!\n");
     
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.priority = TASK_PRIORITY_NORMAL;
+    desc.timeout_ms = 5000;
+    
     // 提交一些同步任务
     printf("\n=== Synchronous Tasks ===\n");
     for (int i = 1; i <= 5; i++) {
-        printf("Submitting synchronous task for fibonacci(%d)...\n", i * 5);
-        
         int input = i * 5;
         task_result_t result;
-        
-        int ret = pool_submit_sync(pool, fibonacci_task, &input, sizeof(input), 
-                                  NULL, TASK_PRIORITY_NORMAL, 5000, &result);
-        
-        if (ret == 0 && result.status == TASK_STATUS_COMPLETED) {
-            long long value = *(long long*)result.output_data;
-            printf("Synchronous result: fibonacci(%d) = %lld\n", input, value);
-            free(result.output_data);
+    
+        printf("Submitting synchronous task for fibonacci(%d)...\n", input);
+    
+        err = pool_submit_sync(pool, &desc, &input, sizeof(input), &result, 5000);
+        if (err == POOL_SUCCESS) {
+            print_result("Synchronous result", i, &result);
+            free(result.result_data);
         } else {
-            printf("Synchronous task failed: %s\n", result.error_message);
+            printf("Synchronous task failed: %s\n", pool_error_string(err));
         }
     }
     
@@ -124,14 +137,13 @@ int main(int argc, char* argv[]) {
     int future_count = 0;
     
     for (int i = 1; i <= 10; i++) {
-        printf("Submitting asynchronous task for fibonacci(%d)...\n", i * 3);
-        
         int input = i * 3;
-        task_future_t* future = pool_submit_async(pool, fibonacci_task, &input, sizeof(input),
-                                                 NULL, TASK_PRIORITY_NORMAL, 0);
-        
-        if (future) {
-            futures[future_count++] = future;
+    
+        printf("Submitting asynchronous task for fibonacci(%d)...\n", input);
+    
+        if (pool_submit_async(pool, &desc, &input, sizeof(input),
+                              &futures[future_count]) == POOL_SUCCESS) {
+            future_count++;
         } else {
             printf("Failed to submit asynchronous task\n");
         }
@@ -141,18 +153,13 @@ int main(int argc, char* argv[]) {
     printf("\nWaiting for asynchronous tasks to complete...\n");
     for (int i = 0; i < future_count; i++) {
         task_result_t result;
-        if (pool_future_wait(futures[i], &result, 10000) == 0) {
-            if (result.status == TASK_STATUS_COMPLETED && result.output_data) {
-                long long value = *(long long*)result.output_data;
-                printf("Async result %d: %lld\n", i + 1, value);
-                free(result.output_data);
-            } else {
-                printf("Async task %d failed: %s\n", i + 1, result.error_message);
-            }
+        if (pool_future_wait(futures[i], &result, 10000) == POOL_SUCCESS) {
+            print_result("Async result", i + 1, &result);
+            free(result.result_data);
         } else {
             printf("Async task %d timed out\n", i + 1);
         }
-        
+    
         pool_future_destroy(futures[i]);
     }
     
@@ -160,96 +167,81 @@ int main(int argc, char* argv[]) {
     printf("\n=== Batch Tasks ===\n");
     task_desc_t batch_tasks[5];
     int batch_inputs[5] = {10, 15, 20, 25, 30};
+    const void* batch_data[5];
+    size_t batch_sizes[5];
+    task_future_t* batch_futures[5];
     
     for (int i = 0; i < 5; i++) {
-        batch_tasks[i].task_func = fibonacci_task;
-        batch_tasks[i].input_data = &batch_inputs[i];
-        batch_tasks[i].input_size = sizeof(int);
-        batch_tasks[i].user_data = NULL;
-        batch_tasks[i].priority = TASK_PRIORITY_NORMAL;
-        batch_tasks[i].timeout_ms = 5000;
-        batch_tasks[i].completion_callback = task_completion_callback;
-        batch_tasks[i].callback_data = NULL;
+        batch_tasks[i] = desc;
+        batch_tasks[i].callback = task_completion_callback;
+        batch_data[i] = &batch_inputs[i];
+        batch_sizes[i] = sizeof(int);
     }
     
-    task_future_t** batch_futures = pool_submit_batch(pool, batch_tasks, 5);
-    if (batch_futures) {
+    err = pool_submit_batch(pool, batch_tasks, batch_data, batch_sizes, 5, batch_futures);
+    if (err == POOL_SUCCESS) {
         printf("Submitted batch of 5 tasks\n");
-        
+    
         // 等待批量任务完成
         for (int i = 0; i < 5; i++) {
-            if (batch_futures[i]) {
-                task_result_t result;
-                if (pool_future_wait(batch_futures[i], &result, 10000) == 0) {
-                    if (result.status == TASK_STATUS_COMPLETED && result.output_data) {
-                        long long value = *(long long*)result.output_data;
-                        printf("Batch result %d: fibonacci(%d) = %lld\n", 
-                               i + 1, batch_inputs[i], value);
-                        free(result.output_data);
-                    }
-                }
-                pool_future_destroy(batch_futures[i]);
+            task_result_t result;
+            if (pool_future_wait(batch_futures[i], &result, 10000) == POOL_SUCCESS) {
+                print_result("Batch result", i + 1, &result);
+                free(result.result_data);
             }
+            pool_future_destroy(batch_futures[i]);
         }
-        
-        free(batch_futures);
     } else {
-        printf("Failed to submit batch tasks\n");
+        printf("Failed to submit batch tasks: %s\n", pool_error_string(err));
     }
     
     // 显示统计信息
     printf("\n=== Pool Statistics ===\n");
     pool_stats_t stats;
-    if (pool_get_stats(pool, &stats) == 0) {
-        printf("Tasks submitted: %lu\n", stats.tasks_submitted);
-        printf("Tasks completed: %lu\n", stats.tasks_completed);
-        printf("Tasks failed: %lu\n", stats.tasks_failed);
-        printf("Tasks cancelled: %lu\n", stats.tasks_cancelled);
-        printf("Active workers: %d\n", stats.active_workers);
-        printf("Idle workers: %d\n", stats.idle_workers);
-        printf("Queue size: %d\n", stats.queue_size);
-        printf("Average task time: %.2f ms\n", stats.avg_task_time_ms);
-        printf("Average queue time: %.2f ms\n", stats.avg_queue_time_ms);
-        printf("Pool uptime: %.2f seconds\n", stats.uptime_seconds);
+    if (pool_get_stats(pool, &stats) == POOL_SUCCESS) {
+        printf("Tasks submitted: %lu\n", (unsigned long)stats.total_submitted);
+        printf("Tasks completed: %lu\n", (unsigned long)stats.total_completed);
+        printf("Tasks failed: %lu\n", (unsigned long)stats.total_failed);
+        printf("Tasks cancelled: %lu\n", (unsigned long)stats.total_cancelled);
+        printf("Active workers: %u\n", stats.active_workers);
+        printf("Idle workers: %u\n", stats.idle_workers);
+        printf("Pending tasks: %u\n", stats.pending_tasks);
+        printf("Average task time: %.2f ms\n", stats.avg_task_time_ns / 1e6);
     }
     
     // 显示Worker信息
     printf("\n=== Worker Information ===\n");
-    worker_info_t* workers;
-    int worker_count;
-    if (pool_get_workers(pool, &workers, &worker_count) == 0) {
-        for (int i = 0; i < worker_count; i++) {
-            printf("Worker %d: PID=%d, Status=%d, Tasks=%lu, CPU=%.1f%%\n",
-                   i, workers[i].pid, workers[i].status, 
-                   workers[i].tasks_completed, workers[i].cpu_usage);
+    worker_info_t workers[8];
+    uint32_t worker_count = 8;
+    if (pool_get_workers(pool, workers, &worker_count) == POOL_SUCCESS) {
+        for (uint32_t i = 0; i < worker_count; i++) {
+            printf("Worker %u: PID=%d, State=%d, Tasks=%lu\n",
+                   workers[i].worker_id, workers[i].pid, workers[i].state,
+                   (unsigned long)workers[i].tasks_processed);
         }
-        free(workers);
     }
     
     // 测试动态扩缩容
     printf("\n=== Dynamic Scaling Test ===\n");
-    printf("Current worker count: %d\n", stats.active_workers + stats.idle_workers);
     
     printf("Scaling up to 6 workers...\n");
-    if (pool_resize(pool, 6) == 0) {
-        sleep(2);  // 等待扩容完成
-        if (pool_get_stats(pool, &stats) == 0) {
-            printf("New worker count: %d\n", stats.active_workers + stats.idle_workers);
-        }
+    if (pool_resize(pool, 6) == POOL_SUCCESS) {
+        worker_count = 8;
+        pool_get_workers(pool, workers, &worker_count);
+        printf("New worker count: %u\n", worker_count);
     }
     
-    printf("Scaling down to 3 workers...\n");
-    if (pool_resize(pool, 3) == 0) {
-        sleep(2);  // 等待缩容完成
-        if (pool_get_stats(pool, &stats) == 0) {
-            printf("New worker count: %d\n", stats.active_workers + stats.idle_workers);
-        }
+    printf("Scaling down to 4 workers...\n");
+    if (pool_resize(pool, 4) == POOL_SUCCESS) {
+        worker_count = 8;
+        pool_get_workers(pool, workers, &worker_count);
+        printf("New worker count: %u\n", worker_count);
     }
     
     // 停止和销毁进程池
     printf("\n=== Cleanup ===\n");
     printf("Stopping process pool...\n");
-    if (pool_stop(pool, 5000) != 0) {
+    if (pool_stop(pool, 5000) != POOL_SUCCESS) {
         printf("Warning: Pool stop timed out, forcing shutdown\n");
     }
     
@@ -261,4 +253,4 @@ int main(int argc, char* argv[]) {
 }
 
 // 编译命令示例:
-// gcc -o basic_example basic_example.c -L../build -lprocesspool -lpthread -lrt
\ No newline at end of file
+// gcc -o basic_example basic_example.c -L../build -lprocesspool -lpthread -lrt
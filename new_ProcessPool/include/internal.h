@@ -2,6 +2,8 @@
 #define INTERNAL_H
 
 #include "process_pool.h"
+#include <stdio.h>
+#include <stddef.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <sys/signalfd.h>
@@ -13,104 +15,519 @@
 // 内部配置常量
 #define EPOLL_MAX_EVENTS 64
 #define SHM_NAME_MAX_LEN 64
+#define CACHE_LINE_SIZE 64           // 缓存行大小
+#define WORKER_STEAL_INTERVAL_MS 2   // 空闲Worker尝试窃取的间隔
+#define WORKER_SPIN_MIN_SHIFT 4      // 自适应忙等时长最低降到上限的1/16
 #define WORKER_HEARTBEAT_INTERVAL 5  // 秒
 #define TASK_ID_INVALID 0
 #define METRICS_UPDATE_INTERVAL 1    // 秒
+#define METRICS_MAX_COUNTERS 64      // 指标注册表容量
+#define METRICS_MAX_LATENCIES 32
+#define METRICS_MAX_HISTOGRAMS 16
+#define METRICS_HISTOGRAM_BUCKETS 32
+#define EVENT_LOOP_HOUSEKEEPING_MS 1000 // 事件循环定期维护间隔
+#define WORKER_RETIRE_TIMEOUT_MS 5000 // 缩容退役的Worker超过该时间仍未退出则强制结束
+
+// 自动扩缩容控制参数(每个维护周期评估一次)
+#define AUTOSCALE_EWMA_ALPHA 0.3        // 积压和利用率的EWMA平滑系数
+#define AUTOSCALE_WAIT_BUCKETS 32       // 排队时间直方图桶数(按微秒取log2)
+#define AUTOSCALE_UP_DEPTH 2.0          // 每个Worker平均积压超过该值时扩容
+#define AUTOSCALE_UP_UTIL 0.85          // 利用率超过该值且有积压时扩容
+#define AUTOSCALE_DOWN_UTIL 0.6         // 减少一个Worker后利用率仍低于该值才缩容
+#define AUTOSCALE_DOWN_DEPTH 0.25       // 每个Worker平均积压低于该值才缩容
+#define AUTOSCALE_UP_TICKS 2            // 扩容条件需连续满足的周期数
+#define AUTOSCALE_DOWN_TICKS 10         // 缩容条件需连续满足的周期数
+#define AUTOSCALE_UP_COOLDOWN_MS 3000   // 任意扩缩容后至少间隔多久才能再扩容
+#define AUTOSCALE_DOWN_COOLDOWN_MS 30000 // 任意扩缩容后至少间隔多久才能再缩容
+
+// 路由键分发：属主负载超过平均负载的ROUTE_LOAD_FACTOR倍再加ROUTE_LOAD_SLACK
+// 时视为过载，改派给负载最轻的Worker
+#define ROUTE_LOAD_FACTOR 1.25
+#define ROUTE_LOAD_SLACK 2
 
 // 原子操作宏
 #define ATOMIC_LOAD(ptr) atomic_load(ptr)
 #define ATOMIC_STORE(ptr, val) atomic_store(ptr, val)
 #define ATOMIC_CAS(ptr, expected, desired) atomic_compare_exchange_weak(ptr, expected, desired)
+#define ATOMIC_CAS_ACQUIRE(ptr, expected, desired) \
+    atomic_compare_exchange_weak_explicit(ptr, expected, desired, \
+                                          memory_order_acquire, memory_order_relaxed)
 #define ATOMIC_ADD(ptr, val) atomic_fetch_add(ptr, val)
 #define ATOMIC_SUB(ptr, val) atomic_fetch_sub(ptr, val)
+#define ATOMIC_EXCHANGE(ptr, val) atomic_exchange(ptr, val)
+#define ATOMIC_LOAD_RELAXED(ptr) atomic_load_explicit(ptr, memory_order_relaxed)
+#define ATOMIC_LOAD_ACQUIRE(ptr) atomic_load_explicit(ptr, memory_order_acquire)
+#define ATOMIC_STORE_RELAXED(ptr, val) atomic_store_explicit(ptr, val, memory_order_relaxed)
+#define ATOMIC_STORE_RELEASE(ptr, val) atomic_store_explicit(ptr, val, memory_order_release)
 
 // 内存屏障
 #define MEMORY_BARRIER() atomic_thread_fence(memory_order_seq_cst)
 
+// 忙等循环中让出流水线
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_RELAX() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define CPU_RELAX() __asm__ __volatile__("yield" ::: "memory")
+#else
+#define CPU_RELAX() atomic_signal_fence(memory_order_seq_cst)
+#endif
+
+// 由成员指针取得外层结构
+#define CONTAINER_OF(ptr, type, member) \
+    ((type*)((char*)(ptr) - offsetof(type, member)))
+
+// 分层时间轮：4层、每层256槽，tick为1ms，可覆盖2^32ms(约49天)的超时
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_BITS 8
+#define TIMER_WHEEL_SLOTS (1U << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_TICK_NS 1000000ULL
+
+// 侵入式定时器节点，嵌入到被计时的对象中
+typedef struct timer_node {
+    struct timer_node* prev;        // 槽位双向链表(NULL表示未挂入时间轮)
+    struct timer_node* next;
+    uint64_t expires;               // 到期tick
+} timer_node_t;
+
+// 时间轮(仅事件循环线程访问)
+typedef struct {
+    uint64_t start_ns;              // tick 0对应的时间
+    uint64_t current;               // 已处理到的tick
+    uint32_t count;                 // 已挂入的定时器数量
+    timer_node_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS]; // 各槽位链表头
+} timer_wheel_t;
+
+typedef void (*timer_expire_fn)(timer_node_t* node, void* arg);
+
+// 结果缓存键：处理函数地址 + 输入大小 + 输入字节的128位SipHash
+typedef struct {
+    uint64_t handler;               // 处理函数地址
+    uint64_t input_size;            // 输入大小
+    uint64_t hash[2];               // 输入哈希
+} result_cache_key_t;
+
+typedef struct result_cache result_cache_t;
+
+// 提交时查找结果缓存和在途任务的结果
+typedef enum {
+    RESULT_CACHE_MISS = 0,          // 需要入队执行
+    RESULT_CACHE_HIT = 1,           // 已用缓存的结果完成
+    RESULT_CACHE_JOINED = 2         // 相同任务正在执行，合并到该任务上
+} result_cache_lookup_t;
+
 // 任务内部结构
 typedef struct task_internal {
     uint64_t task_id;               // 任务ID
     task_desc_t desc;               // 任务描述
     void* input_data;               // 输入数据
     size_t input_size;              // 输入大小
+    pool_fd_region_t input_region;  // 以描述符传递的输入(fd为-1表示没有，由任务持有)
     
     // 状态管理
     atomic_int state;               // 任务状态
     atomic_uint worker_id;          // 分配的worker ID
+    atomic_int ref_count;           // 引用计数
     
     // 时间戳
     uint64_t submit_time_ns;        // 提交时间
     uint64_t start_time_ns;         // 开始时间
     uint64_t end_time_ns;           // 结束时间
+    uint64_t deadline_ns;           // 绝对截止时间(0表示不限时)
+    uint64_t dispatch_seq;          // 在属主Worker提交环中的记录序号
+    int cancel_stage;               // 取消升级阶段(仅事件循环线程访问)
+    int route;                      // 本次分发的路由结果(task_route_t，仅事件循环线程访问)
+    bool dispatch_aged;             // 本次出队是否因老化而提前(仅事件循环线程访问)
+    bool cache_key_valid;           // 已计算结果缓存键(cacheable且启用了结果缓存)
+    result_cache_key_t cache_key;   // 结果缓存键
+    result_cache_t* flight;         // 登记为在途领头任务时指向结果缓存，到达终态时注销
+    atomic_int flight_sharers;      // 共享本任务的未取消future数(单飞合并)
+    task_graph_t* graph;            // 所属任务图(可为NULL)
+    uint32_t graph_node;            // 在任务图中的节点下标
+    struct task_internal* graph_next; // 本线程待处理的已结束节点链表
+    timer_node_t timer;             // 超时定时器(由事件循环挂入时间轮)
     
     // 结果数据
-    void* result_data;              // 结果数据
-    size_t result_size;             // 结果大小
-    int error_code;                 // 错误码
-    char error_message[256];        // 错误信息
+    struct {
+        void* output_data;          // 结果数据
+        size_t output_size;         // 结果大小
+        int error_code;             // 错误码
+        char* error_message;        // 错误信息
+        pool_fd_region_t output_region; // 以描述符返回的结果(fd为-1表示没有，由任务持有)
+    } result;
     
     // 同步原语
     pthread_mutex_t mutex;          // 互斥锁
-    pthread_cond_t cond;            // 条件变量
+    pthread_cond_t completion_cond; // 完成条件变量
     
     // 链表节点
-    struct task_internal* next;
+    struct task_internal* next;        // 待分发链表
+    struct task_internal* worker_next; // Worker在途任务链表
+    struct task_internal* cancel_next; // 待转交Worker的取消请求链表
+    struct task_internal* flight_next; // 在途任务表的哈希桶链表
 } task_internal_t;
 
+// 按路由键分发的结果
+typedef enum {
+    TASK_ROUTE_NONE = 0,            // 未指定路由键
+    TASK_ROUTE_HIT = 1,             // 分发到键所属的Worker
+    TASK_ROUTE_SPILL = 2            // 所属Worker过载或不可用，改派给负载最轻的Worker
+} task_route_t;
+
+// 运行中任务的取消升级阶段
+enum {
+    TASK_CANCEL_NONE = 0,           // 未请求取消
+    TASK_CANCEL_REQUESTED = 1,      // 已写入取消表，等待处理函数自行返回
+    TASK_CANCEL_SIGNALLED = 2,      // 已向执行者发送SIGUSR1
+    TASK_CANCEL_RECYCLED = 3        // 已回收执行者进程
+};
+
+// 优先级待分发通道(仅事件循环线程访问)
+typedef struct {
+    task_internal_t* head;          // 最早入队的任务
+    task_internal_t* tail;          // 最晚入队的任务
+} task_lane_t;
+
+// 按截止时间排序的待分发任务最小堆(EDF调度，仅事件循环线程访问)
+typedef struct {
+    task_internal_t** tasks;        // 堆数组
+    uint32_t size;                  // 任务数
+    uint32_t capacity;              // 数组容量
+} task_heap_t;
+
+// 自动扩缩容控制器状态(仅事件循环线程访问，wait_hist和wait_samples由stats_mutex保护)
+typedef struct {
+    double depth_ewma;              // 积压任务数EWMA
+    double util_ewma;               // Worker利用率EWMA
+    uint32_t wait_hist[AUTOSCALE_WAIT_BUCKETS]; // 本周期分发任务的排队时间直方图
+    uint32_t wait_samples;          // 本周期样本数
+    uint32_t up_ticks;              // 扩容条件已连续满足的周期数
+    uint32_t down_ticks;            // 缩容条件已连续满足的周期数
+    uint64_t last_tick_ns;          // 上次评估时间
+    uint64_t last_completed;        // 上次评估时的总完成任务数
+    uint64_t last_scale_ns;         // 上次扩缩容时间
+    uint64_t worker_completed[MAX_WORKERS]; // 各Worker上次评估时的完成数
+    uint64_t worker_active_ns[MAX_WORKERS]; // 各Worker最后一次有任务的时间
+} autoscaler_t;
+
+// 队列并发模式
+typedef enum {
+    QUEUE_MODE_SPSC = 0,            // 单生产者单消费者
+    QUEUE_MODE_MPMC = 1             // 多生产者多消费者(每槽位序号)
+} queue_mode_t;
+
+// MPMC队列槽位，序号标识槽位当前可写还是可读
+typedef struct {
+    atomic_uint sequence;           // 槽位序号
+    task_internal_t* task;          // 任务指针
+} queue_cell_t;
+
 // 无锁环形队列
+// head和tail各占独立缓存行，避免生产者和消费者之间的伪共享
 typedef struct {
-    atomic_uint head;               // 头指针
-    atomic_uint tail;               // 尾指针
-    uint32_t capacity;              // 容量(必须是2的幂)
+    _Alignas(CACHE_LINE_SIZE) atomic_uint head; // 头指针(出队位置)
+    _Alignas(CACHE_LINE_SIZE) atomic_uint tail; // 尾指针(入队位置)
+    _Alignas(CACHE_LINE_SIZE) uint32_t capacity; // 容量(必须是2的幂)
     uint32_t mask;                  // 掩码(capacity - 1)
-    task_internal_t** tasks;        // 任务指针数组
-    char padding[64];               // 缓存行对齐
+    queue_mode_t mode;              // 并发模式
+    task_internal_t** tasks;        // 任务指针数组(SPSC模式)
+    queue_cell_t* cells;            // 槽位数组(MPMC模式)
 } lockfree_queue_t;
 
+// 共享内存魔数和版本
+#define SHM_MAGIC 0x50504F4C        // "PPOL"
+#define SHM_VERSION 12
+
+// 共享内存环同步模式
+typedef enum {
+    SHM_RING_MUTEX = 0,             // 进程间互斥锁+条件变量
+    SHM_RING_SPSC = 1               // 无锁单生产者单消费者，futex休眠唤醒
+} shm_ring_mode_t;
+
+// 共享内存环形队列(单生产者单消费者，位于共享段内)
+// 按字节寻址的变长记录环，记录按缓存行对齐，环尾放不下时写入回绕标记。
+// 生产者、消费者和休眠唤醒字段各占独立缓存行，SPSC模式下双方只在
+// 缓存的对端位置失效时才读取对端缓存行
+typedef struct {
+    // 只读配置
+    uint32_t mode;                  // 同步模式(shm_ring_mode_t)
+    size_t capacity;                // 记录区字节数
+    size_t data_offset;             // 记录区相对本结构的偏移
+    
+    // 生产者缓存行
+    _Alignas(CACHE_LINE_SIZE) atomic_ulong producer_pos; // 生产者字节位置(单调递增)
+    uint64_t reserve_pos;           // 预留记录的结束位置(仅生产者访问)
+    uint64_t cached_consumer_pos;   // 缓存的消费者位置(仅生产者访问)
+    atomic_ulong records_produced;  // 已提交记录数
+    
+    // 消费者缓存行
+    _Alignas(CACHE_LINE_SIZE) atomic_ulong consumer_pos; // 消费者字节位置(单调递增)
+    uint64_t cached_producer_pos;   // 缓存的生产者位置(仅消费者访问)
+    atomic_ulong records_consumed;  // 已释放记录数
+    
+    // 休眠唤醒(SPSC模式)，只有对端声明休眠时才执行FUTEX_WAKE
+    _Alignas(CACHE_LINE_SIZE) atomic_uint data_seq; // 数据到达futex字
+    atomic_uint consumer_sleeping;  // 消费者正在等待数据
+    atomic_uint space_seq;          // 空间释放futex字
+    atomic_uint producer_sleeping;  // 生产者正在等待空间
+    atomic_ulong space_wake_pos;    // 消费者位置达到此值才唤醒生产者
+    
+    // 进程间同步原语(互斥模式)
+    _Alignas(CACHE_LINE_SIZE) pthread_mutex_t mutex; // 互斥锁
+    pthread_cond_t not_empty;       // 非空条件
+    pthread_cond_t not_full;        // 非满条件
+} shm_ring_t;
+
+// 记录标志
+#define SHM_RECORD_WRAP 0x1         // 回绕标记，消费者跳到记录区开头
+#define SHM_RECORD_STREAM 0x2       // 流式任务，执行时打开Worker段内的流通道
+#define SHM_RECORD_FD 0x4           // 负载以shm_fd_region_t开头，描述符经Worker的fd套接字传递
+
+// 环形队列记录头，负载数据紧随其后
+typedef struct {
+    uint32_t record_size;           // 记录总字节数(含记录头和对齐填充)
+    uint32_t flags;                 // 记录标志
+    uint64_t task_id;               // 任务ID
+    uint64_t cookie;                // Master侧任务句柄，Worker原样回传
+    uint64_t handler;               // 处理函数地址(fork后地址空间一致)
+    uint32_t data_size;             // 负载大小
+    int32_t status;                 // 处理函数返回值(仅完成记录)
+    uint64_t start_time_ns;         // 开始执行时间(仅完成记录)
+    uint64_t end_time_ns;           // 结束执行时间(仅完成记录)
+    uint32_t origin_worker;         // 任务登记所在的Worker(被窃取时与执行者不同)
+} shm_record_t;
+
+#define SHM_RECORD_DATA(rec) ((void*)((char*)(rec) + sizeof(shm_record_t)))
+
+// SHM_RECORD_FD记录负载开头的区域描述，完成记录中其后紧跟常规输出
+typedef struct {
+    uint64_t offset;                // 区域起始偏移
+    uint64_t length;                // 区域长度
+} shm_fd_region_t;
+
+// 记录按缓存行对齐；环至少容纳两条最大记录，保证回绕后总能放下任意记录
+#define SHM_RECORD_ALIGN CACHE_LINE_SIZE
+#define SHM_RECORD_MAX_DATA \
+    ((MAX_TASK_DATA_SIZE > MAX_RESULT_DATA_SIZE ? MAX_TASK_DATA_SIZE : MAX_RESULT_DATA_SIZE) + \
+     sizeof(shm_fd_region_t))
+#define SHM_RECORD_MAX_SIZE \
+    ((sizeof(shm_record_t) + SHM_RECORD_MAX_DATA + SHM_RECORD_ALIGN - 1) & \
+     ~(size_t)(SHM_RECORD_ALIGN - 1))
+#define SHM_RING_MIN_SIZE (2 * SHM_RECORD_MAX_SIZE)
+#define SHM_RING_MAX_SIZE ((size_t)1 << 30)  // 1GB
+
+// 可窃取任务表
+// 提交环中的每条待执行记录按序号登记在属主Worker的任务表中。属主和
+// 窃取者都通过CAS槽位状态字认领记录，状态字高位带记录序号，槽位被
+// 复用后旧序号的CAS必然失败。窃取者认领时把自己的进程ID一并写入状态字，
+// 认领后未拷贝完就退出时属主据此发现并收回记录
+#define SHM_STEAL_SLOTS 1024        // 每个Worker最多登记的待执行记录数
+#define STEAL_STATE_READY 0         // 等待执行，可被窃取
+#define STEAL_STATE_OWNED 1         // 属主Worker已开始执行
+#define STEAL_STATE_STOLEN 2        // 已被窃取，窃取者正在拷贝输入
+#define STEAL_STATE_COPIED 3        // 窃取者已拷贝完输入，属主可以释放记录
+#define STEAL_PID_BITS 22           // Linux进程ID上限为2^22
+#define STEAL_PID_MASK ((1ULL << STEAL_PID_BITS) - 1)
+#define STEAL_WORD_PID(seq, pid, state) \
+    (((uint64_t)(seq) << (STEAL_PID_BITS + 2)) | (((uint64_t)(pid) & STEAL_PID_MASK) << 2) | (state))
+#define STEAL_WORD(seq, state) STEAL_WORD_PID(seq, 0, state)
+#define STEAL_WORD_STATE(word) ((word) & 0x3)
+#define STEAL_WORD_THIEF_PID(word) ((pid_t)(((word) >> 2) & STEAL_PID_MASK))
+
+typedef struct {
+    atomic_ulong word;              // 记录序号 | 窃取者进程ID | 状态
+    uint64_t position;              // 记录在提交环中的字节位置
+    uint64_t cookie;                // Master侧任务句柄
+    uint64_t task_id;               // 任务ID
+    atomic_uint thief;              // 窃取者Worker ID
+    atomic_uint urgent;             // 是否为可插队执行的紧急任务
+    atomic_uint pinned;             // 是否按路由键分发到属主，不允许被窃取
+} shm_steal_slot_t;
+
+// 取消表：Master按任务ID取模写入被取消任务的ID，执行者(属主或窃取者)
+// 执行前和执行中轮询属主段中的对应字；冲突时较早的请求被覆盖，由信号升级兜底
+#define SHM_CANCEL_SLOTS 256
+
+// 流式任务的字节管道(单生产者单消费者，位于Worker段内)
+// 位置单调递增，数据区按容量取模；任一端推进位置或改变状态后递增seq，
+// 有等待者时才执行FUTEX_WAKE
+#define SHM_STREAM_PIPE_SIZE (256 * 1024) // 每个方向的管道字节数
+
+typedef struct {
+    // 只读配置
+    size_t capacity;                // 数据区字节数
+    size_t data_offset;             // 数据区相对本结构的偏移
+    
+    // 写端缓存行
+    _Alignas(CACHE_LINE_SIZE) atomic_ulong write_pos; // 写端字节位置
+    atomic_uint closed;             // 写端已结束
+    
+    // 读端缓存行
+    _Alignas(CACHE_LINE_SIZE) atomic_ulong read_pos; // 读端字节位置
+    atomic_uint abandoned;          // 读端已放弃，写端不必再写
+    
+    // 休眠唤醒
+    _Alignas(CACHE_LINE_SIZE) atomic_uint seq; // futex字
+    atomic_uint waiters;            // 正在等待的一端数量
+} shm_pipe_t;
+
+// 流通道：Worker同一时间只执行一个任务，每个段一个通道即可。
+// Worker开始执行流式任务时重置管道并写入task_id，Master侧读写前核对
+// task_id并登记master_busy，Worker释放通道前等待master_busy归零
+typedef struct {
+    atomic_ulong task_id;           // 占用通道的流式任务ID(0表示空闲)
+    atomic_uint master_busy;        // 正在访问管道的Master线程数
+    shm_pipe_t input;               // 输入管道(Master -> Worker)
+    shm_pipe_t output;              // 输出管道(Worker -> Master)
+} shm_stream_t;
+
+// 共享内存段的支撑页类型
+typedef enum {
+    SHM_PAGES_NORMAL = 0,           // 普通页
+    SHM_PAGES_HUGETLB = 1,          // hugetlb大页(MFD_HUGETLB)
+    SHM_PAGES_THP = 2               // 普通页并建议透明大页(MADV_HUGEPAGE)
+} shm_page_kind_t;
+
 // 共享内存区域
 typedef struct {
-    // 队列元数据
-    atomic_uint producer_pos;       // 生产者位置
-    atomic_uint consumer_pos;       // 消费者位置
-    uint32_t queue_size;            // 队列大小
+    uint32_t magic;                 // 魔数
+    uint32_t version;               // 版本
+    size_t size;                    // 段大小(arena中的槽位间距，已按页大小取整)
+    uint32_t page_size;             // 支撑页大小(字节)
+    uint32_t page_kind;             // 支撑页类型(shm_page_kind_t)
+    
+    // 任务提交环(Master -> Worker)与完成环(Worker -> Master)
+    shm_ring_t submit_ring;         // 提交环
+    shm_ring_t complete_ring;       // 完成环
     
     // 统计信息
     atomic_ulong total_submitted;   // 总提交数
     atomic_ulong total_completed;   // 总完成数
     atomic_ulong total_failed;      // 总失败数
+    atomic_ulong total_stolen;      // 从其他Worker窃取的任务数
+    atomic_ulong total_stolen_from; // 被其他Worker窃取的任务数
+    
+    atomic_ulong total_cancelled;   // 执行前或执行中被取消的任务数
+    
+    // 提交环中尚未被认领的紧急任务数，非零时Worker先插队执行紧急任务
+    atomic_uint urgent_pending;
+    
+    // 正在执行的任务ID(0表示空闲)，Master据此决定是否升级取消
+    atomic_ulong running_task_id;
+    
+    // Worker心跳(CLOCK_MONOTONIC纳秒)：主循环每次醒来和每完成一个任务时写入，
+    // Master据此发现进程仍在但主循环卡住的Worker
+    atomic_ulong heartbeat_ns;
+    
+    // 完成通知合并：Master回收期间Worker不写result_eventfd，
+    // 已写过且Master尚未处理时也不再写，一批结果只唤醒Master一次
+    atomic_uint master_reaping;     // Master正在回收完成环
+    atomic_uint result_signalled;   // 已写result_eventfd，Master尚未开始回收
+    
+    // Worker不在epoll_wait中休眠(正在执行或忙等)时为1，Master提交任务后
+    // 看到该标志即省去task_eventfd通知，Worker会自己回到提交环
+    atomic_uint worker_awake;
+    
+    // 窃取时扫描的槽位上界(最大的已初始化槽位+1)，Master在创建和销毁Worker时
+    // 写入所有段，Worker不必访问未启用的槽位
+    atomic_uint peer_slots;
+    
+    // 流式任务通道
+    shm_stream_t stream;
+    
+    // 取消表
+    atomic_ulong cancel_words[SHM_CANCEL_SLOTS];
+    
+    // 可窃取任务表
+    shm_steal_slot_t steal_slots[SHM_STEAL_SLOTS];
     
     // 任务数据区域
-    char task_data[0];              // 变长任务数据
+    char task_data[];               // 两个环的槽位区，之后是流通道的两个管道
 } shared_memory_t;
 
+// 共享内存arena：每个进程池一个memfd，按槽位切成等长的Worker段
+typedef struct {
+    int fd;                         // memfd(-1表示未创建)
+    void* base;                     // 映射基址，fork后在所有Worker中相同
+    size_t size;                    // 映射总大小
+    size_t stride;                  // 每个段的大小(已按页大小取整)
+    uint32_t slots;                 // 段数(max_workers)
+    uint32_t page_size;             // 支撑页大小(字节)
+    shm_page_kind_t page_kind;      // 支撑页类型
+} shm_arena_t;
+
+// 共享内存统计信息
+typedef struct {
+    size_t ring_capacity;           // 每个环的字节数
+    size_t bytes_used;              // 提交环已用字节数
+    uint32_t current_size;          // 提交环当前深度
+    uint32_t completion_size;       // 完成环当前深度
+    bool is_full;                   // 提交环是否已满
+    bool is_empty;                  // 提交环是否为空
+    uint64_t total_submitted;       // 总提交数
+    uint64_t total_completed;       // 总完成数
+    uint64_t total_failed;          // 总失败数
+} shm_stats_t;
+
+// Worker内部状态
+enum worker_state_internal {
+    WORKER_INTERNAL_CREATED = 0,
+    WORKER_INTERNAL_STARTING = 1,
+    WORKER_INTERNAL_RUNNING = 2,
+    WORKER_INTERNAL_STOPPING = 3,
+    WORKER_INTERNAL_STOPPED = 4,
+    WORKER_INTERNAL_ERROR = 5
+};
+
 // Worker进程内部结构
 typedef struct {
     uint32_t worker_id;             // Worker ID
     pid_t pid;                      // 进程ID
     atomic_int state;               // 状态
+    process_pool_t* pool;           // 所属进程池
     
     // 通信文件描述符
     int task_eventfd;               // 任务通知eventfd
     int result_eventfd;             // 结果通知eventfd
     int control_eventfd;            // 控制命令eventfd
+    int pidfd;                      // 进程pidfd，进程退出时可读(-1表示不可用)
+    int fd_socket;                  // 传递描述符的SEQPACKET套接字(Master端，非阻塞)
+    int fd_socket_peer;             // 套接字的Worker端，Master在派生Worker后关闭
+    
+    // 放置
+    int cpu;                        // 绑定的CPU(-1表示不绑定)
+    int numa_node;                  // 共享内存段所在NUMA节点(-1表示不绑定)
     
     // 共享内存
     shared_memory_t* shared_mem;    // 共享内存指针
     size_t shared_mem_size;         // 共享内存大小
-    char shm_name[SHM_NAME_MAX_LEN]; // 共享内存名称
+    
+    // 缩容退役：已通知退出，进程退出后由事件循环回收(0表示未退役)
+    uint64_t retire_deadline_ns;    // 超过该时间仍未退出则强制结束
+    
+    // 派生：事件循环向zygote发出请求后不等待，应答到达时完成启动(0表示没有在等待)
+    uint64_t spawn_start_ns;        // 开始派生的时间
+    uint64_t spawn_deadline_ns;     // 超过该时间仍未应答则放弃zygote
+    uint32_t spawn_token;           // 请求序号，用于识别已失效的应答
     
     // 统计信息
     atomic_ulong tasks_processed;   // 已处理任务数
-    atomic_ulong last_heartbeat;    // 最后心跳时间
-    atomic_uint current_task_id;    // 当前任务ID
+    atomic_ulong last_heartbeat;    // Master最后一次回收到结果的时间
+    atomic_ulong current_task_id;   // 当前任务ID
+    
+    // 在途任务(仅事件循环线程访问链表)
+    task_internal_t* inflight_head; // 在途任务链表头
+    task_internal_t* inflight_tail; // 在途任务链表尾
+    atomic_uint inflight_count;     // 在途任务数量
+    
+    // 唤醒统计(仅事件循环线程写入)
+    atomic_ulong doorbells_sent;    // 写task_eventfd的次数
+    atomic_ulong doorbells_suppressed; // Worker未休眠而省去的次数
+    atomic_ulong route_hits;        // 按路由键分发到该Worker的任务数
     
     // 性能指标
     double cpu_usage;               // CPU使用率
     size_t memory_usage;            // 内存使用量
-    
-    // 进程控制
-    pthread_t monitor_thread;       // 监控线程
-    bool monitor_running;           // 监控线程运行标志
 } worker_internal_t;
 
 // Future对象内部结构
@@ -119,6 +536,17 @@ struct task_future {
     task_internal_t* task;          // 任务对象指针
     process_pool_t* pool;           // 进程池指针
     atomic_int ref_count;           // 引用计数
+    atomic_bool detached;           // 已取消但共享的任务仍在为其他future执行
+    pthread_mutex_t mutex;          // 互斥锁
+};
+
+// 进程池状态枚举
+enum pool_state {
+    POOL_STATE_CREATED = 0,
+    POOL_STATE_STARTING = 1,
+    POOL_STATE_RUNNING = 2,
+    POOL_STATE_STOPPING = 3,
+    POOL_STATE_STOPPED = 4
 };
 
 // 进程池内部结构
@@ -136,6 +564,24 @@ struct process_pool {
     atomic_uint active_workers;     // 活跃Worker数量
     atomic_uint target_workers;     // 目标Worker数量
     
+    // Zygote
+    pid_t zygote_pid;               // zygote进程ID(0表示未启用)
+    int zygote_sock;                // 同步派生的SEQPACKET套接字(-1表示不可用)
+    pthread_mutex_t zygote_mutex;   // 串行化同步派生请求
+    int zygote_async_sock;          // 事件循环异步派生的套接字(非阻塞，只由事件循环线程使用)
+    uint32_t zygote_next_token;     // 下一个异步请求的序号
+    autoscaler_t scaler;            // 自动扩缩容控制器
+    
+    // 共享内存arena(zygote和Worker派生前映射，所有Worker继承同一映射)
+    shm_arena_t shm_arena;          // 按槽位切分的Worker共享内存段
+    
+    // 结果缓存(未启用时为NULL)
+    result_cache_t* result_cache;   // 按内容寻址的结果缓存
+    
+    // Worker放置(按槽位，pool_create时计算)
+    int16_t worker_cpus[MAX_WORKERS];  // 各槽位绑定的CPU(-1表示不绑定)
+    int16_t worker_nodes[MAX_WORKERS]; // 各槽位共享内存段的NUMA节点(-1表示不绑定)
+    
     // 任务队列
     lockfree_queue_t* task_queue;   // 任务队列
     pthread_mutex_t queue_mutex;    // 队列互斥锁(fallback)
@@ -148,7 +594,13 @@ struct process_pool {
     bool event_loop_running;        // 事件循环运行标志
     
     // 任务管理
-    task_internal_t* pending_tasks; // 待处理任务链表
+    atomic_int sched_policy;        // 当前调度策略(pool_sched_policy_t)
+    task_lane_t pending_lanes[TASK_PRIORITY_COUNT]; // FIFO/优先级调度下按优先级分道的待分发任务
+    task_heap_t edf_heap;           // EDF调度下的待分发任务
+    atomic_uint pending_counts[TASK_PRIORITY_COUNT]; // 各优先级待分发任务数(供统计读取)
+    timer_wheel_t timer_wheel;      // 任务超时时间轮
+    task_internal_t* cancel_requests; // 待转交Worker的取消请求(task_mutex保护)
+    task_lane_t deferred_tasks;     // 事件循环线程自身提交的任务，下一轮与队列一同暂存(仅事件循环线程访问)
     task_internal_t* completed_tasks; // 已完成任务链表
     pthread_mutex_t task_mutex;     // 任务链表互斥锁
     
@@ -156,10 +608,6 @@ struct process_pool {
     pool_stats_t stats;             // 统计信息
     pthread_mutex_t stats_mutex;    // 统计信息互斥锁
     
-    // 内存管理
-    void* memory_pool;              // 内存池
-    size_t memory_pool_size;        // 内存池大小
-    
     // 监控和调试
     bool metrics_enabled;           // 指标收集开关
     bool tracing_enabled;           // 追踪开关
@@ -176,64 +624,279 @@ struct process_pool {
 // ============================================================================
 
 // 队列操作
-lockfree_queue_t* queue_create(uint32_t capacity);
+lockfree_queue_t* queue_create(uint32_t capacity, queue_mode_t mode);
 void queue_destroy(lockfree_queue_t* queue);
 bool queue_enqueue(lockfree_queue_t* queue, task_internal_t* task);
 task_internal_t* queue_dequeue(lockfree_queue_t* queue);
+bool queue_enqueue_batch(lockfree_queue_t* queue, task_internal_t** tasks,
+                         uint32_t count, uint32_t* enqueued);
+uint32_t queue_dequeue_batch(lockfree_queue_t* queue, task_internal_t** tasks,
+                             uint32_t max_count);
 bool queue_is_empty(lockfree_queue_t* queue);
 bool queue_is_full(lockfree_queue_t* queue);
 uint32_t queue_size(lockfree_queue_t* queue);
+void queue_producer_benchmark(uint32_t ops_per_producer);
+
+// 时间轮
+void timer_wheel_init(timer_wheel_t* wheel, uint64_t now_ns);
+void timer_wheel_add(timer_wheel_t* wheel, timer_node_t* node, uint64_t expire_ns);
+void timer_wheel_cancel(timer_wheel_t* wheel, timer_node_t* node);
+bool timer_wheel_pending(const timer_node_t* node);
+uint32_t timer_wheel_advance(timer_wheel_t* wheel, uint64_t now_ns,
+                             timer_expire_fn expire, void* arg);
+bool timer_wheel_next_expiry(const timer_wheel_t* wheel, uint64_t* expire_ns);
 
 // Worker管理
 pool_error_t worker_create(process_pool_t* pool, uint32_t worker_id);
 pool_error_t worker_start(worker_internal_t* worker);
+pool_error_t worker_start_async(worker_internal_t* worker);
+pool_error_t worker_finish_start(worker_internal_t* worker, pid_t pid);
+pool_error_t worker_request_stop(worker_internal_t* worker);
 pool_error_t worker_stop(worker_internal_t* worker, uint32_t timeout_ms);
 void worker_destroy(worker_internal_t* worker);
 bool worker_is_alive(worker_internal_t* worker);
 pool_error_t worker_send_task(worker_internal_t* worker, task_internal_t* task);
-pool_error_t worker_get_result(worker_internal_t* worker, task_internal_t* task);
+pool_error_t worker_send_batch(worker_internal_t* worker, task_internal_t** tasks,
+                               uint32_t count, uint32_t* sent);
+pool_error_t worker_get_result(worker_internal_t* worker, task_internal_t** task);
+uint32_t worker_get_results(worker_internal_t* worker, task_internal_t** tasks, uint32_t max_count);
+void worker_fail_inflight(worker_internal_t* worker, int error_code, const char* error_message);
+bool worker_request_cancel(worker_internal_t* worker, task_internal_t* task);
+worker_internal_t* worker_find_executor(process_pool_t* pool, const task_internal_t* task);
+uint32_t worker_reclaim_unstarted(worker_internal_t* worker, task_internal_t** tasks, uint32_t max_count);
+void worker_process_main(worker_internal_t* worker) __attribute__((noreturn));
+
+// 进程池管理
+pool_error_t pool_resize_locked(process_pool_t* pool, uint32_t target_count);
+
+// 自动扩缩容
+void adjust_worker_count(process_pool_t* pool);
+void autoscaler_record_wait(process_pool_t* pool, uint64_t wait_ns);
+
+// 结果缓存
+result_cache_t* result_cache_create(size_t capacity, bool single_flight, uint32_t max_inflight);
+void result_cache_destroy(result_cache_t* cache);
+result_cache_lookup_t result_cache_lookup(process_pool_t* pool, task_internal_t* task,
+                                          task_internal_t** leader);
+void result_cache_flight_done(task_internal_t* task);
+void result_cache_store(process_pool_t* pool, const task_internal_t* task);
+void result_cache_get_stats(result_cache_t* cache, pool_stats_t* stats);
+
+// 任务图
+void task_graph_node_done(task_internal_t* task);
+
+// 流式任务
+task_stream_t* task_stream_create(process_pool_t* pool, task_future_t* future);
+void worker_stream_begin(shared_memory_t* shm, uint64_t task_id);
+void worker_stream_end(void);
+
+// 以描述符传递的输入输出
+typedef struct {
+    const void* data;               // 内存中的数据(region.fd为-1时使用)
+    size_t size;                    // 内存数据大小
+    pool_fd_region_t region;        // 文件区域(fd >= 0时使用，不转移所有权)
+} task_fd_part_t;
+
+pool_error_t task_fd_attach_input(task_internal_t* task, const pool_fd_region_t* input);
+pool_error_t task_fd_attach_parts(task_internal_t* task, const task_fd_part_t* parts, uint32_t count);
+bool task_fd_send(int sock, uint64_t task_id, int fd);
+int task_fd_recv(process_pool_t* pool, int sock, uint64_t task_id);
+const void* worker_fd_map_input(int sock, const shm_record_t* rec, size_t* size);
+void worker_fd_unmap_input(void);
+bool worker_fd_take_output(pool_fd_region_t* region);
+
+// Worker放置
+pool_error_t affinity_init(process_pool_t* pool);
+int affinity_pin_self(int cpu);
+int affinity_bind_memory(void* addr, size_t size, int node);
+int affinity_benchmark(size_t num_operations, size_t data_size);
+
+// Zygote
+pool_error_t zygote_start(process_pool_t* pool);
+void zygote_stop(process_pool_t* pool);
+pid_t zygote_spawn_worker(process_pool_t* pool, worker_internal_t* worker);
+int zygote_request_spawn(process_pool_t* pool, worker_internal_t* worker);
+int zygote_recv_spawn(process_pool_t* pool, uint32_t* worker_id, uint32_t* token, pid_t* pid);
+void zygote_abort(process_pool_t* pool);
+void zygote_close_async(process_pool_t* pool);
+void zygote_collect_spawns(process_pool_t* pool);
+void zygote_close_in_child(process_pool_t* pool);
 
 // 任务管理
 task_internal_t* task_create(const task_desc_t* desc, const void* input_data, size_t input_size);
+bool task_create_batch(const task_desc_t* descs, const void** input_data,
+                       const size_t* input_sizes, uint32_t count,
+                       task_internal_t** tasks);
 void task_destroy(task_internal_t* task);
 pool_error_t task_set_result(task_internal_t* task, const void* result_data, size_t result_size);
+void task_set_result_fd(task_internal_t* task, const pool_fd_region_t* region);
 pool_error_t task_set_error(task_internal_t* task, int error_code, const char* error_message);
+void task_complete(task_internal_t* task, task_state_t state);
+void task_complete_batch(task_internal_t** tasks, const task_state_t* states, uint32_t count);
+bool task_is_completed(task_internal_t* task);
+void task_ref(task_internal_t* task);
+void task_unref(task_internal_t* task);
+pool_error_t task_wait(task_internal_t* task, uint32_t timeout_ms);
+pool_error_t task_cancel(task_internal_t* task);
+task_future_t* future_create(task_internal_t* task);
+void future_destroy(task_future_t* future);
 
 // 事件处理
 pool_error_t event_loop_init(process_pool_t* pool);
-void event_loop_cleanup(process_pool_t* pool);
-void* event_loop_thread(void* arg);
+void event_loop_cleanup(void);
+pool_error_t event_loop_start(void);
+pool_error_t event_loop_stop(void);
+pool_error_t event_loop_notify_task_submit(void);
+pool_error_t event_loop_notify_task_cancel(task_internal_t* task);
+pool_error_t event_loop_resize(uint32_t target_count);
+bool event_loop_defer_task(task_internal_t* task);
+pool_error_t event_loop_add_worker_events(uint32_t worker_id);
+pool_error_t event_loop_remove_worker_events(uint32_t worker_id);
+void event_loop_retire_worker(uint32_t worker_id);
+bool event_loop_release_retired(uint32_t worker_id);
+void event_loop_get_stats(uint64_t* events_processed, uint64_t* tasks_submitted,
+                          uint64_t* tasks_completed, uint64_t* worker_events,
+                          uint64_t* timer_events);
+pool_event_backend_t event_loop_backend(void);
+uint64_t event_loop_cpu_time_ns(void);
+int event_loop_benchmark(size_t num_events, uint32_t num_fds);
+pool_error_t assign_task_to_worker(process_pool_t* pool, task_internal_t* task);
 pool_error_t event_add_worker(process_pool_t* pool, worker_internal_t* worker);
 pool_error_t event_remove_worker(process_pool_t* pool, worker_internal_t* worker);
 
 // 共享内存
-shared_memory_t* shm_create(const char* name, size_t size);
-shared_memory_t* shm_open_existing(const char* name, size_t size);
-void shm_destroy(shared_memory_t* shm, const char* name, size_t size);
+pool_error_t shm_arena_create(shm_arena_t* arena, const char* name, size_t segment_size,
+                              uint32_t slots, pool_huge_pages_t huge_pages, bool seal);
+void shm_arena_destroy(shm_arena_t* arena);
+shared_memory_t* shm_arena_segment(const shm_arena_t* arena, uint32_t slot);
+shared_memory_t* shm_segment_init(shm_arena_t* arena, uint32_t slot, int numa_node);
+void shm_segment_release(shm_arena_t* arena, shared_memory_t* shm);
+size_t shm_segment_size(size_t ring_size);
+int shm_init_rings(shared_memory_t* shm, size_t ring_size, shm_ring_mode_t mode);
+
+// 流式任务管道
+void shm_stream_open(shm_stream_t* stream, uint64_t task_id);
+size_t shm_pipe_write(shm_pipe_t* pipe, const void* data, size_t size);
+size_t shm_pipe_read(shm_pipe_t* pipe, void* buffer, size_t size);
+bool shm_pipe_empty(shm_pipe_t* pipe);
+void shm_pipe_close(shm_pipe_t* pipe);
+void shm_pipe_abandon(shm_pipe_t* pipe);
+void shm_pipe_wait(shm_pipe_t* pipe, uint32_t seq, uint32_t timeout_ms);
 
-// 内存管理
-void* memory_pool_alloc(process_pool_t* pool, size_t size);
-void memory_pool_free(process_pool_t* pool, void* ptr);
-pool_error_t memory_pool_init(process_pool_t* pool, size_t size);
-void memory_pool_cleanup(process_pool_t* pool);
+// 共享内存环形队列
+shm_record_t* shm_ring_reserve(shm_ring_t* ring, size_t data_size, bool wait);
+shm_record_t* shm_ring_record_at(shm_ring_t* ring, uint64_t pos);
+void shm_ring_unreserve(shm_ring_t* ring, uint64_t mark);
+void shm_ring_commit(shm_ring_t* ring);
+void shm_ring_commit_batch(shm_ring_t* ring, uint32_t count);
+shm_record_t* shm_ring_peek(shm_ring_t* ring);
+void shm_ring_release(shm_ring_t* ring);
+typedef void (*shm_consume_fn)(shm_record_t* rec, void* arg);
+uint32_t shm_ring_consume_batch(shm_ring_t* ring, uint32_t max_count,
+                                shm_consume_fn consume, void* arg);
+int shm_queue_enqueue(shm_ring_t* ring, const void* data, size_t data_size);
+int shm_queue_dequeue(shm_ring_t* ring, void* data, size_t* data_size, uint32_t timeout_ms);
+int shm_queue_try_enqueue(shm_ring_t* ring, const void* data, size_t data_size);
+int shm_queue_try_dequeue(shm_ring_t* ring, void* data, size_t* data_size);
+int shm_benchmark(size_t num_operations, size_t data_size);
 
 // 监控和统计
 void stats_update(process_pool_t* pool);
 void stats_task_submitted(process_pool_t* pool);
+void stats_task_submitted_batch(process_pool_t* pool, uint32_t count);
 void stats_task_completed(process_pool_t* pool, uint64_t duration_ns);
 void stats_task_failed(process_pool_t* pool);
+void stats_task_timeout(process_pool_t* pool);
+void stats_task_cancelled(process_pool_t* pool);
+void stats_cancel_escalated(process_pool_t* pool, bool recycled);
+void stats_worker_spawned(process_pool_t* pool, uint64_t duration_ns, bool via_zygote);
+void stats_task_deadline(process_pool_t* pool, pool_sched_policy_t policy,
+                         bool met, bool dropped);
+void stats_task_dispatched(process_pool_t* pool, task_priority_t priority,
+                           uint64_t wait_ns, bool aged, task_route_t route);
 
 // 日志记录
 void log_message(process_pool_t* pool, int level, const char* format, ...);
+void log_set_level(int level);
+int log_get_level(void);
 
 // 工具函数
 uint64_t get_time_ns(void);
 uint32_t next_power_of_2(uint32_t n);
 bool is_power_of_2(uint32_t n);
+uint64_t hash_memory(const void* data, size_t size);
 int create_eventfd(void);
 int create_timerfd(void);
 int create_signalfd(void);
 
+// 指标注册表
+typedef struct {
+    uint64_t count;                 // 记录次数
+    uint64_t total_time;            // 总耗时(纳秒)
+    uint64_t min_time;              // 最小耗时
+    uint64_t max_time;              // 最大耗时
+    uint64_t avg_time;              // 平均耗时
+} latency_stats_t;
+
+typedef struct {
+    uint64_t total_count;           // 观测次数
+    uint64_t total_sum;             // 观测值之和
+    double average;                 // 平均值
+    uint64_t buckets[METRICS_HISTOGRAM_BUCKETS];            // 各桶计数
+    uint64_t bucket_boundaries[METRICS_HISTOGRAM_BUCKETS];  // 各桶上界(含)
+} histogram_stats_t;
+
+typedef struct {
+    uint64_t user_cpu_time;         // 用户态CPU时间(纳秒)
+    uint64_t system_cpu_time;       // 内核态CPU时间(纳秒)
+    unsigned long max_resident_set_size; // 峰值RSS(字节)
+    unsigned long current_rss;      // 当前RSS(字节)
+    unsigned long virtual_memory_size; // 虚拟内存大小(字节)
+    unsigned long page_faults;      // 缺页次数
+    unsigned long voluntary_context_switches;   // 主动上下文切换次数
+    unsigned long involuntary_context_switches; // 被动上下文切换次数
+    uint64_t timestamp;             // 采样时间
+} resource_usage_t;
+
+typedef struct {
+    int pid;                        // 进程ID
+    char state;                     // 进程状态(/proc/pid/stat第3列)
+    int ppid;                       // 父进程ID
+    long num_threads;               // 线程数
+    long priority;                  // 调度优先级
+    long nice;                      // nice值
+    unsigned long user_time;        // 用户态时间(时钟滴答)
+    unsigned long system_time;      // 内核态时间(时钟滴答)
+    unsigned long long virtual_memory; // 虚拟内存大小(字节)
+    unsigned long long resident_memory; // 驻留内存(字节)
+    unsigned long minor_faults;     // 次缺页次数
+    unsigned long major_faults;     // 主缺页次数
+    unsigned long long start_time;  // 启动时间(系统启动后的时钟滴答)
+    uint64_t timestamp;             // 采样时间
+} process_stats_t;
+
+int metrics_init(void);
+void metrics_cleanup(void);
+int metrics_counter_register(const char* name);
+void metrics_counter_inc(int counter_id);
+void metrics_counter_add(int counter_id, uint64_t value);
+uint64_t metrics_counter_get(int counter_id);
+void metrics_counter_reset(int counter_id);
+int metrics_latency_register(const char* name);
+void metrics_latency_record(int latency_id, uint64_t latency_ns);
+latency_stats_t metrics_latency_get(int latency_id);
+void metrics_latency_reset(int latency_id);
+int metrics_histogram_register(const char* name, const uint64_t* boundaries, int bucket_count);
+void metrics_histogram_observe(int histogram_id, uint64_t value);
+histogram_stats_t metrics_histogram_get(int histogram_id);
+void metrics_histogram_reset(int histogram_id);
+resource_usage_t get_resource_usage(void);
+process_stats_t get_process_stats(pid_t pid);
+void metrics_print_summary(FILE* output);
+void metrics_export_json(FILE* output);
+void metrics_reset_all(void);
+char* format_time_ns(uint64_t nanoseconds, char* buffer, size_t buffer_size);
+
 // 调试和追踪
 void trace_task_start(task_internal_t* task);
 void trace_task_end(task_internal_t* task);
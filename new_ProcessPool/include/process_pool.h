@@ -11,6 +11,9 @@
 extern "C" {
 #endif
 
+// 库以-fvisibility=hidden编译，只导出本头文件声明的接口
+#pragma GCC visibility push(default)
+
 // 现代进程池版本信息
 #define PROCESS_POOL_VERSION_MAJOR 2
 #define PROCESS_POOL_VERSION_MINOR 0
@@ -21,6 +24,13 @@ extern "C" {
 #define MAX_TASK_DATA_SIZE (64 * 1024)  // 64KB
 #define MAX_RESULT_DATA_SIZE (64 * 1024)
 #define DEFAULT_QUEUE_SIZE 4096
+#define DEFAULT_SHM_RING_SIZE (1024 * 1024)  // 1MB
+#define DEFAULT_WORKER_QUEUE_DEPTH 8      // 每个Worker默认最多在途任务数
+#define DEFAULT_PRIORITY_AGING_MS 500     // 默认每等待500ms提升一级优先级
+#define DEFAULT_CANCEL_SIGNAL_MS 100      // 取消后默认100ms仍在执行则发送SIGUSR1
+#define DEFAULT_CANCEL_KILL_MS 1000       // 发送信号后默认1s仍在执行则回收Worker
+#define DEFAULT_WORKER_SPIN_US 0          // 默认不忙等，提交环为空时直接休眠
+#define DEFAULT_SCALE_WAIT_P95_MS 50      // 默认排队时间p95超过50ms时扩容
 #define MAX_TASK_NAME_LEN 64
 
 // 错误码定义
@@ -32,7 +42,8 @@ typedef enum {
     POOL_ERROR_TIMEOUT = -4,
     POOL_ERROR_QUEUE_FULL = -5,
     POOL_ERROR_WORKER_DEAD = -6,
-    POOL_ERROR_SHUTDOWN = -7
+    POOL_ERROR_SHUTDOWN = -7,
+    POOL_ERROR_STREAM_CLOSED = -8
 } pool_error_t;
 
 // 任务优先级
@@ -43,6 +54,24 @@ typedef enum {
     TASK_PRIORITY_URGENT = 3
 } task_priority_t;
 
+#define TASK_PRIORITY_COUNT 4
+
+// 调度策略
+typedef enum {
+    POOL_SCHED_FIFO = 0,            // 按提交顺序分发
+    POOL_SCHED_PRIORITY = 1,        // 按优先级分发，等待过久的任务逐级提升
+    POOL_SCHED_EDF = 2              // 截止时间最早者优先，提前丢弃已无法按时完成的任务
+} pool_sched_policy_t;
+
+#define POOL_SCHED_POLICY_COUNT 3
+
+// 事件循环后端
+typedef enum {
+    POOL_EVENT_BACKEND_AUTO = 0,    // 编译时启用且内核支持时使用io_uring，否则epoll
+    POOL_EVENT_BACKEND_EPOLL = 1,   // epoll等待就绪后逐个read
+    POOL_EVENT_BACKEND_IO_URING = 2 // io_uring multishot读取，就绪与读取一步完成
+} pool_event_backend_t;
+
 // Worker状态
 typedef enum {
     WORKER_STATE_IDLE = 0,
@@ -62,26 +91,47 @@ typedef enum {
     TASK_STATE_CANCELLED = 5
 } task_state_t;
 
+// Worker绑核策略
+typedef enum {
+    POOL_AFFINITY_NONE = 0,         // 不绑核，由内核调度
+    POOL_AFFINITY_COMPACT = 1,      // 依次占满一个NUMA节点的核心(含超线程)再用下一个节点
+    POOL_AFFINITY_SCATTER = 2,      // 在NUMA节点和物理核心间轮转，最后才使用超线程
+    POOL_AFFINITY_CPU_LIST = 3      // 按affinity_cpu_list给出的CPU依次绑定
+} pool_affinity_policy_t;
+
+// 共享内存段的大页策略
+typedef enum {
+    POOL_HUGE_PAGES_OFF = 0,        // 普通4KB页
+    POOL_HUGE_PAGES_AUTO = 1,       // 优先hugetlb大页(MFD_HUGETLB)，不可用时退回透明大页
+    POOL_HUGE_PAGES_THP = 2         // 只建议透明大页(MADV_HUGEPAGE)
+} pool_huge_pages_t;
+
 // 前向声明
 typedef struct process_pool process_pool_t;
 typedef struct task_future task_future_t;
+typedef struct task_graph task_graph_t;
+typedef struct task_stream task_stream_t;
 
 // 任务处理函数类型
 typedef int (*task_handler_t)(const void* input_data, size_t input_size,
                              void** output_data, size_t* output_size,
                              void* user_context);
 
+// Worker进程初始化函数类型
+typedef void (*worker_init_t)(void* user_context);
+
 // 任务完成回调函数类型
 typedef void (*task_callback_t)(uint64_t task_id, task_state_t state,
                                const void* result_data, size_t result_size,
                                void* user_data);
 
 // 进程池配置结构
+// 新增字段只追加在末尾，已有字段的偏移保持不变
 typedef struct {
     uint32_t min_workers;           // 最小worker数量
     uint32_t max_workers;           // 最大worker数量
     uint32_t queue_size;            // 任务队列大小
-    uint32_t worker_idle_timeout;   // worker空闲超时(秒)
+    uint32_t worker_idle_timeout;   // worker空闲超时(秒)，自动扩缩容时空闲超过该时间的Worker被回收
     uint32_t task_timeout;          // 任务超时(秒)
     bool enable_auto_scaling;       // 是否启用自动扩缩容
     bool enable_metrics;            // 是否启用指标收集
@@ -89,6 +139,25 @@ typedef struct {
     const char* pool_name;          // 进程池名称
     task_handler_t default_handler; // 默认任务处理函数
     void* user_context;             // 用户上下文
+
+    size_t shm_ring_size;           // 每个Worker共享内存环的字节数(0表示默认)
+    pool_huge_pages_t shm_huge_pages; // 共享内存段的大页策略
+    bool shm_seal;                  // 是否封印共享内存arena的大小(F_SEAL_SHRINK/F_SEAL_GROW)
+    size_t result_cache_bytes;      // 结果缓存容量(字节，0表示不启用)，只缓存cacheable任务的结果
+    bool enable_single_flight;      // 是否合并相同的在途cacheable任务，重复提交共享第一个任务的执行和结果(优先级更高或超时不同的提交不合并)
+    uint32_t worker_queue_depth;    // 每个Worker最多在途任务数(0表示默认，紧急任务不受限)
+    uint32_t priority_aging_ms;     // 任务每等待多久提升一级优先级(0表示不老化)
+    pool_sched_policy_t sched_policy; // 调度策略
+    uint32_t cancel_signal_ms;      // 取消后仍在执行多久向Worker发送SIGUSR1(0表示不发送)
+    uint32_t cancel_kill_ms;        // 发送SIGUSR1后仍在执行多久回收Worker(0表示不回收)
+    uint32_t worker_spin_us;        // Worker处理完任务后忙等新任务的最长时间(微秒，0表示不忙等)
+    pool_event_backend_t event_backend; // 事件循环后端(不可用时回退到epoll)
+    pool_affinity_policy_t affinity_policy; // Worker绑核策略，共享内存段随Worker放在同一NUMA节点
+    const char* affinity_cpu_list;  // CPU_LIST策略使用的CPU列表，如"0-3,8"(与cgroup cpuset取交集)
+    uint32_t scale_wait_p95_ms;     // 自动扩缩容的排队时间p95目标(毫秒，0表示默认)
+    bool enable_work_stealing;      // 是否允许空闲Worker窃取其他Worker的待执行任务
+    bool enable_zygote;             // 是否由预先初始化的zygote进程派生Worker
+    worker_init_t worker_init;      // Worker进程初始化函数(可选，启用zygote时只在zygote中执行一次)
 } pool_config_t;
 
 // 任务描述结构
@@ -100,6 +169,9 @@ typedef struct {
     task_callback_t callback;       // 完成回调(可选)
     void* callback_data;            // 回调用户数据
     uint64_t trace_id;              // 追踪ID
+    uint64_t routing_key;           // 路由键(0表示不指定)，相同键的任务尽量分发到同一Worker
+    bool cacheable;                 // 处理函数对相同输入总是产生相同结果，可使用结果缓存
+    bool streaming;                 // 流式任务(由pool_submit_stream设置)，输入输出分块传递，不受大小上限限制
 } task_desc_t;
 
 // 任务结果结构
@@ -115,7 +187,33 @@ typedef struct {
     uint32_t worker_id;             // 处理的worker ID
 } task_result_t;
 
+// 以文件描述符传递的数据区域(可读的普通文件中的一段)
+typedef struct {
+    int fd;                         // 文件描述符
+    uint64_t offset;                // 区域起始偏移
+    size_t length;                  // 区域长度
+} pool_fd_region_t;
+
+// 任务图节点描述
+typedef struct {
+    task_desc_t desc;               // 任务描述
+    const void* input_data;         // 节点自身的输入(可选，不超过MAX_TASK_DATA_SIZE)，依赖节点的输出按deps顺序拼接在其后
+    size_t input_size;              // 节点自身的输入大小
+    const uint32_t* deps;           // 依赖的节点下标(可选)
+    uint32_t dep_count;             // 依赖数量
+} task_graph_node_t;
+
+// 任务图执行时间
+typedef struct {
+    uint64_t wall_time_ns;          // 提交到最后一个节点结束的时间
+    uint64_t critical_path_ns;      // 关键路径上各节点执行时间之和
+    uint32_t critical_path_nodes;   // 关键路径的节点数
+    uint32_t completed_nodes;       // 成功完成的节点数
+    uint32_t failed_nodes;          // 失败、超时、取消或因依赖失败未执行的节点数
+} pool_graph_timing_t;
+
 // 进程池统计信息
+// 新增字段只追加在末尾，已有字段的偏移保持不变
 typedef struct {
     uint32_t active_workers;        // 活跃worker数量
     uint32_t idle_workers;          // 空闲worker数量
@@ -129,6 +227,46 @@ typedef struct {
     double cpu_usage;               // CPU使用率
     size_t memory_usage;            // 内存使用量
     uint64_t uptime_seconds;        // 运行时间
+
+    uint64_t total_timeout;         // 总超时任务数
+    uint64_t total_cancelled;       // 总取消任务数
+    uint64_t cancel_signals;        // 因取消向Worker发送SIGUSR1的次数
+    uint64_t cancel_recycles;       // 因取消回收Worker的次数
+    uint64_t doorbells_sent;        // 写task_eventfd唤醒Worker的次数
+    uint64_t doorbells_suppressed;  // Worker未休眠而省去的唤醒次数
+    uint32_t pending_by_priority[TASK_PRIORITY_COUNT];      // 各优先级待分发任务数
+    uint64_t dispatched_by_priority[TASK_PRIORITY_COUNT];   // 各优先级已分发任务数
+    uint64_t avg_wait_ns_by_priority[TASK_PRIORITY_COUNT];  // 各优先级平均排队时间
+    uint64_t max_wait_ns_by_priority[TASK_PRIORITY_COUNT];  // 各优先级最大排队时间
+    uint64_t aged_dispatches;       // 因老化而先于更高优先级分发的任务数
+    uint64_t routed_dispatches;     // 带路由键分发的任务数
+    uint64_t route_hits;            // 其中分发到键所属Worker的任务数
+    uint64_t route_spills;          // 其中因所属Worker过载或不可用而改派的任务数
+    double route_hit_rate;          // 路由命中率(route_hits / routed_dispatches)
+    uint64_t result_cache_hits;     // 命中结果缓存、未经Worker即完成的提交数
+    uint64_t result_cache_misses;   // 可缓存但未命中的提交数
+    uint64_t result_cache_evictions; // 因容量不足按LRU淘汰的结果数
+    size_t result_cache_bytes;      // 结果缓存当前占用的字节数
+    uint32_t result_cache_entries;  // 结果缓存当前的条目数
+    uint64_t single_flight_joins;   // 合并到相同在途任务上、未单独执行的提交数
+    uint32_t single_flight_inflight; // 当前登记的在途领头任务数
+    pool_sched_policy_t sched_policy; // 当前调度策略
+    pool_event_backend_t event_backend; // 实际使用的事件循环后端
+    uint64_t loop_events;           // 事件循环处理的事件数
+    uint64_t loop_cpu_time_ns;      // 事件循环线程消耗的CPU时间
+    uint64_t workers_spawned;       // 启动(含重启)的Worker进程数
+    uint64_t zygote_spawns;         // 其中由zygote派生的数量
+    uint64_t avg_spawn_ns;          // 平均Worker派生耗时
+    uint64_t max_spawn_ns;          // 最大Worker派生耗时
+    uint32_t target_workers;        // 当前目标Worker数量
+    double queue_depth_ewma;        // 自动扩缩容观测到的积压任务数(EWMA)
+    double worker_utilization;      // 自动扩缩容观测到的Worker利用率(EWMA，0-1)
+    uint64_t queue_wait_p95_ns;     // 最近一个控制周期的排队时间p95
+    uint64_t scale_ups;             // 自动扩容次数
+    uint64_t scale_downs;           // 自动缩容(回收空闲Worker)次数
+    uint64_t deadline_met_by_policy[POOL_SCHED_POLICY_COUNT];     // 按时完成的限时任务数
+    uint64_t deadline_missed_by_policy[POOL_SCHED_POLICY_COUNT];  // 错过截止时间的限时任务数(含提前丢弃)
+    uint64_t deadline_dropped_by_policy[POOL_SCHED_POLICY_COUNT]; // 因无法按时完成而提前丢弃的任务数
 } pool_stats_t;
 
 // Worker信息结构
@@ -141,6 +279,11 @@ typedef struct {
     double cpu_usage;               // CPU使用率
     size_t memory_usage;            // 内存使用量
     uint64_t current_task_id;       // 当前处理的任务ID
+    uint64_t tasks_stolen;          // 从其他Worker窃取的任务数
+    uint64_t tasks_stolen_from;     // 被其他Worker窃取的任务数
+    uint64_t route_hits;            // 按路由键分发到该Worker的任务数
+    int cpu;                        // 绑定的CPU(-1表示未绑定)
+    int numa_node;                  // 共享内存段所在NUMA节点(-1表示未绑定)
 } worker_info_t;
 
 // ============================================================================
@@ -195,8 +338,13 @@ pool_error_t pool_submit_async(process_pool_t* pool,
 
 /**
  * 批量提交任务
+ * 整批共用一次内存池分配、队列发布和事件循环通知，适合突发提交大量任务。
+ * 任务按顺序入队，队列满时返回POOL_ERROR_QUEUE_FULL，此前的任务已提交，
+ * 对应的future有效，其余future为NULL
  * @param pool 进程池句柄
  * @param tasks 任务数组
+ * @param input_data 各任务的输入数据(可为NULL)
+ * @param input_sizes 各任务的输入大小(可为NULL)
  * @param count 任务数量
  * @param futures 返回的future数组
  * @return 成功返回POOL_SUCCESS
@@ -226,6 +374,14 @@ pool_error_t pool_future_wait(task_future_t* future,
  */
 pool_error_t pool_future_cancel(task_future_t* future);
 
+/**
+ * 查询当前任务是否已被取消或超时
+ * 仅在任务处理函数中(Worker进程内)调用，长时间运行的处理函数应定期检查并尽快返回。
+ * 处理函数忽略取消时，Worker会先收到SIGUSR1(会中断阻塞的系统调用)，之后被回收
+ * @return 已取消返回true
+ */
+bool pool_task_is_cancelled(void);
+
 /**
  * 释放future对象
  * @param future future对象
@@ -259,6 +415,14 @@ pool_error_t pool_get_workers(process_pool_t* pool,
  */
 pool_error_t pool_resize(process_pool_t* pool, uint32_t target_count);
 
+/**
+ * 切换调度策略，尚未分发的任务按新策略重新排序
+ * @param pool 进程池句柄
+ * @param policy 调度策略
+ * @return 成功返回POOL_SUCCESS
+ */
+pool_error_t pool_set_sched_policy(process_pool_t* pool, pool_sched_policy_t policy);
+
 /**
  * 优雅停止进程池
  * @param pool 进程池句柄
@@ -290,6 +454,201 @@ const char* pool_error_string(pool_error_t error);
  */
 uint64_t pool_get_time_ns(void);
 
+/**
+ * 由任意字节串计算task_desc_t.routing_key
+ * @param key 键数据
+ * @param key_size 键长度
+ * @return 非0路由键，key为空时返回0(不指定)
+ */
+uint64_t pool_routing_key(const void* key, size_t key_size);
+
+/**
+ * 提交流式任务
+ * 输入和输出通过执行任务的Worker段内的两个有界管道分块传递，总大小不受
+ * MAX_TASK_DATA_SIZE限制，两端内存占用固定。调用方用pool_stream_write写入
+ * 输入并以pool_stream_close结束，同时用pool_stream_read读取输出；处理函数用
+ * pool_task_stream_read/pool_task_stream_write读写。处理函数返回后Worker等待
+ * 调用方取完输出才完成任务，因此应先读完输出再等待future。
+ * 流式任务的执行时间取决于调用方读写的快慢，不受配置的task_timeout限制，
+ * 只在desc->timeout_ms非0时按它限时(从提交起算，含等待调用方读完输出的时间)。
+ * 流式任务不会被其他Worker窃取，也不使用结果缓存和单飞合并
+ * @param pool 进程池句柄
+ * @param desc 任务描述
+ * @param input_data 随任务一起发送的首段输入(可选，不超过MAX_TASK_DATA_SIZE)
+ * @param input_size 首段输入大小
+ * @param stream 返回的流句柄
+ * @return 成功返回POOL_SUCCESS
+ */
+pool_error_t pool_submit_stream(process_pool_t* pool,
+                               const task_desc_t* desc,
+                               const void* input_data,
+                               size_t input_size,
+                               task_stream_t** stream);
+
+/**
+ * 写入流式任务的输入，管道满时等待处理函数读取
+ * @param stream 流句柄
+ * @param data 数据
+ * @param size 数据大小
+ * @param timeout_ms 超时时间(毫秒，0表示一直等待)
+ * @return 全部写入返回POOL_SUCCESS；任务已结束或处理函数不再读取输入时
+ *         返回POOL_ERROR_STREAM_CLOSED
+ */
+pool_error_t pool_stream_write(task_stream_t* stream, const void* data, size_t size,
+                              uint32_t timeout_ms);
+
+/**
+ * 结束流式任务的输入，处理函数读完已写入的数据后读到输入结束
+ * @param stream 流句柄
+ * @return 成功返回POOL_SUCCESS
+ */
+pool_error_t pool_stream_close(task_stream_t* stream);
+
+/**
+ * 读取流式任务的输出，没有数据时等待处理函数写入
+ * @param stream 流句柄
+ * @param buffer 缓冲区
+ * @param size 缓冲区大小
+ * @param bytes_read 实际读取的字节数，0表示输出已结束
+ * @param timeout_ms 超时时间(毫秒，0表示一直等待)
+ * @return 成功返回POOL_SUCCESS
+ */
+pool_error_t pool_stream_read(task_stream_t* stream, void* buffer, size_t size,
+                             size_t* bytes_read, uint32_t timeout_ms);
+
+/**
+ * 获取流式任务的future(由流句柄持有，不要单独释放)，处理函数的返回值和
+ * 最终结果通过它获取
+ * @param stream 流句柄
+ * @return future对象
+ */
+task_future_t* pool_stream_future(task_stream_t* stream);
+
+/**
+ * 释放流句柄；任务尚未结束时取消任务
+ * @param stream 流句柄
+ */
+void pool_stream_destroy(task_stream_t* stream);
+
+/**
+ * 读取当前流式任务的输入，仅在流式任务的处理函数中(Worker进程内)调用
+ * @param buffer 缓冲区
+ * @param size 缓冲区大小
+ * @param bytes_read 实际读取的字节数，0表示输入已结束
+ * @return 成功返回POOL_SUCCESS，任务已取消返回POOL_ERROR_STREAM_CLOSED
+ */
+pool_error_t pool_task_stream_read(void* buffer, size_t size, size_t* bytes_read);
+
+/**
+ * 写入当前流式任务的输出，管道满时等待调用方读取，仅在流式任务的处理函数中调用
+ * @param data 数据
+ * @param size 数据大小
+ * @return 全部写入返回POOL_SUCCESS；任务已取消或调用方不再读取时返回
+ *         POOL_ERROR_STREAM_CLOSED
+ */
+pool_error_t pool_task_stream_write(const void* data, size_t size);
+
+/**
+ * 以文件描述符提交任务输入(零拷贝)
+ * 进程池复制一份描述符，调用返回后调用方即可关闭自己的描述符。分发时描述符
+ * 经Worker的Unix套接字(SCM_RIGHTS)传给执行者，区域内容作为处理函数的输入，
+ * 数据不经过共享内存环，大小不受MAX_TASK_DATA_SIZE限制。
+ * fd可以是任意可读的普通文件：以F_SEAL_SHRINK和F_SEAL_WRITE封印的memfd
+ * (memfd_create须带MFD_ALLOW_SEALING)不会被截断或改写，Worker直接只读映射，
+ * 不复制数据；其他文件由Worker以pread复制一份，执行前文件被截断时任务失败，
+ * 被改写时处理函数读到的内容不确定。
+ * 这类任务不会被其他Worker窃取，也不使用结果缓存和单飞合并
+ * @param pool 进程池句柄
+ * @param desc 任务描述
+ * @param input 输入区域，fd须为可读的普通文件，length不能为0且区域在文件范围内
+ * @param future 返回的future对象
+ * @return 成功返回POOL_SUCCESS，描述符不满足要求或区域越界时返回
+ *         POOL_ERROR_INVALID_PARAM
+ */
+pool_error_t pool_submit_fd(process_pool_t* pool,
+                           const task_desc_t* desc,
+                           const pool_fd_region_t* input,
+                           task_future_t** future);
+
+/**
+ * 取处理函数以pool_task_output_fd返回的结果区域，任务成功完成后调用
+ * 返回的是新复制的描述符，由调用方关闭；同一future可多次调用
+ * @param future future对象
+ * @param region 结果区域输出
+ * @return 成功返回POOL_SUCCESS，任务未完成或没有以描述符返回结果时返回
+ *         POOL_ERROR_INVALID_PARAM
+ */
+pool_error_t pool_future_get_fd(task_future_t* future, pool_fd_region_t* region);
+
+/**
+ * 以文件描述符返回当前任务的结果，仅在处理函数中(Worker进程内)调用
+ * 复制一份描述符，处理函数返回0后经Unix套接字传回Master，调用方用
+ * pool_future_get_fd取得；处理函数之后即可关闭自己的描述符。可与常规输出
+ * 同时使用，多次调用时以最后一次为准。与pool_submit_fd相同，fd可以是任意
+ * 可读的普通文件；调用方读取未封印的文件时自行处理截断(映射时的SIGBUS)
+ * @param fd 文件描述符(可读的普通文件)
+ * @param offset 结果区域起始偏移
+ * @param length 结果区域长度
+ * @return 成功返回POOL_SUCCESS
+ */
+pool_error_t pool_task_output_fd(int fd, uint64_t offset, size_t length);
+
+/**
+ * 提交任务图
+ * 没有依赖的节点立即入队，其余节点在全部依赖成功完成后由完成依赖的线程
+ * (通常是事件循环)入队，输入为节点自身的输入加上各依赖节点的输出，
+ * 不经过提交线程；任一依赖未成功完成时节点以TASK_STATE_CANCELLED结束。
+ * 依赖的常规输出在前、以描述符返回的结果(pool_task_output_fd)在后。
+ * 拼接后超过MAX_TASK_DATA_SIZE或含有描述符结果时，输入写入封印的memfd
+ * 以描述符交给节点，大小不受MAX_TASK_DATA_SIZE限制；唯一的依赖只以描述符
+ * 返回结果时直接转交该描述符，数据不经过Master复制。
+ * 节点不使用结果缓存和单飞合并
+ * @param pool 进程池句柄
+ * @param nodes 节点数组，deps为节点在数组中的下标，不能成环
+ * @param count 节点数量
+ * @param graph 返回的任务图句柄
+ * @return 成功返回POOL_SUCCESS
+ */
+pool_error_t pool_submit_graph(process_pool_t* pool,
+                              const task_graph_node_t* nodes,
+                              uint32_t count,
+                              task_graph_t** graph);
+
+/**
+ * 等待任务图的全部节点结束
+ * @param graph 任务图句柄
+ * @param timeout_ms 超时时间(毫秒，0表示一直等待)
+ * @return 全部节点结束返回POOL_SUCCESS，不论各节点是否成功
+ */
+pool_error_t pool_graph_wait(task_graph_t* graph, uint32_t timeout_ms);
+
+/**
+ * 获取节点的future，用pool_future_wait取结果，用完后调用pool_future_destroy
+ * @param graph 任务图句柄
+ * @param index 节点下标
+ * @return future对象，下标无效时返回NULL
+ */
+task_future_t* pool_graph_node_future(task_graph_t* graph, uint32_t index);
+
+/**
+ * 获取任务图的执行时间和关键路径
+ * @param graph 任务图句柄
+ * @param timing 执行时间输出
+ * @param path 关键路径上的节点下标输出，从根节点开始(可为NULL)
+ * @param path_capacity path数组容量
+ * @return 任务图尚未结束返回POOL_ERROR_INVALID_PARAM
+ */
+pool_error_t pool_graph_get_timing(task_graph_t* graph,
+                                  pool_graph_timing_t* timing,
+                                  uint32_t* path,
+                                  uint32_t path_capacity);
+
+/**
+ * 释放任务图句柄，未结束的节点继续执行
+ * @param graph 任务图句柄
+ */
+void pool_graph_destroy(task_graph_t* graph);
+
 /**
  * 设置日志级别
  * @param level 日志级别(0-4)
@@ -302,6 +661,8 @@ void pool_set_log_level(int level);
  */
 const char* pool_get_version(void);
 
+#pragma GCC visibility pop
+
 #ifdef __cplusplus
 }
 #endif
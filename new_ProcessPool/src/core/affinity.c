@@ -0,0 +1,572 @@
+#define _GNU_SOURCE
+#include "../../include/internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sched.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+// ============================================================================
+// CPU拓扑
+// ============================================================================
+
+/**
+ * 拓扑直接读取sysfs，不依赖libnuma：
+ * - /sys/devices/system/node/nodeN/cpulist 给出每个NUMA节点的CPU
+ * - /sys/devices/system/cpu/cpuN/topology 给出物理封装和核心编号
+ * 可用CPU取进程亲和性掩码与所在cgroup的cpuset.cpus.effective的交集，
+ * 容器中只在分配给本容器的CPU上放置Worker
+ */
+
+#define AFFINITY_MAX_NODES 64
+
+typedef struct {
+    int cpu;                        // CPU编号
+    int node;                       // NUMA节点
+    int package;                    // 物理封装(插槽)
+    int core;                       // 核心编号
+    int thread;                     // 同一核心上的第几个超线程
+    int core_rank;                  // 在本节点中的第几个核心
+} cpu_topo_t;
+
+static int read_int_file(const char* path, int default_value) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        return default_value;
+    }
+    
+    int value;
+    if (fscanf(fp, "%d", &value) != 1) {
+        value = default_value;
+    }
+    
+    fclose(fp);
+    return value;
+}
+
+/**
+ * 解析"0-3,8,10-11"格式的CPU列表
+ * @return 格式错误返回false
+ */
+static bool parse_cpu_list(const char* list, cpu_set_t* set) {
+    CPU_ZERO(set);
+    
+    const char* p = list;
+    while (*p) {
+        while (*p == ' ' || *p == ',' || *p == '\n') {
+            p++;
+        }
+        if (!*p) {
+            break;
+        }
+    
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0 || first >= CPU_SETSIZE) {
+            return false;
+        }
+    
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            p++;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first || last >= CPU_SETSIZE) {
+                return false;
+            }
+            p = end;
+        }
+    
+        for (long cpu = first; cpu <= last; cpu++) {
+            CPU_SET((int)cpu, set);
+        }
+    
+        if (*p && *p != ',' && *p != '\n' && *p != ' ') {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+static bool read_cpu_list_file(const char* path, cpu_set_t* set) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        return false;
+    }
+    
+    char buffer[4096];
+    bool ok = fgets(buffer, sizeof(buffer), fp) != NULL && parse_cpu_list(buffer, set);
+    
+    fclose(fp);
+    return ok;
+}
+
+/**
+ * 读取本进程所在cgroup的有效cpuset(v2为cpuset.cpus.effective，
+ * v1为cpuset控制器下的cpuset.effective_cpus)
+ */
+static bool read_cgroup_cpuset(cpu_set_t* set) {
+    FILE* fp = fopen("/proc/self/cgroup", "r");
+    if (!fp) {
+        return false;
+    }
+    
+    char line[1024];
+    char path[PATH_MAX];
+    bool found = false;
+    
+    while (!found && fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\n")] = '\0';
+    
+        if (strncmp(line, "0::", 3) == 0) {
+            snprintf(path, sizeof(path), "/sys/fs/cgroup%s/cpuset.cpus.effective", line + 3);
+            found = read_cpu_list_file(path, set);
+        } else {
+            char* controllers = strchr(line, ':');
+            char* cgroup = controllers ? strchr(controllers + 1, ':') : NULL;
+            if (cgroup && strstr(controllers, "cpuset")) {
+                snprintf(path, sizeof(path), "/sys/fs/cgroup/cpuset%s/cpuset.effective_cpus", cgroup + 1);
+                found = read_cpu_list_file(path, set);
+            }
+        }
+    }
+    
+    fclose(fp);
+    return found && CPU_COUNT(set) > 0;
+}
+
+static void affinity_allowed_cpus(cpu_set_t* allowed) {
+    if (sched_getaffinity(0, sizeof(cpu_set_t), allowed) == -1) {
+        CPU_ZERO(allowed);
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long i = 0; i < n && i < CPU_SETSIZE; i++) {
+            CPU_SET((int)i, allowed);
+        }
+    }
+    
+    cpu_set_t cpuset;
+    if (read_cgroup_cpuset(&cpuset)) {
+        cpu_set_t both;
+        CPU_AND(&both, allowed, &cpuset);
+        if (CPU_COUNT(&both) > 0) {
+            *allowed = both;
+        }
+    }
+}
+
+/**
+ * 读取每个CPU所在的NUMA节点，没有节点信息的CPU归到节点0
+ * @return NUMA节点数
+ */
+static int affinity_read_nodes(int* node_of) {
+    for (int i = 0; i < CPU_SETSIZE; i++) {
+        node_of[i] = 0;
+    }
+    
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (!dir) {
+        return 1;
+    }
+    
+    int nodes = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        int node;
+        if (sscanf(entry->d_name, "node%d", &node) != 1 || node < 0 || node >= AFFINITY_MAX_NODES) {
+            continue;
+        }
+    
+        char path[PATH_MAX];
+        cpu_set_t set;
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        if (!read_cpu_list_file(path, &set)) {
+            continue;
+        }
+    
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                node_of[cpu] = node;
+            }
+        }
+        nodes++;
+    }
+    
+    closedir(dir);
+    return nodes > 0 ? nodes : 1;
+}
+
+static int topo_compare_compact(const void* a, const void* b) {
+    const cpu_topo_t* x = (const cpu_topo_t*)a;
+    const cpu_topo_t* y = (const cpu_topo_t*)b;
+    
+    if (x->node != y->node) return x->node - y->node;
+    if (x->package != y->package) return x->package - y->package;
+    if (x->core != y->core) return x->core - y->core;
+    return x->cpu - y->cpu;
+}
+
+static int topo_compare_scatter(const void* a, const void* b) {
+    const cpu_topo_t* x = (const cpu_topo_t*)a;
+    const cpu_topo_t* y = (const cpu_topo_t*)b;
+    
+    if (x->thread != y->thread) return x->thread - y->thread;
+    if (x->core_rank != y->core_rank) return x->core_rank - y->core_rank;
+    if (x->node != y->node) return x->node - y->node;
+    return x->cpu - y->cpu;
+}
+
+/**
+ * 按策略排列可用CPU
+ * - COMPACT: 同一节点、同一核心的超线程相邻，Worker集中在尽量少的节点上
+ * - SCATTER: 先在各节点间轮转，再在节点内跨核心，最后才使用超线程
+ * @return CPU数量
+ */
+static int affinity_order_cpus(const cpu_set_t* allowed, const int* node_of,
+                               pool_affinity_policy_t policy, cpu_topo_t* order) {
+    int count = 0;
+    
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, allowed)) {
+            continue;
+        }
+    
+        char path[PATH_MAX];
+        cpu_topo_t* topo = &order[count++];
+        topo->cpu = cpu;
+        topo->node = node_of[cpu];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+        topo->package = read_int_file(path, 0);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+        topo->core = read_int_file(path, cpu);
+    }
+    
+    qsort(order, (size_t)count, sizeof(cpu_topo_t), topo_compare_compact);
+    
+    if (policy != POOL_AFFINITY_SCATTER) {
+        return count;
+    }
+    
+    // 紧凑序中同一核心的超线程相邻，据此编号超线程和节点内核心
+    for (int i = 0; i < count; i++) {
+        cpu_topo_t* topo = &order[i];
+        if (i > 0 && order[i - 1].node == topo->node) {
+            const cpu_topo_t* prev = &order[i - 1];
+            bool same_core = prev->package == topo->package && prev->core == topo->core;
+            topo->thread = same_core ? prev->thread + 1 : 0;
+            topo->core_rank = same_core ? prev->core_rank : prev->core_rank + 1;
+        } else {
+            topo->thread = 0;
+            topo->core_rank = 0;
+        }
+    }
+    
+    qsort(order, (size_t)count, sizeof(cpu_topo_t), topo_compare_scatter);
+    return count;
+}
+
+static const char* affinity_policy_name(pool_affinity_policy_t policy) {
+    static const char* names[] = { "none", "compact", "scatter", "cpu-list" };
+    return (uint32_t)policy < sizeof(names) / sizeof(names[0]) ? names[policy] : "unknown";
+}
+
+// ============================================================================
+// 放置策略
+// ============================================================================
+
+/**
+ * 按配置计算每个Worker槽位的CPU和NUMA节点，结果保存在pool->worker_cpus/worker_nodes
+ * 只有一个NUMA节点时不绑定内存
+ */
+pool_error_t affinity_init(process_pool_t* pool) {
+    if (!pool) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    for (uint32_t i = 0; i < MAX_WORKERS; i++) {
+        pool->worker_cpus[i] = -1;
+        pool->worker_nodes[i] = -1;
+    }
+    
+    pool_affinity_policy_t policy = pool->config.affinity_policy;
+    if (policy == POOL_AFFINITY_NONE) {
+        return POOL_SUCCESS;
+    }
+    
+    cpu_set_t allowed;
+    affinity_allowed_cpus(&allowed);
+    
+    if (policy == POOL_AFFINITY_CPU_LIST) {
+        cpu_set_t requested;
+        if (!pool->config.affinity_cpu_list ||
+            !parse_cpu_list(pool->config.affinity_cpu_list, &requested)) {
+            log_message(pool, 0, "Invalid affinity_cpu_list: %s",
+                       pool->config.affinity_cpu_list ? pool->config.affinity_cpu_list : "(null)");
+            return POOL_ERROR_INVALID_PARAM;
+        }
+    
+        CPU_AND(&allowed, &allowed, &requested);
+        if (CPU_COUNT(&allowed) == 0) {
+            log_message(pool, 0, "affinity_cpu_list %s has no CPU usable by this process",
+                       pool->config.affinity_cpu_list);
+            return POOL_ERROR_INVALID_PARAM;
+        }
+    }
+    
+    int* node_of = malloc(sizeof(int) * CPU_SETSIZE);
+    cpu_topo_t* order = malloc(sizeof(cpu_topo_t) * CPU_SETSIZE);
+    if (!node_of || !order) {
+        free(node_of);
+        free(order);
+        return POOL_ERROR_NO_MEMORY;
+    }
+    
+    int nodes = affinity_read_nodes(node_of);
+    int count = affinity_order_cpus(&allowed, node_of, policy, order);
+    
+    for (uint32_t i = 0; i < MAX_WORKERS && count > 0; i++) {
+        const cpu_topo_t* topo = &order[i % (uint32_t)count];
+        pool->worker_cpus[i] = (int16_t)topo->cpu;
+        pool->worker_nodes[i] = nodes > 1 ? (int16_t)topo->node : -1;
+    }
+    
+    log_message(pool, 2, "Worker placement: %s over %d CPUs on %d NUMA node(s)",
+               affinity_policy_name(policy), count, nodes);
+    
+    free(node_of);
+    free(order);
+    return POOL_SUCCESS;
+}
+
+/**
+ * 把调用线程绑定到一个CPU，cpu小于0时不做任何事
+ */
+int affinity_pin_self(int cpu) {
+    if (cpu < 0) {
+        return 0;
+    }
+    
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    
+    return sched_setaffinity(0, sizeof(set), &set);
+}
+
+/**
+ * 把一段尚未访问的共享映射的内存策略设为优先从node分配
+ * 共享内存对象的策略对所有映射它的进程生效，node小于0时不做任何事。
+ * 使用MPOL_PREFERRED，节点内存不足时仍可从其他节点分配
+ */
+int affinity_bind_memory(void* addr, size_t size, int node) {
+    if (node < 0 || node >= AFFINITY_MAX_NODES) {
+        return 0;
+    }
+    
+    unsigned long mask = 1UL << node;
+    if (syscall(SYS_mbind, addr, size, MPOL_PREFERRED, &mask,
+                sizeof(mask) * 8, 0) == -1) {
+        return -1;
+    }
+    
+    return 0;
+}
+
+// ============================================================================
+// 放置性能测试
+// ============================================================================
+
+typedef struct {
+    shm_ring_t* ring;               // 被测环
+    size_t num_operations;          // 消息数量
+    size_t data_size;               // 消息大小
+    int cpu;                        // 消费者绑定的CPU
+} affinity_bench_consumer_t;
+
+static void* affinity_bench_consumer(void* arg) {
+    affinity_bench_consumer_t* ctx = (affinity_bench_consumer_t*)arg;
+    char* buffer = malloc(ctx->data_size);
+    if (!buffer) {
+        return NULL;
+    }
+    
+    affinity_pin_self(ctx->cpu);
+    
+    for (size_t i = 0; i < ctx->num_operations; i++) {
+        size_t read_size = ctx->data_size;
+        if (shm_queue_dequeue(ctx->ring, buffer, &read_size, 0) != 0) {
+            break;
+        }
+    }
+    
+    free(buffer);
+    return NULL;
+}
+
+/**
+ * 生产者(Master角色)绑定在master_cpu，消费者(Worker角色)绑定在worker_cpu，
+ * 环所在的段优先分配在mem_node上，测SPSC环的消息吞吐量
+ * @return 消息/秒，失败返回负数
+ */
+static double affinity_bench_run(int master_cpu, int worker_cpu, int mem_node,
+                                 size_t num_operations, size_t data_size) {
+    size_t size = shm_segment_size(0);
+    void* addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+        return -1.0;
+    }
+    
+    // 在初始化写入之前设置策略，页面按策略首次分配
+    affinity_bind_memory(addr, size, mem_node);
+    
+    shared_memory_t* shm = (shared_memory_t*)addr;
+    shm->size = size;
+    if (shm_init_rings(shm, 0, SHM_RING_SPSC) != 0) {
+        munmap(addr, size);
+        return -1.0;
+    }
+    
+    char* buffer = calloc(1, data_size);
+    if (!buffer) {
+        munmap(addr, size);
+        return -1.0;
+    }
+    
+    cpu_set_t saved;
+    bool restore = sched_getaffinity(0, sizeof(saved), &saved) == 0;
+    affinity_pin_self(master_cpu);
+    
+    affinity_bench_consumer_t ctx = {
+        .ring = &shm->submit_ring,
+        .num_operations = num_operations,
+        .data_size = data_size,
+        .cpu = worker_cpu
+    };
+    
+    pthread_t consumer;
+    if (pthread_create(&consumer, NULL, affinity_bench_consumer, &ctx) != 0) {
+        if (restore) {
+            sched_setaffinity(0, sizeof(saved), &saved);
+        }
+        free(buffer);
+        munmap(addr, size);
+        return -1.0;
+    }
+    
+    uint64_t start_time = get_time_ns();
+    
+    for (size_t i = 0; i < num_operations; i++) {
+        shm_queue_enqueue(&shm->submit_ring, buffer, data_size);
+    }
+    
+    pthread_join(consumer, NULL);
+    
+    uint64_t end_time = get_time_ns();
+    
+    if (restore) {
+        sched_setaffinity(0, sizeof(saved), &saved);
+    }
+    
+    pthread_mutex_destroy(&shm->submit_ring.mutex);
+    pthread_cond_destroy(&shm->submit_ring.not_empty);
+    pthread_cond_destroy(&shm->submit_ring.not_full);
+    pthread_mutex_destroy(&shm->complete_ring.mutex);
+    pthread_cond_destroy(&shm->complete_ring.not_empty);
+    pthread_cond_destroy(&shm->complete_ring.not_full);
+    
+    free(buffer);
+    munmap(addr, size);
+    
+    return (double)num_operations * 1000000000.0 / (end_time - start_time);
+}
+
+/**
+ * 对比Worker与其共享内存段的几种放置方式，用于多插槽机器上评估放置策略：
+ * - unpinned: 不绑核、不绑内存
+ * - same-node: Master、Worker和段都在节点A
+ * - placed: Worker在节点B，段在Worker所在的节点B(本库的放置方式)
+ * - misplaced: Worker在节点B，段在节点A
+ * 只有一个NUMA节点时只测前两项
+ */
+int affinity_benchmark(size_t num_operations, size_t data_size) {
+    if (num_operations == 0 || data_size == 0 || data_size > MAX_TASK_DATA_SIZE) {
+        return -1;
+    }
+    
+    cpu_set_t allowed;
+    affinity_allowed_cpus(&allowed);
+    
+    int* node_of = malloc(sizeof(int) * CPU_SETSIZE);
+    cpu_topo_t* order = malloc(sizeof(cpu_topo_t) * CPU_SETSIZE);
+    if (!node_of || !order) {
+        free(node_of);
+        free(order);
+        return -1;
+    }
+    
+    int nodes = affinity_read_nodes(node_of);
+    int count = affinity_order_cpus(&allowed, node_of, POOL_AFFINITY_COMPACT, order);
+    
+    // 节点A取第一个CPU所在节点，节点B取第一个不同节点的CPU
+    int master_cpu = count > 0 ? order[0].cpu : -1;
+    int local_cpu = count > 1 ? order[1].cpu : master_cpu;
+    int node_a = count > 0 ? order[0].node : 0;
+    int remote_cpu = -1;
+    int node_b = -1;
+    for (int i = 0; i < count; i++) {
+        if (order[i].node != node_a) {
+            remote_cpu = order[i].cpu;
+            node_b = order[i].node;
+            break;
+        }
+    }
+    
+    free(node_of);
+    free(order);
+    
+    if (master_cpu < 0) {
+        return -1;
+    }
+    
+    double unpinned = affinity_bench_run(-1, -1, -1, num_operations, data_size);
+    double same_node = affinity_bench_run(master_cpu, local_cpu, nodes > 1 ? node_a : -1,
+                                          num_operations, data_size);
+    double placed = -1.0;
+    double misplaced = -1.0;
+    if (remote_cpu >= 0) {
+        placed = affinity_bench_run(master_cpu, remote_cpu, node_b, num_operations, data_size);
+        misplaced = affinity_bench_run(master_cpu, remote_cpu, node_a, num_operations, data_size);
+    }
+    
+    if (unpinned < 0 || same_node < 0) {
+        return -1;
+    }
+    
+    printf("=== Worker Placement Benchmark ===\n");
+    printf("Operations: %zu\n", num_operations);
+    printf("Data Size: %zu bytes\n", data_size);
+    printf("NUMA nodes: %d, usable CPUs: %d\n", nodes, count);
+    printf("Unpinned:  %.2f msgs/sec\n", unpinned);
+    printf("Same node: %.2f msgs/sec (master cpu %d, worker cpu %d)\n",
+           same_node, master_cpu, local_cpu);
+    if (remote_cpu >= 0) {
+        printf("Placed:    %.2f msgs/sec (worker cpu %d, segment on node %d)\n",
+               placed, remote_cpu, node_b);
+        printf("Misplaced: %.2f msgs/sec (worker cpu %d, segment on node %d)\n",
+               misplaced, remote_cpu, node_a);
+        printf("Placement gain: %.2fx\n", placed / misplaced);
+    } else {
+        printf("Single NUMA node: cross-node placement not measured\n");
+    }
+    printf("==================================\n");
+    
+    return 0;
+}
@@ -0,0 +1,237 @@
+#define _GNU_SOURCE
+#include "../../include/internal.h"
+#include <string.h>
+
+// ============================================================================
+// 自动扩缩容控制器
+// ============================================================================
+
+/**
+ * 事件循环每个维护周期评估一次，在min_workers和max_workers之间调整Worker数：
+ *
+ * - 积压：待分发和未取出的任务数，取EWMA平滑突发
+ * - 排队时间p95：本周期内分发任务的排队时间，按log2直方图估算
+ * - 利用率：本周期完成任务数 x 平均处理时间 / (周期 x Worker数)，取EWMA
+ *
+ * 积压、p95或利用率任一超标并持续AUTOSCALE_UP_TICKS个周期时按当前规模
+ * 的一半扩容；三者都回落到缩容阈值以下并持续AUTOSCALE_DOWN_TICKS个周期，
+ * 且末尾Worker已空闲超过worker_idle_timeout时回收一个。扩容与缩容阈值
+ * 之间留有间隔，并各自带冷却时间，负载在阈值附近波动时不会来回震荡。
+ *
+ * 分发总是选在途任务最少且编号最小的Worker，轻载时末尾的Worker最先空闲，
+ * 缩容只需要移除末尾的Worker。
+ */
+
+/**
+ * 记录一次分发的排队时间，由stats_task_dispatched在持有stats_mutex时调用
+ */
+void autoscaler_record_wait(process_pool_t* pool, uint64_t wait_ns) {
+    autoscaler_t* scaler = &pool->scaler;
+    uint64_t wait_us = wait_ns / 1000;
+    uint32_t bucket = 0;
+    
+    while (wait_us > 0 && bucket < AUTOSCALE_WAIT_BUCKETS - 1) {
+        wait_us >>= 1;
+        bucket++;
+    }
+    
+    scaler->wait_hist[bucket]++;
+    scaler->wait_samples++;
+}
+
+/**
+ * 取出本周期的排队时间p95并清空直方图，调用方持有stats_mutex
+ * 返回所在桶的上界，没有样本时返回0
+ */
+static uint64_t autoscaler_take_wait_p95(autoscaler_t* scaler) {
+    uint64_t p95_ns = 0;
+    
+    if (scaler->wait_samples > 0) {
+        uint32_t threshold = scaler->wait_samples - scaler->wait_samples / 20;
+        uint32_t seen = 0;
+    
+        for (uint32_t i = 0; i < AUTOSCALE_WAIT_BUCKETS; i++) {
+            seen += scaler->wait_hist[i];
+            if (seen >= threshold) {
+                p95_ns = (1ULL << i) * 1000ULL;
+                break;
+            }
+        }
+    }
+    
+    memset(scaler->wait_hist, 0, sizeof(scaler->wait_hist));
+    scaler->wait_samples = 0;
+    
+    return p95_ns;
+}
+
+static uint32_t autoscaler_pending(process_pool_t* pool) {
+    uint32_t pending = queue_size(pool->task_queue);
+    
+    for (int i = 0; i < TASK_PRIORITY_COUNT; i++) {
+        pending += ATOMIC_LOAD(&pool->pending_counts[i]);
+    }
+    
+    return pending;
+}
+
+/**
+ * 刷新各Worker最后一次有任务的时间：有在途任务或本周期完成过任务即视为活跃
+ */
+static void autoscaler_track_workers(process_pool_t* pool, uint32_t active, uint64_t now) {
+    autoscaler_t* scaler = &pool->scaler;
+    
+    for (uint32_t i = 0; i < active; i++) {
+        worker_internal_t* worker = &pool->workers[i];
+        uint64_t completed = worker->shared_mem ?
+            ATOMIC_LOAD(&worker->shared_mem->total_completed) : 0;
+    
+        // Worker重启后计数归零，同样按有变化处理
+        if (ATOMIC_LOAD(&worker->inflight_count) > 0 ||
+            completed != scaler->worker_completed[i] ||
+            scaler->worker_active_ns[i] == 0) {
+            scaler->worker_active_ns[i] = now;
+        }
+        scaler->worker_completed[i] = completed;
+    }
+}
+
+/**
+ * 按新规模调整Worker，pool_stop/pool_resize正持有pool_mutex时跳过本周期
+ * (pool_stop会在持锁时等待事件循环线程退出)
+ */
+static bool autoscaler_resize(process_pool_t* pool, uint32_t target, uint64_t now) {
+    if (pthread_mutex_trylock(&pool->pool_mutex) != 0) {
+        return false;
+    }
+    
+    // pool_start持锁直到启动完成，拿到锁且事件循环仍在运行即处于运行状态
+    if (!pool->event_loop_running) {
+        pthread_mutex_unlock(&pool->pool_mutex);
+        return false;
+    }
+    
+    uint32_t before = ATOMIC_LOAD(&pool->active_workers);
+    pool_resize_locked(pool, target);
+    uint32_t after = ATOMIC_LOAD(&pool->active_workers);
+    
+    pthread_mutex_unlock(&pool->pool_mutex);
+    
+    autoscaler_t* scaler = &pool->scaler;
+    for (uint32_t i = before; i < after; i++) {
+        scaler->worker_completed[i] = 0;
+        scaler->worker_active_ns[i] = now;
+    }
+    
+    scaler->last_scale_ns = now;
+    scaler->up_ticks = 0;
+    scaler->down_ticks = 0;
+    
+    return after != before;
+}
+
+void adjust_worker_count(process_pool_t* pool) {
+    if (!pool || !pool->workers) {
+        return;
+    }
+    
+    autoscaler_t* scaler = &pool->scaler;
+    const pool_config_t* config = &pool->config;
+    uint64_t now = get_time_ns();
+    uint32_t active = ATOMIC_LOAD(&pool->active_workers);
+    
+    if (active == 0) {
+        return;
+    }
+    
+    // 采样本周期的排队时间、完成数和平均处理时间
+    pthread_mutex_lock(&pool->stats_mutex);
+    uint64_t wait_p95_ns = autoscaler_take_wait_p95(scaler);
+    uint64_t completed = pool->stats.total_completed;
+    uint64_t avg_task_ns = pool->stats.avg_task_time_ns;
+    pthread_mutex_unlock(&pool->stats_mutex);
+    
+    uint64_t interval_ns = scaler->last_tick_ns ? now - scaler->last_tick_ns : 0;
+    uint64_t completed_delta = completed - scaler->last_completed;
+    scaler->last_tick_ns = now;
+    scaler->last_completed = completed;
+    
+    if (interval_ns == 0) {
+        // 第一个周期只建立基线
+        autoscaler_track_workers(pool, active, now);
+        return;
+    }
+    
+    double util = (double)completed_delta * (double)avg_task_ns /
+                  ((double)interval_ns * (double)active);
+    if (util > 1.0) {
+        util = 1.0;
+    }
+    
+    double depth = (double)autoscaler_pending(pool);
+    scaler->depth_ewma += AUTOSCALE_EWMA_ALPHA * (depth - scaler->depth_ewma);
+    scaler->util_ewma += AUTOSCALE_EWMA_ALPHA * (util - scaler->util_ewma);
+    
+    autoscaler_track_workers(pool, active, now);
+    
+    uint64_t wait_target_ns = (uint64_t)(config->scale_wait_p95_ms ?
+        config->scale_wait_p95_ms : DEFAULT_SCALE_WAIT_P95_MS) * 1000000ULL;
+    double depth_per_worker = scaler->depth_ewma / active;
+    bool backlog = scaler->depth_ewma >= 1.0;
+    
+    bool want_up = depth_per_worker > AUTOSCALE_UP_DEPTH ||
+                   (backlog && wait_p95_ns > wait_target_ns) ||
+                   (backlog && scaler->util_ewma > AUTOSCALE_UP_UTIL);
+    
+    // 缩容按减少一个Worker之后的利用率判断，与扩容阈值之间留出间隔
+    double util_after = active > 1 ?
+        scaler->util_ewma * active / (active - 1) : 1.0;
+    bool want_down = !want_up &&
+                     depth_per_worker < AUTOSCALE_DOWN_DEPTH &&
+                     wait_p95_ns <= wait_target_ns / 2 &&
+                     util_after < AUTOSCALE_DOWN_UTIL;
+    
+    scaler->up_ticks = want_up ? scaler->up_ticks + 1 : 0;
+    scaler->down_ticks = want_down ? scaler->down_ticks + 1 : 0;
+    
+    uint64_t since_scale_ns = now - scaler->last_scale_ns;
+    uint64_t scale_ups = 0;
+    uint64_t scale_downs = 0;
+    
+    if (scaler->up_ticks >= AUTOSCALE_UP_TICKS && active < config->max_workers &&
+        since_scale_ns >= AUTOSCALE_UP_COOLDOWN_MS * 1000000ULL) {
+        // 按当前规模的一半扩容，负载成倍变化时几个周期内即可跟上
+        uint32_t step = active / 2 > 0 ? active / 2 : 1;
+        uint32_t target = active + step;
+        if (target > config->max_workers) {
+            target = config->max_workers;
+        }
+    
+        log_message(pool, 2, "Autoscaler: scaling up %u -> %u (depth %.1f, wait p95 %lu us, util %.2f)",
+                   active, target, scaler->depth_ewma, wait_p95_ns / 1000, scaler->util_ewma);
+        if (autoscaler_resize(pool, target, now)) {
+            scale_ups = 1;
+        }
+    } else if (scaler->down_ticks >= AUTOSCALE_DOWN_TICKS && active > config->min_workers &&
+               since_scale_ns >= AUTOSCALE_DOWN_COOLDOWN_MS * 1000000ULL) {
+        // 只回收已空闲超过worker_idle_timeout的末尾Worker
+        uint32_t last = active - 1;
+        uint64_t idle_ns = now - scaler->worker_active_ns[last];
+        if (idle_ns >= (uint64_t)config->worker_idle_timeout * 1000000000ULL &&
+            ATOMIC_LOAD(&pool->workers[last].inflight_count) == 0) {
+            log_message(pool, 2, "Autoscaler: reaping worker %u idle for %lu s (util %.2f)",
+                       last, idle_ns / 1000000000ULL, scaler->util_ewma);
+            if (autoscaler_resize(pool, last, now)) {
+                scale_downs = 1;
+            }
+        }
+    }
+    
+    pthread_mutex_lock(&pool->stats_mutex);
+    pool->stats.queue_depth_ewma = scaler->depth_ewma;
+    pool->stats.worker_utilization = scaler->util_ewma;
+    pool->stats.queue_wait_p95_ns = wait_p95_ns;
+    pool->stats.scale_ups += scale_ups;
+    pool->stats.scale_downs += scale_downs;
+    pthread_mutex_unlock(&pool->stats_mutex);
+}
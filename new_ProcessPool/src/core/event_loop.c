@@ -1,4 +1,6 @@
+#define _GNU_SOURCE
 #include "../../include/internal.h"
+#include "config.h"
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -7,7 +9,15 @@
 #include <sys/eventfd.h>
 #include <sys/signalfd.h>
 #include <sys/timerfd.h>
+#include <sys/wait.h>
 #include <signal.h>
+#include <time.h>
+#include <malloc.h>
+
+#ifdef PROCESS_POOL_USE_IO_URING
+#include <poll.h>
+#include <liburing.h>
+#endif
 
 // ============================================================================
 // 事件类型定义
@@ -19,120 +29,1589 @@ typedef enum {
     EVENT_TYPE_WORKER_STATUS = 3,   // Worker状态变化事件
     EVENT_TYPE_TIMER = 4,           // 定时器事件
     EVENT_TYPE_SIGNAL = 5,          // 信号事件
-    EVENT_TYPE_CONTROL = 6          // 控制命令事件
+    EVENT_TYPE_CONTROL = 6,         // 控制命令事件
+    EVENT_TYPE_ZYGOTE = 7           // zygote派生应答事件
 } event_type_t;
 
-// 事件数据结构
-typedef struct {
-    event_type_t type;
-    int fd;
-    void* data;
-    uint32_t events;
-} event_data_t;
+// 事件数据结构
+typedef struct {
+    event_type_t type;
+    int fd;
+    void* data;
+    uint32_t events;
+} event_data_t;
+
+#ifdef PROCESS_POOL_USE_IO_URING
+// io_uring请求的user_data：高8位事件类型，中间24位注册代数，低32位Worker ID
+#define URING_TAG(type, gen, id) (((uint64_t)(type) << 56) | \
+                                  ((uint64_t)((gen) & 0xFFFFFF) << 32) | (uint32_t)(id))
+#define URING_TAG_TYPE(tag) ((event_type_t)((tag) >> 56))
+#define URING_TAG_GEN(tag)  ((uint32_t)((tag) >> 32) & 0xFFFFFF)
+#define URING_TAG_ID(tag)   ((uint32_t)(tag))
+
+#define URING_SQ_ENTRIES 64
+#define URING_CQ_ENTRIES 1024
+#define URING_BUF_GROUP 0
+#define URING_BUF_COUNT 256             // provided buffer数量(2的幂)
+#endif
+
+// ============================================================================
+// 事件循环状态
+// ============================================================================
+
+typedef struct {
+    pool_event_backend_t backend;   // 实际使用的后端
+    int epoll_fd;
+    int task_submit_eventfd;
+    int control_eventfd;
+    int signal_fd;
+    int timer_fd;
+    bool running;
+    pthread_t thread;
+    process_pool_t* pool;
+    
+    // pool_resize转交的调整请求，请求方持有pool_mutex等待处理完成
+    pthread_mutex_t resize_mutex;
+    pthread_cond_t resize_cond;
+    uint32_t resize_target;         // 请求的Worker数量
+    bool resize_done;               // 事件循环已处理
+    pool_error_t resize_result;     // 处理结果
+    
+    // Worker结果eventfd和pidfd对应的事件数据(用于移除时释放)
+    event_data_t* worker_event_data[MAX_WORKERS];
+    event_data_t* worker_status_data[MAX_WORKERS];
+    
+    // zygote异步派生套接字是否已注册(epoll后端另存事件数据用于移除)
+    bool zygote_watched;
+    event_data_t* zygote_event_data;
+    
+#ifdef PROCESS_POOL_USE_IO_URING
+    // io_uring后端：每个fd挂一个multishot读请求，完成时计数值已读入provided buffer
+    struct io_uring ring;
+    bool ring_ready;
+    struct io_uring_buf_ring* buf_ring;
+    uint64_t ring_bufs[URING_BUF_COUNT];    // 每个缓冲区容纳一次eventfd/timerfd读取
+    uint32_t bufs_returned;                 // 本轮已归还、尚未发布给内核的缓冲区数
+    pthread_mutex_t sq_mutex;               // 其他线程增删Worker时与事件循环串行使用提交队列
+    uint32_t worker_gen[MAX_WORKERS];       // Worker注册代数，用于丢弃已移除注册的残留完成
+#endif
+    
+    // timer_fd按绝对时间单次触发，到期时间取定期维护和最近任务超时中较早者
+    uint64_t timer_armed_ns;        // timer_fd当前的到期时间(0表示未设置)
+    uint64_t next_housekeeping_ns;  // 下一次定期维护时间
+    
+    // 调度状态
+    int active_policy;              // 待分发任务当前按哪种策略组织
+    uint64_t exec_estimate_ns;      // 任务执行时间的滑动平均(EDF提前丢弃用)
+    
+    // 统计信息
+    _Atomic uint64_t events_processed;
+    _Atomic uint64_t tasks_submitted;
+    _Atomic uint64_t tasks_completed;
+    _Atomic uint64_t worker_events;
+    _Atomic uint64_t timer_events;
+    _Atomic uint64_t tasks_timed_out;
+} event_loop_t;
+
+static event_loop_t g_event_loop = {0};
+
+// 当前线程是否为事件循环线程
+static PROCESS_POOL_THREAD_LOCAL bool g_in_event_loop = false;
+
+// 控制命令(control_eventfd的计数值)
+// 发送方都持有pool_mutex，同一时刻至多一条命令，计数值不会叠加
+enum event_loop_command {
+    EVENT_LOOP_CMD_STOP = 1,        // 停止事件循环
+    EVENT_LOOP_CMD_RESIZE = 2,      // 调整Worker数量(resize_target)
+    EVENT_LOOP_CMD_GC = 3           // 把空闲堆内存归还系统
+};
+
+// ============================================================================
+// 辅助函数
+// ============================================================================
+
+static int setup_signal_fd(void) {
+    sigset_t mask;
+    int sfd;
+    
+    // 设置信号掩码
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);  // 子进程退出
+    sigaddset(&mask, SIGTERM);  // 终止信号
+    sigaddset(&mask, SIGINT);   // 中断信号
+    sigaddset(&mask, SIGUSR1);  // 用户信号1
+    sigaddset(&mask, SIGUSR2);  // 用户信号2
+    
+    // 阻塞这些信号，通过signalfd处理
+    if (pthread_sigmask(SIG_BLOCK, &mask, NULL) == -1) {
+        return -1;
+    }
+    
+    // 创建signalfd
+    sfd = signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (sfd == -1) {
+        return -1;
+    }
+    
+    return sfd;
+}
+
+static int setup_timer_fd(void) {
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (tfd == -1) {
+        return -1;
+    }
+    
+    // 到期时间由event_loop_rearm_timer按需设置
+    return tfd;
+}
+
+static int add_epoll_event(int epoll_fd, int fd, uint32_t events, event_type_t type, void* data) {
+    struct epoll_event ev;
+    event_data_t* event_data = malloc(sizeof(event_data_t));
+    if (!event_data) {
+        return -1;
+    }
+    
+    event_data->type = type;
+    event_data->fd = fd;
+    event_data->data = data;
+    event_data->events = events;
+    
+    ev.events = events;
+    ev.data.ptr = event_data;
+    
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        free(event_data);
+        return -1;
+    }
+    
+    return 0;
+}
+
+static void remove_epoll_event(int epoll_fd, int fd) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &ev);
+}
+
+// ============================================================================
+// io_uring后端
+// ============================================================================
+
+#ifdef PROCESS_POOL_USE_IO_URING
+
+/**
+ * 每个fd挂一个multishot请求：fd可读时内核直接把计数值读入provided buffer，
+ * 就绪和读取在一个完成项里交付，无需epoll_wait之后再逐个read。请求一直有效，
+ * 只有在缓冲区耗尽、完成队列溢出或被取消时结束，由事件循环重新挂上
+ *
+ * 提交队列只在事件循环线程上等待前统一提交；pool_start/pool_stop在其他
+ * 线程增删Worker时持sq_mutex准备请求并立即提交
+ */
+
+/**
+ * 获取一个提交项，提交队列满时先提交已准备的请求
+ * 调用方持有sq_mutex
+ */
+static struct io_uring_sqe* uring_get_sqe(event_loop_t* loop) {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&loop->ring);
+    if (!sqe) {
+        io_uring_submit(&loop->ring);
+        sqe = io_uring_get_sqe(&loop->ring);
+    }
+    return sqe;
+}
+
+static int uring_arm_read(event_loop_t* loop, int fd, uint64_t tag) {
+    struct io_uring_sqe* sqe = uring_get_sqe(loop);
+    if (!sqe) {
+        return -1;
+    }
+    
+    io_uring_prep_read_multishot(sqe, fd, sizeof(uint64_t), 0, URING_BUF_GROUP);
+    io_uring_sqe_set_data64(sqe, tag);
+    return 0;
+}
+
+/**
+ * signalfd只做multishot poll，由handle_signal_event在事件循环线程上读取：
+ * signalfd读取的是调用线程的待决信号，不能交给内核的异步上下文去读
+ */
+static int uring_arm_poll(event_loop_t* loop, int fd, uint64_t tag) {
+    struct io_uring_sqe* sqe = uring_get_sqe(loop);
+    if (!sqe) {
+        return -1;
+    }
+    
+    io_uring_prep_poll_multishot(sqe, fd, POLLIN);
+    io_uring_sqe_set_data64(sqe, tag);
+    return 0;
+}
+
+/**
+ * 事件循环线程上准备的请求留到下一轮等待前批量提交，其他线程立即提交
+ * 调用方持有sq_mutex
+ */
+static void uring_flush(event_loop_t* loop) {
+    if (!g_in_event_loop) {
+        io_uring_submit(&loop->ring);
+    }
+}
+
+/**
+ * 重新挂上已结束的multishot请求，调用方持有sq_mutex
+ */
+static int uring_arm_event(event_loop_t* loop, event_type_t type, uint32_t id) {
+    switch (type) {
+        case EVENT_TYPE_TASK_SUBMIT:
+            return uring_arm_read(loop, loop->task_submit_eventfd, URING_TAG(type, 0, 0));
+        case EVENT_TYPE_CONTROL:
+            return uring_arm_read(loop, loop->control_eventfd, URING_TAG(type, 0, 0));
+        case EVENT_TYPE_TIMER:
+            return uring_arm_read(loop, loop->timer_fd, URING_TAG(type, 0, 0));
+        case EVENT_TYPE_SIGNAL:
+            return uring_arm_poll(loop, loop->signal_fd, URING_TAG(type, 0, 0));
+        case EVENT_TYPE_ZYGOTE:
+            return uring_arm_poll(loop, loop->pool->zygote_async_sock, URING_TAG(type, 0, 0));
+        case EVENT_TYPE_TASK_COMPLETE:
+            return uring_arm_read(loop, loop->pool->workers[id].result_eventfd,
+                                  URING_TAG(type, loop->worker_gen[id], id));
+        case EVENT_TYPE_WORKER_STATUS:
+            return uring_arm_poll(loop, loop->pool->workers[id].pidfd,
+                                  URING_TAG(type, loop->worker_gen[id], id));
+        default:
+            return -1;
+    }
+}
+
+static int uring_add_worker(event_loop_t* loop, uint32_t worker_id) {
+    pthread_mutex_lock(&loop->sq_mutex);
+    int ret = uring_arm_event(loop, EVENT_TYPE_TASK_COMPLETE, worker_id);
+    if (ret == 0 && loop->pool->workers[worker_id].pidfd >= 0) {
+        ret = uring_arm_event(loop, EVENT_TYPE_WORKER_STATUS, worker_id);
+    }
+    if (ret == 0) {
+        uring_flush(loop);
+    }
+    pthread_mutex_unlock(&loop->sq_mutex);
+    
+    return ret;
+}
+
+static void uring_remove_worker(event_loop_t* loop, uint32_t worker_id) {
+    pthread_mutex_lock(&loop->sq_mutex);
+    
+    static const event_type_t types[] = { EVENT_TYPE_TASK_COMPLETE, EVENT_TYPE_WORKER_STATUS };
+    uint32_t gen = loop->worker_gen[worker_id];
+    
+    // 先换代：取消生效前已进入完成队列的结果按旧代数丢弃。请求持有文件引用，
+    // 之后关闭result_eventfd和pidfd不影响取消
+    loop->worker_gen[worker_id]++;
+    
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        struct io_uring_sqe* sqe = uring_get_sqe(loop);
+        if (sqe) {
+            io_uring_prep_cancel64(sqe, URING_TAG(types[i], gen, worker_id), 0);
+            io_uring_sqe_set_data64(sqe, 0);
+        }
+    }
+    uring_flush(loop);
+    
+    pthread_mutex_unlock(&loop->sq_mutex);
+}
+
+static void uring_backend_cleanup(event_loop_t* loop) {
+    if (!loop->ring_ready) {
+        return;
+    }
+    
+    if (loop->buf_ring) {
+        io_uring_free_buf_ring(&loop->ring, loop->buf_ring, URING_BUF_COUNT, URING_BUF_GROUP);
+        loop->buf_ring = NULL;
+    }
+    
+    io_uring_queue_exit(&loop->ring);
+    pthread_mutex_destroy(&loop->sq_mutex);
+    loop->ring_ready = false;
+}
+
+/**
+ * 建立io_uring实例并挂上固定fd的请求
+ * 内核不支持multishot读取或带超时等待时返回-1，由调用方回退到epoll
+ */
+static int uring_backend_init(event_loop_t* loop) {
+    struct io_uring_params params;
+    int ret;
+    
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = URING_CQ_ENTRIES;
+    
+    ret = io_uring_queue_init_params(URING_SQ_ENTRIES, &loop->ring, &params);
+    if (ret < 0) {
+        log_message(loop->pool, 1, "io_uring setup failed: %s", strerror(-ret));
+        return -1;
+    }
+    
+    pthread_mutex_init(&loop->sq_mutex, NULL);
+    loop->ring_ready = true;
+    
+    // EXT_ARG：带超时等待不占用提交队列；NODROP：完成队列满时内核暂存而不丢弃
+    if (!(params.features & IORING_FEAT_EXT_ARG) || !(params.features & IORING_FEAT_NODROP)) {
+        log_message(loop->pool, 1, "io_uring lacks EXT_ARG/NODROP support");
+        uring_backend_cleanup(loop);
+        return -1;
+    }
+    
+    struct io_uring_probe* probe = io_uring_get_probe_ring(&loop->ring);
+    bool supported = probe && io_uring_opcode_supported(probe, IORING_OP_READ_MULTISHOT);
+    io_uring_free_probe(probe);
+    if (!supported) {
+        log_message(loop->pool, 1, "io_uring multishot read is not supported by this kernel");
+        uring_backend_cleanup(loop);
+        return -1;
+    }
+    
+    loop->buf_ring = io_uring_setup_buf_ring(&loop->ring, URING_BUF_COUNT,
+                                             URING_BUF_GROUP, 0, &ret);
+    if (!loop->buf_ring) {
+        log_message(loop->pool, 1, "io_uring buffer ring setup failed: %s", strerror(-ret));
+        uring_backend_cleanup(loop);
+        return -1;
+    }
+    
+    for (uint32_t i = 0; i < URING_BUF_COUNT; i++) {
+        io_uring_buf_ring_add(loop->buf_ring, &loop->ring_bufs[i], sizeof(uint64_t), i,
+                              io_uring_buf_ring_mask(URING_BUF_COUNT), i);
+    }
+    io_uring_buf_ring_advance(loop->buf_ring, URING_BUF_COUNT);
+    
+    if (uring_arm_event(loop, EVENT_TYPE_TASK_SUBMIT, 0) == -1 ||
+        uring_arm_event(loop, EVENT_TYPE_CONTROL, 0) == -1 ||
+        uring_arm_event(loop, EVENT_TYPE_TIMER, 0) == -1 ||
+        uring_arm_event(loop, EVENT_TYPE_SIGNAL, 0) == -1 ||
+        (ret = io_uring_submit(&loop->ring)) < 0) {
+        log_message(loop->pool, 1, "io_uring initial submit failed");
+        uring_backend_cleanup(loop);
+        return -1;
+    }
+    
+    return 0;
+}
+
+#endif // PROCESS_POOL_USE_IO_URING
+
+// ============================================================================
+// Worker事件注册
+// ============================================================================
+
+static event_data_t* add_worker_fd(event_loop_t* loop, int fd, uint32_t events,
+                                   event_type_t type, uint32_t worker_id) {
+    struct epoll_event ev;
+    
+    event_data_t* event_data = malloc(sizeof(event_data_t));
+    if (!event_data) {
+        return NULL;
+    }
+    
+    event_data->type = type;
+    event_data->fd = fd;
+    event_data->data = (void*)(intptr_t)worker_id;
+    event_data->events = events;
+    
+    ev.events = event_data->events;
+    ev.data.ptr = event_data;
+    
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        free(event_data);
+        return NULL;
+    }
+    
+    return event_data;
+}
+
+static int add_worker_event(event_loop_t* loop, uint32_t worker_id) {
+    worker_internal_t* worker = &loop->pool->workers[worker_id];
+    
+#ifdef PROCESS_POOL_USE_IO_URING
+    if (loop->backend == POOL_EVENT_BACKEND_IO_URING) {
+        return uring_add_worker(loop, worker_id);
+    }
+#endif
+    
+    loop->worker_event_data[worker_id] = add_worker_fd(loop, worker->result_eventfd,
+                                                       EPOLLIN | EPOLLET,
+                                                       EVENT_TYPE_TASK_COMPLETE, worker_id);
+    if (!loop->worker_event_data[worker_id]) {
+        return -1;
+    }
+    
+    // 进程退出时pidfd可读，不必等SIGCHLD或定期健康检查
+    if (worker->pidfd >= 0) {
+        loop->worker_status_data[worker_id] = add_worker_fd(loop, worker->pidfd, EPOLLIN,
+                                                            EVENT_TYPE_WORKER_STATUS, worker_id);
+        if (!loop->worker_status_data[worker_id]) {
+            remove_epoll_event(loop->epoll_fd, worker->result_eventfd);
+            free(loop->worker_event_data[worker_id]);
+            loop->worker_event_data[worker_id] = NULL;
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+static void remove_worker_event(event_loop_t* loop, uint32_t worker_id) {
+    worker_internal_t* worker = &loop->pool->workers[worker_id];
+    
+#ifdef PROCESS_POOL_USE_IO_URING
+    if (loop->backend == POOL_EVENT_BACKEND_IO_URING) {
+        uring_remove_worker(loop, worker_id);
+        return;
+    }
+#endif
+    
+    // epoll_ctl(DEL)不会返回注册时的数据指针，需自行保存并释放
+    remove_epoll_event(loop->epoll_fd, worker->result_eventfd);
+    free(loop->worker_event_data[worker_id]);
+    loop->worker_event_data[worker_id] = NULL;
+    
+    if (loop->worker_status_data[worker_id]) {
+        remove_epoll_event(loop->epoll_fd, worker->pidfd);
+        free(loop->worker_status_data[worker_id]);
+        loop->worker_status_data[worker_id] = NULL;
+    }
+}
+
+// ============================================================================
+// 任务分发
+// ============================================================================
+
+/**
+ * 路由键分发
+ *
+ * 相同路由键的任务按跳跃一致性哈希(jump consistent hash)映射到
+ * [0, active_workers)中的同一个Worker。Worker总是占用连续的槽位，扩缩容
+ * 只增减末尾的Worker，跳跃哈希在这种情况下只迁移必须迁移的那部分键，
+ * 且不需要维护哈希环。属主不在运行或过载时改派给负载最轻的Worker。
+ * 分发到属主的任务在任务表中标记为不可窃取
+ */
+
+static uint64_t route_mix(uint64_t key) {
+    // MurmurHash3的64位终结函数，调用方传入的键可能是连续整数
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    
+    return key;
+}
+
+/**
+ * 跳跃一致性哈希(Lamping & Veach)
+ * @return [0, buckets)中的桶号
+ */
+static uint32_t route_jump_hash(uint64_t key, uint32_t buckets) {
+    int64_t b = -1;
+    int64_t j = 0;
+    
+    while (j < (int64_t)buckets) {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = (int64_t)((double)(b + 1) * ((double)(1LL << 31) / (double)((key >> 33) + 1)));
+    }
+    
+    return (uint32_t)b;
+}
+
+/**
+ * 取路由键所属的Worker，不在运行时返回NULL
+ */
+static worker_internal_t* route_owner(process_pool_t* pool, uint64_t routing_key) {
+    uint32_t active = ATOMIC_LOAD(&pool->active_workers);
+    if (active == 0) {
+        return NULL;
+    }
+    
+    worker_internal_t* owner = &pool->workers[route_jump_hash(route_mix(routing_key), active)];
+    if (ATOMIC_LOAD(&owner->state) != WORKER_INTERNAL_RUNNING) {
+        return NULL;
+    }
+    
+    return owner;
+}
+
+/**
+ * 属主是否过载
+ * @param load 属主的负载(在途任务数)
+ * @param total_load 所有运行中Worker的负载之和
+ */
+static bool route_overloaded(uint32_t load, uint32_t total_load, uint32_t running) {
+    double avg = running > 0 ? (double)total_load / running : 0.0;
+    return (double)load > avg * ROUTE_LOAD_FACTOR + ROUTE_LOAD_SLACK;
+}
+
+pool_error_t assign_task_to_worker(process_pool_t* pool, task_internal_t* task) {
+    if (!pool || !task) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    // 选择在途任务最少的运行中Worker
+    worker_internal_t* target = NULL;
+    uint32_t min_inflight = UINT32_MAX;
+    uint32_t total_inflight = 0;
+    uint32_t running = 0;
+    
+    for (uint32_t i = 0; i < pool->config.max_workers; i++) {
+        worker_internal_t* worker = &pool->workers[i];
+        if (ATOMIC_LOAD(&worker->state) != WORKER_INTERNAL_RUNNING) {
+            continue;
+        }
+        
+        uint32_t inflight = ATOMIC_LOAD(&worker->inflight_count);
+        total_inflight += inflight;
+        running++;
+        if (inflight < min_inflight) {
+            min_inflight = inflight;
+            target = worker;
+        }
+    }
+    
+    if (!target) {
+        return POOL_ERROR_WORKER_DEAD;
+    }
+    
+    // 限制每个Worker的在途深度，让积压留在Master侧按调度策略排序；
+    // 优先级调度下紧急任务不受限制，由Worker在提交环内插队执行
+    uint32_t depth = pool->config.worker_queue_depth ?
+                     pool->config.worker_queue_depth : DEFAULT_WORKER_QUEUE_DEPTH;
+    bool urgent = task->desc.priority == TASK_PRIORITY_URGENT &&
+                  ATOMIC_LOAD(&pool->sched_policy) == POOL_SCHED_PRIORITY;
+    
+    task->route = TASK_ROUTE_NONE;
+    if (task->desc.routing_key != 0) {
+        worker_internal_t* owner = route_owner(pool, task->desc.routing_key);
+        uint32_t load = owner ? ATOMIC_LOAD(&owner->inflight_count) : 0;
+    
+        if (owner && (urgent || load < depth) && !route_overloaded(load, total_inflight, running)) {
+            target = owner;
+            min_inflight = load;
+            task->route = TASK_ROUTE_HIT;
+        } else {
+            task->route = TASK_ROUTE_SPILL;
+        }
+    }
+    
+    if (!urgent && min_inflight >= depth) {
+        return POOL_ERROR_QUEUE_FULL;
+    }
+    
+    pool_error_t result = worker_send_task(target, task);
+    if (result == POOL_SUCCESS && task->route == TASK_ROUTE_HIT) {
+        ATOMIC_ADD(&target->route_hits, 1);
+    }
+    
+    return result;
+}
+
+// ============================================================================
+// 待分发任务组织
+// ============================================================================
+
+/**
+ * FIFO和优先级调度共用按优先级分道的链表，每个通道内部按提交顺序排列；
+ * EDF调度使用按截止时间排序的最小堆。切换策略时在两种结构之间迁移
+ */
+
+static void lane_push(process_pool_t* pool, task_internal_t* task) {
+    task_lane_t* lane = &pool->pending_lanes[task->desc.priority];
+    
+    task->next = NULL;
+    if (lane->tail) {
+        lane->tail->next = task;
+    } else {
+        lane->head = task;
+    }
+    lane->tail = task;
+}
+
+static void lane_push_front(process_pool_t* pool, task_internal_t* task) {
+    task_lane_t* lane = &pool->pending_lanes[task->desc.priority];
+    
+    task->next = lane->head;
+    lane->head = task;
+    if (!lane->tail) {
+        lane->tail = task;
+    }
+}
+
+static task_internal_t* lane_pop(process_pool_t* pool, int priority) {
+    task_lane_t* lane = &pool->pending_lanes[priority];
+    task_internal_t* task = lane->head;
+    
+    lane->head = task->next;
+    if (!lane->head) {
+        lane->tail = NULL;
+    }
+    task->next = NULL;
+    
+    return task;
+}
+
+/**
+ * 截止时间比较，不限时的任务排在最后，截止时间相同时先提交者优先
+ */
+static bool deadline_before(const task_internal_t* a, const task_internal_t* b) {
+    uint64_t da = a->deadline_ns ? a->deadline_ns : UINT64_MAX;
+    uint64_t db = b->deadline_ns ? b->deadline_ns : UINT64_MAX;
+    
+    if (da != db) {
+        return da < db;
+    }
+    return a->submit_time_ns < b->submit_time_ns;
+}
+
+static bool heap_reserve(task_heap_t* heap, uint32_t capacity) {
+    if (capacity <= heap->capacity) {
+        return true;
+    }
+    
+    uint32_t new_capacity = heap->capacity ? heap->capacity : 1024;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+    
+    task_internal_t** tasks = realloc(heap->tasks, new_capacity * sizeof(task_internal_t*));
+    if (!tasks) {
+        return false;
+    }
+    
+    heap->tasks = tasks;
+    heap->capacity = new_capacity;
+    return true;
+}
+
+static bool heap_push(task_heap_t* heap, task_internal_t* task) {
+    if (!heap_reserve(heap, heap->size + 1)) {
+        return false;
+    }
+    
+    // 上浮
+    uint32_t i = heap->size++;
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!deadline_before(task, heap->tasks[parent])) {
+            break;
+        }
+        heap->tasks[i] = heap->tasks[parent];
+        i = parent;
+    }
+    heap->tasks[i] = task;
+    
+    return true;
+}
+
+static task_internal_t* heap_pop(task_heap_t* heap) {
+    if (heap->size == 0) {
+        return NULL;
+    }
+    
+    task_internal_t* top = heap->tasks[0];
+    task_internal_t* last = heap->tasks[--heap->size];
+    
+    // 下沉
+    uint32_t i = 0;
+    for (;;) {
+        uint32_t child = i * 2 + 1;
+        if (child >= heap->size) {
+            break;
+        }
+        if (child + 1 < heap->size && deadline_before(heap->tasks[child + 1], heap->tasks[child])) {
+            child++;
+        }
+        if (!deadline_before(heap->tasks[child], last)) {
+            break;
+        }
+        heap->tasks[i] = heap->tasks[child];
+        i = child;
+    }
+    if (heap->size > 0) {
+        heap->tasks[i] = last;
+    }
+    
+    return top;
+}
+
+/**
+ * 计算任务的有效优先级：每等待priority_aging_ms提升一级，最高提升到HIGH，
+ * 紧急通道始终优先
+ */
+static uint32_t effective_priority(const process_pool_t* pool,
+                                   const task_internal_t* task, uint64_t now) {
+    uint32_t priority = task->desc.priority;
+    uint32_t aging_ms = pool->config.priority_aging_ms;
+    
+    if (aging_ms > 0 && priority < TASK_PRIORITY_HIGH && now > task->submit_time_ns) {
+        uint64_t boost = (now - task->submit_time_ns) / 1000000ULL / aging_ms;
+        priority = (priority + boost > TASK_PRIORITY_HIGH) ?
+                   TASK_PRIORITY_HIGH : (uint32_t)(priority + boost);
+    }
+    
+    return priority;
+}
+
+/**
+ * 选出下一个要分发的通道，返回-1表示所有通道为空。
+ * 每个通道内部FIFO，只需比较各通道队首：FIFO调度取最早提交者；
+ * 优先级调度取有效优先级最高者，相同时基础优先级高者胜出
+ */
+static int select_lane(const process_pool_t* pool, int policy, uint64_t now, bool* aged) {
+    int best = -1;
+    int highest = -1;
+    uint32_t best_priority = 0;
+    
+    for (int i = TASK_PRIORITY_COUNT - 1; i >= 0; i--) {
+        const task_internal_t* head = pool->pending_lanes[i].head;
+        if (!head) {
+            continue;
+        }
+        
+        if (policy == POOL_SCHED_FIFO) {
+            if (best < 0 || head->submit_time_ns < pool->pending_lanes[best].head->submit_time_ns) {
+                best = i;
+            }
+            continue;
+        }
+        
+        if (highest < 0) {
+            highest = i;
+        }
+        
+        uint32_t priority = effective_priority(pool, head, now);
+        if (best < 0 || priority > best_priority) {
+            best = i;
+            best_priority = priority;
+        }
+    }
+    
+    *aged = (highest >= 0 && best < highest);
+    return best;
+}
+
+static bool pending_push(process_pool_t* pool, int policy, task_internal_t* task) {
+    if (policy == POOL_SCHED_EDF) {
+        if (!heap_push(&pool->edf_heap, task)) {
+            return false;
+        }
+    } else {
+        lane_push(pool, task);
+    }
+    
+    ATOMIC_ADD(&pool->pending_counts[task->desc.priority], 1);
+    return true;
+}
+
+/**
+ * 按调度策略取出下一个待分发任务，没有任务时返回NULL
+ */
+static task_internal_t* pending_take(process_pool_t* pool, int policy, uint64_t now, bool* aged) {
+    task_internal_t* task;
+    
+    *aged = false;
+    if (policy == POOL_SCHED_EDF) {
+        task = heap_pop(&pool->edf_heap);
+    } else {
+        int priority = select_lane(pool, policy, now, aged);
+        task = priority >= 0 ? lane_pop(pool, priority) : NULL;
+    }
+    
+    if (task) {
+        ATOMIC_SUB(&pool->pending_counts[task->desc.priority], 1);
+    }
+    return task;
+}
+
+/**
+ * 把刚取出但未能分发的任务放回原位置
+ */
+static void pending_putback(process_pool_t* pool, int policy, task_internal_t* task) {
+    if (policy == POOL_SCHED_EDF) {
+        heap_push(&pool->edf_heap, task); // 刚弹出过，容量一定足够
+    } else {
+        lane_push_front(pool, task);
+    }
+    
+    ATOMIC_ADD(&pool->pending_counts[task->desc.priority], 1);
+}
+
+/**
+ * 应用pool_set_sched_policy设置的新策略，必要时在通道和堆之间迁移积压任务
+ * @return 生效的调度策略
+ */
+static int update_sched_policy(event_loop_t* loop) {
+    process_pool_t* pool = loop->pool;
+    int policy = ATOMIC_LOAD(&pool->sched_policy);
+    
+    if (policy == loop->active_policy) {
+        return policy;
+    }
+    
+    if (policy == POOL_SCHED_EDF) {
+        uint32_t total = 0;
+        for (int i = 0; i < TASK_PRIORITY_COUNT; i++) {
+            total += ATOMIC_LOAD(&pool->pending_counts[i]);
+        }
+        
+        if (!heap_reserve(&pool->edf_heap, total)) {
+            log_message(pool, 0, "Failed to switch to EDF scheduling: out of memory");
+            ATOMIC_STORE(&pool->sched_policy, loop->active_policy);
+            return loop->active_policy;
+        }
+        
+        for (int i = 0; i < TASK_PRIORITY_COUNT; i++) {
+            while (pool->pending_lanes[i].head) {
+                heap_push(&pool->edf_heap, lane_pop(pool, i));
+            }
+        }
+    } else if (loop->active_policy == POOL_SCHED_EDF) {
+        // 按截止时间顺序放入通道，通道内近似保持提交顺序
+        task_internal_t* task;
+        while ((task = heap_pop(&pool->edf_heap)) != NULL) {
+            lane_push(pool, task);
+        }
+    }
+    
+    log_message(pool, 2, "Scheduling policy changed from %d to %d", loop->active_policy, policy);
+    loop->active_policy = policy;
+    
+    return policy;
+}
+
+/**
+ * 截止时间前已无法完成的任务直接以超时结束，不再占用Worker
+ */
+static void drop_missed_task(event_loop_t* loop, task_internal_t* task) {
+    log_message(loop->pool, 3, "Dropping task %lu: deadline cannot be met", task->task_id);
+    
+    timer_wheel_cancel(&loop->pool->timer_wheel, &task->timer);
+    task_set_error(task, POOL_ERROR_TIMEOUT, "Deadline cannot be met");
+    task_complete(task, TASK_STATE_TIMEOUT);
+    stats_task_timeout(loop->pool);
+    stats_task_deadline(loop->pool, POOL_SCHED_EDF, false, true);
+    task_unref(task);
+}
+
+/**
+ * 任务无法交给Worker，标记失败并通知等待的线程
+ */
+static void fail_dispatch(event_loop_t* loop, task_internal_t* task, pool_error_t result) {
+    log_message(loop->pool, 1, "Failed to assign task %lu to worker: %d", 
+               task->task_id, result);
+    
+    timer_wheel_cancel(&loop->pool->timer_wheel, &task->timer);
+    task_set_error(task, result, "Failed to assign to worker");
+    task_complete(task, TASK_STATE_FAILED);
+    stats_task_failed(loop->pool);
+    task_unref(task);
+}
+
+/**
+ * 分发前已被取消或已超时的任务直接丢弃；EDF下按执行时间估计提前丢弃
+ * 必然超时的任务，把Worker留给还来得及的任务
+ * @return 任务已被丢弃返回true
+ */
+static bool discard_before_dispatch(event_loop_t* loop, task_internal_t* task,
+                                    int policy, uint64_t now) {
+    if (ATOMIC_LOAD(&task->state) != TASK_STATE_PENDING) {
+        timer_wheel_cancel(&loop->pool->timer_wheel, &task->timer);
+        task_unref(task);
+        return true;
+    }
+    
+    if (policy == POOL_SCHED_EDF && task->deadline_ns &&
+        now + loop->exec_estimate_ns > task->deadline_ns) {
+        drop_missed_task(loop, task);
+        return true;
+    }
+    
+    return false;
+}
+
+/**
+ * 分发单个任务，返回false表示没有Worker能再接收任务
+ */
+static bool dispatch_task(event_loop_t* loop, task_internal_t* task,
+                          uint64_t now, bool aged) {
+    pool_error_t result = assign_task_to_worker(loop->pool, task);
+    if (result == POOL_SUCCESS) {
+        uint64_t wait_ns = now > task->submit_time_ns ? now - task->submit_time_ns : 0;
+        stats_task_dispatched(loop->pool, task->desc.priority, wait_ns, aged, task->route);
+        return true;
+    }
+    
+    if (result == POOL_ERROR_QUEUE_FULL) {
+        return false;
+    }
+    
+    fail_dispatch(loop, task, result);
+    return true;
+}
+
+// 一轮分发中按路由键暂存给各属主的任务，整轮结束时按属主成批发送
+typedef struct {
+    task_internal_t* head[MAX_WORKERS]; // 各属主暂存链表(经task->next链接)
+    task_internal_t* tail[MAX_WORKERS];
+    uint32_t count[MAX_WORKERS];        // 各属主暂存的任务数
+    uint32_t total_load;                // 运行中Worker的在途任务数加本轮已分配的任务数
+    uint32_t running;                   // 运行中Worker数
+} route_round_t;
+
+/**
+ * 选择本轮尚未分发过、且有空余在途名额的Worker中负载最轻的一个
+ * 负载包含本轮按路由键暂存给该Worker的任务
+ * @return 没有这样的Worker时返回NULL
+ */
+static worker_internal_t* pick_dispatch_worker(process_pool_t* pool, uint32_t depth,
+                                              const bool* served, const route_round_t* round,
+                                              uint32_t* room) {
+    worker_internal_t* target = NULL;
+    uint32_t min_load = depth;
+    
+    for (uint32_t i = 0; i < pool->config.max_workers; i++) {
+        worker_internal_t* worker = &pool->workers[i];
+        if (served[i] || ATOMIC_LOAD(&worker->state) != WORKER_INTERNAL_RUNNING) {
+            continue;
+        }
+        
+        uint32_t load = ATOMIC_LOAD(&worker->inflight_count) + round->count[i];
+        if (load < min_load) {
+            min_load = load;
+            target = worker;
+        }
+    }
+    
+    *room = depth - min_load;
+    return target;
+}
+
+/**
+ * 为带路由键的任务选择去向：属主有空余名额且未过载时暂存给属主，
+ * 否则留给本批的目标Worker(本轮负载最轻者)
+ * @return 任务已暂存给属主返回true
+ */
+static bool route_task(process_pool_t* pool, route_round_t* round, task_internal_t* task,
+                       worker_internal_t* target, uint32_t depth) {
+    worker_internal_t* owner = route_owner(pool, task->desc.routing_key);
+    
+    if (owner == target) {
+        task->route = TASK_ROUTE_HIT;
+        return false;
+    }
+    
+    uint32_t id = owner ? owner->worker_id : 0;
+    uint32_t load = owner ? ATOMIC_LOAD(&owner->inflight_count) + round->count[id] : 0;
+    
+    if (!owner || load >= depth || route_overloaded(load, round->total_load, round->running)) {
+        task->route = TASK_ROUTE_SPILL;
+        return false;
+    }
+    
+    task->route = TASK_ROUTE_HIT;
+    task->next = NULL;
+    if (round->tail[id]) {
+        round->tail[id]->next = task;
+    } else {
+        round->head[id] = task;
+    }
+    round->tail[id] = task;
+    round->count[id]++;
+    round->total_load++;
+    
+    return true;
+}
+
+/**
+ * 把一批任务写入目标Worker的提交环，未能写入的任务放回待分发结构
+ * @return 放回的任务数；*full在提交环已满时置为true
+ */
+static uint32_t send_dispatch_batch(event_loop_t* loop, worker_internal_t* target,
+                                    task_internal_t** chunk, uint32_t count,
+                                    int policy, uint64_t now, bool* full) {
+    process_pool_t* pool = loop->pool;
+    uint32_t sent = 0;
+    uint32_t hits = 0;
+    pool_error_t result = worker_send_batch(target, chunk, count, &sent);
+    
+    for (uint32_t i = 0; i < sent; i++) {
+        uint64_t wait_ns = now > chunk[i]->submit_time_ns ? now - chunk[i]->submit_time_ns : 0;
+        stats_task_dispatched(pool, chunk[i]->desc.priority, wait_ns,
+                              chunk[i]->dispatch_aged, chunk[i]->route);
+        if (chunk[i]->route == TASK_ROUTE_HIT) {
+            hits++;
+        }
+    }
+    
+    if (hits > 0) {
+        ATOMIC_ADD(&target->route_hits, hits);
+    }
+    
+    if (sent == count) {
+        return 0;
+    }
+    
+    uint32_t first_unsent = sent;
+    
+    // 提交环已满时停止本轮分发；其他错误只影响出错的任务
+    if (result == POOL_ERROR_QUEUE_FULL) {
+        *full = true;
+    } else {
+        fail_dispatch(loop, chunk[first_unsent++], result);
+    }
+    
+    // 逆序放回，保持原有的出队顺序
+    for (uint32_t i = count; i > first_unsent; i--) {
+        pending_putback(pool, policy, chunk[i - 1]);
+    }
+    
+    return count - first_unsent;
+}
+
+/**
+ * 按调度策略分发积压任务，直到没有任务或Worker均已满载
+ *
+ * 积压按有空余名额的Worker数均分，每个Worker本轮只接收一批：整批写入
+ * 提交环后一次提交、一次唤醒，突发提交时系统调用数与Worker数成正比
+ * 而不是与任务数成正比。任务少于Worker数时每批一个，仍然分散执行。
+ * 带路由键的任务在出队时暂存给各自的属主，本轮结束时按属主成批发送
+ */
+static void dispatch_pending_tasks(event_loop_t* loop) {
+    process_pool_t* pool = loop->pool;
+    int policy = update_sched_policy(loop);
+    uint64_t now = get_time_ns();
+    uint32_t depth = pool->config.worker_queue_depth ?
+                     pool->config.worker_queue_depth : DEFAULT_WORKER_QUEUE_DEPTH;
+    task_internal_t* chunk[SHM_STEAL_SLOTS]; // 在途深度不超过任务表大小
+    bool served[MAX_WORKERS] = {false};
+    route_round_t round;
+    task_internal_t* task;
+    bool aged;
+    
+    uint32_t pending = 0;
+    for (int i = 0; i < TASK_PRIORITY_COUNT; i++) {
+        pending += ATOMIC_LOAD(&pool->pending_counts[i]);
+    }
+    
+    memset(&round, 0, sizeof(round));
+    uint32_t open_workers = 0;
+    for (uint32_t i = 0; i < pool->config.max_workers; i++) {
+        if (ATOMIC_LOAD(&pool->workers[i].state) != WORKER_INTERNAL_RUNNING) {
+            continue;
+        }
+    
+        uint32_t inflight = ATOMIC_LOAD(&pool->workers[i].inflight_count);
+        round.total_load += inflight;
+        round.running++;
+        if (inflight < depth) {
+            open_workers++;
+        }
+    }
+    
+    uint32_t share = open_workers > 0 ? (pending + open_workers - 1) / open_workers : 0;
+    
+    bool full = false;
+    while (pending > 0 && !full) {
+        uint32_t room;
+        worker_internal_t* target = pick_dispatch_worker(pool, depth, served, &round, &room);
+        if (!target) {
+            break;
+        }
+        served[target->worker_id] = true;
+        
+        // 任务在分发失败时可能立即被释放，先取出再分发
+        uint32_t limit = room < share ? room : share;
+        uint32_t count = 0;
+        
+        while (count < limit && (task = pending_take(pool, policy, now, &aged)) != NULL) {
+            pending--;
+            if (discard_before_dispatch(loop, task, policy, now)) {
+                continue;
+            }
+            task->dispatch_aged = aged;
+            task->route = TASK_ROUTE_NONE;
+            if (task->desc.routing_key != 0 && route_task(pool, &round, task, target, depth)) {
+                continue;
+            }
+            chunk[count++] = task;
+            round.total_load++;
+        }
+        
+        if (count == 0) {
+            continue;
+        }
+        
+        pending += send_dispatch_batch(loop, target, chunk, count, policy, now, &full);
+    }
+    
+    // 发送暂存给各属主的任务，某个属主的提交环已满不影响其他属主
+    for (uint32_t i = 0; i < pool->config.max_workers; i++) {
+        if (round.count[i] == 0) {
+            continue;
+        }
+    
+        uint32_t count = 0;
+        for (task = round.head[i]; task; task = task->next) {
+            chunk[count++] = task;
+        }
+    
+        send_dispatch_batch(loop, &pool->workers[i], chunk, count, policy, now, &full);
+    }
+    
+    // Worker均已满载：优先级调度下紧急任务不受在途深度限制，逐个插队分发
+    if (policy != POOL_SCHED_PRIORITY) {
+        return;
+    }
+    
+    while ((task = pending_take(pool, policy, now, &aged)) != NULL) {
+        if (discard_before_dispatch(loop, task, policy, now)) {
+            continue;
+        }
+        
+        if (task->desc.priority != TASK_PRIORITY_URGENT || !dispatch_task(loop, task, now, aged)) {
+            pending_putback(pool, policy, task);
+            break;
+        }
+    }
+}
+
+// ============================================================================
+// 任务超时
+// ============================================================================
+
+/**
+ * 任务的绝对截止时间，从提交时刻起算，覆盖排队和执行两个阶段
+ * 任务未指定timeout_ms时使用配置的task_timeout，两者均为0表示不限时。
+ * 流式任务的时长取决于调用方读写的快慢，不套用task_timeout，只按自身的timeout_ms限时
+ */
+static uint64_t task_deadline_ns(const process_pool_t* pool, const task_internal_t* task) {
+    uint64_t timeout_ms = task->desc.timeout_ms;
+    if (timeout_ms == 0 && !task->desc.streaming) {
+        timeout_ms = (uint64_t)pool->config.task_timeout * 1000ULL;
+    }
+    
+    if (timeout_ms == 0) {
+        return 0;
+    }
+    
+    return task->submit_time_ns + timeout_ms * 1000000ULL;
+}
+
+static void cancel_running_task(event_loop_t* loop, task_internal_t* task, uint64_t now);
+static void escalate_cancel(event_loop_t* loop, task_internal_t* task, uint64_t now);
+static void reap_worker_results(event_loop_t* loop, int worker_id);
+
+/**
+ * 时间轮到期回调：任务仍由待分发结构或Worker在途链表持有，
+ * 这里只设置终态并唤醒等待者，任务离开时再释放引用。
+ * 已请求取消的任务复用同一个定时器推进取消升级
+ */
+static void expire_task(timer_node_t* node, void* arg) {
+    event_loop_t* loop = (event_loop_t*)arg;
+    task_internal_t* task = CONTAINER_OF(node, task_internal_t, timer);
+    
+    if (task->cancel_stage != TASK_CANCEL_NONE) {
+        escalate_cancel(loop, task, get_time_ns());
+        return;
+    }
+    
+    if (task_is_completed(task)) {
+        return;
+    }
+    
+    log_message(loop->pool, 2, "Task %lu timed out after %lu ms", task->task_id,
+               (get_time_ns() - task->submit_time_ns) / 1000000ULL);
+    
+    task_set_error(task, POOL_ERROR_TIMEOUT, "Task timed out");
+    task_complete(task, TASK_STATE_TIMEOUT);
+    stats_task_timeout(loop->pool);
+    stats_task_deadline(loop->pool, loop->active_policy, false, false);
+    ATOMIC_ADD(&loop->tasks_timed_out, 1);
+    
+    // 已分发的任务同样要让Worker停下来
+    cancel_running_task(loop, task, get_time_ns());
+}
+
+/**
+ * 把timer_fd设为下一次定期维护和时间轮下一个事件中较早的时间
+ */
+static void event_loop_rearm_timer(event_loop_t* loop) {
+    uint64_t expire_ns = loop->next_housekeeping_ns;
+    uint64_t wheel_ns;
+    
+    if (timer_wheel_next_expiry(&loop->pool->timer_wheel, &wheel_ns) && wheel_ns < expire_ns) {
+        expire_ns = wheel_ns;
+    }
+    
+    if (expire_ns == loop->timer_armed_ns) {
+        return;
+    }
+    
+    struct itimerspec timer_spec = {0};
+    timer_spec.it_value.tv_sec = expire_ns / 1000000000ULL;
+    timer_spec.it_value.tv_nsec = expire_ns % 1000000000ULL;
+    
+    if (timerfd_settime(loop->timer_fd, TFD_TIMER_ABSTIME, &timer_spec, NULL) == -1) {
+        log_message(loop->pool, 0, "Failed to arm timer fd: %s", strerror(errno));
+        return;
+    }
+    
+    loop->timer_armed_ns = expire_ns;
+}
+
+// ============================================================================
+// 运行中任务的取消
+// ============================================================================
+
+/**
+ * 重启指定Worker，在途任务以error_code失败
+ */
+static void restart_worker(event_loop_t* loop, uint32_t worker_id,
+                           int error_code, const char* error_message) {
+    worker_internal_t* worker = &loop->pool->workers[worker_id];
+    
+    // 在途任务随Worker一起丢失，标记为失败
+    worker_fail_inflight(worker, error_code, error_message);
+    
+    remove_worker_event(loop, worker_id);
+    worker_stop(worker, 1000);
+    worker_destroy(worker);
+    
+    if (worker_create(loop->pool, worker_id) == POOL_SUCCESS) {
+        if (worker_start_async(worker) == POOL_SUCCESS) {
+            log_message(loop->pool, 2, "Worker %u restarted successfully", worker_id);
+            
+            // 重新添加Worker事件到epoll，由zygote派生时等应答到达后再添加
+            if (ATOMIC_LOAD(&worker->state) == WORKER_INTERNAL_RUNNING) {
+                add_worker_event(loop, worker_id);
+            }
+        } else {
+            log_message(loop->pool, 0, "Failed to restart worker %u", worker_id);
+        }
+    }
+}
+
+/**
+ * 把收回的任务放回待分发队列，放不回的任务以失败结束
+ */
+static void requeue_reclaimed(event_loop_t* loop, task_internal_t** tasks, uint32_t count) {
+    process_pool_t* pool = loop->pool;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        if (!pending_push(pool, loop->active_policy, tasks[i])) {
+            timer_wheel_cancel(&pool->timer_wheel, &tasks[i]->timer);
+            task_set_error(tasks[i], POOL_ERROR_NO_MEMORY, "Failed to requeue task");
+            task_complete(tasks[i], TASK_STATE_FAILED);
+            stats_task_failed(pool);
+            task_unref(tasks[i]);
+        }
+    }
+}
+
+/**
+ * 回收已退出(或刚被强制结束)的退役Worker：取走退出前写入的结果，
+ * 仍未完成的在途任务以失败结束
+ */
+static void finish_retired_worker(event_loop_t* loop, uint32_t worker_id) {
+    worker_internal_t* worker = &loop->pool->workers[worker_id];
+    
+    reap_worker_results(loop, worker_id);
+    remove_worker_event(loop, worker_id);
+    worker_stop(worker, WORKER_RETIRE_TIMEOUT_MS);
+    worker_fail_inflight(worker, POOL_ERROR_WORKER_DEAD, "Worker stopped by resize");
+    worker_destroy(worker);
+    
+    log_message(loop->pool, 2, "Retired worker %u reaped", worker_id);
+}
 
-// ============================================================================
-// 事件循环状态
-// ============================================================================
+/**
+ * 检查退役Worker：已退出的回收，超时的强制结束(退出后由pidfd事件回收)
+ */
+static void check_retired_workers(event_loop_t* loop, uint64_t now) {
+    for (uint32_t i = 0; i < loop->pool->config.max_workers; i++) {
+        worker_internal_t* worker = &loop->pool->workers[i];
+        if (worker->retire_deadline_ns == 0 || worker->spawn_deadline_ns > 0) {
+            continue;
+        }
+    
+        if (!worker_is_alive(worker)) {
+            finish_retired_worker(loop, i);
+        } else if (now >= worker->retire_deadline_ns) {
+            log_message(loop->pool, 1, "Retired worker %u did not exit in time, killing it", i);
+            kill(worker->pid, SIGKILL);
+        }
+    }
+}
 
-typedef struct {
-    int epoll_fd;
-    int task_submit_eventfd;
-    int control_eventfd;
-    int signal_fd;
-    int timer_fd;
-    bool running;
-    pthread_t thread;
-    process_pool_t* pool;
+/**
+ * 把取消请求写入属主Worker的取消表，并挂上升级定时器
+ * 任务尚未分发或已经完成时无需处理
+ */
+static void cancel_running_task(event_loop_t* loop, task_internal_t* task, uint64_t now) {
+    process_pool_t* pool = loop->pool;
+    
+    if (task->cancel_stage != TASK_CANCEL_NONE) {
+        return;
+    }
     
-    // 统计信息
-    _Atomic uint64_t events_processed;
-    _Atomic uint64_t tasks_submitted;
-    _Atomic uint64_t tasks_completed;
-    _Atomic uint64_t worker_events;
-    _Atomic uint64_t timer_events;
-} event_loop_t;
+    uint32_t owner_id = ATOMIC_LOAD(&task->worker_id);
+    if (owner_id >= pool->config.max_workers ||
+        !worker_request_cancel(&pool->workers[owner_id], task)) {
+        return;
+    }
+    
+    task->cancel_stage = TASK_CANCEL_REQUESTED;
+    
+    if (pool->config.cancel_signal_ms > 0) {
+        timer_wheel_add(&pool->timer_wheel, &task->timer,
+                        now + (uint64_t)pool->config.cancel_signal_ms * 1000000ULL);
+    } else {
+        timer_wheel_cancel(&pool->timer_wheel, &task->timer);
+    }
+}
 
-static event_loop_t g_event_loop = {0};
+/**
+ * 处理函数在宽限期内没有返回：先发送携带任务ID的SIGUSR1，
+ * 仍不返回则收回执行者提交环中未开始的任务并回收执行者进程
+ */
+static void escalate_cancel(event_loop_t* loop, task_internal_t* task, uint64_t now) {
+    process_pool_t* pool = loop->pool;
+    
+    // 执行者已经返回(或任务还没开始)，结果回收时会释放任务
+    worker_internal_t* executor = worker_find_executor(pool, task);
+    if (!executor || executor->pid <= 0) {
+        return;
+    }
+    
+    if (task->cancel_stage == TASK_CANCEL_REQUESTED) {
+        union sigval value;
+        value.sival_ptr = (void*)(uintptr_t)task->task_id;
+        
+        if (sigqueue(executor->pid, SIGUSR1, value) == -1) {
+            log_message(pool, 1, "Failed to signal worker %u for task %lu: %s",
+                       executor->worker_id, task->task_id, strerror(errno));
+        } else {
+            log_message(pool, 2, "Task %lu ignored cancellation, signalled worker %u",
+                       task->task_id, executor->worker_id);
+            stats_cancel_escalated(pool, false);
+        }
+        
+        task->cancel_stage = TASK_CANCEL_SIGNALLED;
+        
+        if (pool->config.cancel_kill_ms > 0) {
+            timer_wheel_add(&pool->timer_wheel, &task->timer,
+                            now + (uint64_t)pool->config.cancel_kill_ms * 1000000ULL);
+        }
+        return;
+    }
+    
+    if (task->cancel_stage != TASK_CANCEL_SIGNALLED) {
+        return;
+    }
+    
+    task->cancel_stage = TASK_CANCEL_RECYCLED;
+    
+    // 执行者可能刚返回并切换到下一个任务，此时不再回收，结果回收时会释放任务
+    if (ATOMIC_LOAD(&executor->shared_mem->running_task_id) != task->task_id) {
+        return;
+    }
+    
+    uint32_t worker_id = executor->worker_id;
+    log_message(pool, 1, "Task %lu ignored SIGUSR1, recycling worker %u",
+               task->task_id, worker_id);
+    
+    // 执行者提交环中还没开始的任务与取消无关，收回后重新分发
+    task_internal_t* reclaimed[SHM_STEAL_SLOTS];
+    uint32_t count = worker_reclaim_unstarted(executor, reclaimed, SHM_STEAL_SLOTS);
+    requeue_reclaimed(loop, reclaimed, count);
+    
+    kill(executor->pid, SIGKILL);
+    stats_cancel_escalated(pool, true);
+    
+    restart_worker(loop, worker_id, POOL_ERROR_WORKER_DEAD, "Worker recycled after cancellation");
+    dispatch_pending_tasks(loop);
+}
+
+/**
+ * 处理提交线程转交的取消请求，每个请求持有一个任务引用
+ */
+static void process_cancel_requests(event_loop_t* loop) {
+    process_pool_t* pool = loop->pool;
+    
+    pthread_mutex_lock(&pool->task_mutex);
+    task_internal_t* task = pool->cancel_requests;
+    pool->cancel_requests = NULL;
+    pthread_mutex_unlock(&pool->task_mutex);
+    
+    uint64_t now = get_time_ns();
+    
+    while (task) {
+        task_internal_t* next = task->cancel_next;
+        task->cancel_next = NULL;
+        
+        cancel_running_task(loop, task, now);
+        task_unref(task);
+        
+        task = next;
+    }
+}
 
 // ============================================================================
-// 辅助函数
+// zygote异步派生
 // ============================================================================
 
-static int setup_signal_fd(void) {
-    sigset_t mask;
-    int sfd;
-    
-    // 设置信号掩码
-    sigemptyset(&mask);
-    sigaddset(&mask, SIGCHLD);  // 子进程退出
-    sigaddset(&mask, SIGTERM);  // 终止信号
-    sigaddset(&mask, SIGINT);   // 中断信号
-    sigaddset(&mask, SIGUSR1);  // 用户信号1
-    sigaddset(&mask, SIGUSR2);  // 用户信号2
+/**
+ * 注册zygote异步派生套接字，zygote未启用时不注册
+ */
+static int add_zygote_event(event_loop_t* loop) {
+    int sock = loop->pool->zygote_async_sock;
+    if (sock < 0) {
+        return 0;
+    }
     
-    // 阻塞这些信号，通过signalfd处理
-    if (pthread_sigmask(SIG_BLOCK, &mask, NULL) == -1) {
-        return -1;
+#ifdef PROCESS_POOL_USE_IO_URING
+    if (loop->backend == POOL_EVENT_BACKEND_IO_URING) {
+        if (uring_arm_event(loop, EVENT_TYPE_ZYGOTE, 0) == -1) {
+            return -1;
+        }
+        loop->zygote_watched = true;
+        return 0;
     }
+#endif
     
-    // 创建signalfd
-    sfd = signalfd(-1, &mask, SFD_CLOEXEC);
-    if (sfd == -1) {
+    loop->zygote_event_data = add_worker_fd(loop, sock, EPOLLIN, EVENT_TYPE_ZYGOTE, 0);
+    if (!loop->zygote_event_data) {
         return -1;
     }
+    loop->zygote_watched = true;
     
-    return sfd;
+    return 0;
 }
 
-static int setup_timer_fd(void) {
-    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
-    if (tfd == -1) {
-        return -1;
+static void remove_zygote_event(event_loop_t* loop) {
+    if (!loop->zygote_watched) {
+        return;
+    }
+    loop->zygote_watched = false;
+    
+#ifdef PROCESS_POOL_USE_IO_URING
+    if (loop->backend == POOL_EVENT_BACKEND_IO_URING) {
+        pthread_mutex_lock(&loop->sq_mutex);
+        struct io_uring_sqe* sqe = uring_get_sqe(loop);
+        if (sqe) {
+            io_uring_prep_cancel64(sqe, URING_TAG(EVENT_TYPE_ZYGOTE, 0, 0), 0);
+            io_uring_sqe_set_data64(sqe, 0);
+        }
+        uring_flush(loop);
+        pthread_mutex_unlock(&loop->sq_mutex);
+        return;
     }
+#endif
+    
+    remove_epoll_event(loop->epoll_fd, loop->pool->zygote_async_sock);
+    free(loop->zygote_event_data);
+    loop->zygote_event_data = NULL;
+}
+
+/**
+ * 以派生结果完成Worker启动(pid<=0时退回到fork)并注册事件
+ * 等待期间被缩容的Worker启动后立即退役
+ */
+static void complete_spawn(event_loop_t* loop, uint32_t worker_id, pid_t pid) {
+    worker_internal_t* worker = &loop->pool->workers[worker_id];
     
-    // 设置定时器：每秒触发一次
-    struct itimerspec timer_spec;
-    timer_spec.it_value.tv_sec = 1;
-    timer_spec.it_value.tv_nsec = 0;
-    timer_spec.it_interval.tv_sec = 1;
-    timer_spec.it_interval.tv_nsec = 0;
+    if (worker_finish_start(worker, pid) != POOL_SUCCESS) {
+        log_message(loop->pool, 0, "Failed to start worker %u", worker_id);
+        return;
+    }
     
-    if (timerfd_settime(tfd, 0, &timer_spec, NULL) == -1) {
-        close(tfd);
-        return -1;
+    if (add_worker_event(loop, worker_id) == -1) {
+        log_message(loop->pool, 0, "Failed to watch worker %u", worker_id);
     }
     
-    return tfd;
+    if (worker->retire_deadline_ns > 0) {
+        worker->retire_deadline_ns = 0;
+        event_loop_retire_worker(worker_id);
+    }
 }
 
-static int add_epoll_event(int epoll_fd, int fd, uint32_t events, event_type_t type, void* data) {
-    struct epoll_event ev;
-    event_data_t* event_data = malloc(sizeof(event_data_t));
-    if (!event_data) {
-        return -1;
-    }
+/**
+ * zygote已退出：注销并停用异步套接字，仍在等待应答的Worker退回到fork
+ */
+static void handle_zygote_lost(event_loop_t* loop) {
+    process_pool_t* pool = loop->pool;
     
-    event_data->type = type;
-    event_data->fd = fd;
-    event_data->data = data;
-    event_data->events = events;
+    log_message(pool, 1, "Zygote exited, pending workers fall back to fork");
     
-    ev.events = events;
-    ev.data.ptr = event_data;
+    remove_zygote_event(loop);
+    zygote_close_async(pool);
     
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
-        free(event_data);
-        return -1;
+    for (uint32_t i = 0; i < pool->config.max_workers; i++) {
+        if (pool->workers[i].spawn_deadline_ns > 0) {
+            complete_spawn(loop, i, -1);
+        }
+    }
+}
+
+/**
+ * 处理zygote的派生应答。槽位已销毁或重新派生时应答已经失效，
+ * 结束这个无人认领的进程
+ */
+static void handle_zygote_event(event_loop_t* loop) {
+    process_pool_t* pool = loop->pool;
+    
+    while (loop->zygote_watched) {
+        uint32_t worker_id;
+        uint32_t token;
+        pid_t pid;
+    
+        int ret = zygote_recv_spawn(pool, &worker_id, &token, &pid);
+        if (ret == 0) {
+            break;
+        }
+        if (ret < 0) {
+            handle_zygote_lost(loop);
+            break;
+        }
+    
+        worker_internal_t* worker = worker_id < pool->config.max_workers ?
+                                    &pool->workers[worker_id] : NULL;
+        if (!worker || worker->spawn_deadline_ns == 0 || worker->spawn_token != token) {
+            if (pid > 0) {
+                log_message(pool, 1, "Discarding stale zygote reply for worker %u", worker_id);
+                kill(pid, SIGKILL);
+                waitpid(pid, NULL, 0);
+            }
+            continue;
+        }
+    
+        complete_spawn(loop, worker_id, pid);
     }
     
-    return 0;
+    dispatch_pending_tasks(loop);
 }
 
-static void remove_epoll_event(int epoll_fd, int fd) {
-    struct epoll_event ev;
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &ev) == 0) {
-        if (ev.data.ptr) {
-            free(ev.data.ptr);
+/**
+ * zygote超时未应答时结束它，之后读到EOF，由handle_zygote_lost退回到fork
+ */
+static void check_pending_spawns(event_loop_t* loop, uint64_t now) {
+    for (uint32_t i = 0; i < loop->pool->config.max_workers; i++) {
+        uint64_t deadline = loop->pool->workers[i].spawn_deadline_ns;
+        if (deadline > 0 && now >= deadline) {
+            log_message(loop->pool, 1, "Zygote did not answer spawn request for worker %u, "
+                       "killing it", i);
+            zygote_abort(loop->pool);
+            return;
         }
     }
 }
@@ -141,6 +1620,79 @@ static void remove_epoll_event(int epoll_fd, int fd) {
 // 事件处理函数
 // ============================================================================
 
+// 每次从提交队列批量取出的任务数
+#define SUBMIT_DRAIN_BATCH 256
+
+// 每次从Worker完成环批量回收的结果数
+#define REAP_BATCH 256
+
+/**
+ * 按调度策略暂存新提交的任务并挂入超时时间轮，记录最早的截止时间
+ */
+static void stage_submitted_task(event_loop_t* loop, int policy, task_internal_t* task,
+                                 uint64_t* earliest) {
+    process_pool_t* pool = loop->pool;
+    
+    task->deadline_ns = task_deadline_ns(pool, task);
+    if (!pending_push(pool, policy, task)) {
+        task_set_error(task, POOL_ERROR_NO_MEMORY, "Failed to queue task");
+        task_complete(task, TASK_STATE_FAILED);
+        stats_task_failed(pool);
+        task_unref(task);
+        return;
+    }
+    
+    if (task->deadline_ns) {
+        timer_wheel_add(&pool->timer_wheel, &task->timer, task->deadline_ns);
+        if (task->deadline_ns < *earliest) {
+            *earliest = task->deadline_ns;
+        }
+    }
+}
+
+static void process_task_submit(event_loop_t* loop, uint64_t value) {
+    log_message(loop->pool, 3, "Received %lu task submit notifications", value);
+    
+    // 取消请求与任务提交共用同一个eventfd
+    process_cancel_requests(loop);
+    
+    // 先取事件循环线程自身提交的任务，再取空任务队列(通知可能被合并，
+    // 因此不依赖计数值)
+    process_pool_t* pool = loop->pool;
+    uint64_t earliest = UINT64_MAX;
+    task_internal_t* batch[SUBMIT_DRAIN_BATCH];
+    task_internal_t* task;
+    uint32_t count;
+    
+    int policy = update_sched_policy(loop);
+    
+    // 暂存时失败的任务可能经任务图再次挂入延迟链表，逐个摘取
+    while ((task = pool->deferred_tasks.head) != NULL) {
+        pool->deferred_tasks.head = task->next;
+        if (!pool->deferred_tasks.head) {
+            pool->deferred_tasks.tail = NULL;
+        }
+        task->next = NULL;
+        stage_submitted_task(loop, policy, task, &earliest);
+    }
+    
+    while ((count = queue_dequeue_batch(pool->task_queue, batch, SUBMIT_DRAIN_BATCH)) > 0) {
+        for (uint32_t i = 0; i < count; i++) {
+            stage_submitted_task(loop, policy, batch[i], &earliest);
+        }
+    }
+    
+    // 按调度策略分发，剩余任务等待Worker完成任务后重试
+    dispatch_pending_tasks(loop);
+    
+    // 新任务的截止时间早于timer_fd当前的到期时间时重新设置
+    if (earliest < loop->timer_armed_ns || loop->timer_armed_ns == 0) {
+        event_loop_rearm_timer(loop);
+    }
+    
+    ATOMIC_ADD(&loop->tasks_submitted, value);
+}
+
 static void handle_task_submit_event(event_loop_t* loop) {
     uint64_t value;
     
@@ -153,32 +1705,94 @@ static void handle_task_submit_event(event_loop_t* loop) {
         return;
     }
     
-    log_message(loop->pool, 3, "Received %lu task submit notifications", value);
+    process_task_submit(loop, value);
+}
+
+/**
+ * 回收Worker完成环中的全部结果，两种后端读到result_eventfd后都从这里处理
+ */
+static void reap_worker_results(event_loop_t* loop, int worker_id) {
+    worker_internal_t* worker = &loop->pool->workers[worker_id];
+    shared_memory_t* shm = worker->shared_mem;
+    if (!shm) {
+        return;
+    }
+    
+    // 先清除通知标记再声明正在回收：回收期间提交的结果不再写eventfd，
+    // 回收结束后提交的结果重新通知
+    ATOMIC_STORE(&shm->result_signalled, 0);
+    ATOMIC_STORE(&shm->master_reaping, 1);
     
-    // 处理提交的任务
-    for (uint64_t i = 0; i < value; i++) {
-        // 从任务队列中取出任务
-        task_internal_t* task = NULL;
-        if (queue_dequeue(loop->pool->task_queue, (void**)&task) == 0) {
-            // 分配任务给Worker
-            pool_error_t result = assign_task_to_worker(loop->pool, task);
-            if (result != POOL_SUCCESS) {
-                log_message(loop->pool, 1, "Failed to assign task %lu to worker: %d", 
-                           task->task_id, result);
+    task_internal_t* batch[REAP_BATCH];
+    task_internal_t* finished[REAP_BATCH];
+    task_state_t states[REAP_BATCH];
+    uint64_t reaped = 0;
+    
+    for (;;) {
+        uint32_t count = worker_get_results(worker, batch, REAP_BATCH);
+        
+        if (count == 0) {
+            // 退出回收后复查一次，与Worker写完成记录后检查master_reaping配对
+            ATOMIC_STORE(&shm->master_reaping, 0);
+            MEMORY_BARRIER();
+            if (!shm_ring_peek(&shm->complete_ring)) {
+                break;
+            }
+            ATOMIC_STORE(&shm->master_reaping, 1);
+            continue;
+        }
+        
+        uint32_t finishing = 0;
+        
+        for (uint32_t i = 0; i < count; i++) {
+            task_internal_t* task = batch[i];
+            timer_wheel_cancel(&loop->pool->timer_wheel, &task->timer);
+            
+            if (task_is_completed(task)) {
+                // 已超时或被取消，结果已被丢弃
+                continue;
+            }
+            
+            if (task->result.error_code == 0) {
+                uint64_t duration_ns = task->end_time_ns - task->start_time_ns;
                 
-                // 标记任务失败
-                task_set_error(task, result, "Failed to assign to worker");
-                ATOMIC_STORE(&task->state, TASK_STATE_FAILED);
+                states[finishing] = TASK_STATE_COMPLETED;
+                stats_task_completed(loop->pool, duration_ns);
                 
-                // 通知等待的线程
-                pthread_mutex_lock(&task->mutex);
-                pthread_cond_broadcast(&task->completion_cond);
-                pthread_mutex_unlock(&task->mutex);
+                // 执行时间估计取1/8权重的滑动平均
+                loop->exec_estimate_ns = loop->exec_estimate_ns ?
+                                         (loop->exec_estimate_ns * 7 + duration_ns) / 8 : duration_ns;
+                
+                if (task->deadline_ns) {
+                    stats_task_deadline(loop->pool, loop->active_policy,
+                                        task->end_time_ns <= task->deadline_ns, false);
+                }
+                
+                result_cache_store(loop->pool, task);
+            } else {
+                states[finishing] = TASK_STATE_FAILED;
+                stats_task_failed(loop->pool);
             }
+            finished[finishing++] = task;
         }
+        
+        // 整批唤醒等待者后再执行回调
+        task_complete_batch(finished, states, finishing);
+        
+        // 释放在途链表持有的引用
+        for (uint32_t i = 0; i < count; i++) {
+            task_unref(batch[i]);
+        }
+        reaped += count;
     }
     
-    ATOMIC_ADD(&loop->tasks_submitted, value);
+    log_message(loop->pool, 3, "Worker %d completed %lu tasks", worker_id, reaped);
+    
+    ATOMIC_STORE(&worker->last_heartbeat, get_time_ns());
+    ATOMIC_ADD(&loop->tasks_completed, reaped);
+    
+    // Worker已腾出在途名额，继续分发积压任务
+    dispatch_pending_tasks(loop);
 }
 
 static void handle_task_complete_event(event_loop_t* loop, int worker_id) {
@@ -194,18 +1808,7 @@ static void handle_task_complete_event(event_loop_t* loop, int worker_id) {
         return;
     }
     
-    log_message(loop->pool, 3, "Worker %d completed %lu tasks", worker_id, value);
-    
-    // 处理完成的任务
-    for (uint64_t i = 0; i < value; i++) {
-        // 从Worker的结果队列中取出任务结果
-        // TODO: 实现从共享内存读取任务结果的逻辑
-        
-        // 更新统计信息
-        ATOMIC_ADD(&loop->pool->stats.tasks_completed, 1);
-    }
-    
-    ATOMIC_ADD(&loop->tasks_completed, value);
+    reap_worker_results(loop, worker_id);
 }
 
 static void handle_worker_status_event(event_loop_t* loop, int worker_id) {
@@ -213,53 +1816,59 @@ static void handle_worker_status_event(event_loop_t* loop, int worker_id) {
     
     log_message(loop->pool, 3, "Worker %d status changed", worker_id);
     
+    // 缩容退役的Worker退出后在这里回收
+    if (worker->retire_deadline_ns > 0) {
+        if (!worker_is_alive(worker)) {
+            finish_retired_worker(loop, (uint32_t)worker_id);
+        }
+        return;
+    }
+    
+    // 正在被pool_stop或重启停止的Worker由停止方回收
+    if (ATOMIC_LOAD(&worker->state) != WORKER_INTERNAL_RUNNING) {
+        return;
+    }
+    
     // 检查Worker状态
     if (!worker_is_alive(worker)) {
         log_message(loop->pool, 1, "Worker %d is dead, attempting restart", worker_id);
         
-        // 重启Worker
-        worker_stop(worker, 1000);
-        worker_destroy(worker);
-        
-        if (worker_create(loop->pool, worker_id) == POOL_SUCCESS) {
-            if (worker_start(worker) == POOL_SUCCESS) {
-                log_message(loop->pool, 2, "Worker %d restarted successfully", worker_id);
-                
-                // 重新添加Worker事件到epoll
-                add_epoll_event(loop->epoll_fd, worker->result_eventfd, 
-                               EPOLLIN | EPOLLET, EVENT_TYPE_TASK_COMPLETE, 
-                               (void*)(intptr_t)worker_id);
-            } else {
-                log_message(loop->pool, 0, "Failed to restart worker %d", worker_id);
-            }
-        }
+        restart_worker(loop, worker_id, POOL_ERROR_WORKER_DEAD, "Worker process died");
+        dispatch_pending_tasks(loop);
     }
     
     ATOMIC_ADD(&loop->worker_events, 1);
 }
 
-static void handle_timer_event(event_loop_t* loop) {
-    uint64_t expirations;
+static void process_timer_expiry(event_loop_t* loop, uint64_t expirations) {
+    log_message(loop->pool, 4, "Timer expired %lu times", expirations);
+    ATOMIC_ADD(&loop->timer_events, expirations);
     
-    // 读取定时器过期次数
-    if (read(loop->timer_fd, &expirations, sizeof(expirations)) == -1) {
-        if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            log_message(loop->pool, 0, "Failed to read timer fd: %s", strerror(errno));
-        }
+    uint64_t now = get_time_ns();
+    loop->timer_armed_ns = 0;
+    
+    // 推进时间轮，使到期任务超时
+    timer_wheel_advance(&loop->pool->timer_wheel, now, expire_task, loop);
+    
+    if (now < loop->next_housekeeping_ns) {
+        event_loop_rearm_timer(loop);
         return;
     }
     
-    log_message(loop->pool, 4, "Timer expired %lu times", expirations);
+    loop->next_housekeeping_ns = now + EVENT_LOOP_HOUSEKEEPING_MS * 1000000ULL;
+    event_loop_rearm_timer(loop);
     
     // 执行定期任务
     
     // 1. 更新统计信息
-    update_pool_statistics(loop->pool);
+    pthread_mutex_lock(&loop->pool->stats_mutex);
+    stats_update(loop->pool);
+    pthread_mutex_unlock(&loop->pool->stats_mutex);
     
     // 2. 检查Worker健康状态
     for (uint32_t i = 0; i < loop->pool->config.max_workers; i++) {
         worker_internal_t* worker = &loop->pool->workers[i];
-        if (ATOMIC_LOAD(&worker->state) == WORKER_STATE_RUNNING) {
+        if (ATOMIC_LOAD(&worker->state) == WORKER_INTERNAL_RUNNING) {
             if (!worker_is_alive(worker)) {
                 log_message(loop->pool, 1, "Worker %u health check failed", i);
                 handle_worker_status_event(loop, i);
@@ -267,15 +1876,31 @@ static void handle_timer_event(event_loop_t* loop) {
         }
     }
     
-    // 3. 清理过期任务
-    cleanup_expired_tasks(loop->pool);
+    // 3. 回收已退出的退役Worker，强制结束超时的
+    check_retired_workers(loop, now);
     
-    // 4. 动态调整Worker数量
+    // 4. zygote超时未应答时放弃它
+    check_pending_spawns(loop, now);
+    
+    // 5. 动态调整Worker数量，扩容后立即把积压分给新Worker
     if (loop->pool->config.enable_auto_scaling) {
         adjust_worker_count(loop->pool);
+        dispatch_pending_tasks(loop);
     }
+}
+
+static void handle_timer_event(event_loop_t* loop) {
+    uint64_t expirations;
     
-    ATOMIC_ADD(&loop->timer_events, expirations);
+    // 读取定时器过期次数
+    if (read(loop->timer_fd, &expirations, sizeof(expirations)) == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            log_message(loop->pool, 0, "Failed to read timer fd: %s", strerror(errno));
+        }
+        return;
+    }
+    
+    process_timer_expiry(loop, expirations);
 }
 
 static void handle_signal_event(event_loop_t* loop) {
@@ -289,7 +1914,7 @@ static void handle_signal_event(event_loop_t* loop) {
                 // 查找对应的Worker
                 for (uint32_t i = 0; i < loop->pool->config.max_workers; i++) {
                     worker_internal_t* worker = &loop->pool->workers[i];
-                    if (worker->pid == si.ssi_pid) {
+                    if (worker->pid == (pid_t)si.ssi_pid) {
                         log_message(loop->pool, 2, "Worker %u (PID %d) exited with status %d", 
                                    i, si.ssi_pid, si.ssi_status);
                         handle_worker_status_event(loop, i);
@@ -306,12 +1931,12 @@ static void handle_signal_event(event_loop_t* loop) {
                 
             case SIGUSR1:
                 log_message(loop->pool, 2, "Received SIGUSR1, dumping statistics");
-                dump_pool_statistics(loop->pool);
+                dump_pool_state(loop->pool);
                 break;
                 
             case SIGUSR2:
                 log_message(loop->pool, 2, "Received SIGUSR2, toggling debug mode");
-                toggle_debug_mode(loop->pool);
+                log_set_level(log_get_level() >= 3 ? 2 : 3);
                 break;
                 
             default:
@@ -321,34 +1946,43 @@ static void handle_signal_event(event_loop_t* loop) {
     }
 }
 
-static void handle_control_event(event_loop_t* loop) {
-    uint64_t command;
-    
-    // 读取控制命令
-    if (read(loop->control_eventfd, &command, sizeof(command)) == -1) {
-        if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            log_message(loop->pool, 0, "Failed to read control eventfd: %s", 
-                       strerror(errno));
-        }
-        return;
-    }
-    
+/**
+ * 处理pool_resize转交的请求：停止Worker要失败其在途任务，只能在事件循环线程上进行
+ * 请求方持有pool_mutex直到收到结果，这里代其调用pool_resize_locked
+ */
+static void process_resize_request(event_loop_t* loop) {
+    pthread_mutex_lock(&loop->resize_mutex);
+    uint32_t target = loop->resize_target;
+    pthread_mutex_unlock(&loop->resize_mutex);
+    
+    pool_error_t err = pool_resize_locked(loop->pool, target);
+    
+    // 扩容后立即把积压分给新Worker
+    dispatch_pending_tasks(loop);
+    
+    pthread_mutex_lock(&loop->resize_mutex);
+    loop->resize_result = err;
+    loop->resize_done = true;
+    pthread_cond_signal(&loop->resize_cond);
+    pthread_mutex_unlock(&loop->resize_mutex);
+}
+
+static void process_control_command(event_loop_t* loop, uint64_t command) {
     log_message(loop->pool, 3, "Received control command: %lu", command);
     
     switch (command) {
-        case 1: // 停止事件循环
+        case EVENT_LOOP_CMD_STOP:
             log_message(loop->pool, 2, "Received stop command");
             loop->running = false;
             break;
             
-        case 2: // 重新加载配置
-            log_message(loop->pool, 2, "Received reload command");
-            // TODO: 实现配置重新加载
+        case EVENT_LOOP_CMD_RESIZE:
+            process_resize_request(loop);
             break;
             
-        case 3: // 强制垃圾回收
+        case EVENT_LOOP_CMD_GC:
             log_message(loop->pool, 2, "Received GC command");
-            force_garbage_collection(loop->pool);
+            malloc_trim(0);
             break;
             
         default:
@@ -357,17 +1991,29 @@ static void handle_control_event(event_loop_t* loop) {
     }
 }
 
+static void handle_control_event(event_loop_t* loop) {
+    uint64_t command;
+    
+    // 读取控制命令
+    if (read(loop->control_eventfd, &command, sizeof(command)) == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            log_message(loop->pool, 0, "Failed to read control eventfd: %s", 
+                       strerror(errno));
+        }
+        return;
+    }
+    
+    process_control_command(loop, command);
+}
+
 // ============================================================================
 // 事件循环主函数
 // ============================================================================
 
-static void* event_loop_thread(void* arg) {
-    event_loop_t* loop = (event_loop_t*)arg;
-    
-    pthread_setname_np(pthread_self(), "event-loop");
-    
-    log_message(loop->pool, 2, "Event loop thread started");
-    
+/**
+ * epoll后端：等待就绪后由各处理函数自行read对应fd
+ */
+static void epoll_loop_run(event_loop_t* loop) {
     struct epoll_event events[EPOLL_MAX_EVENTS];
     
     while (loop->running) {
@@ -418,6 +2064,10 @@ static void* event_loop_thread(void* arg) {
                     handle_control_event(loop);
                     break;
                     
+                case EVENT_TYPE_ZYGOTE:
+                    handle_zygote_event(loop);
+                    break;
+                    
                 default:
                     log_message(loop->pool, 1, "Unknown event type: %d", event_data->type);
                     break;
@@ -426,6 +2076,161 @@ static void* event_loop_thread(void* arg) {
             ATOMIC_ADD(&loop->events_processed, 1);
         }
     }
+}
+
+#ifdef PROCESS_POOL_USE_IO_URING
+
+/**
+ * 归还provided buffer，本轮完成项处理完后统一发布给内核
+ */
+static void uring_return_buffer(event_loop_t* loop, uint32_t bid) {
+    io_uring_buf_ring_add(loop->buf_ring, &loop->ring_bufs[bid], sizeof(uint64_t), bid,
+                          io_uring_buf_ring_mask(URING_BUF_COUNT), loop->bufs_returned++);
+}
+
+static void uring_handle_cqe(event_loop_t* loop, const struct io_uring_cqe* cqe) {
+    uint64_t tag = io_uring_cqe_get_data64(cqe);
+    event_type_t type = URING_TAG_TYPE(tag);
+    uint32_t id = URING_TAG_ID(tag);
+    uint64_t value = 0;
+    
+    if (cqe->flags & IORING_CQE_F_BUFFER) {
+        uint32_t bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        value = loop->ring_bufs[bid];
+        uring_return_buffer(loop, bid);
+    }
+    
+    // 取消请求自身的完成，或已移除Worker的残留完成
+    bool worker_event = type == EVENT_TYPE_TASK_COMPLETE || type == EVENT_TYPE_WORKER_STATUS;
+    if (type == 0 ||
+        (worker_event && URING_TAG_GEN(tag) != (loop->worker_gen[id] & 0xFFFFFF))) {
+        return;
+    }
+    
+    if (cqe->res < 0 && cqe->res != -ENOBUFS) {
+        if (cqe->res != -ECANCELED) {
+            log_message(loop->pool, 0, "io_uring request for event type %d failed: %s",
+                       type, strerror(-cqe->res));
+        }
+        return;
+    }
+    
+    if (cqe->res > 0) {
+        switch (type) {
+            case EVENT_TYPE_TASK_SUBMIT:
+                process_task_submit(loop, value);
+                break;
+                
+            case EVENT_TYPE_TASK_COMPLETE:
+                reap_worker_results(loop, (int)id);
+                break;
+                
+            case EVENT_TYPE_WORKER_STATUS:
+                handle_worker_status_event(loop, (int)id);
+                break;
+                
+            case EVENT_TYPE_TIMER:
+                process_timer_expiry(loop, value);
+                break;
+                
+            case EVENT_TYPE_SIGNAL:
+                handle_signal_event(loop);
+                break;
+                
+            case EVENT_TYPE_CONTROL:
+                process_control_command(loop, value);
+                break;
+                
+            case EVENT_TYPE_ZYGOTE:
+                handle_zygote_event(loop);
+                break;
+                
+            default:
+                log_message(loop->pool, 1, "Unknown event type: %d", type);
+                break;
+        }
+        
+        ATOMIC_ADD(&loop->events_processed, 1);
+    }
+    
+    // multishot请求已结束(缓冲区耗尽等)时重新挂上；处理函数可能已重启该Worker
+    // 并以新代数注册过，此时不再重复挂。已停用的zygote套接字也不再挂
+    if (!(cqe->flags & IORING_CQE_F_MORE) && loop->running &&
+        (!worker_event || URING_TAG_GEN(tag) == (loop->worker_gen[id] & 0xFFFFFF)) &&
+        (type != EVENT_TYPE_ZYGOTE || loop->zygote_watched)) {
+        pthread_mutex_lock(&loop->sq_mutex);
+        if (uring_arm_event(loop, type, id) == -1) {
+            log_message(loop->pool, 0, "Failed to re-arm io_uring request for event type %d", type);
+        }
+        pthread_mutex_unlock(&loop->sq_mutex);
+    }
+}
+
+/**
+ * io_uring后端：每轮先批量提交本轮重新挂上的请求，再等待完成项。
+ * 稳态下multishot请求无需重新提交，一次io_uring_enter同时交付就绪和计数值
+ */
+static void uring_loop_run(event_loop_t* loop) {
+    struct __kernel_timespec timeout = { .tv_sec = 1, .tv_nsec = 0 };
+    struct io_uring_cqe* cqe;
+    
+    while (loop->running) {
+        pthread_mutex_lock(&loop->sq_mutex);
+        if (io_uring_sq_ready(&loop->ring) > 0) {
+            io_uring_submit(&loop->ring);
+        }
+        pthread_mutex_unlock(&loop->sq_mutex);
+        
+        int ret = io_uring_wait_cqe_timeout(&loop->ring, &cqe, &timeout);
+        if (ret == -ETIME || ret == -EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            log_message(loop->pool, 0, "io_uring wait failed: %s", strerror(-ret));
+            break;
+        }
+        
+        unsigned head;
+        unsigned seen = 0;
+        io_uring_for_each_cqe(&loop->ring, head, cqe) {
+            uring_handle_cqe(loop, cqe);
+            seen++;
+        }
+        io_uring_cq_advance(&loop->ring, seen);
+        
+        // 在重新提交之前发布归还的缓冲区，避免重新挂上的请求立即ENOBUFS
+        if (loop->bufs_returned > 0) {
+            io_uring_buf_ring_advance(loop->buf_ring, loop->bufs_returned);
+            loop->bufs_returned = 0;
+        }
+    }
+}
+
+#endif // PROCESS_POOL_USE_IO_URING
+
+static const char* event_backend_name(pool_event_backend_t backend) {
+    return backend == POOL_EVENT_BACKEND_IO_URING ? "io_uring" : "epoll";
+}
+
+static void* event_loop_thread(void* arg) {
+    event_loop_t* loop = (event_loop_t*)arg;
+    
+    pthread_setname_np(pthread_self(), "event-loop");
+    
+    log_message(loop->pool, 2, "Event loop thread started (%s)",
+               event_backend_name(loop->backend));
+    
+    g_in_event_loop = true;
+    
+    if (loop->backend == POOL_EVENT_BACKEND_IO_URING) {
+#ifdef PROCESS_POOL_USE_IO_URING
+        uring_loop_run(loop);
+#endif
+    } else {
+        epoll_loop_run(loop);
+    }
+    
+    g_in_event_loop = false;
     
     log_message(loop->pool, 2, "Event loop thread exited");
     
@@ -443,73 +2248,104 @@ pool_error_t event_loop_init(process_pool_t* pool) {
     
     memset(&g_event_loop, 0, sizeof(g_event_loop));
     g_event_loop.pool = pool;
-    
-    // 创建epoll实例
-    g_event_loop.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
-    if (g_event_loop.epoll_fd == -1) {
-        log_message(pool, 0, "Failed to create epoll instance: %s", strerror(errno));
-        return POOL_ERROR_SYSTEM_CALL;
-    }
+    pthread_mutex_init(&g_event_loop.resize_mutex, NULL);
+    pthread_cond_init(&g_event_loop.resize_cond, NULL);
+    g_event_loop.backend = POOL_EVENT_BACKEND_EPOLL;
+    g_event_loop.epoll_fd = -1;
+    g_event_loop.signal_fd = -1;
+    g_event_loop.timer_fd = -1;
+    g_event_loop.control_eventfd = -1;
     
     // 创建任务提交eventfd
     g_event_loop.task_submit_eventfd = create_eventfd();
     if (g_event_loop.task_submit_eventfd == -1) {
-        close(g_event_loop.epoll_fd);
+        event_loop_cleanup();
         return POOL_ERROR_SYSTEM_CALL;
     }
     
     // 创建控制eventfd
     g_event_loop.control_eventfd = create_eventfd();
     if (g_event_loop.control_eventfd == -1) {
-        close(g_event_loop.task_submit_eventfd);
-        close(g_event_loop.epoll_fd);
+        event_loop_cleanup();
         return POOL_ERROR_SYSTEM_CALL;
     }
     
     // 创建信号fd
     g_event_loop.signal_fd = setup_signal_fd();
     if (g_event_loop.signal_fd == -1) {
-        close(g_event_loop.control_eventfd);
-        close(g_event_loop.task_submit_eventfd);
-        close(g_event_loop.epoll_fd);
+        event_loop_cleanup();
         return POOL_ERROR_SYSTEM_CALL;
     }
     
     // 创建定时器fd
     g_event_loop.timer_fd = setup_timer_fd();
     if (g_event_loop.timer_fd == -1) {
-        close(g_event_loop.signal_fd);
-        close(g_event_loop.control_eventfd);
-        close(g_event_loop.task_submit_eventfd);
-        close(g_event_loop.epoll_fd);
+        event_loop_cleanup();
         return POOL_ERROR_SYSTEM_CALL;
     }
     
-    // 添加事件到epoll
-    if (add_epoll_event(g_event_loop.epoll_fd, g_event_loop.task_submit_eventfd,
-                       EPOLLIN | EPOLLET, EVENT_TYPE_TASK_SUBMIT, NULL) == -1 ||
-        add_epoll_event(g_event_loop.epoll_fd, g_event_loop.control_eventfd,
-                       EPOLLIN | EPOLLET, EVENT_TYPE_CONTROL, NULL) == -1 ||
-        add_epoll_event(g_event_loop.epoll_fd, g_event_loop.signal_fd,
-                       EPOLLIN, EVENT_TYPE_SIGNAL, NULL) == -1 ||
-        add_epoll_event(g_event_loop.epoll_fd, g_event_loop.timer_fd,
-                       EPOLLIN, EVENT_TYPE_TIMER, NULL) == -1) {
+    // 选择后端：AUTO和IO_URING优先尝试io_uring，不可用时回退到epoll
+#ifdef PROCESS_POOL_USE_IO_URING
+    if (pool->config.event_backend != POOL_EVENT_BACKEND_EPOLL) {
+        if (uring_backend_init(&g_event_loop) == 0) {
+            g_event_loop.backend = POOL_EVENT_BACKEND_IO_URING;
+        } else if (pool->config.event_backend == POOL_EVENT_BACKEND_IO_URING) {
+            log_message(pool, 1, "io_uring backend unavailable, falling back to epoll");
+        }
+    }
+#else
+    if (pool->config.event_backend == POOL_EVENT_BACKEND_IO_URING) {
+        log_message(pool, 1, "io_uring backend not compiled in, falling back to epoll");
+    }
+#endif
+    
+    if (g_event_loop.backend == POOL_EVENT_BACKEND_EPOLL) {
+        // 创建epoll实例
+        g_event_loop.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (g_event_loop.epoll_fd == -1) {
+            log_message(pool, 0, "Failed to create epoll instance: %s", strerror(errno));
+            event_loop_cleanup();
+            return POOL_ERROR_SYSTEM_CALL;
+        }
         
-        event_loop_cleanup();
-        return POOL_ERROR_SYSTEM_CALL;
+        // 添加事件到epoll
+        if (add_epoll_event(g_event_loop.epoll_fd, g_event_loop.task_submit_eventfd,
+                           EPOLLIN | EPOLLET, EVENT_TYPE_TASK_SUBMIT, NULL) == -1 ||
+            add_epoll_event(g_event_loop.epoll_fd, g_event_loop.control_eventfd,
+                           EPOLLIN | EPOLLET, EVENT_TYPE_CONTROL, NULL) == -1 ||
+            add_epoll_event(g_event_loop.epoll_fd, g_event_loop.signal_fd,
+                           EPOLLIN, EVENT_TYPE_SIGNAL, NULL) == -1 ||
+            add_epoll_event(g_event_loop.epoll_fd, g_event_loop.timer_fd,
+                           EPOLLIN, EVENT_TYPE_TIMER, NULL) == -1) {
+            
+            event_loop_cleanup();
+            return POOL_ERROR_SYSTEM_CALL;
+        }
+    }
+    
+    // zygote的异步派生应答(io_uring后端在事件循环首轮等待前提交)
+    if (add_zygote_event(&g_event_loop) == -1) {
+        log_message(pool, 1, "Failed to watch zygote socket, workers restarted by the "
+                   "event loop will be forked directly");
+        zygote_close_async(pool);
     }
     
-    // 保存eventfd到pool中
-    pool->task_submit_eventfd = g_event_loop.task_submit_eventfd;
-    pool->control_eventfd = g_event_loop.control_eventfd;
+    g_event_loop.active_policy = ATOMIC_LOAD(&pool->sched_policy);
     
-    log_message(pool, 2, "Event loop initialized successfully");
+    // 初始化超时时间轮并设置第一次定期维护
+    uint64_t now = get_time_ns();
+    timer_wheel_init(&pool->timer_wheel, now);
+    g_event_loop.next_housekeeping_ns = now + EVENT_LOOP_HOUSEKEEPING_MS * 1000000ULL;
+    event_loop_rearm_timer(&g_event_loop);
+    
+    log_message(pool, 2, "Event loop initialized successfully (%s)",
+               event_backend_name(g_event_loop.backend));
     
     return POOL_SUCCESS;
 }
 
 pool_error_t event_loop_start(void) {
-    if (g_event_loop.epoll_fd == -1) {
+    if (!g_event_loop.pool) {
         return POOL_ERROR_INVALID_PARAM;
     }
     
@@ -534,7 +2370,7 @@ pool_error_t event_loop_stop(void) {
     log_message(g_event_loop.pool, 2, "Stopping event loop");
     
     // 发送停止命令
-    uint64_t command = 1;
+    uint64_t command = EVENT_LOOP_CMD_STOP;
     if (write(g_event_loop.control_eventfd, &command, sizeof(command)) == -1) {
         log_message(g_event_loop.pool, 1, "Failed to send stop command to event loop");
     }
@@ -557,6 +2393,10 @@ void event_loop_cleanup(void) {
         event_loop_stop();
     }
     
+#ifdef PROCESS_POOL_USE_IO_URING
+    uring_backend_cleanup(&g_event_loop);
+#endif
+    
     if (g_event_loop.epoll_fd >= 0) {
         close(g_event_loop.epoll_fd);
         g_event_loop.epoll_fd = -1;
@@ -582,6 +2422,11 @@ void event_loop_cleanup(void) {
         g_event_loop.timer_fd = -1;
     }
     
+    if (g_event_loop.pool) {
+        pthread_cond_destroy(&g_event_loop.resize_cond);
+        pthread_mutex_destroy(&g_event_loop.resize_mutex);
+    }
+    
     memset(&g_event_loop, 0, sizeof(g_event_loop));
 }
 
@@ -600,17 +2445,135 @@ pool_error_t event_loop_notify_task_submit(void) {
     return POOL_SUCCESS;
 }
 
+/**
+ * 把运行中任务的取消请求转交给事件循环线程，Worker在途链表只能由它访问
+ */
+pool_error_t event_loop_notify_task_cancel(task_internal_t* task) {
+    process_pool_t* pool = g_event_loop.pool;
+    
+    if (!task || !pool) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    task_ref(task);
+    
+    pthread_mutex_lock(&pool->task_mutex);
+    task->cancel_next = pool->cancel_requests;
+    pool->cancel_requests = task;
+    pthread_mutex_unlock(&pool->task_mutex);
+    
+    return event_loop_notify_task_submit();
+}
+
+/**
+ * 请事件循环线程把Worker调整到target_count个并等待完成
+ * 调用方持有pool_mutex，且事件循环正在运行
+ */
+pool_error_t event_loop_resize(uint32_t target_count) {
+    event_loop_t* loop = &g_event_loop;
+    
+    pthread_mutex_lock(&loop->resize_mutex);
+    
+    loop->resize_target = target_count;
+    loop->resize_done = false;
+    
+    uint64_t command = EVENT_LOOP_CMD_RESIZE;
+    if (write(loop->control_eventfd, &command, sizeof(command)) == -1) {
+        pthread_mutex_unlock(&loop->resize_mutex);
+        log_message(loop->pool, 0, "Failed to send resize command: %s", strerror(errno));
+        return POOL_ERROR_SYSTEM_CALL;
+    }
+    
+    while (!loop->resize_done) {
+        pthread_cond_wait(&loop->resize_cond, &loop->resize_mutex);
+    }
+    
+    pool_error_t err = loop->resize_result;
+    
+    pthread_mutex_unlock(&loop->resize_mutex);
+    
+    return err;
+}
+
+/**
+ * 在事件循环线程上提交任务：它是任务队列唯一的消费者，队列满时等不到空位，
+ * 因此挂入延迟链表，由调用方通知后在下一轮处理提交事件时暂存
+ * @return 不在事件循环线程上返回false，调用方应改为入队
+ */
+/**
+ * 缩容时退役Worker(事件循环线程调用)：收回其提交环中未开始的任务重新分发，
+ * 通知其退出后立即返回。事件注册保留到进程退出，期间照常回收结果；
+ * 进程退出后由pidfd事件、SIGCHLD或定期维护回收
+ */
+void event_loop_retire_worker(uint32_t worker_id) {
+    event_loop_t* loop = &g_event_loop;
+    worker_internal_t* worker = &loop->pool->workers[worker_id];
+    
+    // 还在等待zygote应答的Worker在启动完成后再退役
+    if (worker->spawn_deadline_ns > 0) {
+        worker->retire_deadline_ns = get_time_ns() + WORKER_RETIRE_TIMEOUT_MS * 1000000ULL;
+        return;
+    }
+    
+    task_internal_t* reclaimed[SHM_STEAL_SLOTS];
+    uint32_t count = worker_reclaim_unstarted(worker, reclaimed, SHM_STEAL_SLOTS);
+    requeue_reclaimed(loop, reclaimed, count);
+    
+    if (worker_request_stop(worker) != POOL_SUCCESS) {
+        return;
+    }
+    worker->retire_deadline_ns = get_time_ns() + WORKER_RETIRE_TIMEOUT_MS * 1000000ULL;
+    
+    log_message(loop->pool, 2, "Retiring worker %u, %u queued tasks requeued", worker_id, count);
+}
+
+/**
+ * 立即结束并回收槽位上尚未退出的退役Worker，扩容复用该槽位前调用
+ * @return 槽位上的Worker还在等待zygote应答时取消退役、继续使用，返回true
+ */
+bool event_loop_release_retired(uint32_t worker_id) {
+    event_loop_t* loop = &g_event_loop;
+    worker_internal_t* worker = &loop->pool->workers[worker_id];
+    
+    if (worker->retire_deadline_ns == 0) {
+        return false;
+    }
+    
+    if (worker->spawn_deadline_ns > 0) {
+        worker->retire_deadline_ns = 0;
+        return true;
+    }
+    
+    kill(worker->pid, SIGKILL);
+    finish_retired_worker(loop, worker_id);
+    return false;
+}
+
+bool event_loop_defer_task(task_internal_t* task) {
+    if (!g_in_event_loop) {
+        return false;
+    }
+    
+    task_lane_t* deferred = &g_event_loop.pool->deferred_tasks;
+    
+    task->next = NULL;
+    if (deferred->tail) {
+        deferred->tail->next = task;
+    } else {
+        deferred->head = task;
+    }
+    deferred->tail = task;
+    
+    return true;
+}
+
 pool_error_t event_loop_add_worker_events(uint32_t worker_id) {
     if (worker_id >= g_event_loop.pool->config.max_workers) {
         return POOL_ERROR_INVALID_PARAM;
     }
     
-    worker_internal_t* worker = &g_event_loop.pool->workers[worker_id];
-    
     // 添加任务完成事件
-    if (add_epoll_event(g_event_loop.epoll_fd, worker->result_eventfd,
-                       EPOLLIN | EPOLLET, EVENT_TYPE_TASK_COMPLETE,
-                       (void*)(intptr_t)worker_id) == -1) {
+    if (add_worker_event(&g_event_loop, worker_id) == -1) {
         return POOL_ERROR_SYSTEM_CALL;
     }
     
@@ -622,10 +2585,8 @@ pool_error_t event_loop_remove_worker_events(uint32_t worker_id) {
         return POOL_ERROR_INVALID_PARAM;
     }
     
-    worker_internal_t* worker = &g_event_loop.pool->workers[worker_id];
-    
     // 移除任务完成事件
-    remove_epoll_event(g_event_loop.epoll_fd, worker->result_eventfd);
+    remove_worker_event(&g_event_loop, worker_id);
     
     return POOL_SUCCESS;
 }
@@ -654,4 +2615,253 @@ void event_loop_get_stats(uint64_t* events_processed,
     if (timer_events) {
         *timer_events = ATOMIC_LOAD(&g_event_loop.timer_events);
     }
-}
\ No newline at end of file
+}
+pool_event_backend_t event_loop_backend(void) {
+    return g_event_loop.backend;
+}
+
+/**
+ * 事件循环线程累计消耗的CPU时间，与events_processed相除得到每事件CPU开销
+ */
+uint64_t event_loop_cpu_time_ns(void) {
+    clockid_t clock_id;
+    struct timespec ts;
+    
+    if (!g_event_loop.running || !g_event_loop.thread ||
+        pthread_getcpuclockid(g_event_loop.thread, &clock_id) != 0 ||
+        clock_gettime(clock_id, &ts) != 0) {
+        return 0;
+    }
+    
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ============================================================================
+// 事件循环后端性能测试
+// ============================================================================
+
+typedef struct {
+    int* fds;
+    uint32_t num_fds;
+    size_t num_events;
+} loop_bench_producer_t;
+
+// 消费者：等待并读取fds，直到读到的计数值之和达到total，返回交付次数(一次读取计一个事件)
+typedef uint64_t (*loop_bench_consume_fn)(int* fds, uint32_t num_fds, uint64_t total);
+
+static void* loop_bench_producer(void* arg) {
+    loop_bench_producer_t* producer = (loop_bench_producer_t*)arg;
+    uint64_t value = 1;
+    
+    for (size_t i = 0; i < producer->num_events; i++) {
+        if (write(producer->fds[i % producer->num_fds], &value, sizeof(value)) != sizeof(value)) {
+            break;
+        }
+    }
+    
+    return NULL;
+}
+
+static uint64_t loop_bench_thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t loop_bench_epoll(int* fds, uint32_t num_fds, uint64_t total) {
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    uint64_t received = 0;
+    uint64_t deliveries = 0;
+    
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1) {
+        return 0;
+    }
+    
+    for (uint32_t i = 0; i < num_fds; i++) {
+        struct epoll_event ev = { .events = EPOLLIN | EPOLLET, .data.u32 = i };
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fds[i], &ev) == -1) {
+            close(epoll_fd);
+            return 0;
+        }
+    }
+    
+    while (received < total) {
+        int nfds = epoll_wait(epoll_fd, events, EPOLL_MAX_EVENTS, 1000);
+        if (nfds == -1 && errno != EINTR) {
+            break;
+        }
+        
+        for (int i = 0; i < nfds; i++) {
+            uint64_t value;
+            if (read(fds[events[i].data.u32], &value, sizeof(value)) == sizeof(value)) {
+                received += value;
+                deliveries++;
+            }
+        }
+    }
+    
+    close(epoll_fd);
+    return received >= total ? deliveries : 0;
+}
+
+#ifdef PROCESS_POOL_USE_IO_URING
+
+static uint64_t loop_bench_uring(int* fds, uint32_t num_fds, uint64_t total) {
+    struct io_uring ring;
+    struct io_uring_cqe* cqe;
+    struct __kernel_timespec timeout = { .tv_sec = 1, .tv_nsec = 0 };
+    uint64_t bufs[URING_BUF_COUNT];
+    uint64_t received = 0;
+    uint64_t deliveries = 0;
+    int ret;
+    
+    if (io_uring_queue_init(URING_SQ_ENTRIES, &ring, 0) < 0) {
+        return 0;
+    }
+    
+    struct io_uring_buf_ring* buf_ring = io_uring_setup_buf_ring(&ring, URING_BUF_COUNT,
+                                                                 URING_BUF_GROUP, 0, &ret);
+    if (!buf_ring) {
+        io_uring_queue_exit(&ring);
+        return 0;
+    }
+    
+    for (uint32_t i = 0; i < URING_BUF_COUNT; i++) {
+        io_uring_buf_ring_add(buf_ring, &bufs[i], sizeof(uint64_t), i,
+                              io_uring_buf_ring_mask(URING_BUF_COUNT), i);
+    }
+    io_uring_buf_ring_advance(buf_ring, URING_BUF_COUNT);
+    
+    for (uint32_t i = 0; i < num_fds; i++) {
+        struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        if (!sqe) {
+            io_uring_submit(&ring);
+            sqe = io_uring_get_sqe(&ring);
+        }
+        io_uring_prep_read_multishot(sqe, fds[i], sizeof(uint64_t), 0, URING_BUF_GROUP);
+        io_uring_sqe_set_data64(sqe, i);
+    }
+    
+    while (received < total) {
+        if (io_uring_sq_ready(&ring) > 0) {
+            io_uring_submit(&ring);
+        }
+        
+        ret = io_uring_wait_cqe_timeout(&ring, &cqe, &timeout);
+        if (ret < 0 && ret != -ETIME && ret != -EINTR) {
+            break;
+        }
+        
+        unsigned head;
+        unsigned seen = 0;
+        uint32_t returned = 0;
+        
+        io_uring_for_each_cqe(&ring, head, cqe) {
+            uint32_t index = (uint32_t)io_uring_cqe_get_data64(cqe);
+            
+            if (cqe->flags & IORING_CQE_F_BUFFER) {
+                uint32_t bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+                received += bufs[bid];
+                deliveries++;
+                io_uring_buf_ring_add(buf_ring, &bufs[bid], sizeof(uint64_t), bid,
+                                      io_uring_buf_ring_mask(URING_BUF_COUNT), returned++);
+            }
+            
+            if (!(cqe->flags & IORING_CQE_F_MORE) && (cqe->res >= 0 || cqe->res == -ENOBUFS)) {
+                struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+                if (sqe) {
+                    io_uring_prep_read_multishot(sqe, fds[index], sizeof(uint64_t), 0,
+                                                 URING_BUF_GROUP);
+                    io_uring_sqe_set_data64(sqe, index);
+                }
+            }
+            seen++;
+        }
+        io_uring_cq_advance(&ring, seen);
+        io_uring_buf_ring_advance(buf_ring, returned);
+    }
+    
+    io_uring_free_buf_ring(&ring, buf_ring, URING_BUF_COUNT, URING_BUF_GROUP);
+    io_uring_queue_exit(&ring);
+    return received >= total ? deliveries : 0;
+}
+
+#endif // PROCESS_POOL_USE_IO_URING
+
+static int loop_bench_run(const char* name, loop_bench_consume_fn consume,
+                          size_t num_events, uint32_t num_fds) {
+    int fds[MAX_WORKERS];
+    pthread_t thread;
+    uint32_t created = 0;
+    int result = -1;
+    
+    for (; created < num_fds; created++) {
+        fds[created] = create_eventfd();
+        if (fds[created] == -1) {
+            goto out;
+        }
+    }
+    
+    loop_bench_producer_t producer = { fds, num_fds, num_events };
+    
+    uint64_t start_time = get_time_ns();
+    uint64_t start_cpu = loop_bench_thread_cpu_ns();
+    
+    if (pthread_create(&thread, NULL, loop_bench_producer, &producer) != 0) {
+        goto out;
+    }
+    
+    uint64_t deliveries = consume(fds, num_fds, num_events);
+    
+    uint64_t cpu_ns = loop_bench_thread_cpu_ns() - start_cpu;
+    uint64_t elapsed_ns = get_time_ns() - start_time;
+    
+    pthread_join(thread, NULL);
+    
+    if (deliveries == 0) {
+        printf("%-9s unavailable\n", name);
+        goto out;
+    }
+    
+    printf("%-9s events: %lu, events/sec: %.2f, writes/sec: %.2f, CPU/event: %.1f ns\n",
+           name, deliveries,
+           (double)deliveries * 1000000000.0 / elapsed_ns,
+           (double)num_events * 1000000000.0 / elapsed_ns,
+           (double)cpu_ns / deliveries);
+    result = 0;
+    
+out:
+    for (uint32_t i = 0; i < created; i++) {
+        close(fds[i]);
+    }
+    return result;
+}
+
+/**
+ * 比较两种后端的事件交付：生产者线程轮流向num_fds个eventfd写入num_events次，
+ * 当前线程作为事件循环读取。events为实际交付的读取次数(写入会在eventfd中合并)，
+ * CPU/event为事件循环线程的CPU时间除以交付次数
+ */
+int event_loop_benchmark(size_t num_events, uint32_t num_fds) {
+    if (num_events == 0 || num_fds == 0 || num_fds > MAX_WORKERS) {
+        return -1;
+    }
+    
+    printf("=== Event Loop Backend Benchmark ===\n");
+    printf("Writes: %zu, fds: %u\n", num_events, num_fds);
+    
+    int result = loop_bench_run("epoll", loop_bench_epoll, num_events, num_fds);
+    
+#ifdef PROCESS_POOL_USE_IO_URING
+    if (loop_bench_run("io_uring", loop_bench_uring, num_events, num_fds) != 0) {
+        result = -1;
+    }
+#else
+    printf("%-9s not compiled in\n", "io_uring");
+#endif
+    
+    printf("====================================\n");
+    
+    return result;
+}
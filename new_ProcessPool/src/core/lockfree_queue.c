@@ -1,7 +1,9 @@
+#define _GNU_SOURCE
 #include "../../include/internal.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <sched.h>
 
 // ============================================================================
 // 无锁环形队列实现
@@ -9,11 +11,15 @@
 
 /**
  * 基于原子操作的无锁环形队列
- * 使用单生产者单消费者(SPSC)模型，适合Master-Worker架构
- * 采用内存屏障确保在多核系统上的正确性
+ * SPSC模式：单生产者单消费者，head/tail只由各自一方写入，acquire/release即可
+ * MPMC模式：有界多生产者多消费者队列，每个槽位带序号。槽位序号等于pos时
+ * 可写入，等于pos+1时可读取，读取后置为pos+capacity供下一轮写入。
+ * 生产者和消费者分别通过CAS竞争tail/head，适合多个提交线程并发提交
+ *
+ * head/tail均为自由递增的32位计数，通过掩码映射到槽位，差值即为元素数量
  */
 
-lockfree_queue_t* queue_create(uint32_t capacity) {
+lockfree_queue_t* queue_create(uint32_t capacity, queue_mode_t mode) {
     // 容量必须是2的幂，便于使用位运算优化
     if (capacity == 0 || !is_power_of_2(capacity)) {
         capacity = next_power_of_2(capacity);
@@ -23,16 +29,35 @@ lockfree_queue_t* queue_create(uint32_t capacity) {
         return NULL;
     }
     
-    lockfree_queue_t* queue = aligned_alloc(64, sizeof(lockfree_queue_t));
+    lockfree_queue_t* queue = aligned_alloc(CACHE_LINE_SIZE, sizeof(lockfree_queue_t));
     if (!queue) {
         return NULL;
     }
-    
-    // 分配任务指针数组，使用缓存行对齐
-    queue->tasks = aligned_alloc(64, capacity * sizeof(task_internal_t*));
-    if (!queue->tasks) {
-        free(queue);
-        return NULL;
+    memset(queue, 0, sizeof(lockfree_queue_t));
+    
+    if (mode == QUEUE_MODE_MPMC) {
+        // 分配槽位数组，使用缓存行对齐
+        queue->cells = aligned_alloc(CACHE_LINE_SIZE, capacity * sizeof(queue_cell_t));
+        if (!queue->cells) {
+            free(queue);
+            return NULL;
+        }
+        
+        // 初始序号等于槽位下标，表示第一轮可写
+        for (uint32_t i = 0; i < capacity; i++) {
+            ATOMIC_STORE_RELAXED(&queue->cells[i].sequence, i);
+            queue->cells[i].task = NULL;
+        }
+    } else {
+        // 分配任务指针数组，使用缓存行对齐
+        queue->tasks = aligned_alloc(CACHE_LINE_SIZE, capacity * sizeof(task_internal_t*));
+        if (!queue->tasks) {
+            free(queue);
+            return NULL;
+        }
+        
+        // 清零任务指针数组
+        memset(queue->tasks, 0, capacity * sizeof(task_internal_t*));
     }
     
     // 初始化队列元数据
@@ -40,9 +65,7 @@ lockfree_queue_t* queue_create(uint32_t capacity) {
     ATOMIC_STORE(&queue->tail, 0);
     queue->capacity = capacity;
     queue->mask = capacity - 1;
-    
-    // 清零任务指针数组
-    memset(queue->tasks, 0, capacity * sizeof(task_internal_t*));
+    queue->mode = mode;
     
     return queue;
 }
@@ -57,31 +80,182 @@ void queue_destroy(lockfree_queue_t* queue) {
     }
     
     free(queue->tasks);
+    free(queue->cells);
     free(queue);
 }
 
+// ============================================================================
+// MPMC模式
+// ============================================================================
+
+static bool queue_mpmc_enqueue(lockfree_queue_t* queue, task_internal_t* task) {
+    uint32_t pos = ATOMIC_LOAD_RELAXED(&queue->tail);
+    
+    for (;;) {
+        queue_cell_t* cell = &queue->cells[pos & queue->mask];
+        uint32_t seq = ATOMIC_LOAD_ACQUIRE(&cell->sequence);
+        int32_t diff = (int32_t)(seq - pos);
+        
+        if (diff == 0) {
+            // 槽位可写，竞争tail
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                cell->task = task;
+                ATOMIC_STORE_RELEASE(&cell->sequence, pos + 1);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // 队列已满(槽位尚未被上一轮消费)
+        } else {
+            pos = ATOMIC_LOAD_RELAXED(&queue->tail); // 被其他生产者抢先
+        }
+    }
+}
+
+static task_internal_t* queue_mpmc_dequeue(lockfree_queue_t* queue) {
+    uint32_t pos = ATOMIC_LOAD_RELAXED(&queue->head);
+    
+    for (;;) {
+        queue_cell_t* cell = &queue->cells[pos & queue->mask];
+        uint32_t seq = ATOMIC_LOAD_ACQUIRE(&cell->sequence);
+        int32_t diff = (int32_t)(seq - (pos + 1));
+        
+        if (diff == 0) {
+            // 槽位可读，竞争head
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                task_internal_t* task = cell->task;
+                cell->task = NULL;
+                ATOMIC_STORE_RELEASE(&cell->sequence, pos + queue->capacity);
+                return task;
+            }
+        } else if (diff < 0) {
+            return NULL; // 队列为空(槽位尚未写入)
+        } else {
+            pos = ATOMIC_LOAD_RELAXED(&queue->head); // 被其他消费者抢先
+        }
+    }
+}
+
+/**
+ * MPMC批量入队
+ * 从tail开始统计连续可写的槽位，一次CAS占用整段。tail之后的槽位只会
+ * 因消费而变为可写，不会被其他生产者在不移动tail的情况下占用，因此
+ * CAS成功即说明整段都归本线程所有
+ */
+static uint32_t queue_mpmc_enqueue_batch(lockfree_queue_t* queue,
+                                         task_internal_t** tasks, uint32_t count) {
+    uint32_t pos = ATOMIC_LOAD_RELAXED(&queue->tail);
+    uint32_t n;
+    
+    for (;;) {
+        n = 0;
+        while (n < count) {
+            queue_cell_t* cell = &queue->cells[(pos + n) & queue->mask];
+            if (ATOMIC_LOAD_ACQUIRE(&cell->sequence) != pos + n) {
+                break;
+            }
+            n++;
+        }
+        
+        if (n == 0) {
+            // 首个槽位不可写：要么队列已满，要么tail已被推进
+            uint32_t tail = ATOMIC_LOAD_RELAXED(&queue->tail);
+            if (tail == pos) {
+                return 0;
+            }
+            pos = tail;
+            continue;
+        }
+        
+        if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + n,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            break;
+        }
+    }
+    
+    for (uint32_t i = 0; i < n; i++) {
+        queue_cell_t* cell = &queue->cells[(pos + i) & queue->mask];
+        cell->task = tasks[i];
+        ATOMIC_STORE_RELEASE(&cell->sequence, pos + i + 1);
+    }
+    
+    return n;
+}
+
+/**
+ * MPMC批量出队，占用方式与批量入队对称
+ */
+static uint32_t queue_mpmc_dequeue_batch(lockfree_queue_t* queue,
+                                         task_internal_t** tasks, uint32_t max_count) {
+    uint32_t pos = ATOMIC_LOAD_RELAXED(&queue->head);
+    uint32_t n;
+    
+    for (;;) {
+        n = 0;
+        while (n < max_count) {
+            queue_cell_t* cell = &queue->cells[(pos + n) & queue->mask];
+            if (ATOMIC_LOAD_ACQUIRE(&cell->sequence) != pos + n + 1) {
+                break;
+            }
+            n++;
+        }
+        
+        if (n == 0) {
+            uint32_t head = ATOMIC_LOAD_RELAXED(&queue->head);
+            if (head == pos) {
+                return 0;
+            }
+            pos = head;
+            continue;
+        }
+        
+        if (atomic_compare_exchange_weak_explicit(&queue->head, &pos, pos + n,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            break;
+        }
+    }
+    
+    for (uint32_t i = 0; i < n; i++) {
+        queue_cell_t* cell = &queue->cells[(pos + i) & queue->mask];
+        tasks[i] = cell->task;
+        cell->task = NULL;
+        ATOMIC_STORE_RELEASE(&cell->sequence, pos + i + queue->capacity);
+    }
+    
+    return n;
+}
+
+// ============================================================================
+// 队列操作接口
+// ============================================================================
+
 bool queue_enqueue(lockfree_queue_t* queue, task_internal_t* task) {
     if (!queue || !task) {
         return false;
     }
     
-    uint32_t head = ATOMIC_LOAD(&queue->head);
-    uint32_t tail = ATOMIC_LOAD(&queue->tail);
+    if (queue->mode == QUEUE_MODE_MPMC) {
+        return queue_mpmc_enqueue(queue, task);
+    }
+    
+    uint32_t head = ATOMIC_LOAD_ACQUIRE(&queue->head);
+    uint32_t tail = ATOMIC_LOAD_RELAXED(&queue->tail);
     
     // 检查队列是否已满
-    // 保留一个空位来区分满和空的状态
-    if (((tail + 1) & queue->mask) == (head & queue->mask)) {
+    if (tail - head >= queue->capacity) {
         return false; // 队列已满
     }
     
     // 写入任务指针
     queue->tasks[tail & queue->mask] = task;
     
-    // 内存屏障确保写入完成后再更新tail
-    MEMORY_BARRIER();
-    
-    // 更新tail指针
-    ATOMIC_STORE(&queue->tail, tail + 1);
+    // release语义确保写入完成后再发布tail
+    ATOMIC_STORE_RELEASE(&queue->tail, tail + 1);
     
     return true;
 }
@@ -91,11 +265,15 @@ task_internal_t* queue_dequeue(lockfree_queue_t* queue) {
         return NULL;
     }
     
-    uint32_t head = ATOMIC_LOAD(&queue->head);
-    uint32_t tail = ATOMIC_LOAD(&queue->tail);
+    if (queue->mode == QUEUE_MODE_MPMC) {
+        return queue_mpmc_dequeue(queue);
+    }
+    
+    uint32_t head = ATOMIC_LOAD_RELAXED(&queue->head);
+    uint32_t tail = ATOMIC_LOAD_ACQUIRE(&queue->tail);
     
     // 检查队列是否为空
-    if ((head & queue->mask) == (tail & queue->mask)) {
+    if (head == tail) {
         return NULL; // 队列为空
     }
     
@@ -105,47 +283,35 @@ task_internal_t* queue_dequeue(lockfree_queue_t* queue) {
     // 清零指针位置
     queue->tasks[head & queue->mask] = NULL;
     
-    // 内存屏障确保读取完成后再更新head
-    MEMORY_BARRIER();
-    
-    // 更新head指针
-    ATOMIC_STORE(&queue->head, head + 1);
+    // release语义确保读取完成后再归还槽位
+    ATOMIC_STORE_RELEASE(&queue->head, head + 1);
     
     return task;
 }
 
-bool queue_is_empty(lockfree_queue_t* queue) {
+uint32_t queue_size(lockfree_queue_t* queue) {
     if (!queue) {
-        return true;
+        return 0;
     }
     
-    uint32_t head = ATOMIC_LOAD(&queue->head);
-    uint32_t tail = ATOMIC_LOAD(&queue->tail);
+    // 先读head再读tail，并发修改下结果只会偏大，再按容量截断
+    uint32_t head = ATOMIC_LOAD_ACQUIRE(&queue->head);
+    uint32_t tail = ATOMIC_LOAD_ACQUIRE(&queue->tail);
+    uint32_t size = tail - head;
     
-    return (head & queue->mask) == (tail & queue->mask);
+    return (size > queue->capacity) ? queue->capacity : size;
 }
 
-bool queue_is_full(lockfree_queue_t* queue) {
-    if (!queue) {
-        return true;
-    }
-    
-    uint32_t head = ATOMIC_LOAD(&queue->head);
-    uint32_t tail = ATOMIC_LOAD(&queue->tail);
-    
-    return ((tail + 1) & queue->mask) == (head & queue->mask);
+bool queue_is_empty(lockfree_queue_t* queue) {
+    return queue_size(queue) == 0;
 }
 
-uint32_t queue_size(lockfree_queue_t* queue) {
+bool queue_is_full(lockfree_queue_t* queue) {
     if (!queue) {
-        return 0;
+        return true;
     }
     
-    uint32_t head = ATOMIC_LOAD(&queue->head);
-    uint32_t tail = ATOMIC_LOAD(&queue->tail);
-    
-    // 计算当前队列中的元素数量
-    return (tail - head) & queue->mask;
+    return queue_size(queue) >= queue->capacity;
 }
 
 // ============================================================================
@@ -164,11 +330,17 @@ bool queue_enqueue_batch(lockfree_queue_t* queue,
         return false;
     }
     
-    uint32_t head = ATOMIC_LOAD(&queue->head);
-    uint32_t tail = ATOMIC_LOAD(&queue->tail);
+    if (queue->mode == QUEUE_MODE_MPMC) {
+        uint32_t n = queue_mpmc_enqueue_batch(queue, tasks, count);
+        if (enqueued) *enqueued = n;
+        return n > 0;
+    }
+    
+    uint32_t head = ATOMIC_LOAD_ACQUIRE(&queue->head);
+    uint32_t tail = ATOMIC_LOAD_RELAXED(&queue->tail);
     
     // 计算可用空间
-    uint32_t available = queue->capacity - ((tail - head) & queue->mask) - 1;
+    uint32_t available = queue->capacity - (tail - head);
     uint32_t to_enqueue = (count < available) ? count : available;
     
     if (to_enqueue == 0) {
@@ -181,11 +353,8 @@ bool queue_enqueue_batch(lockfree_queue_t* queue,
         queue->tasks[(tail + i) & queue->mask] = tasks[i];
     }
     
-    // 内存屏障
-    MEMORY_BARRIER();
-    
-    // 更新tail指针
-    ATOMIC_STORE(&queue->tail, tail + to_enqueue);
+    // 一次发布整批
+    ATOMIC_STORE_RELEASE(&queue->tail, tail + to_enqueue);
     
     if (enqueued) *enqueued = to_enqueue;
     return true;
@@ -201,11 +370,15 @@ uint32_t queue_dequeue_batch(lockfree_queue_t* queue,
         return 0;
     }
     
-    uint32_t head = ATOMIC_LOAD(&queue->head);
-    uint32_t tail = ATOMIC_LOAD(&queue->tail);
+    if (queue->mode == QUEUE_MODE_MPMC) {
+        return queue_mpmc_dequeue_batch(queue, tasks, max_count);
+    }
+    
+    uint32_t head = ATOMIC_LOAD_RELAXED(&queue->head);
+    uint32_t tail = ATOMIC_LOAD_ACQUIRE(&queue->tail);
     
     // 计算可读取的元素数量
-    uint32_t available = (tail - head) & queue->mask;
+    uint32_t available = tail - head;
     uint32_t to_dequeue = (max_count < available) ? max_count : available;
     
     if (to_dequeue == 0) {
@@ -219,11 +392,8 @@ uint32_t queue_dequeue_batch(lockfree_queue_t* queue,
         queue->tasks[index] = NULL;
     }
     
-    // 内存屏障
-    MEMORY_BARRIER();
-    
-    // 更新head指针
-    ATOMIC_STORE(&queue->head, head + to_dequeue);
+    // 一次归还整批槽位
+    ATOMIC_STORE_RELEASE(&queue->head, head + to_dequeue);
     
     return to_dequeue;
 }
@@ -252,15 +422,15 @@ void queue_get_stats(lockfree_queue_t* queue, queue_stats_t* stats) {
     
     uint32_t head = ATOMIC_LOAD(&queue->head);
     uint32_t tail = ATOMIC_LOAD(&queue->tail);
-    uint32_t size = (tail - head) & queue->mask;
+    uint32_t size = queue_size(queue);
     
     stats->capacity = queue->capacity;
     stats->size = size;
     stats->head_pos = head & queue->mask;
     stats->tail_pos = tail & queue->mask;
-    stats->utilization = (double)size / (queue->capacity - 1);
+    stats->utilization = (double)size / queue->capacity;
     stats->is_empty = (size == 0);
-    stats->is_full = (size == queue->capacity - 1);
+    stats->is_full = (size == queue->capacity);
 }
 
 /**
@@ -361,4 +531,115 @@ void queue_benchmark(lockfree_queue_t* queue,
     if (perf->dequeue_time_ns > 0) {
         perf->dequeue_throughput = (double)perf->dequeue_ops * 1000000000.0 / perf->dequeue_time_ns;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * 多生产者性能测试
+ * 提交线程数从1倍增到64，单个消费者线程模拟事件循环出队。
+ * 对比MPMC模式与"SPSC队列+互斥锁串行化生产者"两种方案的吞吐量
+ */
+#define QUEUE_BENCH_MAX_PRODUCERS 64
+
+typedef struct {
+    lockfree_queue_t* queue;        // 被测队列
+    pthread_mutex_t* producer_lock; // 生产者互斥锁(NULL表示MPMC)
+    uint32_t ops;                   // 每个生产者的入队次数
+    task_internal_t* task;          // 入队的测试任务
+} queue_bench_producer_t;
+
+static void* queue_bench_producer(void* arg) {
+    queue_bench_producer_t* ctx = (queue_bench_producer_t*)arg;
+    
+    for (uint32_t i = 0; i < ctx->ops; i++) {
+        for (;;) {
+            bool ok;
+            if (ctx->producer_lock) {
+                pthread_mutex_lock(ctx->producer_lock);
+                ok = queue_enqueue(ctx->queue, ctx->task);
+                pthread_mutex_unlock(ctx->producer_lock);
+            } else {
+                ok = queue_enqueue(ctx->queue, ctx->task);
+            }
+            if (ok) {
+                break;
+            }
+            sched_yield(); // 队列满，让出CPU给消费者
+        }
+    }
+    
+    return NULL;
+}
+
+static double queue_bench_run(queue_mode_t mode, uint32_t producers,
+                              uint32_t ops_per_producer) {
+    lockfree_queue_t* queue = queue_create(4096, mode);
+    if (!queue) {
+        return 0.0;
+    }
+    
+    pthread_mutex_t producer_lock = PTHREAD_MUTEX_INITIALIZER;
+    task_internal_t test_task;
+    memset(&test_task, 0, sizeof(test_task));
+    test_task.task_id = 1;
+    
+    queue_bench_producer_t ctx = {
+        .queue = queue,
+        .producer_lock = (mode == QUEUE_MODE_SPSC) ? &producer_lock : NULL,
+        .ops = ops_per_producer,
+        .task = &test_task
+    };
+    
+    pthread_t threads[QUEUE_BENCH_MAX_PRODUCERS];
+    uint32_t started = 0;
+    uint64_t start_time = get_time_ns();
+    
+    for (uint32_t i = 0; i < producers; i++) {
+        if (pthread_create(&threads[i], NULL, queue_bench_producer, &ctx) != 0) {
+            break;
+        }
+        started++;
+    }
+    
+    // 当前线程作为唯一消费者，批量出队
+    task_internal_t* batch[64];
+    uint64_t total = (uint64_t)started * ops_per_producer;
+    uint64_t consumed = 0;
+    while (consumed < total) {
+        uint32_t n = queue_dequeue_batch(queue, batch, 64);
+        if (n == 0) {
+            sched_yield();
+        }
+        consumed += n;
+    }
+    
+    for (uint32_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    
+    uint64_t elapsed = get_time_ns() - start_time;
+    
+    pthread_mutex_destroy(&producer_lock);
+    free(queue->tasks);
+    free(queue->cells);
+    free(queue);
+    
+    return elapsed > 0 ? (double)total * 1000000000.0 / elapsed : 0.0;
+}
+
+void queue_producer_benchmark(uint32_t ops_per_producer) {
+    if (ops_per_producer == 0) {
+        return;
+    }
+    
+    printf("=== Queue Multi-Producer Benchmark ===\n");
+    printf("Ops per producer: %u\n", ops_per_producer);
+    printf("%-10s %20s %20s\n", "Producers", "MPMC (ops/sec)", "Mutex+SPSC (ops/sec)");
+    
+    for (uint32_t producers = 1; producers <= QUEUE_BENCH_MAX_PRODUCERS; producers *= 2) {
+        double mpmc = queue_bench_run(QUEUE_MODE_MPMC, producers, ops_per_producer);
+        double locked = queue_bench_run(QUEUE_MODE_SPSC, producers, ops_per_producer);
+        printf("%-10u %20.2f %20.2f\n", producers, mpmc, locked);
+    }
+    
+    printf("======================================\n");
+}
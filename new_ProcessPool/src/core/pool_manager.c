@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include "../../include/process_pool.h"
 #include "../../include/internal.h"
 #include <stdlib.h>
@@ -7,20 +8,14 @@
 #include <sys/wait.h>
 #include <errno.h>
 #include <assert.h>
+#include <sched.h>
+
+// 批量提交时每块任务数(每块发布一次队列tail)
+#define SUBMIT_BATCH_CHUNK 256
 
 // 全局变量
-static atomic_uint g_next_pool_id = 1;
 static int g_log_level = 2; // INFO级别
 
-// 进程池状态枚举
-enum pool_state {
-    POOL_STATE_CREATED = 0,
-    POOL_STATE_STARTING = 1,
-    POOL_STATE_RUNNING = 2,
-    POOL_STATE_STOPPING = 3,
-    POOL_STATE_STOPPED = 4
-};
-
 // ============================================================================
 // 内部辅助函数
 // ============================================================================
@@ -30,13 +25,29 @@ static void init_default_config(pool_config_t* config) {
     config->min_workers = 2;
     config->max_workers = 8;
     config->queue_size = DEFAULT_QUEUE_SIZE;
+    config->shm_ring_size = DEFAULT_SHM_RING_SIZE;
+    config->shm_huge_pages = POOL_HUGE_PAGES_OFF;
+    config->shm_seal = true;
+    config->worker_queue_depth = DEFAULT_WORKER_QUEUE_DEPTH;
+    config->priority_aging_ms = DEFAULT_PRIORITY_AGING_MS;
+    config->sched_policy = POOL_SCHED_PRIORITY;
+    config->cancel_signal_ms = DEFAULT_CANCEL_SIGNAL_MS;
+    config->cancel_kill_ms = DEFAULT_CANCEL_KILL_MS;
+    config->worker_spin_us = DEFAULT_WORKER_SPIN_US;
+    config->event_backend = POOL_EVENT_BACKEND_AUTO;
+    config->affinity_policy = POOL_AFFINITY_NONE;
+    config->affinity_cpu_list = NULL;
     config->worker_idle_timeout = 300; // 5分钟
+    config->scale_wait_p95_ms = DEFAULT_SCALE_WAIT_P95_MS;
     config->task_timeout = 30; // 30秒
     config->enable_auto_scaling = true;
+    config->enable_work_stealing = true;
+    config->enable_zygote = true;
     config->enable_metrics = true;
     config->enable_tracing = false;
     config->pool_name = "default_pool";
     config->default_handler = NULL;
+    config->worker_init = NULL;
     config->user_context = NULL;
 }
 
@@ -58,6 +69,44 @@ static bool validate_config(const pool_config_t* config) {
         return false;
     }
     
+    if (config->worker_queue_depth > SHM_STEAL_SLOTS) {
+        log_message(NULL, 0, "Invalid worker_queue_depth: %u (max %u)",
+                    config->worker_queue_depth, SHM_STEAL_SLOTS);
+        return false;
+    }
+    
+    if ((uint32_t)config->sched_policy >= POOL_SCHED_POLICY_COUNT) {
+        log_message(NULL, 0, "Invalid sched_policy: %d", config->sched_policy);
+        return false;
+    }
+    
+    if ((uint32_t)config->event_backend > POOL_EVENT_BACKEND_IO_URING) {
+        log_message(NULL, 0, "Invalid event_backend: %d", config->event_backend);
+        return false;
+    }
+    
+    if ((uint32_t)config->shm_huge_pages > POOL_HUGE_PAGES_THP) {
+        log_message(NULL, 0, "Invalid shm_huge_pages: %d", config->shm_huge_pages);
+        return false;
+    }
+    
+    if ((uint32_t)config->affinity_policy > POOL_AFFINITY_CPU_LIST) {
+        log_message(NULL, 0, "Invalid affinity_policy: %d", config->affinity_policy);
+        return false;
+    }
+    
+    if (config->affinity_policy == POOL_AFFINITY_CPU_LIST && !config->affinity_cpu_list) {
+        log_message(NULL, 0, "affinity_cpu_list is required for POOL_AFFINITY_CPU_LIST");
+        return false;
+    }
+    
+    if (config->shm_ring_size != 0 &&
+        (config->shm_ring_size < SHM_RING_MIN_SIZE || config->shm_ring_size > SHM_RING_MAX_SIZE)) {
+        log_message(NULL, 0, "Invalid shm_ring_size: %zu (min %zu, max %zu)",
+                    config->shm_ring_size, (size_t)SHM_RING_MIN_SIZE, (size_t)SHM_RING_MAX_SIZE);
+        return false;
+    }
+    
     return true;
 }
 
@@ -94,7 +143,7 @@ static pool_error_t init_pool_resources(process_pool_t* pool) {
     }
     
     // 创建任务队列
-    pool->task_queue = queue_create(pool->config.queue_size);
+    pool->task_queue = queue_create(pool->config.queue_size, QUEUE_MODE_MPMC);
     if (!pool->task_queue) {
         pthread_cond_destroy(&pool->shutdown_cond);
         pthread_mutex_destroy(&pool->stats_mutex);
@@ -116,8 +165,8 @@ static pool_error_t init_pool_resources(process_pool_t* pool) {
         return POOL_ERROR_NO_MEMORY;
     }
     
-    // 初始化内存池
-    pool_error_t err = memory_pool_init(pool, 1024 * 1024); // 1MB
+    // 初始化事件循环
+    pool_error_t err = event_loop_init(pool);
     if (err != POOL_SUCCESS) {
         free(pool->workers);
         queue_destroy(pool->task_queue);
@@ -129,18 +178,26 @@ static pool_error_t init_pool_resources(process_pool_t* pool) {
         return err;
     }
     
-    // 初始化事件循环
-    err = event_loop_init(pool);
-    if (err != POOL_SUCCESS) {
-        memory_pool_cleanup(pool);
-        free(pool->workers);
-        queue_destroy(pool->task_queue);
-        pthread_cond_destroy(&pool->shutdown_cond);
-        pthread_mutex_destroy(&pool->stats_mutex);
-        pthread_mutex_destroy(&pool->task_mutex);
-        pthread_mutex_destroy(&pool->queue_mutex);
-        pthread_mutex_destroy(&pool->pool_mutex);
-        return err;
+    // 创建结果缓存
+    if (pool->config.result_cache_bytes > 0 || pool->config.enable_single_flight) {
+        // 在途任务表按同时在途的任务数上限分配
+        uint32_t depth = pool->config.worker_queue_depth ?
+                         pool->config.worker_queue_depth : DEFAULT_WORKER_QUEUE_DEPTH;
+        uint32_t max_inflight = pool->config.queue_size + pool->config.max_workers * depth;
+        pool->result_cache = result_cache_create(pool->config.result_cache_bytes,
+                                                 pool->config.enable_single_flight,
+                                                 max_inflight);
+        if (!pool->result_cache) {
+            event_loop_cleanup();
+            free(pool->workers);
+            queue_destroy(pool->task_queue);
+            pthread_cond_destroy(&pool->shutdown_cond);
+            pthread_mutex_destroy(&pool->stats_mutex);
+            pthread_mutex_destroy(&pool->task_mutex);
+            pthread_mutex_destroy(&pool->queue_mutex);
+            pthread_mutex_destroy(&pool->pool_mutex);
+            return POOL_ERROR_NO_MEMORY;
+        }
     }
     
     return POOL_SUCCESS;
@@ -150,10 +207,17 @@ static void cleanup_pool_resources(process_pool_t* pool) {
     if (!pool) return;
     
     // 清理事件循环
-    event_loop_cleanup(pool);
+    event_loop_cleanup();
+    
+    // 事件循环已停止，不会再写入结果缓存
+    result_cache_destroy(pool->result_cache);
+    pool->result_cache = NULL;
     
-    // 清理内存池
-    memory_pool_cleanup(pool);
+    // 停止zygote
+    zygote_stop(pool);
+    
+    // 所有Worker已销毁，释放共享内存arena
+    shm_arena_destroy(&pool->shm_arena);
     
     // 释放Worker数组
     if (pool->workers) {
@@ -167,6 +231,12 @@ static void cleanup_pool_resources(process_pool_t* pool) {
         pool->task_queue = NULL;
     }
     
+    // 释放EDF堆
+    free(pool->edf_heap.tasks);
+    pool->edf_heap.tasks = NULL;
+    pool->edf_heap.size = 0;
+    pool->edf_heap.capacity = 0;
+    
     // 销毁同步原语
     pthread_cond_destroy(&pool->shutdown_cond);
     pthread_mutex_destroy(&pool->stats_mutex);
@@ -181,6 +251,59 @@ static void cleanup_pool_resources(process_pool_t* pool) {
     }
 }
 
+static void fail_shutdown_task(process_pool_t* pool, task_internal_t* task) {
+    timer_wheel_cancel(&pool->timer_wheel, &task->timer);
+    task_set_error(task, POOL_ERROR_SHUTDOWN, "Pool is shutting down");
+    task_complete(task, TASK_STATE_FAILED);
+    task_unref(task);
+}
+
+/**
+ * 将尚未分发的任务标记为失败，仅在事件循环停止后调用
+ */
+static void fail_queued_tasks(process_pool_t* pool) {
+    task_internal_t* task;
+    
+    for (int i = 0; i < TASK_PRIORITY_COUNT; i++) {
+        task_lane_t* lane = &pool->pending_lanes[i];
+        
+        while ((task = lane->head) != NULL) {
+            lane->head = task->next;
+            fail_shutdown_task(pool, task);
+        }
+        lane->tail = NULL;
+        ATOMIC_STORE(&pool->pending_counts[i], 0);
+    }
+    
+    for (uint32_t i = 0; i < pool->edf_heap.size; i++) {
+        fail_shutdown_task(pool, pool->edf_heap.tasks[i]);
+    }
+    pool->edf_heap.size = 0;
+    
+    while ((task = pool->deferred_tasks.head) != NULL) {
+        pool->deferred_tasks.head = task->next;
+        fail_shutdown_task(pool, task);
+    }
+    pool->deferred_tasks.tail = NULL;
+    
+    while ((task = queue_dequeue(pool->task_queue)) != NULL) {
+        fail_shutdown_task(pool, task);
+    }
+    
+    // 未处理的取消请求只持有引用，任务本身已是终态
+    pthread_mutex_lock(&pool->task_mutex);
+    task = pool->cancel_requests;
+    pool->cancel_requests = NULL;
+    pthread_mutex_unlock(&pool->task_mutex);
+    
+    while (task) {
+        task_internal_t* next = task->cancel_next;
+        task->cancel_next = NULL;
+        task_unref(task);
+        task = next;
+    }
+}
+
 // ============================================================================
 // 公共API实现
 // ============================================================================
@@ -215,6 +338,7 @@ process_pool_t* pool_create(const pool_config_t* config) {
     ATOMIC_STORE(&pool->next_task_id, 1);
     ATOMIC_STORE(&pool->active_workers, 0);
     ATOMIC_STORE(&pool->target_workers, config->min_workers);
+    ATOMIC_STORE(&pool->sched_policy, config->sched_policy);
     
     // 初始化统计信息
     memset(&pool->stats, 0, sizeof(pool_stats_t));
@@ -226,11 +350,41 @@ process_pool_t* pool_create(const pool_config_t* config) {
     pool->metrics_enabled = config->enable_metrics;
     pool->tracing_enabled = config->enable_tracing;
     
+    // 计算Worker放置，CPU列表不可用时创建失败
+    pool_error_t err = affinity_init(pool);
+    if (err != POOL_SUCCESS) {
+        free(pool);
+        return NULL;
+    }
+    
+    // 所有Worker的共享内存段在一个arena中，必须在zygote和任何Worker派生之前映射
+    err = shm_arena_create(&pool->shm_arena, pool->pool_name,
+                           shm_segment_size(pool->config.shm_ring_size),
+                           pool->config.max_workers, pool->config.shm_huge_pages,
+                           pool->config.shm_seal);
+    if (err != POOL_SUCCESS) {
+        log_message(pool, 0, "Failed to create shared memory arena: %s", strerror(errno));
+        free(pool);
+        return NULL;
+    }
+    
+    if (pool->config.shm_huge_pages != POOL_HUGE_PAGES_OFF &&
+        pool->shm_arena.page_kind == SHM_PAGES_NORMAL) {
+        log_message(pool, 1, "Huge pages unavailable, shared memory uses normal pages");
+    }
+    
+    // 在创建事件循环线程和分配队列之前启动zygote，失败时Worker直接fork
+    if (zygote_start(pool) != POOL_SUCCESS) {
+        log_message(pool, 1, "Zygote unavailable, workers will be forked directly");
+    }
+    
     // 初始化资源
-    pool_error_t err = init_pool_resources(pool);
+    err = init_pool_resources(pool);
     if (err != POOL_SUCCESS) {
         log_message(pool, 0, "Failed to initialize pool resources: %s", 
                    pool_error_string(err));
+        zygote_stop(pool);
+        shm_arena_destroy(&pool->shm_arena);
         free(pool);
         return NULL;
     }
@@ -262,7 +416,8 @@ pool_error_t pool_start(process_pool_t* pool) {
     
     // 启动事件循环线程
     pool->event_loop_running = true;
-    if (pthread_create(&pool->event_thread, NULL, event_loop_thread, pool) != 0) {
+    if (event_loop_start() != POOL_SUCCESS) {
+        pool->event_loop_running = false;
         ATOMIC_STORE(&pool->state, POOL_STATE_CREATED);
         pthread_mutex_unlock(&pool->pool_mutex);
         log_message(pool, 0, "Failed to create event loop thread");
@@ -287,6 +442,16 @@ pool_error_t pool_start(process_pool_t* pool) {
             break;
         }
         
+        // 监听Worker的结果通知
+        err = event_loop_add_worker_events(i);
+        if (err != POOL_SUCCESS) {
+            log_message(pool, 0, "Failed to watch worker %u: %s", 
+                       i, pool_error_string(err));
+            worker_stop(&pool->workers[i], 1000);
+            worker_destroy(&pool->workers[i]);
+            break;
+        }
+        
         ATOMIC_ADD(&pool->active_workers, 1);
         log_message(pool, 3, "Worker %u started successfully", i);
     }
@@ -298,8 +463,11 @@ pool_error_t pool_start(process_pool_t* pool) {
     } else {
         // 启动失败，清理已创建的Worker
         ATOMIC_STORE(&pool->state, POOL_STATE_STOPPING);
+        event_loop_stop();
+        pool->event_loop_running = false;
         for (uint32_t i = 0; i < pool->config.max_workers; i++) {
             if (pool->workers[i].pid > 0) {
+                event_loop_remove_worker_events(i);
                 worker_stop(&pool->workers[i], 5000); // 5秒超时
                 worker_destroy(&pool->workers[i]);
             }
@@ -349,23 +517,29 @@ pool_error_t pool_stop(process_pool_t* pool, uint32_t timeout_ms) {
         pthread_mutex_lock(&pool->pool_mutex);
     }
     
+    // 停止事件循环线程，之后由当前线程独占Worker的在途链表
+    event_loop_stop();
+    fail_queued_tasks(pool);
+    
+    // 等待事件循环发给zygote、尚未应答的派生请求，收到的Worker随下面一起停止
+    zygote_collect_spawns(pool);
+    
     // 停止所有Worker进程
     uint32_t active_workers = ATOMIC_LOAD(&pool->active_workers);
+    if (active_workers == 0) {
+        active_workers = 1;
+    }
     for (uint32_t i = 0; i < pool->config.max_workers; i++) {
         if (pool->workers[i].pid > 0) {
+            event_loop_remove_worker_events(i);
             worker_stop(&pool->workers[i], timeout_ms / active_workers);
+            worker_fail_inflight(&pool->workers[i], POOL_ERROR_SHUTDOWN, "Pool is shutting down");
             worker_destroy(&pool->workers[i]);
         }
     }
     
     ATOMIC_STORE(&pool->active_workers, 0);
     
-    // 停止事件循环线程
-    if (pool->event_thread) {
-        pthread_join(pool->event_thread, NULL);
-        pool->event_thread = 0;
-    }
-    
     ATOMIC_STORE(&pool->state, POOL_STATE_STOPPED);
     
     log_message(pool, 2, "Process pool stopped successfully");
@@ -396,6 +570,388 @@ void pool_destroy(process_pool_t* pool) {
     log_message(NULL, 2, "Process pool destroyed");
 }
 
+/**
+ * 入队前查找结果缓存和相同的在途任务
+ * @return 任务已用缓存的结果完成，或future已改为引用在途任务时返回true，
+ *         此时任务不再入队，队列引用已释放
+ */
+static bool submit_resolved(process_pool_t* pool, task_internal_t* task, task_future_t* future) {
+    task_internal_t* leader = NULL;
+    result_cache_lookup_t outcome = result_cache_lookup(pool, task, &leader);
+    
+    if (outcome == RESULT_CACHE_MISS) {
+        return false;
+    }
+    
+    if (outcome == RESULT_CACHE_JOINED) {
+        // future改为引用在途任务，新建的任务随之释放
+        future->task = leader;
+        future->task_id = leader->task_id;
+        task_unref(task);
+    }
+    
+    task_unref(task);
+    return true;
+}
+
+static pool_error_t submit_task(process_pool_t* pool,
+                                const task_desc_t* desc,
+                                const void* input_data,
+                                size_t input_size,
+                                const pool_fd_region_t* input_region,
+                                task_future_t** future) {
+    if (!pool || !desc || !future || (input_size > 0 && !input_data)) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    *future = NULL;
+    
+    if (input_size > MAX_TASK_DATA_SIZE) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    if ((uint32_t)desc->priority >= TASK_PRIORITY_COUNT) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    if (ATOMIC_LOAD(&pool->state) != POOL_STATE_RUNNING) {
+        return POOL_ERROR_SHUTDOWN;
+    }
+    
+    task_internal_t* task = task_create(desc, input_data, input_size);
+    if (!task) {
+        return POOL_ERROR_NO_MEMORY;
+    }
+    
+    if (input_region) {
+        pool_error_t err = task_fd_attach_input(task, input_region);
+        if (err != POOL_SUCCESS) {
+            task_unref(task);
+            return err;
+        }
+    }
+    
+    task_future_t* f = future_create(task);
+    if (!f) {
+        task_unref(task);
+        return POOL_ERROR_NO_MEMORY;
+    }
+    f->task_id = task->task_id;
+    f->pool = pool;
+    
+    // 命中结果缓存或合并到在途任务时不再入队
+    if (submit_resolved(pool, task, f)) {
+        *future = f;
+        return POOL_SUCCESS;
+    }
+    
+    // 任务队列为MPMC模式，任意数量的提交线程可以并发入队
+    if (!queue_enqueue(pool->task_queue, task)) {
+        future_destroy(f);
+        task_unref(task);
+        return POOL_ERROR_QUEUE_FULL;
+    }
+    
+    // 队列持有的引用由事件循环接管
+    stats_task_submitted(pool);
+    event_loop_notify_task_submit();
+    
+    *future = f;
+    return POOL_SUCCESS;
+}
+
+pool_error_t pool_submit_async(process_pool_t* pool,
+                              const task_desc_t* desc,
+                              const void* input_data,
+                              size_t input_size,
+                              task_future_t** future) {
+    // 流式任务需要流句柄，只能通过pool_submit_stream提交
+    if (desc && desc->streaming) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    return submit_task(pool, desc, input_data, input_size, NULL, future);
+}
+
+pool_error_t pool_submit_fd(process_pool_t* pool,
+                           const task_desc_t* desc,
+                           const pool_fd_region_t* input,
+                           task_future_t** future) {
+    if (!desc || !input || desc->streaming) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    // 输入不在Master内存中，无法计算缓存键
+    task_desc_t fd_desc = *desc;
+    fd_desc.cacheable = false;
+    
+    return submit_task(pool, &fd_desc, NULL, 0, input, future);
+}
+
+pool_error_t pool_submit_stream(process_pool_t* pool,
+                               const task_desc_t* desc,
+                               const void* input_data,
+                               size_t input_size,
+                               task_stream_t** stream) {
+    if (!desc || !stream) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    *stream = NULL;
+    
+    task_desc_t stream_desc = *desc;
+    stream_desc.streaming = true;
+    stream_desc.cacheable = false;
+    
+    task_future_t* future = NULL;
+    pool_error_t err = submit_task(pool, &stream_desc, input_data, input_size, NULL, &future);
+    if (err != POOL_SUCCESS) {
+        return err;
+    }
+    
+    *stream = task_stream_create(pool, future);
+    if (!*stream) {
+        pool_future_cancel(future);
+        pool_future_destroy(future);
+        return POOL_ERROR_NO_MEMORY;
+    }
+    
+    return POOL_SUCCESS;
+}
+
+pool_error_t pool_submit_sync(process_pool_t* pool,
+                             const task_desc_t* desc,
+                             const void* input_data,
+                             size_t input_size,
+                             task_result_t* result,
+                             uint32_t timeout_ms) {
+    task_future_t* future = NULL;
+    
+    pool_error_t err = pool_submit_async(pool, desc, input_data, input_size, &future);
+    if (err != POOL_SUCCESS) {
+        return err;
+    }
+    
+    err = pool_future_wait(future, result, timeout_ms);
+    if (err == POOL_ERROR_TIMEOUT) {
+        pool_future_cancel(future);
+    }
+    
+    pool_future_destroy(future);
+    return err;
+}
+
+/**
+ * 批量提交：任务结构一次从内存池分配，每块只发布一次队列tail，
+ * 整批只通知一次事件循环。事件循环按Worker分块写入提交环，
+ * 每个Worker每轮只提交一次、唤醒一次
+ */
+pool_error_t pool_submit_batch(process_pool_t* pool,
+                              const task_desc_t* tasks,
+                              const void** input_data,
+                              const size_t* input_sizes,
+                              uint32_t count,
+                              task_future_t** futures) {
+    if (!pool || !tasks || !futures || count == 0) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        futures[i] = NULL;
+    }
+    
+    // 先整体校验，避免提交到一半才发现参数错误
+    for (uint32_t i = 0; i < count; i++) {
+        size_t size = input_sizes ? input_sizes[i] : 0;
+        
+        if (size > MAX_TASK_DATA_SIZE || (size > 0 && (!input_data || !input_data[i])) ||
+            (uint32_t)tasks[i].priority >= TASK_PRIORITY_COUNT || tasks[i].streaming) {
+            return POOL_ERROR_INVALID_PARAM;
+        }
+    }
+    
+    if (ATOMIC_LOAD(&pool->state) != POOL_STATE_RUNNING) {
+        return POOL_ERROR_SHUTDOWN;
+    }
+    
+    task_internal_t* batch[SUBMIT_BATCH_CHUNK];
+    uint32_t slots[SUBMIT_BATCH_CHUNK];
+    pool_error_t err = POOL_SUCCESS;
+    uint32_t offset = 0;
+    uint32_t submitted = 0;
+    
+    while (offset < count && err == POOL_SUCCESS) {
+        uint32_t n = count - offset;
+        if (n > SUBMIT_BATCH_CHUNK) {
+            n = SUBMIT_BATCH_CHUNK;
+        }
+        
+        if (!task_create_batch(&tasks[offset],
+                               input_data ? &input_data[offset] : NULL,
+                               input_sizes ? &input_sizes[offset] : NULL,
+                               n, batch)) {
+            err = POOL_ERROR_NO_MEMORY;
+            break;
+        }
+        
+        uint32_t ready = 0;
+        while (ready < n) {
+            task_future_t* f = future_create(batch[ready]);
+            if (!f) {
+                break;
+            }
+            f->task_id = batch[ready]->task_id;
+            f->pool = pool;
+            futures[offset + ready] = f;
+            ready++;
+        }
+        if (ready < n) {
+            err = POOL_ERROR_NO_MEMORY;
+        }
+        
+        // 命中结果缓存或合并到在途任务的不再入队，其余任务按原顺序前移
+        uint32_t queued = 0;
+        for (uint32_t i = 0; i < ready; i++) {
+            if (submit_resolved(pool, batch[i], futures[offset + i])) {
+                continue;
+            }
+            batch[queued] = batch[i];
+            slots[queued] = i;
+            queued++;
+        }
+        
+        // 队列满时先唤醒事件循环取走已入队的任务，没有进展再放弃
+        uint32_t enqueued = 0;
+        while (enqueued < queued) {
+            uint32_t added = 0;
+            queue_enqueue_batch(pool->task_queue, &batch[enqueued], queued - enqueued, &added);
+            if (added == 0) {
+                event_loop_notify_task_submit();
+                sched_yield();
+                queue_enqueue_batch(pool->task_queue, &batch[enqueued], queued - enqueued, &added);
+                if (added == 0) {
+                    err = POOL_ERROR_QUEUE_FULL;
+                    break;
+                }
+            }
+            enqueued += added;
+        }
+        
+        // 未能入队的任务连同future一起释放
+        for (uint32_t i = enqueued; i < queued; i++) {
+            future_destroy(futures[offset + slots[i]]);
+            futures[offset + slots[i]] = NULL;
+            task_unref(batch[i]);
+        }
+        for (uint32_t i = ready; i < n; i++) {
+            task_unref(batch[i]);
+        }
+        
+        submitted += enqueued;
+        offset += n;
+    }
+    
+    // 队列持有的引用由事件循环接管
+    if (submitted > 0) {
+        stats_task_submitted_batch(pool, submitted);
+        event_loop_notify_task_submit();
+    }
+    
+    return err;
+}
+
+pool_error_t pool_future_wait(task_future_t* future,
+                             task_result_t* result,
+                             uint32_t timeout_ms) {
+    if (!future || !future->task) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    pool_error_t err = task_wait(future->task, timeout_ms);
+    if (err != POOL_SUCCESS || !result) {
+        return err;
+    }
+    
+    task_internal_t* task = future->task;
+    memset(result, 0, sizeof(task_result_t));
+    
+    // 共享任务上单独取消的future不取结果
+    if (ATOMIC_LOAD(&future->detached)) {
+        result->task_id = future->task_id;
+        result->state = TASK_STATE_CANCELLED;
+        return POOL_SUCCESS;
+    }
+    
+    pthread_mutex_lock(&task->mutex);
+    
+    result->task_id = task->task_id;
+    result->state = ATOMIC_LOAD(&task->state);
+    result->error_code = task->result.error_code;
+    if (task->result.error_message) {
+        strncpy(result->error_message, task->result.error_message,
+                sizeof(result->error_message) - 1);
+    }
+    
+    // 结果数据复制给调用方，由调用方free
+    if (task->result.output_data && task->result.output_size > 0) {
+        result->result_data = malloc(task->result.output_size);
+        if (result->result_data) {
+            memcpy(result->result_data, task->result.output_data, task->result.output_size);
+            result->result_size = task->result.output_size;
+        } else {
+            err = POOL_ERROR_NO_MEMORY;
+        }
+    }
+    
+    result->start_time_ns = task->start_time_ns;
+    result->end_time_ns = task->end_time_ns;
+    result->worker_id = ATOMIC_LOAD(&task->worker_id);
+    
+    pthread_mutex_unlock(&task->mutex);
+    
+    return err;
+}
+
+pool_error_t pool_future_cancel(task_future_t* future) {
+    if (!future || !future->task) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    if (ATOMIC_LOAD(&future->detached)) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    task_internal_t* task = future->task;
+    
+    // 合并后的任务还有其他future在等待时只取消这一个future，任务继续执行
+    int sharers = ATOMIC_LOAD(&task->flight_sharers);
+    while (sharers > 1 && !task_is_completed(task)) {
+        if (ATOMIC_CAS(&task->flight_sharers, &sharers, sharers - 1)) {
+            ATOMIC_STORE(&future->detached, true);
+            stats_task_cancelled(future->pool);
+            return POOL_SUCCESS;
+        }
+    }
+    
+    pool_error_t result = task_cancel(task);
+    if (result != POOL_SUCCESS) {
+        return result;
+    }
+    
+    stats_task_cancelled(future->pool);
+    
+    // 已分发的任务还需通知执行它的Worker
+    if (ATOMIC_LOAD(&future->pool->state) == POOL_STATE_RUNNING) {
+        event_loop_notify_task_cancel(future->task);
+    }
+    
+    return POOL_SUCCESS;
+}
+
+void pool_future_destroy(task_future_t* future) {
+    future_destroy(future);
+}
+
 pool_error_t pool_get_stats(process_pool_t* pool, pool_stats_t* stats) {
     if (!pool || !stats) {
         return POOL_ERROR_INVALID_PARAM;
@@ -414,18 +970,86 @@ pool_error_t pool_get_stats(process_pool_t* pool, pool_stats_t* stats) {
     return POOL_SUCCESS;
 }
 
-pool_error_t pool_resize(process_pool_t* pool, uint32_t target_count) {
-    if (!pool) {
+pool_error_t pool_set_sched_policy(process_pool_t* pool, pool_sched_policy_t policy) {
+    if (!pool || (uint32_t)policy >= POOL_SCHED_POLICY_COUNT) {
         return POOL_ERROR_INVALID_PARAM;
     }
     
-    if (target_count < pool->config.min_workers || 
-        target_count > pool->config.max_workers) {
+    ATOMIC_STORE(&pool->sched_policy, policy);
+    log_message(pool, 2, "Scheduling policy set to %d", policy);
+    
+    // 由事件循环在下一次分发前迁移积压任务
+    if (ATOMIC_LOAD(&pool->state) == POOL_STATE_RUNNING) {
+        event_loop_notify_task_submit();
+    }
+    
+    return POOL_SUCCESS;
+}
+
+pool_error_t pool_get_workers(process_pool_t* pool,
+                             worker_info_t* workers,
+                             uint32_t* count) {
+    if (!pool || !workers || !count) {
         return POOL_ERROR_INVALID_PARAM;
     }
     
-    pthread_mutex_lock(&pool->pool_mutex);
+    uint32_t capacity = *count;
+    uint32_t n = 0;
+    
+    for (uint32_t i = 0; i < pool->config.max_workers && n < capacity; i++) {
+        worker_internal_t* worker = &pool->workers[i];
+        if (worker->pid <= 0) {
+            continue;
+        }
+        
+        worker_info_t* info = &workers[n++];
+        memset(info, 0, sizeof(worker_info_t));
+        
+        info->worker_id = worker->worker_id;
+        info->pid = worker->pid;
+        
+        switch (ATOMIC_LOAD(&worker->state)) {
+            case WORKER_INTERNAL_RUNNING:
+                info->state = ATOMIC_LOAD(&worker->inflight_count) > 0 ?
+                              WORKER_STATE_BUSY : WORKER_STATE_IDLE;
+                break;
+            case WORKER_INTERNAL_CREATED:
+            case WORKER_INTERNAL_STARTING:
+                info->state = WORKER_STATE_STARTING;
+                break;
+            case WORKER_INTERNAL_STOPPING:
+                info->state = WORKER_STATE_STOPPING;
+                break;
+            default:
+                info->state = WORKER_STATE_DEAD;
+                break;
+        }
+        
+        // 处理计数由Worker进程写在共享内存中
+        if (worker->shared_mem) {
+            info->tasks_processed = ATOMIC_LOAD(&worker->shared_mem->total_completed) +
+                                    ATOMIC_LOAD(&worker->shared_mem->total_failed);
+            info->tasks_stolen = ATOMIC_LOAD(&worker->shared_mem->total_stolen);
+            info->tasks_stolen_from = ATOMIC_LOAD(&worker->shared_mem->total_stolen_from);
+        }
+        info->last_activity_time = ATOMIC_LOAD(&worker->last_heartbeat);
+        info->cpu_usage = worker->cpu_usage;
+        info->memory_usage = worker->memory_usage;
+        info->cpu = worker->cpu;
+        info->numa_node = worker->numa_node;
+        info->route_hits = ATOMIC_LOAD(&worker->route_hits);
+    }
     
+    *count = n;
+    return POOL_SUCCESS;
+}
+
+/**
+ * 调整Worker数量，在事件循环线程上调用(缩容要收回Worker的积压任务)，
+ * 且pool_mutex由调用方或等待结果的pool_resize持有
+ * Worker总是占用[0, active_workers)，增减都发生在尾部
+ */
+pool_error_t pool_resize_locked(process_pool_t* pool, uint32_t target_count) {
     uint32_t current_count = ATOMIC_LOAD(&pool->active_workers);
     ATOMIC_STORE(&pool->target_workers, target_count);
     
@@ -437,36 +1061,72 @@ pool_error_t pool_resize(process_pool_t* pool, uint32_t target_count) {
     if (target_count > current_count) {
         // 增加Worker
         for (uint32_t i = current_count; i < target_count; i++) {
+            // 槽位上缩容退役的Worker还没退出，不再等它；还在派生中的直接继续使用
+            if (pool->workers[i].retire_deadline_ns > 0 && event_loop_release_retired(i)) {
+                ATOMIC_ADD(&pool->active_workers, 1);
+                continue;
+            }
+            
             err = worker_create(pool, i);
             if (err != POOL_SUCCESS) break;
             
-            err = worker_start(&pool->workers[i]);
+            // 由zygote派生时不等应答，事件循环收到应答后再注册事件
+            err = worker_start_async(&pool->workers[i]);
             if (err != POOL_SUCCESS) {
                 worker_destroy(&pool->workers[i]);
                 break;
             }
             
+            if (ATOMIC_LOAD(&pool->workers[i].state) == WORKER_INTERNAL_RUNNING) {
+                err = event_loop_add_worker_events(i);
+                if (err != POOL_SUCCESS) {
+                    worker_stop(&pool->workers[i], 1000);
+                    worker_destroy(&pool->workers[i]);
+                    break;
+                }
+            }
+            
             ATOMIC_ADD(&pool->active_workers, 1);
         }
     } else if (target_count < current_count) {
-        // 减少Worker
+        // 减少Worker：只通知退出，进程退出后由事件循环回收，不阻塞分发
         for (uint32_t i = target_count; i < current_count; i++) {
-            if (pool->workers[i].pid > 0) {
-                worker_stop(&pool->workers[i], 5000);
-                worker_destroy(&pool->workers[i]);
+            if (pool->workers[i].pid > 0 || pool->workers[i].spawn_deadline_ns > 0) {
+                event_loop_retire_worker(i);
                 ATOMIC_SUB(&pool->active_workers, 1);
             }
         }
     }
     
-    pthread_mutex_unlock(&pool->pool_mutex);
-    
     log_message(pool, 2, "Pool resized to %u workers", 
                ATOMIC_LOAD(&pool->active_workers));
     
     return err;
 }
 
+pool_error_t pool_resize(process_pool_t* pool, uint32_t target_count) {
+    if (!pool) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    if (target_count < pool->config.min_workers || 
+        target_count > pool->config.max_workers) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    pthread_mutex_lock(&pool->pool_mutex);
+    
+    // 持锁期间pool_stop不会停止事件循环，由事件循环线程完成调整
+    pool_error_t err = POOL_ERROR_INVALID_PARAM;
+    if (ATOMIC_LOAD(&pool->state) == POOL_STATE_RUNNING) {
+        err = event_loop_resize(target_count);
+    }
+    
+    pthread_mutex_unlock(&pool->pool_mutex);
+    
+    return err;
+}
+
 // ============================================================================
 // 工具函数实现
 // ============================================================================
@@ -481,6 +1141,7 @@ const char* pool_error_string(pool_error_t error) {
         case POOL_ERROR_QUEUE_FULL: return "Task queue full";
         case POOL_ERROR_WORKER_DEAD: return "Worker process died";
         case POOL_ERROR_SHUTDOWN: return "Pool is shutting down";
+        case POOL_ERROR_STREAM_CLOSED: return "Stream closed";
         default: return "Unknown error";
     }
 }
@@ -489,8 +1150,19 @@ uint64_t pool_get_time_ns(void) {
     return get_time_ns();
 }
 
+uint64_t pool_routing_key(const void* key, size_t key_size) {
+    if (!key || key_size == 0) {
+        return 0;
+    }
+    
+    // 0表示不指定路由键，分发时还会再混合一次，这里只需保证非0
+    uint64_t hash = hash_memory(key, key_size);
+    return hash != 0 ? hash : 1;
+}
+
 void pool_set_log_level(int level) {
     g_log_level = level;
+    log_set_level(level);
 }
 
 const char* pool_get_version(void) {
@@ -0,0 +1,528 @@
+#define _GNU_SOURCE
+#include "../../include/internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/random.h>
+
+// ============================================================================
+// 结果缓存
+// ============================================================================
+
+/**
+ * 按内容寻址的结果缓存：键为处理函数地址、输入大小和输入字节的
+ * SipHash-2-4(128位输出，密钥在创建缓存时随机生成)。只有提交时设置了
+ * task_desc_t.cacheable的任务参与，命中时在提交线程中直接以缓存的结果
+ * 完成任务，不进入队列，也不经过Worker。
+ *
+ * 容量按字节计算(结果数据加条目开销)，超出时从LRU链表尾部淘汰。
+ * 查找在提交线程、写入在事件循环线程，两者用同一把互斥锁串行化。
+ *
+ * 启用单飞合并时，未命中的任务按同一个键登记到在途任务表，之后相同的
+ * 提交直接引用这个领头任务，不再入队；领头任务到达任意终态时注销。
+ * 在途任务表以任务自身的flight_next串成哈希链，表持有领头任务一个引用；
+ * 桶数按同时在途的任务数上限(队列容量加各Worker的在途任务数)取整到2的幂。
+ *
+ * 合并后的提交按领头任务的优先级排队、按它的超时计时，因此只有优先级
+ * 不高于领头任务且超时相同的提交才合并，其余的各自执行。
+ */
+
+#define RESULT_CACHE_MIN_BUCKETS 1024
+
+typedef struct result_cache_entry {
+    result_cache_key_t key;             // 缓存键
+    void* data;                         // 结果数据
+    size_t size;                        // 结果大小
+    struct result_cache_entry* hash_next; // 哈希桶链表
+    struct result_cache_entry* lru_prev;  // LRU链表，表头最近使用
+    struct result_cache_entry* lru_next;
+} result_cache_entry_t;
+
+struct result_cache {
+    pthread_mutex_t mutex;              // 保护以下全部字段
+    uint64_t sip_key[2];                // SipHash密钥
+    result_cache_entry_t** buckets;     // 哈希桶
+    uint32_t bucket_mask;               // 桶数-1(桶数为2的幂)
+    uint32_t entries;                   // 条目数
+    size_t bytes;                       // 已占用字节数
+    size_t capacity;                    // 容量(字节)
+    result_cache_entry_t* lru_head;     // 最近使用
+    result_cache_entry_t* lru_tail;     // 最久未使用
+    uint64_t hits;                      // 命中数
+    uint64_t misses;                    // 未命中数
+    uint64_t evictions;                 // 淘汰数
+    
+    bool single_flight;                 // 是否合并相同的在途任务
+    task_internal_t** flights;          // 在途领头任务表
+    uint32_t flight_mask;               // 在途任务表桶数-1(桶数为2的幂)
+    uint32_t flight_count;              // 在途领头任务数
+    uint64_t joins;                     // 合并到在途任务上的提交数
+};
+
+// ============================================================================
+// SipHash-2-4(128位输出)
+// ============================================================================
+
+#define SIP_ROTL(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+#define SIP_ROUND(v0, v1, v2, v3) do {                                    \
+    v0 += v1; v1 = SIP_ROTL(v1, 13); v1 ^= v0; v0 = SIP_ROTL(v0, 32);     \
+    v2 += v3; v3 = SIP_ROTL(v3, 16); v3 ^= v2;                            \
+    v0 += v3; v3 = SIP_ROTL(v3, 21); v3 ^= v0;                            \
+    v2 += v1; v1 = SIP_ROTL(v1, 17); v1 ^= v2; v2 = SIP_ROTL(v2, 32);     \
+} while (0)
+
+static uint64_t sip_load64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v; // 小端平台
+}
+
+static void siphash128(const void* data, size_t size, const uint64_t key[2], uint64_t out[2]) {
+    const uint8_t* in = (const uint8_t*)data;
+    uint64_t v0 = 0x736f6d6570736575ULL ^ key[0];
+    uint64_t v1 = 0x646f72616e646f6dULL ^ key[1];
+    uint64_t v2 = 0x6c7967656e657261ULL ^ key[0];
+    uint64_t v3 = 0x7465646279746573ULL ^ key[1];
+    size_t tail = size & 7;
+    const uint8_t* end = in + size - tail;
+    
+    v1 ^= 0xee;
+    
+    for (; in != end; in += 8) {
+        uint64_t m = sip_load64(in);
+        v3 ^= m;
+        SIP_ROUND(v0, v1, v2, v3);
+        SIP_ROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    
+    uint64_t b = (uint64_t)size << 56;
+    for (size_t i = 0; i < tail; i++) {
+        b |= (uint64_t)in[i] << (8 * i);
+    }
+    
+    v3 ^= b;
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    v0 ^= b;
+    
+    v2 ^= 0xee;
+    for (int i = 0; i < 4; i++) {
+        SIP_ROUND(v0, v1, v2, v3);
+    }
+    out[0] = v0 ^ v1 ^ v2 ^ v3;
+    
+    v1 ^= 0xdd;
+    for (int i = 0; i < 4; i++) {
+        SIP_ROUND(v0, v1, v2, v3);
+    }
+    out[1] = v0 ^ v1 ^ v2 ^ v3;
+}
+
+// ============================================================================
+// 哈希表与LRU链表(调用方持有mutex)
+// ============================================================================
+
+static inline size_t entry_cost(size_t size) {
+    return sizeof(result_cache_entry_t) + size;
+}
+
+static inline uint32_t key_bucket(const result_cache_t* cache, const result_cache_key_t* key) {
+    return (uint32_t)key->hash[0] & cache->bucket_mask;
+}
+
+static inline bool key_equal(const result_cache_key_t* a, const result_cache_key_t* b) {
+    return a->handler == b->handler && a->input_size == b->input_size &&
+           a->hash[0] == b->hash[0] && a->hash[1] == b->hash[1];
+}
+
+static void lru_unlink(result_cache_t* cache, result_cache_entry_t* entry) {
+    if (entry->lru_prev) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else {
+        cache->lru_head = entry->lru_next;
+    }
+    
+    if (entry->lru_next) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        cache->lru_tail = entry->lru_prev;
+    }
+    
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+static void lru_push_front(result_cache_t* cache, result_cache_entry_t* entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head) {
+        cache->lru_head->lru_prev = entry;
+    } else {
+        cache->lru_tail = entry;
+    }
+    cache->lru_head = entry;
+}
+
+static result_cache_entry_t* cache_find(result_cache_t* cache, const result_cache_key_t* key) {
+    result_cache_entry_t* entry = cache->buckets[key_bucket(cache, key)];
+    
+    while (entry && !key_equal(&entry->key, key)) {
+        entry = entry->hash_next;
+    }
+    
+    return entry;
+}
+
+static void cache_remove(result_cache_t* cache, result_cache_entry_t* entry) {
+    result_cache_entry_t** link = &cache->buckets[key_bucket(cache, &entry->key)];
+    
+    while (*link != entry) {
+        link = &(*link)->hash_next;
+    }
+    *link = entry->hash_next;
+    
+    lru_unlink(cache, entry);
+    cache->entries--;
+    cache->bytes -= entry_cost(entry->size);
+    
+    free(entry->data);
+    free(entry);
+}
+
+/**
+ * 条目数超过桶数时桶数翻倍，分配失败时保持原大小
+ */
+static void cache_grow(result_cache_t* cache) {
+    uint32_t count = (cache->bucket_mask + 1) * 2;
+    result_cache_entry_t** buckets = calloc(count, sizeof(result_cache_entry_t*));
+    if (!buckets) {
+        return;
+    }
+    
+    for (uint32_t i = 0; i <= cache->bucket_mask; i++) {
+        result_cache_entry_t* entry = cache->buckets[i];
+        while (entry) {
+            result_cache_entry_t* next = entry->hash_next;
+            uint32_t bucket = (uint32_t)entry->key.hash[0] & (count - 1);
+            entry->hash_next = buckets[bucket];
+            buckets[bucket] = entry;
+            entry = next;
+        }
+    }
+    
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_mask = count - 1;
+}
+
+// ============================================================================
+// 接口
+// ============================================================================
+
+result_cache_t* result_cache_create(size_t capacity, bool single_flight, uint32_t max_inflight) {
+    if (capacity == 0 && !single_flight) {
+        return NULL;
+    }
+    
+    result_cache_t* cache = calloc(1, sizeof(result_cache_t));
+    if (!cache) {
+        return NULL;
+    }
+    
+    uint32_t flight_buckets = 1;
+    if (single_flight) {
+        while (flight_buckets < max_inflight && flight_buckets < (1u << 20)) {
+            flight_buckets <<= 1;
+        }
+    }
+    
+    cache->buckets = calloc(RESULT_CACHE_MIN_BUCKETS, sizeof(result_cache_entry_t*));
+    cache->flights = calloc(flight_buckets, sizeof(task_internal_t*));
+    if (!cache->buckets || !cache->flights) {
+        free(cache->buckets);
+        free(cache->flights);
+        free(cache);
+        return NULL;
+    }
+    
+    // 随机密钥使构造碰撞输入不可行；取不到随机数时退回时间和进程号
+    if (getrandom(cache->sip_key, sizeof(cache->sip_key), 0) != (ssize_t)sizeof(cache->sip_key)) {
+        cache->sip_key[0] = get_time_ns();
+        cache->sip_key[1] = ((uint64_t)getpid() << 32) ^ (uint64_t)(uintptr_t)cache;
+    }
+    
+    cache->bucket_mask = RESULT_CACHE_MIN_BUCKETS - 1;
+    cache->flight_mask = flight_buckets - 1;
+    cache->capacity = capacity;
+    cache->single_flight = single_flight;
+    pthread_mutex_init(&cache->mutex, NULL);
+    
+    return cache;
+}
+
+void result_cache_destroy(result_cache_t* cache) {
+    if (!cache) {
+        return;
+    }
+    
+    result_cache_entry_t* entry = cache->lru_head;
+    while (entry) {
+        result_cache_entry_t* next = entry->lru_next;
+        free(entry->data);
+        free(entry);
+        entry = next;
+    }
+    
+    // 仍被future引用的领头任务不能再指向已释放的缓存
+    for (uint32_t i = 0; i <= cache->flight_mask; i++) {
+        task_internal_t* task = cache->flights[i];
+        while (task) {
+            task_internal_t* next = task->flight_next;
+            task->flight = NULL;
+            task->flight_next = NULL;
+            task_unref(task);
+            task = next;
+        }
+    }
+    
+    free(cache->buckets);
+    free(cache->flights);
+    pthread_mutex_destroy(&cache->mutex);
+    free(cache);
+}
+
+static inline uint32_t flight_bucket(const result_cache_t* cache, const result_cache_key_t* key) {
+    return (uint32_t)key->hash[1] & cache->flight_mask;
+}
+
+/**
+ * 从在途任务表中摘除领头任务(调用方持有mutex)
+ * @return 任务在表中返回true，此时由调用方释放表持有的引用
+ */
+static bool flight_remove(result_cache_t* cache, task_internal_t* task) {
+    task_internal_t** link = &cache->flights[flight_bucket(cache, &task->cache_key)];
+    
+    while (*link && *link != task) {
+        link = &(*link)->flight_next;
+    }
+    if (!*link) {
+        return false;
+    }
+    
+    *link = task->flight_next;
+    task->flight_next = NULL;
+    cache->flight_count--;
+    return true;
+}
+
+/**
+ * 查找相同键的在途领头任务，顺带摘除已到达终态但尚未注销的任务
+ * (调用方持有mutex)
+ */
+static task_internal_t* flight_find(result_cache_t* cache, const result_cache_key_t* key,
+                                    task_internal_t** finished) {
+    task_internal_t* task = cache->flights[flight_bucket(cache, key)];
+    
+    while (task && !key_equal(&task->cache_key, key)) {
+        task = task->flight_next;
+    }
+    
+    if (task && task_is_completed(task)) {
+        flight_remove(cache, task);
+        *finished = task;
+        return NULL;
+    }
+    
+    return task;
+}
+
+/**
+ * 提交能否合并到领头任务上：带完成回调的提交需要自己的回调被执行；
+ * 合并后沿用领头任务的优先级和超时，更高的优先级或不同的超时得不到满足
+ */
+static bool flight_joinable(const task_internal_t* leader, const task_internal_t* task) {
+    return !task->desc.callback &&
+           task->desc.priority <= leader->desc.priority &&
+           task->desc.timeout_ms == leader->desc.timeout_ms;
+}
+
+/**
+ * 为可缓存的任务计算缓存键，依次查找结果缓存和在途任务表。
+ * 命中结果缓存时以缓存的结果完成任务(完成回调在调用线程中执行)；
+ * 合并到在途任务时通过leader返回该任务的一个引用，本任务不需要执行；
+ * 未命中时本任务登记为领头任务。
+ */
+result_cache_lookup_t result_cache_lookup(process_pool_t* pool, task_internal_t* task,
+                                          task_internal_t** leader) {
+    result_cache_t* cache = pool->result_cache;
+    if (!cache || !task->desc.cacheable) {
+        return RESULT_CACHE_MISS;
+    }
+    
+    // 处理函数在fork后地址一致，地址即可标识处理函数
+    task_handler_t handler = task->desc.handler ? task->desc.handler : pool->config.default_handler;
+    result_cache_key_t* key = &task->cache_key;
+    key->handler = (uint64_t)(uintptr_t)handler;
+    key->input_size = task->input_size;
+    siphash128(task->input_data, task->input_size, cache->sip_key, key->hash);
+    task->cache_key_valid = true;
+    
+    task_internal_t* finished = NULL;
+    result_cache_lookup_t outcome = RESULT_CACHE_MISS;
+    bool hit = false;
+    
+    pthread_mutex_lock(&cache->mutex);
+    
+    result_cache_entry_t* entry = cache_find(cache, key);
+    if (entry) {
+        lru_unlink(cache, entry);
+        lru_push_front(cache, entry);
+        cache->hits++;
+        
+        // 结果在持锁时复制，避免条目被并发淘汰
+        hit = task_set_result(task, entry->data, entry->size) == POOL_SUCCESS;
+    } else if (cache->capacity > 0) {
+        cache->misses++;
+    }
+    
+    if (!hit && cache->single_flight) {
+        task_internal_t* existing = flight_find(cache, key, &finished);
+        
+        if (existing && flight_joinable(existing, task)) {
+            task_ref(existing);
+            ATOMIC_ADD(&existing->flight_sharers, 1);
+            cache->joins++;
+            *leader = existing;
+            outcome = RESULT_CACHE_JOINED;
+        } else if (!existing) {
+            task_ref(task);
+            ATOMIC_STORE(&task->flight_sharers, 1);
+            task->flight = cache;
+            task->flight_next = cache->flights[flight_bucket(cache, key)];
+            cache->flights[flight_bucket(cache, key)] = task;
+            cache->flight_count++;
+        }
+    }
+    
+    pthread_mutex_unlock(&cache->mutex);
+    
+    if (finished) {
+        task_unref(finished);
+    }
+    
+    if (hit) {
+        task->start_time_ns = task->submit_time_ns;
+        task->end_time_ns = task->submit_time_ns;
+        task_complete(task, TASK_STATE_COMPLETED);
+        return RESULT_CACHE_HIT;
+    }
+    
+    return outcome;
+}
+
+/**
+ * 领头任务到达终态后从在途任务表注销，之后相同的提交重新执行或命中结果缓存
+ */
+void result_cache_flight_done(task_internal_t* task) {
+    result_cache_t* cache = task->flight;
+    if (!cache) {
+        return;
+    }
+    
+    pthread_mutex_lock(&cache->mutex);
+    bool removed = flight_remove(cache, task);
+    pthread_mutex_unlock(&cache->mutex);
+    
+    if (removed) {
+        task_unref(task);
+    }
+}
+
+/**
+ * 缓存成功完成的任务的结果，由事件循环线程调用
+ */
+void result_cache_store(process_pool_t* pool, const task_internal_t* task) {
+    result_cache_t* cache = pool->result_cache;
+    // 缓存条目只保存字节，结果带描述符的任务不缓存
+    if (!cache || !task->cache_key_valid || cache->capacity == 0 ||
+        task->result.output_region.fd >= 0) {
+        return;
+    }
+    
+    size_t size = task->result.output_size;
+    size_t cost = entry_cost(size);
+    
+    // 单个结果超过容量的1/8时不缓存，避免一条结果冲掉整个缓存
+    if (cost > cache->capacity / 8) {
+        return;
+    }
+    
+    result_cache_entry_t* entry = malloc(sizeof(result_cache_entry_t));
+    void* data = size > 0 ? malloc(size) : NULL;
+    if (!entry || (size > 0 && !data)) {
+        free(entry);
+        free(data);
+        return;
+    }
+    
+    if (size > 0) {
+        memcpy(data, task->result.output_data, size);
+    }
+    
+    memset(entry, 0, sizeof(result_cache_entry_t));
+    entry->key = task->cache_key;
+    entry->data = data;
+    entry->size = size;
+    
+    pthread_mutex_lock(&cache->mutex);
+    
+    // 相同输入的多个任务同时未命中时只保留先写入的结果
+    result_cache_entry_t* existing = cache_find(cache, &entry->key);
+    if (existing) {
+        lru_unlink(cache, existing);
+        lru_push_front(cache, existing);
+        pthread_mutex_unlock(&cache->mutex);
+        free(data);
+        free(entry);
+        return;
+    }
+    
+    while (cache->bytes + cost > cache->capacity && cache->lru_tail) {
+        cache_remove(cache, cache->lru_tail);
+        cache->evictions++;
+    }
+    
+    if (cache->entries >= cache->bucket_mask + 1) {
+        cache_grow(cache);
+    }
+    
+    uint32_t bucket = key_bucket(cache, &entry->key);
+    entry->hash_next = cache->buckets[bucket];
+    cache->buckets[bucket] = entry;
+    lru_push_front(cache, entry);
+    cache->entries++;
+    cache->bytes += cost;
+    
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+/**
+ * 把缓存计数写入统计信息，调用方持有stats_mutex
+ */
+void result_cache_get_stats(result_cache_t* cache, pool_stats_t* stats) {
+    if (!cache) {
+        return;
+    }
+    
+    pthread_mutex_lock(&cache->mutex);
+    stats->result_cache_hits = cache->hits;
+    stats->result_cache_misses = cache->misses;
+    stats->result_cache_evictions = cache->evictions;
+    stats->result_cache_bytes = cache->bytes;
+    stats->result_cache_entries = cache->entries;
+    stats->single_flight_joins = cache->joins;
+    stats->single_flight_inflight = cache->flight_count;
+    pthread_mutex_unlock(&cache->mutex);
+}
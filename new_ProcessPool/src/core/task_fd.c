@@ -0,0 +1,508 @@
+#define _GNU_SOURCE
+#include "../../include/internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+// ============================================================================
+// 以描述符传递的输入输出
+// ============================================================================
+
+/**
+ * 大块输入输出不经过共享内存环：记录中只写区域的偏移和长度(shm_fd_region_t)，
+ * 描述符本身经每个Worker专属的SEQPACKET套接字以SCM_RIGHTS传递，每条消息
+ * 带任务ID。Master在提交记录之前发送输入描述符，Worker在提交完成记录之前
+ * 发送结果描述符，对端看到记录时消息已在套接字中。
+ *
+ * 这类任务不允许被窃取，输入描述符只发给属主；紧急任务插队时Worker先收到的
+ * 消息可能属于排在后面的任务，暂存到执行该任务时再取用。
+ *
+ * 接受任意可读的普通文件。以F_SEAL_SHRINK和F_SEAL_WRITE封印的memfd既不会被
+ * 截断也不会被改写，Worker直接只读映射(零拷贝)；其他文件映射后被截断，访问
+ * 映射会收到SIGBUS，因此Worker以pread把区域复制到私有缓冲区，读到的长度
+ * 不足(文件已被截断)时任务失败。复制期间文件被改写时读到的内容不确定。
+ */
+
+// Worker暂存的未执行任务描述符数上限：提交环中未消费的记录数小于任务表大小，
+// 先于当前任务到达的消息不会更多，暂存永远不会溢出
+#define WORKER_FD_STASH SHM_STEAL_SLOTS
+
+// 区域所在文件必须具有的封印
+#define FD_REQUIRED_SEALS (F_SEAL_SHRINK | F_SEAL_WRITE)
+
+// 套接字消息，描述符作为SCM_RIGHTS附带
+typedef struct {
+    uint64_t task_id;                   // 描述符所属的任务
+} fd_message_t;
+
+/**
+ * 文件是否已封印，不会被截断或改写(不支持封印的文件F_GET_SEALS失败)
+ */
+static bool fd_is_sealed(int fd) {
+    int seals = fcntl(fd, F_GET_SEALS);
+    return seals != -1 && (seals & FD_REQUIRED_SEALS) == FD_REQUIRED_SEALS;
+}
+
+/**
+ * 检查区域：描述符可读、是普通文件且区域在文件当前范围内
+ */
+static pool_error_t fd_region_check(int fd, uint64_t offset, size_t length) {
+    if (fd < 0 || length == 0 || offset + length < offset) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    int flags = fcntl(fd, F_GETFL);
+    if (flags == -1 || (flags & O_ACCMODE) == O_WRONLY) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) ||
+        offset + length > (uint64_t)st.st_size) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    return POOL_SUCCESS;
+}
+
+static int fd_dup(int fd) {
+    return fcntl(fd, F_DUPFD_CLOEXEC, 0);
+}
+
+bool task_fd_send(int sock, uint64_t task_id, int fd) {
+    fd_message_t body = { .task_id = task_id };
+    char control[CMSG_SPACE(sizeof(int))];
+    memset(control, 0, sizeof(control));
+    struct iovec iov = { .iov_base = &body, .iov_len = sizeof(body) };
+    struct msghdr msg;
+    
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    
+    ssize_t n;
+    do {
+        n = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (n == -1 && errno == EINTR);
+    
+    return n == (ssize_t)sizeof(body);
+}
+
+/**
+ * 不等待地接收一条消息，格式不对的消息*fd为-1
+ * @return 套接字中没有消息时返回false
+ */
+static bool fd_recv_message(int sock, uint64_t* task_id, int* fd) {
+    fd_message_t body = { .task_id = 0 };
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = { .iov_base = &body, .iov_len = sizeof(body) };
+    struct msghdr msg;
+    
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    
+    ssize_t n;
+    do {
+        n = recvmsg(sock, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    } while (n == -1 && errno == EINTR);
+    
+    if (n <= 0) {
+        return false;
+    }
+    
+    *fd = -1;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN(sizeof(int))) {
+            memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+            break;
+        }
+    }
+    
+    if (*fd >= 0 && (n != (ssize_t)sizeof(body) || (msg.msg_flags & MSG_CTRUNC))) {
+        close(*fd);
+        *fd = -1;
+    }
+    
+    *task_id = body.task_id;
+    return true;
+}
+
+// ============================================================================
+// Master侧
+// ============================================================================
+
+/**
+ * 检查输入区域并为任务复制一份描述符，任务销毁时关闭
+ */
+pool_error_t task_fd_attach_input(task_internal_t* task, const pool_fd_region_t* input) {
+    pool_error_t err = fd_region_check(input->fd, input->offset, input->length);
+    if (err != POOL_SUCCESS) {
+        return err;
+    }
+    
+    int fd = fd_dup(input->fd);
+    if (fd == -1) {
+        return POOL_ERROR_SYSTEM_CALL;
+    }
+    
+    task->input_region = *input;
+    task->input_region.fd = fd;
+    
+    return POOL_SUCCESS;
+}
+
+/**
+ * 从文件区域复制到memfd的指定偏移，内核不支持跨文件复制时退回pread/pwrite
+ */
+static bool fd_copy_region(int dst, uint64_t dst_offset, const pool_fd_region_t* src) {
+    loff_t in = (loff_t)src->offset;
+    loff_t out = (loff_t)dst_offset;
+    size_t left = src->length;
+    bool kernel_copy = true;
+    char buf[16 * 1024];
+    
+    while (left > 0) {
+        ssize_t n;
+        if (kernel_copy) {
+            n = copy_file_range(src->fd, &in, dst, &out, left, 0);
+            if (n == -1 && (errno == EXDEV || errno == EINVAL || errno == ENOSYS)) {
+                kernel_copy = false;
+                continue;
+            }
+        } else {
+            n = pread(src->fd, buf, left < sizeof(buf) ? left : sizeof(buf), in);
+            if (n > 0) {
+                if (pwrite(dst, buf, (size_t)n, out) != n) {
+                    return false;
+                }
+                in += n;
+                out += n;
+            }
+        }
+    
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        // 读到文件末尾说明源文件已被截断
+        if (n <= 0) {
+            return false;
+        }
+        left -= (size_t)n;
+    }
+    
+    return true;
+}
+
+/**
+ * 把各段依次拼接到新建的memfd中，封印后作为任务以描述符传递的输入，
+ * Worker随后零拷贝映射；段中的文件区域由内核直接复制，不经过用户态缓冲
+ */
+pool_error_t task_fd_attach_parts(task_internal_t* task, const task_fd_part_t* parts, uint32_t count) {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        total += parts[i].region.fd >= 0 ? parts[i].region.length : parts[i].size;
+    }
+    
+    if (total == 0) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    int fd = memfd_create("pool_task_input", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd == -1 || ftruncate(fd, (off_t)total) == -1) {
+        log_message(NULL, 1, "Task %lu: failed to create input file (%lu bytes): %s",
+                   task->task_id, total, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return POOL_ERROR_SYSTEM_CALL;
+    }
+    
+    uint64_t offset = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const task_fd_part_t* part = &parts[i];
+        bool ok;
+    
+        if (part->region.fd >= 0) {
+            ok = fd_copy_region(fd, offset, &part->region);
+            offset += part->region.length;
+        } else {
+            ok = part->size == 0 || pwrite(fd, part->data, part->size, (off_t)offset) == (ssize_t)part->size;
+            offset += part->size;
+        }
+    
+        if (!ok) {
+            log_message(NULL, 1, "Task %lu: failed to build input file: %s",
+                       task->task_id, strerror(errno));
+            close(fd);
+            return POOL_ERROR_SYSTEM_CALL;
+        }
+    }
+    
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == -1) {
+        close(fd);
+        return POOL_ERROR_SYSTEM_CALL;
+    }
+    
+    pool_fd_region_t region = { .fd = fd, .offset = 0, .length = (size_t)total };
+    pool_error_t err = task_fd_attach_input(task, &region);
+    close(fd);
+    return err;
+}
+
+/**
+ * 取Worker随完成记录发来的结果描述符(事件循环线程调用)
+ * Worker按完成顺序发送，与完成环中记录的顺序一致，不匹配的只可能是
+ * 损坏的消息，直接丢弃
+ * @return 描述符，没有收到返回-1
+ */
+int task_fd_recv(process_pool_t* pool, int sock, uint64_t task_id) {
+    uint64_t id;
+    int fd;
+    
+    while (fd_recv_message(sock, &id, &fd)) {
+        if (fd >= 0 && id == task_id) {
+            return fd;
+        }
+    
+        if (fd >= 0) {
+            close(fd);
+        }
+        log_message(pool, 1, "Dropping stray descriptor message for task %lu", id);
+    }
+    
+    return -1;
+}
+
+pool_error_t pool_future_get_fd(task_future_t* future, pool_fd_region_t* region) {
+    if (!future || !future->task || !region) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    task_internal_t* task = future->task;
+    if (ATOMIC_LOAD(&future->detached) || ATOMIC_LOAD(&task->state) != TASK_STATE_COMPLETED) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    pool_error_t err = POOL_ERROR_INVALID_PARAM;
+    
+    pthread_mutex_lock(&task->mutex);
+    
+    // 共享同一任务的多个future各自取得一份描述符
+    if (task->result.output_region.fd >= 0) {
+        *region = task->result.output_region;
+        region->fd = fd_dup(region->fd);
+        err = region->fd >= 0 ? POOL_SUCCESS : POOL_ERROR_SYSTEM_CALL;
+    }
+    
+    pthread_mutex_unlock(&task->mutex);
+    
+    return err;
+}
+
+// ============================================================================
+// Worker侧
+// ============================================================================
+
+// 提前收到、尚未执行到的任务的描述符(Worker进程私有，按到达顺序)
+static struct {
+    uint64_t task_id;
+    int fd;
+} g_fd_stash[WORKER_FD_STASH];
+static uint32_t g_fd_stash_count;
+
+// 当前任务输入的只读映射(已封印的memfd)或私有副本(其他文件)
+static void* g_input_map;
+static size_t g_input_map_size;
+static void* g_input_copy;
+
+// 处理函数以pool_task_output_fd设置的结果区域
+static pool_fd_region_t g_output_region = { .fd = -1 };
+
+static void worker_fd_stash_remove(uint32_t index) {
+    g_fd_stash_count--;
+    memmove(&g_fd_stash[index], &g_fd_stash[index + 1],
+            sizeof(g_fd_stash[0]) * (g_fd_stash_count - index));
+}
+
+/**
+ * 取任务的输入描述符：先查暂存，再读套接字，途中收到的其他任务的描述符暂存
+ * @return 描述符，没有收到返回-1
+ */
+static int worker_fd_take(int sock, uint64_t task_id) {
+    for (uint32_t i = 0; i < g_fd_stash_count; i++) {
+        if (g_fd_stash[i].task_id == task_id) {
+            int fd = g_fd_stash[i].fd;
+            worker_fd_stash_remove(i);
+            return fd;
+        }
+    }
+    
+    uint64_t id;
+    int fd;
+    
+    while (fd_recv_message(sock, &id, &fd)) {
+        if (fd < 0) {
+            continue;
+        }
+        if (id == task_id) {
+            return fd;
+        }
+    
+        // 只有消息损坏或重复时才会放不下
+        if (g_fd_stash_count == WORKER_FD_STASH) {
+            log_message(NULL, 1, "Descriptor stash full, dropping descriptor for task %lu", id);
+            close(fd);
+            continue;
+        }
+        g_fd_stash[g_fd_stash_count].task_id = id;
+        g_fd_stash[g_fd_stash_count].fd = fd;
+        g_fd_stash_count++;
+    }
+    
+    return -1;
+}
+
+/**
+ * 以pread把区域复制到私有缓冲区，文件被截断时读到的长度不足而不会收到SIGBUS
+ * @return 缓冲区，失败返回NULL
+ */
+static void* worker_fd_copy_input(int fd, uint64_t task_id, const shm_fd_region_t* region) {
+    char* buf = malloc((size_t)region->length);
+    if (!buf) {
+        log_message(NULL, 1, "Task %lu: failed to allocate input copy (%lu bytes)",
+                   task_id, region->length);
+        return NULL;
+    }
+    
+    size_t done = 0;
+    while (done < region->length) {
+        ssize_t n = pread(fd, buf + done, (size_t)region->length - done,
+                          (off_t)(region->offset + done));
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            log_message(NULL, 1, "Task %lu: input file shrank or failed to read: %s",
+                       task_id, n == 0 ? "unexpected end of file" : strerror(errno));
+            free(buf);
+            return NULL;
+        }
+        done += (size_t)n;
+    }
+    
+    return buf;
+}
+
+/**
+ * 取得SHM_RECORD_FD记录的输入区域：已封印的memfd只读映射，其他文件复制，
+ * 完成后即关闭描述符
+ * @return 区域起始地址，失败返回NULL
+ */
+const void* worker_fd_map_input(int sock, const shm_record_t* rec, size_t* size) {
+    *size = 0;
+    
+    if (rec->data_size < sizeof(shm_fd_region_t)) {
+        return NULL;
+    }
+    
+    const shm_fd_region_t* region = (const shm_fd_region_t*)SHM_RECORD_DATA(rec);
+    
+    int fd = worker_fd_take(sock, rec->task_id);
+    if (fd == -1) {
+        log_message(NULL, 1, "Task %lu: input descriptor not received", rec->task_id);
+        return NULL;
+    }
+    
+    if (!fd_is_sealed(fd)) {
+        g_input_copy = worker_fd_copy_input(fd, rec->task_id, region);
+        close(fd);
+        if (!g_input_copy) {
+            return NULL;
+        }
+        *size = (size_t)region->length;
+        return g_input_copy;
+    }
+    
+    // mmap的偏移须按页对齐，从区域所在页开始映射
+    uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t delta = region->offset % page;
+    size_t map_size = (size_t)(region->length + delta);
+    
+    void* addr = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, (off_t)(region->offset - delta));
+    close(fd);
+    
+    if (addr == MAP_FAILED) {
+        log_message(NULL, 1, "Task %lu: failed to map input (%lu bytes): %s",
+                   rec->task_id, region->length, strerror(errno));
+        return NULL;
+    }
+    
+    // 处理函数通常顺序扫描输入，让内核加大预读
+    madvise(addr, map_size, MADV_SEQUENTIAL);
+    
+    g_input_map = addr;
+    g_input_map_size = map_size;
+    *size = (size_t)region->length;
+    
+    return (const char*)addr + delta;
+}
+
+void worker_fd_unmap_input(void) {
+    if (g_input_map) {
+        munmap(g_input_map, g_input_map_size);
+        g_input_map = NULL;
+        g_input_map_size = 0;
+    }
+    
+    free(g_input_copy);
+    g_input_copy = NULL;
+}
+
+pool_error_t pool_task_output_fd(int fd, uint64_t offset, size_t length) {
+    pool_error_t err = fd_region_check(fd, offset, length);
+    if (err != POOL_SUCCESS) {
+        return err;
+    }
+    
+    int copy = fd_dup(fd);
+    if (copy == -1) {
+        return POOL_ERROR_SYSTEM_CALL;
+    }
+    
+    if (g_output_region.fd >= 0) {
+        close(g_output_region.fd);
+    }
+    
+    g_output_region.fd = copy;
+    g_output_region.offset = offset;
+    g_output_region.length = length;
+    
+    return POOL_SUCCESS;
+}
+
+/**
+ * 取出处理函数设置的结果区域，描述符转交调用方
+ * @return 设置过结果区域返回true
+ */
+bool worker_fd_take_output(pool_fd_region_t* region) {
+    *region = g_output_region;
+    g_output_region.fd = -1;
+    
+    return region->fd >= 0;
+}
@@ -0,0 +1,652 @@
+#define _GNU_SOURCE
+#include "../../include/internal.h"
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+
+// ============================================================================
+// 任务图
+// ============================================================================
+
+/**
+ * 任务图中每个节点对应一个普通任务。没有依赖的节点提交时直接入队；
+ * 其余节点创建后由任务图持有队列引用，最后一个依赖到达终态的线程
+ * 把依赖的输出拼接成节点的输入后入队，结果不经过提交线程。
+ *
+ * 节点的终态通知来自task_complete/task_cancel，可能在事件循环、Worker
+ * 回收或取消线程中执行，因此计数全部使用原子操作，只有任务图整体结束
+ * 时才加锁。任务图本身由句柄和"尚有节点未结束"各持有一个引用。
+ *
+ * 依赖失败时子节点随即结束，又会触发孙节点，终态通知按线程排队逐个处理，
+ * 深的依赖链不会加深调用栈。
+ */
+
+typedef struct {
+    task_internal_t* task;              // 节点任务(任务图持有一个引用)
+    void* input_data;                   // 节点自身的输入
+    size_t input_size;                  // 节点自身的输入大小
+    uint32_t* parents;                  // 依赖的节点下标
+    uint32_t parent_count;              // 依赖数量
+    uint32_t* children;                 // 依赖本节点的节点下标
+    uint32_t child_count;               // 被依赖数量
+    atomic_uint waiting_parents;        // 尚未结束的依赖数
+    atomic_bool parent_failed;          // 有依赖未成功完成
+    atomic_int parent_error;            // 未成功完成的依赖的错误码
+} graph_node_state_t;
+
+struct task_graph {
+    process_pool_t* pool;               // 所属进程池
+    graph_node_state_t* nodes;          // 节点
+    uint32_t* order;                    // 拓扑序
+    uint32_t count;                     // 节点数量
+    uint32_t* edges;                    // parents/children共用的存储
+    atomic_uint remaining;              // 尚未结束的节点数
+    atomic_int ref_count;               // 引用计数
+    uint64_t submit_time_ns;            // 提交时间
+    
+    pthread_mutex_t mutex;              // 保护以下字段
+    pthread_cond_t done_cond;           // 全部节点结束
+    bool done;                          // 全部节点已结束
+    pool_graph_timing_t timing;         // 执行时间(结束后有效)
+    uint32_t* critical_path;            // 关键路径，从根节点开始(结束后有效)
+};
+
+static void graph_unref(task_graph_t* graph) {
+    if (ATOMIC_SUB(&graph->ref_count, 1) > 1) {
+        return;
+    }
+    
+    for (uint32_t i = 0; graph->nodes && i < graph->count; i++) {
+        graph_node_state_t* node = &graph->nodes[i];
+        if (node->task) {
+            node->task->graph = NULL;
+            task_unref(node->task);
+        }
+        free(node->input_data);
+    }
+    
+    pthread_cond_destroy(&graph->done_cond);
+    pthread_mutex_destroy(&graph->mutex);
+    free(graph->critical_path);
+    free(graph->edges);
+    free(graph->order);
+    free(graph->nodes);
+    free(graph);
+}
+
+/**
+ * 按拓扑序计算每个节点的最早结束时间(依赖中最晚的一个加上自身执行时间)，
+ * 结束最晚的节点沿前驱回溯即为关键路径
+ */
+static void graph_compute_timing(task_graph_t* graph) {
+    uint64_t* finish = calloc(graph->count, sizeof(uint64_t));
+    uint32_t* pred = malloc(graph->count * sizeof(uint32_t));
+    pool_graph_timing_t* timing = &graph->timing;
+    uint64_t end_ns = graph->submit_time_ns;
+    
+    for (uint32_t i = 0; i < graph->count; i++) {
+        task_internal_t* task = graph->nodes[i].task;
+    
+        if (ATOMIC_LOAD(&task->state) == TASK_STATE_COMPLETED) {
+            timing->completed_nodes++;
+        } else {
+            timing->failed_nodes++;
+        }
+        if (task->end_time_ns > end_ns) {
+            end_ns = task->end_time_ns;
+        }
+    }
+    timing->wall_time_ns = end_ns - graph->submit_time_ns;
+    
+    if (!finish || !pred) {
+        free(finish);
+        free(pred);
+        return;
+    }
+    
+    uint32_t last = graph->order[0];
+    
+    for (uint32_t k = 0; k < graph->count; k++) {
+        uint32_t i = graph->order[k];
+        graph_node_state_t* node = &graph->nodes[i];
+        task_internal_t* task = node->task;
+    
+        // 未开始执行的节点不计执行时间
+        uint64_t duration = task->start_time_ns && task->end_time_ns > task->start_time_ns ?
+                            task->end_time_ns - task->start_time_ns : 0;
+    
+        pred[i] = UINT32_MAX;
+        for (uint32_t j = 0; j < node->parent_count; j++) {
+            uint32_t parent = node->parents[j];
+            if (pred[i] == UINT32_MAX || finish[parent] > finish[pred[i]]) {
+                pred[i] = parent;
+            }
+        }
+    
+        finish[i] = (pred[i] == UINT32_MAX ? 0 : finish[pred[i]]) + duration;
+        if (finish[i] > finish[last]) {
+            last = i;
+        }
+    }
+    
+    timing->critical_path_ns = finish[last];
+    
+    uint32_t length = 0;
+    for (uint32_t i = last; i != UINT32_MAX; i = pred[i]) {
+        length++;
+    }
+    
+    graph->critical_path = malloc(length * sizeof(uint32_t));
+    if (graph->critical_path) {
+        uint32_t pos = length;
+        for (uint32_t i = last; i != UINT32_MAX; i = pred[i]) {
+            graph->critical_path[--pos] = i;
+        }
+        timing->critical_path_nodes = length;
+    }
+    
+    free(finish);
+    free(pred);
+}
+
+/**
+ * 节点到达终态后计数，最后一个节点结束时计算执行时间并唤醒等待者
+ */
+static void graph_node_finished(task_graph_t* graph) {
+    if (ATOMIC_SUB(&graph->remaining, 1) > 1) {
+        return;
+    }
+    
+    pthread_mutex_lock(&graph->mutex);
+    graph_compute_timing(graph);
+    graph->done = true;
+    pthread_cond_broadcast(&graph->done_cond);
+    pthread_mutex_unlock(&graph->mutex);
+    
+    // 释放"尚有节点未结束"持有的引用
+    graph_unref(graph);
+}
+
+/**
+ * 把节点输入拼接到memfd中，以描述符交给Worker
+ */
+static pool_error_t graph_build_fd_input(task_graph_t* graph, graph_node_state_t* node) {
+    task_fd_part_t* parts = calloc(1 + 2 * (size_t)node->parent_count, sizeof(task_fd_part_t));
+    if (!parts) {
+        return POOL_ERROR_NO_MEMORY;
+    }
+    
+    uint32_t count = 0;
+    if (node->input_size > 0) {
+        parts[count++] = (task_fd_part_t){ .data = node->input_data, .size = node->input_size,
+                                           .region = { .fd = -1 } };
+    }
+    
+    for (uint32_t j = 0; j < node->parent_count; j++) {
+        task_internal_t* parent = graph->nodes[node->parents[j]].task;
+        if (parent->result.output_size > 0) {
+            parts[count++] = (task_fd_part_t){ .data = parent->result.output_data,
+                                               .size = parent->result.output_size,
+                                               .region = { .fd = -1 } };
+        }
+        if (parent->result.output_region.fd >= 0) {
+            parts[count++] = (task_fd_part_t){ .region = parent->result.output_region };
+        }
+    }
+    
+    pool_error_t err = task_fd_attach_parts(node->task, parts, count);
+    free(parts);
+    return err;
+}
+
+/**
+ * 节点输入为自身的输入加上各依赖节点的输出(常规输出在前，描述符结果在后)，
+ * 依赖均已成功完成，结果不再变化。
+ *
+ * 唯一的依赖只以描述符返回结果时，把描述符直接转交给节点，数据在Worker之间
+ * 传递而不经过Master；含有描述符结果或总量超过MAX_TASK_DATA_SIZE时拼接到
+ * memfd中以描述符传递；其余情况照常复制，经共享内存环发送
+ */
+static pool_error_t graph_build_input(task_graph_t* graph, graph_node_state_t* node) {
+    task_internal_t* task = node->task;
+    size_t size = node->input_size;
+    bool has_fd = false;
+    
+    for (uint32_t j = 0; j < node->parent_count; j++) {
+        task_internal_t* parent = graph->nodes[node->parents[j]].task;
+        size += parent->result.output_size;
+        has_fd |= parent->result.output_region.fd >= 0;
+    }
+    
+    if (has_fd || size > MAX_TASK_DATA_SIZE) {
+        pool_error_t err;
+        task_internal_t* parent = graph->nodes[node->parents[0]].task;
+        if (node->parent_count == 1 && size == 0) {
+            err = task_fd_attach_input(task, &parent->result.output_region);
+        } else {
+            err = graph_build_fd_input(graph, node);
+        }
+    
+        if (err == POOL_SUCCESS) {
+            free(task->input_data);
+            task->input_data = NULL;
+            task->input_size = 0;
+        }
+        return err;
+    }
+    
+    uint8_t* input = NULL;
+    if (size > 0) {
+        input = malloc(size);
+        if (!input) {
+            return POOL_ERROR_NO_MEMORY;
+        }
+    }
+    
+    size_t offset = 0;
+    if (node->input_size > 0) {
+        memcpy(input, node->input_data, node->input_size);
+        offset = node->input_size;
+    }
+    
+    for (uint32_t j = 0; j < node->parent_count; j++) {
+        task_internal_t* parent = graph->nodes[node->parents[j]].task;
+        if (parent->result.output_size > 0) {
+            memcpy(input + offset, parent->result.output_data, parent->result.output_size);
+            offset += parent->result.output_size;
+        }
+    }
+    
+    free(task->input_data);
+    task->input_data = input;
+    task->input_size = size;
+    return POOL_SUCCESS;
+}
+
+/**
+ * 任务队列为MPMC模式，可以在任意线程入队；队列满时唤醒事件循环让出一次CPU再试。
+ * 事件循环线程是队列唯一的消费者，在它上面释放的节点改挂延迟链表
+ */
+static pool_error_t graph_enqueue(process_pool_t* pool, task_internal_t* task) {
+    if (ATOMIC_LOAD(&pool->state) != POOL_STATE_RUNNING) {
+        return POOL_ERROR_SHUTDOWN;
+    }
+    
+    if (!event_loop_defer_task(task) && !queue_enqueue(pool->task_queue, task)) {
+        event_loop_notify_task_submit();
+        sched_yield();
+        if (!queue_enqueue(pool->task_queue, task)) {
+            return POOL_ERROR_QUEUE_FULL;
+        }
+    }
+    
+    stats_task_submitted(pool);
+    event_loop_notify_task_submit();
+    return POOL_SUCCESS;
+}
+
+/**
+ * 入队节点，队列引用随之转交给队列；无法入队时节点以失败结束
+ */
+static void graph_release_node(task_graph_t* graph, graph_node_state_t* node) {
+    task_internal_t* task = node->task;
+    
+    // 等待依赖期间已被单独取消
+    if (task_is_completed(task)) {
+        task_unref(task);
+        return;
+    }
+    
+    if (ATOMIC_LOAD(&node->parent_failed)) {
+        task_set_error(task, ATOMIC_LOAD(&node->parent_error), "Dependency did not complete");
+        task_complete(task, TASK_STATE_CANCELLED);
+        stats_task_cancelled(graph->pool);
+        task_unref(task);
+        return;
+    }
+    
+    pool_error_t err = node->parent_count > 0 ? graph_build_input(graph, node) : POOL_SUCCESS;
+    if (err == POOL_SUCCESS) {
+        // 排队等待时间和超时从入队开始计算
+        task->submit_time_ns = get_time_ns();
+        err = graph_enqueue(graph->pool, task);
+    }
+    
+    if (err != POOL_SUCCESS) {
+        task_set_error(task, err, "Failed to queue graph node");
+        task_complete(task, TASK_STATE_FAILED);
+        stats_task_failed(graph->pool);
+        task_unref(task);
+    }
+}
+
+/**
+ * 释放依赖已全部结束的子节点，然后为节点计数
+ */
+static void graph_node_done(task_internal_t* task) {
+    task_graph_t* graph = task->graph;
+    graph_node_state_t* node = &graph->nodes[task->graph_node];
+    bool completed = ATOMIC_LOAD(&task->state) == TASK_STATE_COMPLETED;
+    
+    // 子节点失败时只排入本线程的待处理链表，本节点计数前任务图不会被释放
+    for (uint32_t j = 0; j < node->child_count; j++) {
+        graph_node_state_t* child = &graph->nodes[node->children[j]];
+    
+        if (!completed) {
+            ATOMIC_STORE(&child->parent_error, task->result.error_code);
+            ATOMIC_STORE(&child->parent_failed, true);
+        }
+        if (ATOMIC_SUB(&child->waiting_parents, 1) == 1) {
+            graph_release_node(graph, child);
+        }
+    }
+    
+    graph_node_finished(graph);
+}
+
+// 本线程待处理的已结束节点；g_done_draining表示外层调用正在逐个处理
+static PROCESS_POOL_THREAD_LOCAL task_internal_t* g_done_nodes;
+static PROCESS_POOL_THREAD_LOCAL bool g_done_draining;
+
+/**
+ * 任务到达终态时由task_complete/task_cancel调用
+ * 处理节点期间结束的子节点排队，由最外层调用依次处理
+ */
+void task_graph_node_done(task_internal_t* task) {
+    if (!task->graph) {
+        return;
+    }
+    
+    task->graph_next = g_done_nodes;
+    g_done_nodes = task;
+    if (g_done_draining) {
+        return;
+    }
+    
+    g_done_draining = true;
+    while ((task = g_done_nodes) != NULL) {
+        g_done_nodes = task->graph_next;
+        task->graph_next = NULL;
+        graph_node_done(task);
+    }
+    g_done_draining = false;
+}
+
+// ============================================================================
+// 接口
+// ============================================================================
+
+/**
+ * 检查依赖下标并按Kahn算法求拓扑序，有环时返回false
+ */
+static bool graph_build_order(task_graph_t* graph) {
+    uint32_t* indegree = malloc(graph->count * sizeof(uint32_t));
+    if (!indegree) {
+        return false;
+    }
+    
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    
+    for (uint32_t i = 0; i < graph->count; i++) {
+        indegree[i] = graph->nodes[i].parent_count;
+        if (indegree[i] == 0) {
+            graph->order[tail++] = i;
+        }
+    }
+    
+    while (head < tail) {
+        graph_node_state_t* node = &graph->nodes[graph->order[head++]];
+        for (uint32_t j = 0; j < node->child_count; j++) {
+            uint32_t child = node->children[j];
+            if (--indegree[child] == 0) {
+                graph->order[tail++] = child;
+            }
+        }
+    }
+    
+    free(indegree);
+    return tail == graph->count;
+}
+
+/**
+ * 建立节点和双向依赖关系，任务创建后暂不入队
+ */
+static pool_error_t graph_init(task_graph_t* graph, const task_graph_node_t* nodes) {
+    uint32_t count = graph->count;
+    size_t edge_count = 0;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        const task_graph_node_t* desc = &nodes[i];
+    
+        if ((desc->input_size > 0 && !desc->input_data) ||
+            desc->input_size > MAX_TASK_DATA_SIZE ||
+            (desc->dep_count > 0 && !desc->deps) ||
+            (uint32_t)desc->desc.priority >= TASK_PRIORITY_COUNT || desc->desc.streaming) {
+            return POOL_ERROR_INVALID_PARAM;
+        }
+    
+        for (uint32_t j = 0; j < desc->dep_count; j++) {
+            if (desc->deps[j] >= count || desc->deps[j] == i) {
+                return POOL_ERROR_INVALID_PARAM;
+            }
+        }
+        edge_count += desc->dep_count;
+    }
+    
+    graph->edges = malloc((edge_count * 2 + 1) * sizeof(uint32_t));
+    if (!graph->edges) {
+        return POOL_ERROR_NO_MEMORY;
+    }
+    
+    // 前半段按节点顺序存放各自的依赖，后半段按被依赖数分段存放子节点
+    uint32_t* parents = graph->edges;
+    uint32_t* children = graph->edges + edge_count;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        graph_node_state_t* node = &graph->nodes[i];
+    
+        node->parents = parents;
+        node->parent_count = nodes[i].dep_count;
+        parents += nodes[i].dep_count;
+        
+        for (uint32_t j = 0; j < nodes[i].dep_count; j++) {
+            node->parents[j] = nodes[i].deps[j];
+            graph->nodes[nodes[i].deps[j]].child_count++;
+        }
+        ATOMIC_STORE(&node->waiting_parents, nodes[i].dep_count);
+        ATOMIC_STORE(&node->parent_failed, false);
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        graph->nodes[i].children = children;
+        children += graph->nodes[i].child_count;
+        graph->nodes[i].child_count = 0;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        for (uint32_t j = 0; j < nodes[i].dep_count; j++) {
+            graph_node_state_t* parent = &graph->nodes[nodes[i].deps[j]];
+            parent->children[parent->child_count++] = i;
+        }
+    }
+    
+    if (!graph_build_order(graph)) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        graph_node_state_t* node = &graph->nodes[i];
+        bool root = nodes[i].dep_count == 0;
+    
+        // 有依赖的节点另存自身的输入，入队前再和依赖的输出拼接
+        if (!root && nodes[i].input_size > 0) {
+            node->input_data = malloc(nodes[i].input_size);
+            if (!node->input_data) {
+                return POOL_ERROR_NO_MEMORY;
+            }
+            memcpy(node->input_data, nodes[i].input_data, nodes[i].input_size);
+            node->input_size = nodes[i].input_size;
+        }
+    
+        node->task = task_create(&nodes[i].desc,
+                                 root ? nodes[i].input_data : NULL,
+                                 root ? nodes[i].input_size : 0);
+        if (!node->task) {
+            return POOL_ERROR_NO_MEMORY;
+        }
+        node->task->graph = graph;
+        node->task->graph_node = i;
+    
+        // 除队列引用外任务图再持有一个，供取结果和计算执行时间
+        task_ref(node->task);
+    }
+    
+    return POOL_SUCCESS;
+}
+
+pool_error_t pool_submit_graph(process_pool_t* pool,
+                              const task_graph_node_t* nodes,
+                              uint32_t count,
+                              task_graph_t** graph) {
+    if (!pool || !nodes || count == 0 || !graph) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    *graph = NULL;
+    
+    if (ATOMIC_LOAD(&pool->state) != POOL_STATE_RUNNING) {
+        return POOL_ERROR_SHUTDOWN;
+    }
+    
+    task_graph_t* g = calloc(1, sizeof(task_graph_t));
+    if (!g) {
+        return POOL_ERROR_NO_MEMORY;
+    }
+    
+    g->pool = pool;
+    g->count = count;
+    g->submit_time_ns = get_time_ns();
+    g->nodes = calloc(count, sizeof(graph_node_state_t));
+    g->order = malloc(count * sizeof(uint32_t));
+    pthread_mutex_init(&g->mutex, NULL);
+    pthread_cond_init(&g->done_cond, NULL);
+    ATOMIC_STORE(&g->remaining, count);
+    ATOMIC_STORE(&g->ref_count, 1);
+    
+    pool_error_t err = g->nodes && g->order ? graph_init(g, nodes) : POOL_ERROR_NO_MEMORY;
+    if (err != POOL_SUCCESS) {
+        // 尚未入队的任务同时释放队列引用
+        for (uint32_t i = 0; g->nodes && i < count; i++) {
+            if (g->nodes[i].task) {
+                g->nodes[i].task->graph = NULL;
+                task_unref(g->nodes[i].task);
+            }
+        }
+        graph_unref(g);
+        return err;
+    }
+    
+    // 句柄和未结束的节点各持有一个引用
+    ATOMIC_STORE(&g->ref_count, 2);
+    
+    for (uint32_t i = 0; i < count; i++) {
+        if (nodes[i].dep_count == 0) {
+            graph_release_node(g, &g->nodes[i]);
+        }
+    }
+    
+    *graph = g;
+    return POOL_SUCCESS;
+}
+
+pool_error_t pool_graph_wait(task_graph_t* graph, uint32_t timeout_ms) {
+    if (!graph) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    pool_error_t result = POOL_SUCCESS;
+    
+    pthread_mutex_lock(&graph->mutex);
+    
+    if (timeout_ms == 0) {
+        while (!graph->done) {
+            pthread_cond_wait(&graph->done_cond, &graph->mutex);
+        }
+    } else {
+        struct timespec abs_timeout;
+        clock_gettime(CLOCK_REALTIME, &abs_timeout);
+    
+        abs_timeout.tv_sec += timeout_ms / 1000;
+        abs_timeout.tv_nsec += (timeout_ms % 1000) * 1000000;
+        if (abs_timeout.tv_nsec >= 1000000000) {
+            abs_timeout.tv_sec++;
+            abs_timeout.tv_nsec -= 1000000000;
+        }
+    
+        while (!graph->done) {
+            int ret = pthread_cond_timedwait(&graph->done_cond, &graph->mutex, &abs_timeout);
+            if (ret == ETIMEDOUT) {
+                result = POOL_ERROR_TIMEOUT;
+                break;
+            } else if (ret != 0) {
+                result = POOL_ERROR_SYSTEM_CALL;
+                break;
+            }
+        }
+    }
+    
+    pthread_mutex_unlock(&graph->mutex);
+    
+    return result;
+}
+
+task_future_t* pool_graph_node_future(task_graph_t* graph, uint32_t index) {
+    if (!graph || index >= graph->count) {
+        return NULL;
+    }
+    
+    task_internal_t* task = graph->nodes[index].task;
+    task_future_t* future = future_create(task);
+    if (future) {
+        future->task_id = task->task_id;
+        future->pool = graph->pool;
+    }
+    
+    return future;
+}
+
+pool_error_t pool_graph_get_timing(task_graph_t* graph,
+                                  pool_graph_timing_t* timing,
+                                  uint32_t* path,
+                                  uint32_t path_capacity) {
+    if (!graph || !timing) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    pthread_mutex_lock(&graph->mutex);
+    
+    if (!graph->done) {
+        pthread_mutex_unlock(&graph->mutex);
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    *timing = graph->timing;
+    if (path && graph->critical_path) {
+        uint32_t n = timing->critical_path_nodes < path_capacity ?
+                     timing->critical_path_nodes : path_capacity;
+        memcpy(path, graph->critical_path, n * sizeof(uint32_t));
+    }
+    
+    pthread_mutex_unlock(&graph->mutex);
+    
+    return POOL_SUCCESS;
+}
+
+void pool_graph_destroy(task_graph_t* graph) {
+    if (graph) {
+        graph_unref(graph);
+    }
+}
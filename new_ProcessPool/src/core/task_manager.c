@@ -1,8 +1,10 @@
+#define _GNU_SOURCE
 #include "../../include/internal.h"
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <pthread.h>
+#include <unistd.h>
 
 // ============================================================================
 // 任务ID生成器
@@ -41,6 +43,8 @@ static task_pool_t g_task_pool = {
     .max_pool_size = 1000
 };
 
+static void task_pool_free(task_internal_t* task);
+
 static task_internal_t* task_pool_alloc(void) {
     pthread_mutex_lock(&g_task_pool.mutex);
     
@@ -72,6 +76,54 @@ static task_internal_t* task_pool_alloc(void) {
     return &node->task;
 }
 
+/**
+ * 批量分配任务结构，整批只获取一次内存池锁
+ * @return 全部分配成功返回true，失败时已分配的结构被归还
+ */
+static bool task_pool_alloc_batch(task_internal_t** tasks, uint32_t count) {
+    uint32_t reused = 0;
+    
+    pthread_mutex_lock(&g_task_pool.mutex);
+    
+    while (reused < count && g_task_pool.free_list) {
+        task_pool_node_t* node = g_task_pool.free_list;
+        g_task_pool.free_list = node->next;
+        g_task_pool.free_count--;
+        tasks[reused++] = &node->task;
+    }
+    
+    pthread_mutex_unlock(&g_task_pool.mutex);
+    
+    // 空闲列表不足的部分在锁外分配
+    uint32_t allocated = reused;
+    while (allocated < count) {
+        task_pool_node_t* node = malloc(sizeof(task_pool_node_t));
+        if (!node) {
+            break;
+        }
+        tasks[allocated++] = &node->task;
+    }
+    
+    pthread_mutex_lock(&g_task_pool.mutex);
+    g_task_pool.total_allocated += allocated - reused;
+    pthread_mutex_unlock(&g_task_pool.mutex);
+    
+    if (allocated < count) {
+        for (uint32_t i = 0; i < allocated; i++) {
+            task_pool_free(tasks[i]);
+        }
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        task_pool_node_t* node = (task_pool_node_t*)((char*)tasks[i] - offsetof(task_pool_node_t, task));
+        memset(&node->task, 0, sizeof(task_internal_t));
+        node->next = NULL;
+    }
+    
+    return true;
+}
+
 static void task_pool_free(task_internal_t* task) {
     if (!task) return;
     
@@ -114,18 +166,13 @@ void task_pool_cleanup(void) {
 // 任务创建和销毁
 // ============================================================================
 
-task_internal_t* task_create(const task_desc_t* desc) {
-    if (!desc || !desc->handler) {
-        return NULL;
-    }
-    
-    task_internal_t* task = task_pool_alloc();
-    if (!task) {
-        return NULL;
-    }
-    
-    // 生成唯一任务ID
-    task->task_id = generate_task_id();
+/**
+ * 初始化刚从内存池取出的任务结构，失败时释放已分配的输入数据，
+ * 任务结构本身由调用方归还
+ */
+static bool task_init(task_internal_t* task, uint64_t task_id, const task_desc_t* desc,
+                      const void* input_data, size_t input_size, uint64_t submit_time_ns) {
+    task->task_id = task_id;
     
     // 复制任务描述
     task->desc = *desc;
@@ -135,7 +182,7 @@ task_internal_t* task_create(const task_desc_t* desc) {
     ATOMIC_STORE(&task->worker_id, UINT32_MAX);
     
     // 初始化时间戳
-    task->submit_time_ns = get_time_ns();
+    task->submit_time_ns = submit_time_ns;
     task->start_time_ns = 0;
     task->end_time_ns = 0;
     
@@ -147,16 +194,17 @@ task_internal_t* task_create(const task_desc_t* desc) {
     task->result.error_message = NULL;
     task->result.output_data = NULL;
     task->result.output_size = 0;
+    task->result.output_region.fd = -1;
+    task->input_region.fd = -1;
     
     // 复制输入数据
-    if (desc->input_data && desc->input_size > 0) {
-        task->input_data = malloc(desc->input_size);
+    if (input_data && input_size > 0) {
+        task->input_data = malloc(input_size);
         if (!task->input_data) {
-            task_pool_free(task);
-            return NULL;
+            return false;
         }
-        memcpy(task->input_data, desc->input_data, desc->input_size);
-        task->input_size = desc->input_size;
+        memcpy(task->input_data, input_data, input_size);
+        task->input_size = input_size;
     } else {
         task->input_data = NULL;
         task->input_size = 0;
@@ -167,8 +215,7 @@ task_internal_t* task_create(const task_desc_t* desc) {
         if (task->input_data) {
             free(task->input_data);
         }
-        task_pool_free(task);
-        return NULL;
+        return false;
     }
     
     if (pthread_cond_init(&task->completion_cond, NULL) != 0) {
@@ -176,6 +223,24 @@ task_internal_t* task_create(const task_desc_t* desc) {
         if (task->input_data) {
             free(task->input_data);
         }
+        return false;
+    }
+    
+    return true;
+}
+
+task_internal_t* task_create(const task_desc_t* desc, const void* input_data, size_t input_size) {
+    if (!desc || (input_size > 0 && !input_data)) {
+        return NULL;
+    }
+    
+    task_internal_t* task = task_pool_alloc();
+    if (!task) {
+        return NULL;
+    }
+    
+    // 生成唯一任务ID
+    if (!task_init(task, generate_task_id(), desc, input_data, input_size, get_time_ns())) {
         task_pool_free(task);
         return NULL;
     }
@@ -183,6 +248,45 @@ task_internal_t* task_create(const task_desc_t* desc) {
     return task;
 }
 
+/**
+ * 批量创建任务：一次获取内存池锁、一次分配连续的任务ID、共用同一个提交时间
+ * input_data/input_sizes可以为NULL，表示所有任务都没有输入
+ * @return 全部创建成功返回true，否则不创建任何任务
+ */
+bool task_create_batch(const task_desc_t* descs, const void** input_data,
+                       const size_t* input_sizes, uint32_t count,
+                       task_internal_t** tasks) {
+    if (!descs || !tasks || count == 0) {
+        return false;
+    }
+    
+    if (!task_pool_alloc_batch(tasks, count)) {
+        return false;
+    }
+    
+    uint64_t first_id = ATOMIC_ADD(&g_next_task_id, count);
+    uint64_t now = get_time_ns();
+    
+    for (uint32_t i = 0; i < count; i++) {
+        const void* data = input_data ? input_data[i] : NULL;
+        size_t size = input_sizes ? input_sizes[i] : 0;
+        
+        if ((size > 0 && !data) ||
+            !task_init(tasks[i], first_id + i, &descs[i], data, size, now)) {
+            // 已初始化的任务正常销毁，其余直接归还内存池
+            for (uint32_t j = 0; j < i; j++) {
+                task_destroy(tasks[j]);
+            }
+            for (uint32_t j = i; j < count; j++) {
+                task_pool_free(tasks[j]);
+            }
+            return false;
+        }
+    }
+    
+    return true;
+}
+
 void task_destroy(task_internal_t* task) {
     if (!task) return;
     
@@ -209,6 +313,17 @@ void task_destroy(task_internal_t* task) {
         task->result.error_message = NULL;
     }
     
+    // 关闭以描述符传递的输入和结果
+    if (task->input_region.fd >= 0) {
+        close(task->input_region.fd);
+        task->input_region.fd = -1;
+    }
+    
+    if (task->result.output_region.fd >= 0) {
+        close(task->result.output_region.fd);
+        task->result.output_region.fd = -1;
+    }
+    
     // 销毁同步原语
     pthread_mutex_destroy(&task->mutex);
     pthread_cond_destroy(&task->completion_cond);
@@ -239,6 +354,7 @@ bool task_is_completed(task_internal_t* task) {
     task_state_t state = ATOMIC_LOAD(&task->state);
     return (state == TASK_STATE_COMPLETED || 
             state == TASK_STATE_FAILED || 
+            state == TASK_STATE_TIMEOUT ||
             state == TASK_STATE_CANCELLED);
 }
 
@@ -248,6 +364,89 @@ bool task_is_running(task_internal_t* task) {
     return ATOMIC_LOAD(&task->state) == TASK_STATE_RUNNING;
 }
 
+/**
+ * 任务到达终态后的收尾，在任务锁外执行：领头任务不再接受合并，
+ * 任务图中依赖本任务的节点可能随之入队
+ */
+static void task_finished(task_internal_t* task) {
+    result_cache_flight_done(task);
+    task_graph_node_done(task);
+}
+
+/**
+ * 设置终态并唤醒等待的线程，不执行回调
+ * @return 任务此前已是终态返回false
+ */
+static bool task_publish_state(task_internal_t* task, task_state_t state) {
+    pthread_mutex_lock(&task->mutex);
+    
+    if (task_is_completed(task)) {
+        pthread_mutex_unlock(&task->mutex);
+        return false;
+    }
+    
+    ATOMIC_STORE(&task->state, state);
+    if (task->end_time_ns == 0) {
+        task->end_time_ns = get_time_ns();
+    }
+    
+    // 通知等待的线程
+    pthread_cond_broadcast(&task->completion_cond);
+    
+    pthread_mutex_unlock(&task->mutex);
+    
+    task_finished(task);
+    return true;
+}
+
+static void task_run_callback(task_internal_t* task, task_state_t state) {
+    if (task->desc.callback) {
+        task->desc.callback(task->task_id, state,
+                            task->result.output_data, task->result.output_size,
+                            task->desc.callback_data);
+    }
+}
+
+/**
+ * 设置任务终态并唤醒等待者
+ * 结果或错误信息需先通过task_set_result/task_set_error写入；
+ * 已处于终态(例如已被取消)的任务保持原状态
+ */
+void task_complete(task_internal_t* task, task_state_t state) {
+    if (!task) return;
+    
+    // 在锁外执行完成回调
+    if (task_publish_state(task, state)) {
+        task_run_callback(task, state);
+    }
+}
+
+/**
+ * 批量完成任务：先发布整批终态、唤醒全部等待者，再依次执行完成回调，
+ * 排在后面的任务的等待者不必等前面任务的回调执行完
+ */
+void task_complete_batch(task_internal_t** tasks, const task_state_t* states, uint32_t count) {
+    if (!tasks || !states) return;
+    
+    // 按64个一组用位图记录本次完成的任务
+    for (uint32_t base = 0; base < count; base += 64) {
+        uint32_t n = count - base < 64 ? count - base : 64;
+        uint64_t published = 0;
+        
+        for (uint32_t i = 0; i < n; i++) {
+            if (task_publish_state(tasks[base + i], states[base + i])) {
+                published |= 1ULL << i;
+            }
+        }
+        
+        for (uint32_t i = 0; i < n; i++) {
+            if (published & (1ULL << i)) {
+                task_run_callback(tasks[base + i], states[base + i]);
+            }
+        }
+    }
+}
+
 pool_error_t task_cancel(task_internal_t* task) {
     if (!task) {
         return POOL_ERROR_INVALID_PARAM;
@@ -266,6 +465,7 @@ pool_error_t task_cancel(task_internal_t* task) {
         pthread_cond_broadcast(&task->completion_cond);
         
         pthread_mutex_unlock(&task->mutex);
+        task_finished(task);
         return POOL_SUCCESS;
     } else if (current_state == TASK_STATE_RUNNING) {
         // 任务正在运行，标记为取消请求
@@ -277,6 +477,7 @@ pool_error_t task_cancel(task_internal_t* task) {
         pthread_cond_broadcast(&task->completion_cond);
         
         pthread_mutex_unlock(&task->mutex);
+        task_finished(task);
         return POOL_SUCCESS;
     } else {
         // 任务已完成，无法取消
@@ -360,7 +561,7 @@ pool_error_t task_set_result(task_internal_t* task,
         task->result.output_data = malloc(output_size);
         if (!task->result.output_data) {
             pthread_mutex_unlock(&task->mutex);
-            return POOL_ERROR_OUT_OF_MEMORY;
+            return POOL_ERROR_NO_MEMORY;
         }
         
         memcpy(task->result.output_data, output_data, output_size);
@@ -374,6 +575,20 @@ pool_error_t task_set_result(task_internal_t* task,
     return POOL_SUCCESS;
 }
 
+/**
+ * 设置以描述符返回的结果区域，任务接管描述符
+ */
+void task_set_result_fd(task_internal_t* task, const pool_fd_region_t* region) {
+    pthread_mutex_lock(&task->mutex);
+    
+    if (task->result.output_region.fd >= 0) {
+        close(task->result.output_region.fd);
+    }
+    task->result.output_region = *region;
+    
+    pthread_mutex_unlock(&task->mutex);
+}
+
 pool_error_t task_set_error(task_internal_t* task, 
                            int error_code, 
                            const char* error_message) {
@@ -414,57 +629,53 @@ pool_error_t task_get_result(task_internal_t* task, task_result_t* result) {
         return POOL_ERROR_INVALID_PARAM;
     }
     
+    pool_error_t err = POOL_SUCCESS;
+    
+    memset(result, 0, sizeof(task_result_t));
+    
     pthread_mutex_lock(&task->mutex);
     
-    // 复制结果
+    result->task_id = task->task_id;
+    result->state = ATOMIC_LOAD(&task->state);
     result->error_code = task->result.error_code;
     
-    // 复制输出数据
-    if (task->result.output_data && task->result.output_size > 0) {
-        result->output_data = malloc(task->result.output_size);
-        if (!result->output_data) {
-            pthread_mutex_unlock(&task->mutex);
-            return POOL_ERROR_OUT_OF_MEMORY;
-        }
-        
-        memcpy(result->output_data, task->result.output_data, task->result.output_size);
-        result->output_size = task->result.output_size;
-    } else {
-        result->output_data = NULL;
-        result->output_size = 0;
-    }
-    
     // 复制错误消息
     if (task->result.error_message) {
-        size_t msg_len = strlen(task->result.error_message) + 1;
-        result->error_message = malloc(msg_len);
-        if (result->error_message) {
-            strcpy(result->error_message, task->result.error_message);
+        strncpy(result->error_message, task->result.error_message,
+                sizeof(result->error_message) - 1);
+    }
+    
+    // 复制输出数据，由task_result_cleanup释放
+    if (task->result.output_data && task->result.output_size > 0) {
+        result->result_data = malloc(task->result.output_size);
+        if (result->result_data) {
+            memcpy(result->result_data, task->result.output_data, task->result.output_size);
+            result->result_size = task->result.output_size;
+        } else {
+            err = POOL_ERROR_NO_MEMORY;
         }
-    } else {
-        result->error_message = NULL;
     }
     
+    result->start_time_ns = task->start_time_ns;
+    result->end_time_ns = task->end_time_ns;
+    result->worker_id = ATOMIC_LOAD(&task->worker_id);
+    
     pthread_mutex_unlock(&task->mutex);
     
-    return POOL_SUCCESS;
+    return err;
 }
 
 void task_result_cleanup(task_result_t* result) {
     if (!result) return;
     
-    if (result->output_data) {
-        free(result->output_data);
-        result->output_data = NULL;
-    }
-    
-    if (result->error_message) {
-        free(result->error_message);
-        result->error_message = NULL;
+    if (result->result_data) {
+        free(result->result_data);
+        result->result_data = NULL;
     }
     
-    result->output_size = 0;
+    result->result_size = 0;
     result->error_code = 0;
+    result->error_message[0] = '\0';
 }
 
 // ============================================================================
@@ -485,6 +696,7 @@ task_future_t* future_create(task_internal_t* task) {
     task_ref(task); // 增加任务引用计数
     
     ATOMIC_STORE(&future->ref_count, 1);
+    ATOMIC_STORE(&future->detached, false);
     
     if (pthread_mutex_init(&future->mutex, NULL) != 0) {
         task_unref(task);
@@ -0,0 +1,348 @@
+#define _GNU_SOURCE
+#include "../../include/internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+// ============================================================================
+// 流式任务
+// ============================================================================
+
+/**
+ * 流式任务的输入输出经由执行它的Worker段内的流通道传递(见shm_stream_t)。
+ * 流式任务不会被窃取，分发后执行者就是task->worker_id记录的Worker；任务被
+ * 收回重新分发时worker_id随之改变，调用方每次等待后重新定位通道。
+ *
+ * 所有等待都按STREAM_WAIT_SLICE_MS分片，醒来后检查任务是否已经结束
+ * (Master侧)或已被取消(Worker侧)，对端进程退出时不会永久阻塞。
+ */
+
+#define STREAM_WAIT_SLICE_MS 50
+
+struct task_stream {
+    process_pool_t* pool;               // 所属进程池
+    task_future_t* future;              // 任务future(由流句柄持有)
+    task_internal_t* task;              // 任务(future持有引用)
+    bool input_closed;                  // 已调用pool_stream_close
+    bool output_done;                   // 已读到输出结束
+};
+
+task_stream_t* task_stream_create(process_pool_t* pool, task_future_t* future) {
+    task_stream_t* stream = calloc(1, sizeof(task_stream_t));
+    if (!stream) {
+        return NULL;
+    }
+    
+    stream->pool = pool;
+    stream->future = future;
+    stream->task = future->task;
+    
+    return stream;
+}
+
+// ============================================================================
+// Master侧
+// ============================================================================
+
+/**
+ * 定位执行任务的Worker的流通道，任务尚未分发(或已被收回等待重新分发)时返回NULL
+ * 分发时先写worker_id再置RUNNING，看到RUNNING后读到的worker_id是已放置的Worker
+ */
+static shm_stream_t* stream_channel(task_stream_t* stream) {
+    if (ATOMIC_LOAD(&stream->task->state) != TASK_STATE_RUNNING) {
+        return NULL;
+    }
+    uint32_t worker_id = ATOMIC_LOAD(&stream->task->worker_id);
+    
+    shared_memory_t* shm = shm_arena_segment(&stream->pool->shm_arena, worker_id);
+    if (!shm || shm->magic != SHM_MAGIC) {
+        return NULL;
+    }
+    
+    return &shm->stream;
+}
+
+/**
+ * 通道属于本任务时登记master_busy并返回通道，Worker释放通道前等待登记归零，
+ * 登记期间管道不会被下一个任务重置
+ */
+static shm_stream_t* stream_attach(shm_stream_t* channel, uint64_t task_id) {
+    if (!channel) {
+        return NULL;
+    }
+    
+    ATOMIC_ADD(&channel->master_busy, 1);
+    if (ATOMIC_LOAD(&channel->task_id) != task_id) {
+        ATOMIC_SUB(&channel->master_busy, 1);
+        return NULL;
+    }
+    
+    return channel;
+}
+
+static void stream_detach(shm_stream_t* channel) {
+    // Worker重启会清零整个段，不能减到负数
+    unsigned int busy = ATOMIC_LOAD(&channel->master_busy);
+    while (busy > 0 && !ATOMIC_CAS(&channel->master_busy, &busy, busy - 1)) {
+    }
+}
+
+/**
+ * 等待一个分片：通道已确定时在管道上等待，否则任务还在排队，短暂休眠后重试
+ * @return 超过截止时间返回false
+ */
+static bool stream_wait(shm_pipe_t* pipe, uint32_t seq, uint64_t deadline_ns) {
+    uint64_t now = get_time_ns();
+    if (deadline_ns && now >= deadline_ns) {
+        return false;
+    }
+    
+    uint32_t slice_ms = STREAM_WAIT_SLICE_MS;
+    if (deadline_ns && deadline_ns - now < (uint64_t)slice_ms * 1000000ULL) {
+        slice_ms = (uint32_t)((deadline_ns - now + 999999ULL) / 1000000ULL);
+    }
+    
+    if (pipe) {
+        shm_pipe_wait(pipe, seq, slice_ms);
+    } else {
+        struct timespec ts = { 0, 1000000L };
+        nanosleep(&ts, NULL);
+    }
+    
+    return true;
+}
+
+static uint64_t stream_deadline(uint32_t timeout_ms) {
+    return timeout_ms ? get_time_ns() + (uint64_t)timeout_ms * 1000000ULL : 0;
+}
+
+pool_error_t pool_stream_write(task_stream_t* stream, const void* data, size_t size,
+                              uint32_t timeout_ms) {
+    if (!stream || (size > 0 && !data) || stream->input_closed) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    const char* p = (const char*)data;
+    uint64_t deadline_ns = stream_deadline(timeout_ms);
+    
+    while (size > 0) {
+        if (task_is_completed(stream->task)) {
+            return POOL_ERROR_STREAM_CLOSED;
+        }
+    
+        shm_stream_t* channel = stream_channel(stream);
+        shm_pipe_t* pipe = channel ? &channel->input : NULL;
+        uint32_t seq = pipe ? ATOMIC_LOAD(&pipe->seq) : 0;
+    
+        if (stream_attach(channel, stream->task->task_id)) {
+            if (ATOMIC_LOAD(&pipe->abandoned)) {
+                stream_detach(channel);
+                return POOL_ERROR_STREAM_CLOSED;
+            }
+    
+            size_t n = shm_pipe_write(pipe, p, size);
+            stream_detach(channel);
+    
+            p += n;
+            size -= n;
+            if (n > 0) {
+                continue;
+            }
+        }
+    
+        if (!stream_wait(pipe, seq, deadline_ns)) {
+            return POOL_ERROR_TIMEOUT;
+        }
+    }
+    
+    return POOL_SUCCESS;
+}
+
+pool_error_t pool_stream_close(task_stream_t* stream) {
+    if (!stream) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    if (stream->input_closed) {
+        return POOL_SUCCESS;
+    }
+    
+    // 任务开始执行后通道才属于本任务，在此之前等待
+    while (!task_is_completed(stream->task)) {
+        shm_stream_t* channel = stream_channel(stream);
+        shm_pipe_t* pipe = channel ? &channel->input : NULL;
+        uint32_t seq = pipe ? ATOMIC_LOAD(&pipe->seq) : 0;
+    
+        if (stream_attach(channel, stream->task->task_id)) {
+            shm_pipe_close(pipe);
+            stream_detach(channel);
+            break;
+        }
+    
+        stream_wait(pipe, seq, 0);
+    }
+    
+    stream->input_closed = true;
+    return POOL_SUCCESS;
+}
+
+pool_error_t pool_stream_read(task_stream_t* stream, void* buffer, size_t size,
+                             size_t* bytes_read, uint32_t timeout_ms) {
+    if (!stream || !buffer || size == 0 || !bytes_read) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    *bytes_read = 0;
+    uint64_t deadline_ns = stream_deadline(timeout_ms);
+    
+    for (;;) {
+        shm_stream_t* channel = stream_channel(stream);
+        shm_pipe_t* pipe = channel ? &channel->output : NULL;
+        uint32_t seq = pipe ? ATOMIC_LOAD(&pipe->seq) : 0;
+    
+        if (stream_attach(channel, stream->task->task_id)) {
+            // 先读结束标志再读数据，看到结束且管道已空才是真正读完
+            bool closed = ATOMIC_LOAD(&pipe->closed);
+            size_t n = shm_pipe_read(pipe, buffer, size);
+            stream_detach(channel);
+    
+            if (n > 0 || closed) {
+                *bytes_read = n;
+                stream->output_done = n == 0;
+                return POOL_SUCCESS;
+            }
+        } else if (task_is_completed(stream->task)) {
+            // Worker在调用方取完输出(或放弃读取)之后才释放通道
+            return ATOMIC_LOAD(&stream->task->state) == TASK_STATE_COMPLETED ?
+                   POOL_SUCCESS : POOL_ERROR_STREAM_CLOSED;
+        }
+    
+        if (!stream_wait(pipe, seq, deadline_ns)) {
+            return POOL_ERROR_TIMEOUT;
+        }
+    }
+}
+
+task_future_t* pool_stream_future(task_stream_t* stream) {
+    return stream ? stream->future : NULL;
+}
+
+void pool_stream_destroy(task_stream_t* stream) {
+    if (!stream) {
+        return;
+    }
+    
+    // 不再读取输出；没有读完输出的任务随之取消，Worker不必等待调用方
+    shm_stream_t* channel = stream_attach(stream_channel(stream), stream->task->task_id);
+    if (channel) {
+        shm_pipe_abandon(&channel->output);
+        if (!stream->input_closed) {
+            shm_pipe_close(&channel->input);
+        }
+        stream_detach(channel);
+    }
+    
+    if (!stream->output_done && !task_is_completed(stream->task)) {
+        pool_future_cancel(stream->future);
+    }
+    
+    pool_future_destroy(stream->future);
+    free(stream);
+}
+
+// ============================================================================
+// Worker侧
+// ============================================================================
+
+// 正在执行的流式任务的通道(Worker进程私有)
+static shm_stream_t* g_stream;
+
+/**
+ * 开始执行流式任务，此后调用方才能读写通道
+ */
+void worker_stream_begin(shared_memory_t* shm, uint64_t task_id) {
+    shm_stream_open(&shm->stream, task_id);
+    g_stream = &shm->stream;
+}
+
+/**
+ * 处理函数返回后结束输出，等调用方取完输出(或放弃读取、任务被取消)
+ * 再释放通道。须在清除running_task_id之前调用，等待期间仍能收到取消
+ */
+void worker_stream_end(void) {
+    shm_stream_t* channel = g_stream;
+    if (!channel) {
+        return;
+    }
+    g_stream = NULL;
+    
+    shm_pipe_abandon(&channel->input);
+    shm_pipe_close(&channel->output);
+    
+    for (;;) {
+        uint32_t seq = ATOMIC_LOAD(&channel->output.seq);
+        if (shm_pipe_empty(&channel->output) || ATOMIC_LOAD(&channel->output.abandoned) ||
+            pool_task_is_cancelled()) {
+            break;
+        }
+        shm_pipe_wait(&channel->output, seq, STREAM_WAIT_SLICE_MS);
+    }
+    
+    ATOMIC_STORE(&channel->task_id, 0);
+    while (ATOMIC_LOAD(&channel->master_busy) > 0) {
+        sched_yield();
+    }
+}
+
+pool_error_t pool_task_stream_read(void* buffer, size_t size, size_t* bytes_read) {
+    if (!g_stream || !buffer || size == 0 || !bytes_read) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    shm_pipe_t* pipe = &g_stream->input;
+    *bytes_read = 0;
+    
+    for (;;) {
+        uint32_t seq = ATOMIC_LOAD(&pipe->seq);
+        bool closed = ATOMIC_LOAD(&pipe->closed);
+        size_t n = shm_pipe_read(pipe, buffer, size);
+    
+        if (n > 0 || closed) {
+            *bytes_read = n;
+            return POOL_SUCCESS;
+        }
+    
+        if (pool_task_is_cancelled()) {
+            return POOL_ERROR_STREAM_CLOSED;
+        }
+    
+        shm_pipe_wait(pipe, seq, STREAM_WAIT_SLICE_MS);
+    }
+}
+
+pool_error_t pool_task_stream_write(const void* data, size_t size) {
+    if (!g_stream || (size > 0 && !data)) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    shm_pipe_t* pipe = &g_stream->output;
+    const char* p = (const char*)data;
+    
+    while (size > 0) {
+        uint32_t seq = ATOMIC_LOAD(&pipe->seq);
+    
+        if (ATOMIC_LOAD(&pipe->abandoned) || pool_task_is_cancelled()) {
+            return POOL_ERROR_STREAM_CLOSED;
+        }
+    
+        size_t n = shm_pipe_write(pipe, p, size);
+        p += n;
+        size -= n;
+    
+        if (n == 0) {
+            shm_pipe_wait(pipe, seq, STREAM_WAIT_SLICE_MS);
+        }
+    }
+    
+    return POOL_SUCCESS;
+}
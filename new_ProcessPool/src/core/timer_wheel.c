@@ -0,0 +1,229 @@
+#define _GNU_SOURCE
+#include "../../include/internal.h"
+#include <string.h>
+
+// ============================================================================
+// 分层时间轮实现
+// ============================================================================
+
+/**
+ * 每层256个槽位，第L层一个槽位覆盖256^L个tick。定时器按距到期的tick数
+ * 挂入能容纳它的最低层；每当低层转完一圈，把上一层当前槽位中的定时器
+ * 重新挂入(cascade)，最终都会落到第0层并在到期tick被触发。
+ *
+ * 插入和取消都是O(1)的链表操作，推进时跳过没有事件的tick，代价只与
+ * 到期和cascade的定时器数成正比，与挂入的定时器总数无关
+ */
+
+static inline uint64_t timer_wheel_tick(const timer_wheel_t* wheel, uint64_t time_ns) {
+    if (time_ns <= wheel->start_ns) {
+        return 0;
+    }
+    return (time_ns - wheel->start_ns) / TIMER_WHEEL_TICK_NS;
+}
+
+static inline void timer_list_init(timer_node_t* head) {
+    head->prev = head;
+    head->next = head;
+}
+
+static inline bool timer_list_empty(const timer_node_t* head) {
+    return head->next == head;
+}
+
+/**
+ * 按到期tick挂入对应层的槽位，调用方保证expires >= current
+ */
+static void timer_wheel_insert(timer_wheel_t* wheel, timer_node_t* node) {
+    uint64_t delta = node->expires - wheel->current;
+    uint32_t level = 0;
+    
+    while (level < TIMER_WHEEL_LEVELS - 1 &&
+           delta >= (1ULL << (TIMER_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    
+    // 超出最高层范围的定时器挂在最高层最远的槽位，转到时再重新计算
+    uint64_t expires = node->expires;
+    if (delta >= (1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))) {
+        expires = wheel->current + (1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1;
+    }
+    
+    uint32_t index = (expires >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+    timer_node_t* head = &wheel->slots[level][index];
+    
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+static inline void timer_list_remove(timer_node_t* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = NULL;
+    node->next = NULL;
+}
+
+/**
+ * 把第level层的一个槽位中的定时器全部重新挂入更低的层
+ */
+static void timer_wheel_cascade(timer_wheel_t* wheel, uint32_t level, uint32_t index) {
+    timer_node_t* head = &wheel->slots[level][index];
+    timer_node_t list;
+    
+    if (timer_list_empty(head)) {
+        return;
+    }
+    
+    // 先整体摘下，避免重新挂入同一槽位时循环
+    list.next = head->next;
+    list.prev = head->prev;
+    list.next->prev = &list;
+    list.prev->next = &list;
+    timer_list_init(head);
+    
+    while (!timer_list_empty(&list)) {
+        timer_node_t* node = list.next;
+        timer_list_remove(node);
+        timer_wheel_insert(wheel, node);
+    }
+}
+
+void timer_wheel_init(timer_wheel_t* wheel, uint64_t now_ns) {
+    memset(wheel, 0, sizeof(timer_wheel_t));
+    wheel->start_ns = now_ns;
+    
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (uint32_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+            timer_list_init(&wheel->slots[level][i]);
+        }
+    }
+}
+
+bool timer_wheel_pending(const timer_node_t* node) {
+    return node && node->next != NULL;
+}
+
+/**
+ * 挂入定时器，到期时间向上取整到tick，保证不会提前触发
+ * 已挂入的定时器会先被取消
+ */
+void timer_wheel_add(timer_wheel_t* wheel, timer_node_t* node, uint64_t expire_ns) {
+    if (!wheel || !node) {
+        return;
+    }
+    
+    timer_wheel_cancel(wheel, node);
+    
+    uint64_t expires = timer_wheel_tick(wheel, expire_ns + TIMER_WHEEL_TICK_NS - 1);
+    if (expires <= wheel->current) {
+        // 当前tick已处理过，最早在下一个tick触发
+        expires = wheel->current + 1;
+    }
+    
+    node->expires = expires;
+    timer_wheel_insert(wheel, node);
+    wheel->count++;
+}
+
+void timer_wheel_cancel(timer_wheel_t* wheel, timer_node_t* node) {
+    if (!wheel || !timer_wheel_pending(node)) {
+        return;
+    }
+    
+    timer_list_remove(node);
+    wheel->count--;
+}
+
+/**
+ * 计算下一个需要处理的tick：第0层的到期槽位，或非空高层槽位的cascade点
+ * 每层都按整圈扫描：第L层的定时器距到期不足256^(L+1)个tick，可能落在
+ * 本层下一圈中与当前位置之前的槽位里，只扫到本层回绕会漏掉它们
+ */
+static uint64_t timer_wheel_next_tick(const timer_wheel_t* wheel) {
+    uint32_t top = TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS;
+    uint64_t next = ((wheel->current >> top) + 1) << top;
+    
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        uint32_t shift = TIMER_WHEEL_BITS * level;
+        uint64_t base = wheel->current >> shift;
+    
+        // 本层最早的cascade点也不早于已找到的tick时，更高层同样不会更早
+        if (((base + 1) << shift) >= next) {
+            break;
+        }
+    
+        for (uint64_t index = base + 1; index <= base + TIMER_WHEEL_SLOTS; index++) {
+            if (!timer_list_empty(&wheel->slots[level][index & TIMER_WHEEL_MASK])) {
+                if ((index << shift) < next) {
+                    next = index << shift;
+                }
+                break;
+            }
+        }
+    }
+    
+    return next;
+}
+
+/**
+ * 推进到now_ns所在的tick，对每个到期的定时器调用expire
+ * 中间没有事件的tick直接跳过；回调可以安全地取消或重新挂入任意定时器
+ * @return 触发的定时器数量
+ */
+uint32_t timer_wheel_advance(timer_wheel_t* wheel, uint64_t now_ns,
+                             timer_expire_fn expire, void* arg) {
+    if (!wheel) {
+        return 0;
+    }
+    
+    uint64_t target = timer_wheel_tick(wheel, now_ns);
+    uint32_t fired = 0;
+    
+    while (wheel->current < target) {
+        uint64_t next = wheel->count > 0 ? timer_wheel_next_tick(wheel) : target + 1;
+        if (next > target) {
+            wheel->current = target;
+            break;
+        }
+    
+        wheel->current = next;
+    
+        // 低层转完一圈时从上一层补充定时器
+        for (uint32_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            if ((wheel->current & ((1ULL << (TIMER_WHEEL_BITS * level)) - 1)) != 0) {
+                break;
+            }
+            uint32_t index = (wheel->current >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+            timer_wheel_cascade(wheel, level, index);
+        }
+    
+        timer_node_t* head = &wheel->slots[0][wheel->current & TIMER_WHEEL_MASK];
+        while (!timer_list_empty(head)) {
+            timer_node_t* node = head->next;
+            timer_list_remove(node);
+            wheel->count--;
+            fired++;
+    
+            if (expire) {
+                expire(node, arg);
+            }
+        }
+    }
+    
+    return fired;
+}
+
+/**
+ * 计算下一次需要推进时间轮的时间，用于设置timer_fd
+ * @return 时间轮为空返回false
+ */
+bool timer_wheel_next_expiry(const timer_wheel_t* wheel, uint64_t* expire_ns) {
+    if (!wheel || !expire_ns || wheel->count == 0) {
+        return false;
+    }
+    
+    *expire_ns = wheel->start_ns + timer_wheel_next_tick(wheel) * TIMER_WHEEL_TICK_NS;
+    return true;
+}
@@ -1,4 +1,6 @@
+#define _GNU_SOURCE
 #include "../../include/internal.h"
+#include "config.h"
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -7,23 +9,18 @@
 #include <sys/prctl.h>
 #include <errno.h>
 #include <sched.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
 
-// Worker进程状态
-enum worker_state_internal {
-    WORKER_INTERNAL_CREATED = 0,
-    WORKER_INTERNAL_STARTING = 1,
-    WORKER_INTERNAL_RUNNING = 2,
-    WORKER_INTERNAL_STOPPING = 3,
-    WORKER_INTERNAL_STOPPED = 4,
-    WORKER_INTERNAL_ERROR = 5
-};
+#ifdef HAVE_PIDFD
+#include <sys/pidfd.h>
+#endif
 
 // Worker控制命令
 enum worker_command {
-    WORKER_CMD_SHUTDOWN = 1,
-    WORKER_CMD_PAUSE = 2,
-    WORKER_CMD_RESUME = 3,
-    WORKER_CMD_PING = 4
+    WORKER_CMD_SHUTDOWN = 1
 };
 
 // ============================================================================
@@ -51,15 +48,40 @@ static int default_task_handler(const void* input_data, size_t input_size,
     return 0;
 }
 
+// 当前任务的取消状态(Worker进程私有，由pool_task_is_cancelled读取)
+static atomic_ulong* g_cancel_word;            // 属主段取消表中对应的字
+static volatile uint64_t g_running_task_id;    // 正在执行的任务ID
+static volatile sig_atomic_t g_cancel_signalled; // 已收到针对当前任务的SIGUSR1
+
+bool pool_task_is_cancelled(void) {
+    if (g_cancel_signalled) {
+        return true;
+    }
+    
+    return g_cancel_word && g_running_task_id != 0 &&
+           ATOMIC_LOAD_ACQUIRE(g_cancel_word) == g_running_task_id;
+}
+
+/**
+ * 取消信号：Master用sigqueue携带任务ID，只对仍在执行的那个任务生效，
+ * 避免信号在任务切换后才送达时误伤下一个任务
+ */
+static void worker_cancel_signal_handler(int sig, siginfo_t* info, void* context) {
+    (void)sig;
+    (void)context;
+    
+    uint64_t task_id = (uint64_t)(uintptr_t)info->si_value.sival_ptr;
+    if (task_id != 0 && task_id == g_running_task_id) {
+        g_cancel_signalled = 1;
+    }
+}
+
 static void worker_signal_handler(int sig) {
     switch (sig) {
         case SIGTERM:
         case SIGINT:
             // 优雅退出信号
             break;
-        case SIGUSR1:
-            // 用户自定义信号1
-            break;
         case SIGUSR2:
             // 用户自定义信号2
             break;
@@ -78,31 +100,60 @@ static int setup_worker_signals(void) {
     
     if (sigaction(SIGTERM, &sa, NULL) == -1 ||
         sigaction(SIGINT, &sa, NULL) == -1 ||
-        sigaction(SIGUSR1, &sa, NULL) == -1 ||
         sigaction(SIGUSR2, &sa, NULL) == -1) {
         return -1;
     }
     
+    // 取消信号不设置SA_RESTART，使处理函数中阻塞的系统调用返回EINTR
+    struct sigaction cancel_sa;
+    memset(&cancel_sa, 0, sizeof(cancel_sa));
+    cancel_sa.sa_sigaction = worker_cancel_signal_handler;
+    sigemptyset(&cancel_sa.sa_mask);
+    cancel_sa.sa_flags = SA_SIGINFO;
+    
+    if (sigaction(SIGUSR1, &cancel_sa, NULL) == -1) {
+        return -1;
+    }
+    
+    // 由事件循环线程重启的Worker继承了Master为signalfd设置的信号掩码
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR1);
+    if (sigprocmask(SIG_UNBLOCK, &mask, NULL) == -1) {
+        return -1;
+    }
+    
     // 忽略SIGPIPE
     signal(SIGPIPE, SIG_IGN);
     
     return 0;
 }
 
-static int worker_process_task(worker_internal_t* worker, 
-                              task_internal_t* task,
-                              const pool_config_t* config) {
-    if (!worker || !task || !config) {
+/**
+ * 在共享内存中原地执行一条任务记录
+ * 输入数据直接取自提交环槽位，结果写入完成环，调用返回后由调用方释放提交槽位。
+ * origin_worker/origin_shm为任务登记所在的Worker及其共享内存段，窃取来的
+ * 任务与当前Worker不同，取消请求写在origin_shm的取消表中
+ */
+static int worker_process_task(worker_internal_t* worker, shm_record_t* rec,
+                               uint32_t origin_worker, shared_memory_t* origin_shm) {
+    if (!worker || !rec) {
         return -1;
     }
     
-    // 更新任务状态
-    ATOMIC_STORE(&task->state, TASK_STATE_RUNNING);
-    ATOMIC_STORE(&task->worker_id, worker->worker_id);
-    task->start_time_ns = get_time_ns();
+    shared_memory_t* shm = worker->shared_mem;
+    const pool_config_t* config = &worker->pool->config;
+    
+    ATOMIC_STORE(&worker->current_task_id, rec->task_id);
+    
+    // 登记当前任务的取消字，先登记再检查，Master的取消请求不会漏掉
+    g_cancel_word = &origin_shm->cancel_words[rec->task_id % SHM_CANCEL_SLOTS];
+    g_cancel_signalled = 0;
+    g_running_task_id = rec->task_id;
+    ATOMIC_STORE(&shm->running_task_id, rec->task_id);
     
     // 选择任务处理函数
-    task_handler_t handler = task->desc.handler;
+    task_handler_t handler = (task_handler_t)(uintptr_t)rec->handler;
     if (!handler) {
         handler = config->default_handler;
     }
@@ -110,24 +161,96 @@ static int worker_process_task(worker_internal_t* worker,
         handler = default_task_handler;
     }
     
-    // 执行任务
+    // 执行任务，输入直接指向共享内存槽位；开始前已被取消的任务直接跳过
     void* output_data = NULL;
     size_t output_size = 0;
+    uint64_t start_time_ns = get_time_ns();
+    int result;
+    
+    // 以描述符传递的输入映射为只读视图，取消的任务也要取走描述符
+    const void* input_data = SHM_RECORD_DATA(rec);
+    size_t input_size = rec->data_size;
+    if (rec->flags & SHM_RECORD_FD) {
+        input_data = worker_fd_map_input(worker->fd_socket_peer, rec, &input_size);
+    }
     
-    int result = handler(task->input_data, task->input_size,
+    if (pool_task_is_cancelled()) {
+        log_message(NULL, 3, "Worker %u: Skipping cancelled task %lu",
+                   worker->worker_id, rec->task_id);
+        result = -1;
+    } else if (!input_data) {
+        result = -1;
+    } else if (rec->flags & SHM_RECORD_STREAM) {
+        worker_stream_begin(shm, rec->task_id);
+        result = handler(input_data, input_size,
+                        &output_data, &output_size,
+                        config->user_context);
+        worker_stream_end();
+    } else {
+        result = handler(input_data, input_size,
                         &output_data, &output_size,
                         config->user_context);
+    }
+    
+    if (rec->flags & SHM_RECORD_FD) {
+        worker_fd_unmap_input();
+    }
     
-    task->end_time_ns = get_time_ns();
+    uint64_t end_time_ns = get_time_ns();
+    bool cancelled = pool_task_is_cancelled();
     
-    if (result == 0) {
-        // 任务成功完成
-        task_set_result(task, output_data, output_size);
-        ATOMIC_STORE(&task->state, TASK_STATE_COMPLETED);
-    } else {
-        // 任务执行失败
-        task_set_error(task, result, "Task execution failed");
-        ATOMIC_STORE(&task->state, TASK_STATE_FAILED);
+    ATOMIC_STORE(&shm->running_task_id, 0);
+    g_running_task_id = 0;
+    g_cancel_word = NULL;
+    g_cancel_signalled = 0;
+    
+    if (result == 0 && output_size > MAX_RESULT_DATA_SIZE) {
+        log_message(NULL, 1, "Worker %u: Task %lu result too large (%zu bytes)",
+                   worker->worker_id, rec->task_id, output_size);
+        result = -1;
+    }
+    
+    // 以描述符返回的结果在提交完成记录之前发出，Master看到记录时消息已在套接字中
+    pool_fd_region_t output_region;
+    bool output_fd = worker_fd_take_output(&output_region);
+    if (output_fd) {
+        if (result == 0 && !task_fd_send(worker->fd_socket_peer, rec->task_id, output_region.fd)) {
+            log_message(NULL, 1, "Worker %u: Failed to pass result descriptor of task %lu: %s",
+                       worker->worker_id, rec->task_id, strerror(errno));
+            result = -1;
+        }
+        close(output_region.fd);
+        output_fd = result == 0;
+    }
+    
+    if (result != 0 || !output_data) {
+        output_size = 0;
+    }
+    
+    // 写入完成环(完成环满时等待Master回收)
+    size_t header_size = output_fd ? sizeof(shm_fd_region_t) : 0;
+    shm_record_t* done = shm_ring_reserve(&shm->complete_ring, header_size + output_size, true);
+    if (done) {
+        done->task_id = rec->task_id;
+        done->cookie = rec->cookie;
+        done->handler = rec->handler;
+        done->status = result;
+        done->start_time_ns = start_time_ns;
+        done->end_time_ns = end_time_ns;
+        done->origin_worker = origin_worker;
+        
+        if (output_fd) {
+            shm_fd_region_t* region = (shm_fd_region_t*)SHM_RECORD_DATA(done);
+            region->offset = output_region.offset;
+            region->length = output_region.length;
+            done->flags |= SHM_RECORD_FD;
+        }
+        
+        if (output_size > 0) {
+            memcpy((char*)SHM_RECORD_DATA(done) + header_size, output_data, output_size);
+        }
+        
+        shm_ring_commit(&shm->complete_ring);
     }
     
     // 清理输出数据
@@ -136,12 +259,309 @@ static int worker_process_task(worker_internal_t* worker,
     }
     
     // 更新统计信息
+    if (cancelled) {
+        ATOMIC_ADD(&shm->total_cancelled, 1);
+    } else if (result == 0) {
+        ATOMIC_ADD(&shm->total_completed, 1);
+    } else {
+        ATOMIC_ADD(&shm->total_failed, 1);
+    }
     ATOMIC_ADD(&worker->tasks_processed, 1);
-    ATOMIC_STORE(&worker->last_heartbeat, get_time_ns());
+    ATOMIC_STORE(&worker->shared_mem->heartbeat_ns, get_time_ns());
+    ATOMIC_STORE(&worker->current_task_id, 0);
+    
+    // 通知Master有结果可取。Master正在回收，或已通知过而Master尚未开始回收时
+    // 跳过，一批结果只写一次eventfd。屏障与Master退出回收时的复查配对，
+    // 保证两者至少有一方看到这条记录
+    MEMORY_BARRIER();
+    if (!ATOMIC_LOAD(&shm->master_reaping) &&
+        ATOMIC_EXCHANGE(&shm->result_signalled, 1) == 0) {
+        uint64_t value = 1;
+        if (write(worker->result_eventfd, &value, sizeof(value)) == -1) {
+            log_message(NULL, 1, "Worker %u: Failed to signal result eventfd",
+                       worker->worker_id);
+        }
+    }
     
     return result;
 }
 
+/**
+ * 等待窃取者拷贝完记录输入
+ * 拷贝只有几微秒；窃取者的进程ID随认领写入状态字，它在拷贝完之前退出
+ * (被取消升级或OOM杀死)时由属主收回记录
+ * @return 窃取者已拷贝完返回true，收回记录(由属主执行)返回false
+ */
+static bool worker_wait_steal_copied(shm_steal_slot_t* slot, uint64_t seq) {
+    uint32_t spins = 0;
+    
+    for (;;) {
+        uint64_t word = ATOMIC_LOAD_ACQUIRE(&slot->word);
+        if (word == STEAL_WORD(seq, STEAL_STATE_COPIED)) {
+            return true;
+        }
+    
+        if (++spins % 1024 == 0) {
+            pid_t thief_pid = STEAL_WORD_THIEF_PID(word);
+            if (kill(thief_pid, 0) == -1 && errno == ESRCH &&
+                ATOMIC_CAS_ACQUIRE(&slot->word, &word, STEAL_WORD(seq, STEAL_STATE_OWNED))) {
+                return false;
+            }
+        }
+        sched_yield();
+    }
+}
+
+static bool worker_run_urgent(worker_internal_t* worker);
+
+/**
+ * 处理提交环中所有待执行的任务
+ * 每条记录先在任务表中认领，已被其他Worker窃取的记录直接跳过；
+ * 环中有紧急任务时先插队执行
+ */
+static void worker_drain_tasks(worker_internal_t* worker) {
+    shared_memory_t* shm = worker->shared_mem;
+    shm_ring_t* ring = &shm->submit_ring;
+    shm_record_t* rec;
+    
+    while ((rec = shm_ring_peek(ring)) != NULL) {
+        while (ATOMIC_LOAD_RELAXED(&shm->urgent_pending) > 0 && worker_run_urgent(worker)) {
+            // 继续插队，直到队首之后没有紧急任务
+        }
+        
+        uint64_t seq = ATOMIC_LOAD_RELAXED(&ring->records_consumed);
+        shm_steal_slot_t* slot = &shm->steal_slots[seq % SHM_STEAL_SLOTS];
+        uint64_t expected = STEAL_WORD(seq, STEAL_STATE_READY);
+        
+        if (ATOMIC_CAS(&slot->word, &expected, STEAL_WORD(seq, STEAL_STATE_OWNED))) {
+            if (ATOMIC_LOAD_RELAXED(&slot->urgent)) {
+                ATOMIC_SUB(&shm->urgent_pending, 1);
+            }
+            worker_process_task(worker, rec, worker->worker_id, shm);
+        } else if (!worker_wait_steal_copied(slot, seq)) {
+            log_message(NULL, 1, "Worker %u: Thief of task %lu exited before copying it, "
+                       "running it locally", worker->worker_id, slot->task_id);
+            worker_process_task(worker, rec, worker->worker_id, shm);
+        } else if (ATOMIC_LOAD(&slot->thief) != worker->worker_id) {
+            // 被自己插队执行的记录不计入被窃取数
+            ATOMIC_ADD(&shm->total_stolen_from, 1);
+        }
+        
+        shm_ring_release(ring);
+    }
+}
+
+// ============================================================================
+// 任务窃取(仅在Worker进程中调用)
+// ============================================================================
+
+// 窃取记录的本地副本(Worker进程单线程执行任务)
+static _Alignas(CACHE_LINE_SIZE) char g_steal_buffer[SHM_RECORD_MAX_SIZE];
+
+/**
+ * 获取其他Worker的共享内存段
+ * 各段都在继承自Master的arena中，按槽位直接访问；段被释放时魔数会被清除
+ */
+static shared_memory_t* worker_peer_shm(worker_internal_t* worker, uint32_t peer_id) {
+    shared_memory_t* shm = shm_arena_segment(&worker->pool->shm_arena, peer_id);
+    
+    if (!shm || shm->magic != SHM_MAGIC) {
+        return NULL;
+    }
+    
+    return shm;
+}
+
+/**
+ * 执行已认领(STOLEN)的记录：拷贝到本地并标记COPIED后再执行任务，
+ * 执行期间属主已可以释放环中的记录
+ */
+static void worker_run_claimed(worker_internal_t* worker, shared_memory_t* owner_shm,
+                               shm_steal_slot_t* slot, uint64_t seq, uint32_t origin_worker) {
+    ATOMIC_STORE(&slot->thief, worker->worker_id);
+    
+    if (ATOMIC_LOAD_RELAXED(&slot->urgent)) {
+        ATOMIC_SUB(&owner_shm->urgent_pending, 1);
+    }
+    
+    // 拷贝记录头和输入，随后属主即可释放提交环中的记录
+    shm_record_t* rec = shm_ring_record_at(&owner_shm->submit_ring, slot->position);
+    shm_record_t* copy = (shm_record_t*)g_steal_buffer;
+    memcpy(copy, rec, sizeof(shm_record_t) + rec->data_size);
+    
+    ATOMIC_STORE_RELEASE(&slot->word, STEAL_WORD(seq, STEAL_STATE_COPIED));
+    
+    worker_process_task(worker, copy, origin_worker, owner_shm);
+}
+
+/**
+ * 在自身提交环中跳过队首，认领并执行最早的一条紧急任务
+ * 与窃取走同一套认领协议，结果仍按本Worker的任务回收
+ * @return 执行了紧急任务返回true
+ */
+static bool worker_run_urgent(worker_internal_t* worker) {
+    shared_memory_t* shm = worker->shared_mem;
+    shm_ring_t* ring = &shm->submit_ring;
+    uint64_t consumed = ATOMIC_LOAD_ACQUIRE(&ring->records_consumed);
+    uint64_t produced = ATOMIC_LOAD_ACQUIRE(&ring->records_produced);
+    pid_t self = getpid();
+    
+    for (uint64_t seq = consumed + 1; seq < produced; seq++) {
+        shm_steal_slot_t* slot = &shm->steal_slots[seq % SHM_STEAL_SLOTS];
+        if (!ATOMIC_LOAD_RELAXED(&slot->urgent)) {
+            continue;
+        }
+        
+        uint64_t expected = STEAL_WORD(seq, STEAL_STATE_READY);
+        if (!ATOMIC_CAS_ACQUIRE(&slot->word, &expected,
+                                STEAL_WORD_PID(seq, self, STEAL_STATE_STOLEN))) {
+            continue;
+        }
+        
+        log_message(NULL, 4, "Worker %u: Running urgent task %lu ahead of queue",
+                   worker->worker_id, slot->task_id);
+        
+        worker_run_claimed(worker, shm, slot, seq, worker->worker_id);
+        return true;
+    }
+    
+    return false;
+}
+
+/**
+ * 从积压最多的Worker窃取一条尚未开始执行的任务
+ * 输入拷贝到本地后即交还记录，任务在本Worker执行，结果写入本Worker的
+ * 完成环并标注原属Worker，Master据此从原属Worker的在途链表中摘除任务
+ * @return 成功窃取并执行返回true
+ */
+static bool worker_try_steal(worker_internal_t* worker) {
+    const pool_config_t* config = &worker->pool->config;
+    shared_memory_t* victim = NULL;
+    uint32_t victim_id = 0;
+    uint64_t max_backlog = 1; // 只剩队首一条时留给属主
+    
+    // 只扫描已启用的槽位，缩容后空闲的段不被访问(访问会重新分配其物理页)
+    uint32_t peer_slots = ATOMIC_LOAD_RELAXED(&worker->shared_mem->peer_slots);
+    if (peer_slots > config->max_workers) {
+        peer_slots = config->max_workers;
+    }
+    
+    for (uint32_t i = 0; i < peer_slots; i++) {
+        if (i == worker->worker_id) {
+            continue;
+        }
+        
+        shared_memory_t* peer = worker_peer_shm(worker, i);
+        if (!peer) {
+            continue;
+        }
+        
+        shm_ring_t* ring = &peer->submit_ring;
+        uint64_t consumed = ATOMIC_LOAD_ACQUIRE(&ring->records_consumed);
+        uint64_t produced = ATOMIC_LOAD_ACQUIRE(&ring->records_produced);
+        
+        if (produced > consumed && produced - consumed > max_backlog) {
+            max_backlog = produced - consumed;
+            victim = peer;
+            victim_id = i;
+        }
+    }
+    
+    if (!victim) {
+        return false;
+    }
+    
+    // 跳过队首(属主很可能正在执行)，从最早的待执行记录开始认领
+    shm_ring_t* ring = &victim->submit_ring;
+    uint64_t consumed = ATOMIC_LOAD_ACQUIRE(&ring->records_consumed);
+    uint64_t produced = ATOMIC_LOAD_ACQUIRE(&ring->records_produced);
+    pid_t self = getpid();
+    
+    for (uint64_t seq = consumed + 1; seq < produced; seq++) {
+        shm_steal_slot_t* slot = &victim->steal_slots[seq % SHM_STEAL_SLOTS];
+        uint64_t expected = STEAL_WORD(seq, STEAL_STATE_READY);
+        
+        // 按路由键分发的任务留在属主执行，保持键与Worker本地缓存的对应
+        if (ATOMIC_LOAD_RELAXED(&slot->pinned)) {
+            continue;
+        }
+        
+        // acquire与属主登记时的release配对，认领成功后槽位位置和记录内容可见
+        if (!ATOMIC_CAS_ACQUIRE(&slot->word, &expected,
+                                STEAL_WORD_PID(seq, self, STEAL_STATE_STOLEN))) {
+            continue;
+        }
+        
+        log_message(NULL, 4, "Worker %u: Stole task %lu from worker %u",
+                   worker->worker_id, slot->task_id, victim_id);
+        
+        ATOMIC_ADD(&worker->shared_mem->total_stolen, 1);
+        worker_run_claimed(worker, victim, slot, seq, victim_id);
+        
+        return true;
+    }
+    
+    return false;
+}
+
+/**
+ * 自身提交环为空时持续窃取，每执行完一条窃取任务先处理自身的新任务
+ */
+static void worker_steal_while_idle(worker_internal_t* worker) {
+    if (!worker->pool->config.enable_work_stealing) {
+        return;
+    }
+    
+    while (worker_try_steal(worker)) {
+        worker_drain_tasks(worker);
+    }
+}
+
+/**
+ * 在提交环上忙等新任务，最多spin_ns纳秒
+ * @return 等到新任务返回true
+ */
+static bool worker_spin_for_tasks(worker_internal_t* worker, uint64_t spin_ns) {
+    shm_ring_t* ring = &worker->shared_mem->submit_ring;
+    uint64_t deadline = get_time_ns() + spin_ns;
+    uint32_t spins = 0;
+    
+    while (!shm_ring_peek(ring)) {
+        // 每64次检查一次时钟，减少clock_gettime开销
+        if ((++spins & 63) == 0 && get_time_ns() >= deadline) {
+            return false;
+        }
+        CPU_RELAX();
+    }
+    
+    return true;
+}
+
+/**
+ * 自适应忙等：处理完一批任务后保持唤醒状态在提交环上等待新任务，
+ * 期间Master不写eventfd。等到任务时把忙等时长翻倍(不超过配置上限)，
+ * 等不到时减半(不低于上限的1/16)，任务稀疏时很快回到休眠
+ */
+static void worker_spin_after_drain(worker_internal_t* worker, uint64_t* budget_ns) {
+    uint64_t max_ns = (uint64_t)worker->pool->config.worker_spin_us * 1000ULL;
+    if (max_ns == 0) {
+        return;
+    }
+    
+    uint64_t min_ns = max_ns >> WORKER_SPIN_MIN_SHIFT;
+    
+    while (ATOMIC_LOAD(&worker->state) == WORKER_INTERNAL_RUNNING) {
+        if (!worker_spin_for_tasks(worker, *budget_ns)) {
+            *budget_ns = *budget_ns / 2 > min_ns ? *budget_ns / 2 : min_ns;
+            return;
+        }
+        
+        *budget_ns = *budget_ns * 2 < max_ns ? *budget_ns * 2 : max_ns;
+        worker_drain_tasks(worker);
+        worker_steal_while_idle(worker);
+    }
+}
+
 static void* worker_main_loop(void* arg) {
     worker_internal_t* worker = (worker_internal_t*)arg;
     if (!worker) {
@@ -195,9 +615,26 @@ static void* worker_main_loop(void* arg) {
     // 主事件循环
     struct epoll_event events[8];
     bool running = true;
+    shared_memory_t* shm = worker->shared_mem;
+    uint64_t spin_budget_ns = (uint64_t)worker->pool->config.worker_spin_us * 1000ULL;
     
     while (running && ATOMIC_LOAD(&worker->state) == WORKER_INTERNAL_RUNNING) {
-        int nfds = epoll_wait(epoll_fd, events, 8, 1000); // 1秒超时
+        // 声明休眠后复查提交环：Master可能在声明之前提交并省去了通知
+        ATOMIC_STORE(&shm->worker_awake, 0);
+        MEMORY_BARRIER();
+        if (shm_ring_peek(&shm->submit_ring)) {
+            ATOMIC_STORE(&shm->worker_awake, 1);
+            worker_drain_tasks(worker);
+            worker_spin_after_drain(worker, &spin_budget_ns);
+            continue;
+        }
+        
+        // 允许窃取时缩短等待，空闲期间定期查看其他Worker的积压
+        int timeout_ms = worker->pool->config.enable_work_stealing ?
+                         WORKER_STEAL_INTERVAL_MS : 1000;
+        int nfds = epoll_wait(epoll_fd, events, 8, timeout_ms);
+        ATOMIC_STORE(&shm->worker_awake, 1);
+        ATOMIC_STORE(&shm->heartbeat_ns, get_time_ns());
         
         if (nfds == -1) {
             if (errno == EINTR) {
@@ -209,8 +646,7 @@ static void* worker_main_loop(void* arg) {
         }
         
         if (nfds == 0) {
-            // 超时，发送心跳
-            ATOMIC_STORE(&worker->last_heartbeat, get_time_ns());
+            worker_steal_while_idle(worker);
             continue;
         }
         
@@ -222,11 +658,14 @@ static void* worker_main_loop(void* arg) {
                 // 有新任务
                 uint64_t value;
                 if (read(worker->task_eventfd, &value, sizeof(value)) > 0) {
-                    // 从共享内存读取任务
-                    // TODO: 实现从共享内存队列读取任务的逻辑
-                    log_message(NULL, 3, "Worker %u: Received task notification", 
-                               worker->worker_id);
+                    log_message(NULL, 4, "Worker %u: Received %lu task notifications", 
+                               worker->worker_id, value);
                 }
+                
+                // 从共享内存提交环读取并执行任务
+                worker_drain_tasks(worker);
+                worker_steal_while_idle(worker);
+                worker_spin_after_drain(worker, &spin_budget_ns);
             } else if (fd == worker->control_eventfd) {
                 // 控制命令
                 uint64_t cmd;
@@ -237,20 +676,6 @@ static void* worker_main_loop(void* arg) {
                                        worker->worker_id);
                             running = false;
                             break;
-                        case WORKER_CMD_PAUSE:
-                            log_message(NULL, 2, "Worker %u: Received pause command", 
-                                       worker->worker_id);
-                            // TODO: 实现暂停逻辑
-                            break;
-                        case WORKER_CMD_RESUME:
-                            log_message(NULL, 2, "Worker %u: Received resume command", 
-                                       worker->worker_id);
-                            // TODO: 实现恢复逻辑
-                            break;
-                        case WORKER_CMD_PING:
-                            // 心跳响应
-                            ATOMIC_STORE(&worker->last_heartbeat, get_time_ns());
-                            break;
                         default:
                             log_message(NULL, 1, "Worker %u: Unknown command: %lu", 
                                        worker->worker_id, cmd);
@@ -272,6 +697,25 @@ static void* worker_main_loop(void* arg) {
 // Worker管理函数实现
 // ============================================================================
 
+/**
+ * 把最大的已初始化槽位+1写入所有段，Worker窃取时只扫描该范围
+ */
+static void worker_publish_peer_slots(process_pool_t* pool) {
+    uint32_t peer_slots = 0;
+    for (uint32_t i = 0; i < pool->config.max_workers; i++) {
+        if (pool->workers[i].shared_mem) {
+            peer_slots = i + 1;
+        }
+    }
+    
+    for (uint32_t i = 0; i < peer_slots; i++) {
+        shared_memory_t* shm = pool->workers[i].shared_mem;
+        if (shm) {
+            ATOMIC_STORE_RELAXED(&shm->peer_slots, peer_slots);
+        }
+    }
+}
+
 pool_error_t worker_create(process_pool_t* pool, uint32_t worker_id) {
     if (!pool || worker_id >= pool->config.max_workers) {
         return POOL_ERROR_INVALID_PARAM;
@@ -281,6 +725,12 @@ pool_error_t worker_create(process_pool_t* pool, uint32_t worker_id) {
     memset(worker, 0, sizeof(worker_internal_t));
     
     worker->worker_id = worker_id;
+    worker->pool = pool;
+    worker->pidfd = -1;
+    worker->fd_socket = -1;
+    worker->fd_socket_peer = -1;
+    worker->cpu = pool->worker_cpus[worker_id];
+    worker->numa_node = pool->worker_nodes[worker_id];
     ATOMIC_STORE(&worker->state, WORKER_INTERNAL_CREATED);
     
     // 创建eventfd用于通信
@@ -305,13 +755,24 @@ pool_error_t worker_create(process_pool_t* pool, uint32_t worker_id) {
         return POOL_ERROR_SYSTEM_CALL;
     }
     
-    // 创建共享内存
-    snprintf(worker->shm_name, sizeof(worker->shm_name), 
-             "/pool_%s_worker_%u", pool->config.pool_name, worker_id);
+    // 传递描述符的套接字，Master端不阻塞事件循环
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) == -1) {
+        close(worker->control_eventfd);
+        close(worker->result_eventfd);
+        close(worker->task_eventfd);
+        log_message(pool, 0, "Failed to create descriptor socket for worker %u", worker_id);
+        return POOL_ERROR_SYSTEM_CALL;
+    }
+    worker->fd_socket = sv[0];
+    worker->fd_socket_peer = sv[1];
+    fcntl(worker->fd_socket, F_SETFL, fcntl(worker->fd_socket, F_GETFL) | O_NONBLOCK);
     
-    worker->shared_mem_size = sizeof(shared_memory_t) + pool->config.queue_size * MAX_TASK_DATA_SIZE;
-    worker->shared_mem = shm_create(worker->shm_name, worker->shared_mem_size);
+    // 初始化arena中本槽位的共享内存段
+    worker->shared_mem = shm_segment_init(&pool->shm_arena, worker_id, worker->numa_node);
     if (!worker->shared_mem) {
+        close(worker->fd_socket_peer);
+        close(worker->fd_socket);
         close(worker->control_eventfd);
         close(worker->result_eventfd);
         close(worker->task_eventfd);
@@ -319,25 +780,92 @@ pool_error_t worker_create(process_pool_t* pool, uint32_t worker_id) {
         return POOL_ERROR_SYSTEM_CALL;
     }
     
-    // 初始化共享内存
-    ATOMIC_STORE(&worker->shared_mem->producer_pos, 0);
-    ATOMIC_STORE(&worker->shared_mem->consumer_pos, 0);
-    worker->shared_mem->queue_size = pool->config.queue_size;
-    ATOMIC_STORE(&worker->shared_mem->total_submitted, 0);
-    ATOMIC_STORE(&worker->shared_mem->total_completed, 0);
-    ATOMIC_STORE(&worker->shared_mem->total_failed, 0);
+    // 启用大页时段大小已按页取整
+    worker->shared_mem_size = worker->shared_mem->size;
+    
+    // 初始化提交环和完成环
+    if (shm_init_rings(worker->shared_mem, pool->config.shm_ring_size, SHM_RING_SPSC) != 0) {
+        shm_segment_release(&pool->shm_arena, worker->shared_mem);
+        worker->shared_mem = NULL;
+        close(worker->fd_socket_peer);
+        close(worker->fd_socket);
+        close(worker->control_eventfd);
+        close(worker->result_eventfd);
+        close(worker->task_eventfd);
+        log_message(pool, 0, "Failed to initialize rings for worker %u", worker_id);
+        return POOL_ERROR_SYSTEM_CALL;
+    }
     
     // 初始化统计信息
     ATOMIC_STORE(&worker->tasks_processed, 0);
     ATOMIC_STORE(&worker->last_heartbeat, get_time_ns());
+    ATOMIC_STORE(&worker->shared_mem->heartbeat_ns, get_time_ns());
     ATOMIC_STORE(&worker->current_task_id, 0);
     
+    // 初始化在途任务链表
+    worker->inflight_head = NULL;
+    worker->inflight_tail = NULL;
+    ATOMIC_STORE(&worker->inflight_count, 0);
+    
+    worker_publish_peer_slots(pool);
+    
     log_message(pool, 3, "Worker %u created successfully", worker_id);
     
     return POOL_SUCCESS;
 }
 
-pool_error_t worker_start(worker_internal_t* worker) {
+/**
+ * 打开Worker进程的pidfd(总是带O_CLOEXEC)，glibc未提供pidfd_open时直接走系统调用
+ */
+static int worker_pidfd_open(pid_t pid) {
+#if defined(HAVE_PIDFD) && defined(HAVE_PIDFD_OPEN)
+    return pidfd_open(pid, 0);
+#elif defined(SYS_pidfd_open)
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+/**
+ * Worker进程入口：由worker_start的fork子进程或zygote派生的子进程调用，不返回
+ */
+void worker_process_main(worker_internal_t* worker) {
+    // 先绑核，主循环和处理函数的内存都在所在节点上首次分配
+    if (affinity_pin_self(worker->cpu) == -1) {
+        log_message(NULL, 1, "Worker %u: Failed to pin to CPU %d", 
+                   worker->worker_id, worker->cpu);
+    }
+    
+    // 设置进程组
+    if (setpgid(0, 0) == -1) {
+        log_message(NULL, 1, "Worker %u: Failed to set process group", 
+                   worker->worker_id);
+    }
+    
+    // 设置进程优先级
+    if (nice(0) == -1) {
+        log_message(NULL, 1, "Worker %u: Failed to set nice value", 
+                   worker->worker_id);
+    }
+    
+    // 派生时Master中的状态还是STARTING，主循环只在RUNNING状态下运行
+    ATOMIC_STORE(&worker->state, WORKER_INTERNAL_RUNNING);
+    
+    // 启动Worker主循环
+    worker_main_loop(worker);
+    
+    // Worker进程退出
+    log_message(NULL, 2, "Worker %u: Process exiting", worker->worker_id);
+    _exit(0);
+}
+
+/**
+ * 把Worker置为STARTING，记录开始派生的时间
+ */
+static pool_error_t worker_begin_start(worker_internal_t* worker) {
     if (!worker) {
         return POOL_ERROR_INVALID_PARAM;
     }
@@ -347,59 +875,100 @@ pool_error_t worker_start(worker_internal_t* worker) {
     }
     
     ATOMIC_STORE(&worker->state, WORKER_INTERNAL_STARTING);
+    worker->spawn_start_ns = get_time_ns();
     
-    // 创建Worker进程
-    pid_t pid = fork();
-    if (pid == -1) {
-        ATOMIC_STORE(&worker->state, WORKER_INTERNAL_ERROR);
-        log_message(NULL, 0, "Failed to fork worker %u: %s", 
-                   worker->worker_id, strerror(errno));
-        return POOL_ERROR_SYSTEM_CALL;
+    return POOL_SUCCESS;
+}
+
+/**
+ * 同步启动Worker：优先由zygote派生并等待应答，zygote未启用或不可用时直接fork
+ * 只在事件循环线程之外调用(pool_start)
+ */
+pool_error_t worker_start(worker_internal_t* worker) {
+    pool_error_t err = worker_begin_start(worker);
+    if (err != POOL_SUCCESS) {
+        return err;
     }
     
-    if (pid == 0) {
-        // 子进程：Worker进程
-        
-        // 设置进程组
-        if (setpgid(0, 0) == -1) {
-            log_message(NULL, 1, "Worker %u: Failed to set process group", 
-                       worker->worker_id);
-        }
-        
-        // 设置进程优先级
-        if (nice(0) == -1) {
-            log_message(NULL, 1, "Worker %u: Failed to set nice value", 
-                       worker->worker_id);
+    return worker_finish_start(worker, zygote_spawn_worker(worker->pool, worker));
+}
+
+/**
+ * 在事件循环线程上启动Worker，不等待zygote应答
+ * 请求已发给zygote时返回POOL_SUCCESS且Worker仍为STARTING，事件循环收到应答后
+ * 完成启动并注册事件；zygote不可用时直接fork，返回时已是RUNNING
+ */
+pool_error_t worker_start_async(worker_internal_t* worker) {
+    pool_error_t err = worker_begin_start(worker);
+    if (err != POOL_SUCCESS) {
+        return err;
+    }
+    
+    if (zygote_request_spawn(worker->pool, worker) == 0) {
+        log_message(NULL, 3, "Worker %u spawn requested from zygote", worker->worker_id);
+        return POOL_SUCCESS;
+    }
+    
+    return worker_finish_start(worker, -1);
+}
+
+/**
+ * 完成Worker启动：pid为zygote派生出的进程，pid<=0表示zygote派生失败或不可用，
+ * 退回到直接fork
+ */
+pool_error_t worker_finish_start(worker_internal_t* worker, pid_t pid) {
+    process_pool_t* pool = worker->pool;
+    bool via_zygote = pid > 0;
+    
+    worker->spawn_deadline_ns = 0;
+    
+    if (!via_zygote) {
+        pid = fork();
+        if (pid == -1) {
+            ATOMIC_STORE(&worker->state, WORKER_INTERNAL_ERROR);
+            log_message(NULL, 0, "Failed to fork worker %u: %s", 
+                       worker->worker_id, strerror(errno));
+            return POOL_ERROR_SYSTEM_CALL;
         }
         
-        // 启动Worker主循环
-        worker_main_loop(worker);
-        
-        // Worker进程退出
-        log_message(NULL, 2, "Worker %u: Process exiting", worker->worker_id);
-        _exit(0);
-    } else {
-        // 父进程：Master进程
-        worker->pid = pid;
-        ATOMIC_STORE(&worker->state, WORKER_INTERNAL_RUNNING);
-        
-        // 启动监控线程
-        worker->monitor_running = true;
-        if (pthread_create(&worker->monitor_thread, NULL, 
-                          worker_monitor_thread, worker) != 0) {
-            log_message(NULL, 1, "Failed to create monitor thread for worker %u", 
-                       worker->worker_id);
-            // 不是致命错误，继续运行
+        if (pid == 0) {
+            // 子进程：Worker进程，没有zygote时初始化函数在每个Worker中执行
+            zygote_close_in_child(pool);
+            if (pool->config.worker_init) {
+                pool->config.worker_init(pool->config.user_context);
+            }
+            worker_process_main(worker);
         }
-        
-        log_message(NULL, 2, "Worker %u started with PID %d", 
-                   worker->worker_id, pid);
     }
     
+    // 父进程：Master进程。套接字的Worker端已由子进程持有
+    close(worker->fd_socket_peer);
+    worker->fd_socket_peer = -1;
+    
+    worker->pid = pid;
+    ATOMIC_STORE(&worker->state, WORKER_INTERNAL_RUNNING);
+    
+    // 子进程在被waitpid回收前pidfd_open仍然成功，此时pidfd已可读，
+    // 不会错过在这之前的退出
+    worker->pidfd = worker_pidfd_open(pid);
+    if (worker->pidfd == -1) {
+        log_message(NULL, 1, "pidfd_open failed for worker %u: %s, "
+                   "falling back to SIGCHLD and health checks",
+                   worker->worker_id, strerror(errno));
+    }
+    
+    stats_worker_spawned(pool, get_time_ns() - worker->spawn_start_ns, via_zygote);
+    
+    log_message(NULL, 2, "Worker %u started with PID %d%s", 
+               worker->worker_id, pid, via_zygote ? " (zygote)" : "");
+    
     return POOL_SUCCESS;
 }
 
-pool_error_t worker_stop(worker_internal_t* worker, uint32_t timeout_ms) {
+/**
+ * 通知Worker退出(不等待)，Worker执行完当前任务后退出主循环
+ */
+pool_error_t worker_request_stop(worker_internal_t* worker) {
     if (!worker || worker->pid <= 0) {
         return POOL_ERROR_INVALID_PARAM;
     }
@@ -421,6 +990,24 @@ pool_error_t worker_stop(worker_internal_t* worker, uint32_t timeout_ms) {
                    worker->worker_id);
     }
     
+    return POOL_SUCCESS;
+}
+
+/**
+ * 停止Worker并等待其退出，已通知退出的Worker只等待
+ */
+pool_error_t worker_stop(worker_internal_t* worker, uint32_t timeout_ms) {
+    if (!worker || worker->pid <= 0) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    if (ATOMIC_LOAD(&worker->state) != WORKER_INTERNAL_STOPPING) {
+        pool_error_t err = worker_request_stop(worker);
+        if (err != POOL_SUCCESS) {
+            return err;
+        }
+    }
+    
     // 等待进程退出
     uint64_t start_time = get_time_ns();
     uint64_t timeout_ns = (uint64_t)timeout_ms * 1000000ULL;
@@ -452,13 +1039,6 @@ pool_error_t worker_stop(worker_internal_t* worker, uint32_t timeout_ms) {
         waitpid(worker->pid, &status, 0);
     }
     
-    // 停止监控线程
-    worker->monitor_running = false;
-    if (worker->monitor_thread) {
-        pthread_join(worker->monitor_thread, NULL);
-        worker->monitor_thread = 0;
-    }
-    
     ATOMIC_STORE(&worker->state, WORKER_INTERNAL_STOPPED);
     
     return POOL_SUCCESS;
@@ -490,107 +1070,624 @@ void worker_destroy(worker_internal_t* worker) {
         worker->control_eventfd = -1;
     }
     
-    // 销毁共享内存
+    if (worker->pidfd >= 0) {
+        close(worker->pidfd);
+        worker->pidfd = -1;
+    }
+    
+    if (worker->fd_socket >= 0) {
+        close(worker->fd_socket);
+        worker->fd_socket = -1;
+    }
+    
+    if (worker->fd_socket_peer >= 0) {
+        close(worker->fd_socket_peer);
+        worker->fd_socket_peer = -1;
+    }
+    
+    // 释放共享内存段，arena映射由进程池持有
     if (worker->shared_mem) {
-        shm_destroy(worker->shared_mem, worker->shm_name, worker->shared_mem_size);
+        shm_segment_release(&worker->pool->shm_arena, worker->shared_mem);
         worker->shared_mem = NULL;
+        worker_publish_peer_slots(worker->pool);
     }
     
     // 清零结构
     memset(worker, 0, sizeof(worker_internal_t));
 }
 
+/**
+ * 进程是否已退出。有pidfd时以其可读为准：已退出但尚未回收的僵尸进程
+ * kill(pid, 0)仍然成功，只有pidfd能区分
+ */
+static bool worker_has_exited(worker_internal_t* worker) {
+    if (worker->pidfd >= 0) {
+        struct pollfd pfd = { .fd = worker->pidfd, .events = POLLIN };
+        return poll(&pfd, 1, 0) > 0;
+    }
+    
+    return kill(worker->pid, 0) == -1 && errno == ESRCH;
+}
+
 bool worker_is_alive(worker_internal_t* worker) {
     if (!worker || worker->pid <= 0) {
         return false;
     }
     
-    // 检查进程是否存在
-    if (kill(worker->pid, 0) == -1) {
-        if (errno == ESRCH) {
-            return false; // 进程不存在
-        }
+    if (worker_has_exited(worker)) {
+        return false;
+    }
+    
+    // 检查共享内存中的心跳。执行任务期间主循环不会醒来，长任务由任务超时
+    // 和取消升级处理，这里只判定空闲时主循环卡住的Worker
+    shared_memory_t* shm = worker->shared_mem;
+    if (!shm || ATOMIC_LOAD(&shm->running_task_id) != 0) {
+        return true;
     }
     
-    // 检查心跳
     uint64_t now = get_time_ns();
-    uint64_t last_heartbeat = ATOMIC_LOAD(&worker->last_heartbeat);
+    uint64_t last_heartbeat = ATOMIC_LOAD(&shm->heartbeat_ns);
     uint64_t heartbeat_timeout = WORKER_HEARTBEAT_INTERVAL * 2 * 1000000000ULL; // 2倍心跳间隔
     
-    return (now - last_heartbeat) < heartbeat_timeout;
+    return now < last_heartbeat || (now - last_heartbeat) < heartbeat_timeout;
+}
+
+// ============================================================================
+// 在途任务跟踪(仅事件循环线程调用)
+// ============================================================================
+
+static void worker_inflight_append(worker_internal_t* worker, task_internal_t* task) {
+    task->worker_next = NULL;
+    
+    if (worker->inflight_tail) {
+        worker->inflight_tail->worker_next = task;
+    } else {
+        worker->inflight_head = task;
+    }
+    worker->inflight_tail = task;
+    
+    ATOMIC_ADD(&worker->inflight_count, 1);
+}
+
+/**
+ * 按cookie摘除在途任务
+ * Worker按提交顺序完成任务，因此通常命中链表头；
+ * 同时以链表成员身份校验来自共享内存的cookie
+ */
+static task_internal_t* worker_inflight_remove(worker_internal_t* worker,
+                                               uint64_t cookie,
+                                               uint64_t task_id) {
+    task_internal_t* prev = NULL;
+    task_internal_t* curr = worker->inflight_head;
+    
+    while (curr) {
+        if ((uint64_t)(uintptr_t)curr == cookie && curr->task_id == task_id) {
+            if (prev) {
+                prev->worker_next = curr->worker_next;
+            } else {
+                worker->inflight_head = curr->worker_next;
+            }
+            
+            if (worker->inflight_tail == curr) {
+                worker->inflight_tail = prev;
+            }
+            
+            curr->worker_next = NULL;
+            ATOMIC_SUB(&worker->inflight_count, 1);
+            return curr;
+        }
+        
+        prev = curr;
+        curr = curr->worker_next;
+    }
+    
+    return NULL;
+}
+
+/**
+ * 在提交环中预留并写入一条任务记录，登记到任务表和在途链表，但不提交
+ * seq为该记录的序号，同一批中的记录序号连续
+ */
+static pool_error_t worker_stage_task(worker_internal_t* worker, task_internal_t* task,
+                                      uint64_t seq) {
+    if (task->input_size > MAX_TASK_DATA_SIZE) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    shared_memory_t* shm = worker->shared_mem;
+    shm_ring_t* ring = &shm->submit_ring;
+    
+    // 任务表已登记满时视同提交环已满
+    if (seq - ATOMIC_LOAD_ACQUIRE(&ring->records_consumed) >= SHM_STEAL_SLOTS) {
+        return POOL_ERROR_QUEUE_FULL;
+    }
+    
+    // 在提交环中预留槽位，直接写入任务记录和输入数据；以描述符传递的输入只写区域
+    bool fd_input = task->input_region.fd >= 0;
+    size_t data_size = fd_input ? sizeof(shm_fd_region_t) : task->input_size;
+    uint64_t reserve_mark = ring->reserve_pos;
+    shm_record_t* rec = shm_ring_reserve(ring, data_size, false);
+    if (!rec) {
+        return POOL_ERROR_QUEUE_FULL;
+    }
+    
+    rec->task_id = task->task_id;
+    rec->cookie = (uint64_t)(uintptr_t)task;
+    rec->handler = (uint64_t)(uintptr_t)task->desc.handler;
+    rec->status = 0;
+    rec->start_time_ns = 0;
+    rec->end_time_ns = 0;
+    rec->origin_worker = worker->worker_id;
+    if (task->desc.streaming) {
+        rec->flags |= SHM_RECORD_STREAM;
+    }
+    
+    if (fd_input) {
+        shm_fd_region_t* region = (shm_fd_region_t*)SHM_RECORD_DATA(rec);
+        region->offset = task->input_region.offset;
+        region->length = task->input_region.length;
+        rec->flags |= SHM_RECORD_FD;
+    
+        // 套接字缓冲区满时撤销预留，等Worker取走描述符后再分发；其他错误
+        // 仍提交记录，Worker取不到描述符即失败该任务
+        if (!task_fd_send(worker->fd_socket, task->task_id, task->input_region.fd)) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                shm_ring_unreserve(ring, reserve_mark);
+                return POOL_ERROR_QUEUE_FULL;
+            }
+            log_message(NULL, 1, "Failed to pass input descriptor of task %lu to worker %u: %s",
+                       task->task_id, worker->worker_id, strerror(errno));
+        }
+    } else if (task->input_size > 0) {
+        memcpy(SHM_RECORD_DATA(rec), task->input_data, task->input_size);
+    }
+    
+    // 清除取消表中同一位置的旧请求
+    uint64_t cancel_id = task->task_id;
+    ATOMIC_CAS(&shm->cancel_words[task->task_id % SHM_CANCEL_SLOTS], &cancel_id, 0);
+    
+    // 在任务表中登记，提交(release)之后属主和窃取者才会看到该记录
+    shm_steal_slot_t* slot = &shm->steal_slots[seq % SHM_STEAL_SLOTS];
+    bool urgent = task->desc.priority == TASK_PRIORITY_URGENT &&
+                  ATOMIC_LOAD(&worker->pool->sched_policy) == POOL_SCHED_PRIORITY;
+    slot->position = ring->reserve_pos - rec->record_size;
+    slot->cookie = rec->cookie;
+    slot->task_id = rec->task_id;
+    ATOMIC_STORE_RELAXED(&slot->urgent, urgent);
+    // 流式任务的调用方按worker_id找流通道，输入描述符只发给了属主，同样不允许被窃取
+    ATOMIC_STORE_RELAXED(&slot->pinned,
+                         task->route == TASK_ROUTE_HIT || task->desc.streaming || fd_input);
+    ATOMIC_STORE_RELAXED(&slot->thief, UINT32_MAX);
+    // release：槽位字段先于状态字可见，提交时records_produced的release再发布给窃取者
+    ATOMIC_STORE_RELEASE(&slot->word, STEAL_WORD(seq, STEAL_STATE_READY));
+    
+    ATOMIC_STORE(&task->worker_id, worker->worker_id);
+    ATOMIC_STORE(&task->state, TASK_STATE_RUNNING);
+    task->dispatch_seq = seq;
+    task->cancel_stage = TASK_CANCEL_NONE;
+    
+    // 队列持有的任务引用转交给在途链表
+    worker_inflight_append(worker, task);
+    
+    // 先登记紧急计数再提交，Worker看到计数时记录可能尚未可见，只会多扫描一次
+    if (urgent) {
+        ATOMIC_ADD(&shm->urgent_pending, 1);
+    }
+    
+    return POOL_SUCCESS;
 }
 
 pool_error_t worker_send_task(worker_internal_t* worker, task_internal_t* task) {
-    if (!worker || !task) {
+    if (!task) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    uint32_t sent = 0;
+    pool_error_t result = worker_send_batch(worker, &task, 1, &sent);
+    
+    return sent == 1 ? POOL_SUCCESS : result;
+}
+
+/**
+ * 向Worker批量发送任务：逐条写入提交环后一次提交，只通知Worker一次
+ * 按顺序发送，遇到提交环已满等错误即停止，*sent返回成功发送的前缀长度
+ * @return 全部发送成功返回POOL_SUCCESS，否则返回使发送停止的错误
+ */
+pool_error_t worker_send_batch(worker_internal_t* worker, task_internal_t** tasks,
+                               uint32_t count, uint32_t* sent) {
+    if (sent) {
+        *sent = 0;
+    }
+    
+    if (!worker || !tasks || count == 0) {
         return POOL_ERROR_INVALID_PARAM;
     }
     
-    if (!worker_is_alive(worker)) {
+    if (ATOMIC_LOAD(&worker->state) != WORKER_INTERNAL_RUNNING || !worker->shared_mem) {
         return POOL_ERROR_WORKER_DEAD;
     }
     
-    // TODO: 实现将任务写入共享内存队列的逻辑
+    shared_memory_t* shm = worker->shared_mem;
+    uint64_t seq = ATOMIC_LOAD_RELAXED(&shm->submit_ring.records_produced);
+    pool_error_t result = POOL_SUCCESS;
+    uint32_t staged = 0;
     
-    // 通知Worker有新任务
-    uint64_t value = 1;
-    if (write(worker->task_eventfd, &value, sizeof(value)) == -1) {
-        log_message(NULL, 0, "Failed to notify worker %u of new task", 
-                   worker->worker_id);
-        return POOL_ERROR_SYSTEM_CALL;
+    while (staged < count) {
+        result = worker_stage_task(worker, tasks[staged], seq + staged);
+        if (result != POOL_SUCCESS) {
+            break;
+        }
+        staged++;
     }
     
-    return POOL_SUCCESS;
+    if (staged == 0) {
+        return result;
+    }
+    
+    shm_ring_commit_batch(&shm->submit_ring, staged);
+    ATOMIC_ADD(&shm->total_submitted, staged);
+    
+    // 通知Worker有新任务，整批只写一次eventfd。Worker未休眠时会自己回到
+    // 提交环，省去通知；屏障与Worker休眠前的复查配对
+    MEMORY_BARRIER();
+    if (ATOMIC_LOAD(&shm->worker_awake)) {
+        ATOMIC_ADD(&worker->doorbells_suppressed, 1);
+    } else {
+        uint64_t value = staged;
+        if (write(worker->task_eventfd, &value, sizeof(value)) == -1) {
+            log_message(NULL, 0, "Failed to notify worker %u of new task", 
+                       worker->worker_id);
+        }
+        ATOMIC_ADD(&worker->doorbells_sent, 1);
+    }
+    
+    if (sent) {
+        *sent = staged;
+    }
+    return result;
 }
 
-pool_error_t worker_get_result(worker_internal_t* worker, task_internal_t* task) {
+/**
+ * 把一条完成记录对应到在途任务并写入结果，记录本身由调用方释放
+ * @return 不属于该Worker的记录(例如重启前遗留)返回NULL
+ */
+static task_internal_t* worker_take_completion(worker_internal_t* worker, shm_record_t* rec) {
+    // 窃取来的任务登记在原属Worker的在途链表中
+    worker_internal_t* owner = worker;
+    if (rec->origin_worker != worker->worker_id && worker->pool &&
+        rec->origin_worker < worker->pool->config.max_workers) {
+        owner = &worker->pool->workers[rec->origin_worker];
+    }
+    
+    // 结果区域在常规输出之前，描述符随记录一起取走，丢弃的记录也不留在套接字中
+    const char* data = (const char*)SHM_RECORD_DATA(rec);
+    size_t size = rec->data_size;
+    pool_fd_region_t output_region = { .fd = -1 };
+    
+    if ((rec->flags & SHM_RECORD_FD) && size >= sizeof(shm_fd_region_t)) {
+        const shm_fd_region_t* region = (const shm_fd_region_t*)data;
+        output_region.offset = region->offset;
+        output_region.length = (size_t)region->length;
+        output_region.fd = task_fd_recv(worker->pool, worker->fd_socket, rec->task_id);
+        data += sizeof(shm_fd_region_t);
+        size -= sizeof(shm_fd_region_t);
+    }
+    
+    task_internal_t* done = worker_inflight_remove(owner, rec->cookie, rec->task_id);
+    if (!done && owner != worker) {
+        // 原属Worker退出时任务已转交给执行者
+        done = worker_inflight_remove(worker, rec->cookie, rec->task_id);
+    }
+    if (!done) {
+        log_message(NULL, 1, "Worker %u: Dropping stray completion for task %lu",
+                   worker->worker_id, rec->task_id);
+        if (output_region.fd >= 0) {
+            close(output_region.fd);
+        }
+        return NULL;
+    }
+    
+    // 已超时或被取消的任务保留终态，丢弃迟到的结果
+    if (!task_is_completed(done)) {
+        done->start_time_ns = rec->start_time_ns;
+        done->end_time_ns = rec->end_time_ns;
+        ATOMIC_STORE(&done->worker_id, worker->worker_id);
+        
+        if (rec->status != 0) {
+            task_set_error(done, rec->status, "Task execution failed");
+        } else if ((rec->flags & SHM_RECORD_FD) && output_region.fd < 0) {
+            task_set_error(done, -1, "Result descriptor not received");
+        } else {
+            task_set_result(done, data, size);
+            if (output_region.fd >= 0) {
+                task_set_result_fd(done, &output_region);
+                output_region.fd = -1;
+            }
+        }
+    }
+    
+    if (output_region.fd >= 0) {
+        close(output_region.fd);
+    }
+    
+    return done;
+}
+
+pool_error_t worker_get_result(worker_internal_t* worker, task_internal_t** task) {
     if (!worker || !task) {
         return POOL_ERROR_INVALID_PARAM;
     }
     
-    // TODO: 实现从共享内存读取结果的逻辑
+    *task = NULL;
+    
+    if (!worker->shared_mem) {
+        return POOL_ERROR_WORKER_DEAD;
+    }
+    
+    shm_ring_t* ring = &worker->shared_mem->complete_ring;
+    shm_record_t* rec;
+    
+    while ((rec = shm_ring_peek(ring)) != NULL) {
+        task_internal_t* done = worker_take_completion(worker, rec);
+        shm_ring_release(ring);
+        
+        if (done) {
+            *task = done;
+            break;
+        }
+    }
     
     return POOL_SUCCESS;
 }
 
-// ============================================================================
-// Worker监控线程
-// ============================================================================
+// 批量回收的收集状态
+typedef struct {
+    worker_internal_t* worker;
+    task_internal_t** tasks;
+    uint32_t count;
+} completion_batch_t;
 
-void* worker_monitor_thread(void* arg) {
-    worker_internal_t* worker = (worker_internal_t*)arg;
-    if (!worker) {
-        return NULL;
+static void worker_collect_completion(shm_record_t* rec, void* arg) {
+    completion_batch_t* batch = (completion_batch_t*)arg;
+    task_internal_t* done = worker_take_completion(batch->worker, rec);
+    
+    if (done) {
+        batch->tasks[batch->count++] = done;
+    }
+}
+
+/**
+ * 一次取出完成环中最多max_count条结果，整批只归还一次环空间
+ * 在途链表持有的引用随任务转交给调用方
+ * @return 取出的任务数，遗留的无主记录被丢弃且不计入
+ */
+uint32_t worker_get_results(worker_internal_t* worker, task_internal_t** tasks, uint32_t max_count) {
+    if (!worker || !tasks || max_count == 0 || !worker->shared_mem) {
+        return 0;
     }
     
-    char thread_name[16];
-    snprintf(thread_name, sizeof(thread_name), "monitor-%u", worker->worker_id);
-    pthread_setname_np(pthread_self(), thread_name);
+    completion_batch_t batch = { worker, tasks, 0 };
     
-    log_message(NULL, 3, "Monitor thread started for worker %u", worker->worker_id);
+    // 丢弃的记录也占用批次名额，返回0且环非空时调用方会再取一次
+    shm_ring_consume_batch(&worker->shared_mem->complete_ring, max_count,
+                           worker_collect_completion, &batch);
     
-    while (worker->monitor_running) {
-        // 检查Worker进程状态
-        if (!worker_is_alive(worker)) {
-            log_message(NULL, 1, "Worker %u is dead, marking for restart", 
-                       worker->worker_id);
-            ATOMIC_STORE(&worker->state, WORKER_INTERNAL_ERROR);
-            break;
+    return batch.count;
+}
+
+static void worker_fail_task(worker_internal_t* worker, task_internal_t* task,
+                             int error_code, const char* error_message) {
+    process_pool_t* pool = worker->pool;
+    
+    if (pool) {
+        timer_wheel_cancel(&pool->timer_wheel, &task->timer);
+    }
+    
+    // 已超时或被取消的任务保留原终态
+    if (!task_is_completed(task)) {
+        task_set_error(task, error_code, error_message);
+        task_complete(task, TASK_STATE_FAILED);
+        if (pool) {
+            stats_task_failed(pool);
+        }
+    }
+    task_unref(task);
+}
+
+/**
+ * 失败该Worker从其他Worker窃取、尚未回收结果的任务
+ * 这些任务仍登记在原属Worker的在途链表中，需要扫描各Worker的任务表
+ */
+static void worker_fail_stolen(worker_internal_t* worker, int error_code,
+                               const char* error_message) {
+    process_pool_t* pool = worker->pool;
+    if (!pool || !pool->workers) {
+        return;
+    }
+    
+    for (uint32_t i = 0; i < pool->config.max_workers; i++) {
+        worker_internal_t* owner = &pool->workers[i];
+        if (owner == worker || !owner->shared_mem || !owner->inflight_head) {
+            continue;
         }
         
-        // 发送心跳ping
-        uint64_t cmd = WORKER_CMD_PING;
-        if (write(worker->control_eventfd, &cmd, sizeof(cmd)) == -1) {
-            log_message(NULL, 1, "Failed to send ping to worker %u", 
-                       worker->worker_id);
+        for (uint32_t j = 0; j < SHM_STEAL_SLOTS; j++) {
+            shm_steal_slot_t* slot = &owner->shared_mem->steal_slots[j];
+            uint64_t state = STEAL_WORD_STATE(ATOMIC_LOAD(&slot->word));
+            
+            if ((state != STEAL_STATE_STOLEN && state != STEAL_STATE_COPIED) ||
+                ATOMIC_LOAD(&slot->thief) != worker->worker_id) {
+                continue;
+            }
+            
+            // 已回收的任务不在链表中，按cookie和任务ID查找即可过滤
+            task_internal_t* task = worker_inflight_remove(owner, slot->cookie, slot->task_id);
+            if (task) {
+                worker_fail_task(worker, task, error_code, error_message);
+            }
         }
+    }
+}
+
+/**
+ * 把已被仍在运行的Worker窃取的任务转交到窃取者的在途链表
+ * 原属Worker退出后这些任务仍会由窃取者正常完成
+ */
+static void worker_handoff_stolen(worker_internal_t* worker) {
+    process_pool_t* pool = worker->pool;
+    if (!pool || !pool->workers || !worker->shared_mem) {
+        return;
+    }
+    
+    for (uint32_t j = 0; j < SHM_STEAL_SLOTS && worker->inflight_head; j++) {
+        shm_steal_slot_t* slot = &worker->shared_mem->steal_slots[j];
+        uint64_t state = STEAL_WORD_STATE(ATOMIC_LOAD(&slot->word));
+        uint32_t thief_id = ATOMIC_LOAD(&slot->thief);
         
-        // 更新性能指标
-        // TODO: 实现CPU和内存使用率统计
+        if ((state != STEAL_STATE_STOLEN && state != STEAL_STATE_COPIED) ||
+            thief_id >= pool->config.max_workers || thief_id == worker->worker_id) {
+            continue;
+        }
+        
+        worker_internal_t* thief = &pool->workers[thief_id];
+        if (ATOMIC_LOAD(&thief->state) != WORKER_INTERNAL_RUNNING) {
+            continue;
+        }
         
-        sleep(WORKER_HEARTBEAT_INTERVAL);
+        task_internal_t* task = worker_inflight_remove(worker, slot->cookie, slot->task_id);
+        if (task) {
+            worker_inflight_append(thief, task);
+        }
     }
+}
+
+void worker_fail_inflight(worker_internal_t* worker, int error_code, const char* error_message) {
+    if (!worker) return;
+    
+    worker_fail_stolen(worker, error_code, error_message);
+    worker_handoff_stolen(worker);
     
-    log_message(NULL, 3, "Monitor thread exited for worker %u", worker->worker_id);
+    task_internal_t* task = worker->inflight_head;
+    worker->inflight_head = NULL;
+    worker->inflight_tail = NULL;
+    ATOMIC_STORE(&worker->inflight_count, 0);
+    
+    while (task) {
+        task_internal_t* next = task->worker_next;
+        task->worker_next = NULL;
+        
+        worker_fail_task(worker, task, error_code, error_message);
+        
+        task = next;
+    }
+}
+
+// ============================================================================
+// 运行中任务的取消(仅事件循环线程调用)
+// ============================================================================
+
+/**
+ * 在属主Worker的取消表中登记取消请求
+ * @return 任务仍在该Worker的在途链表中返回true
+ */
+bool worker_request_cancel(worker_internal_t* worker, task_internal_t* task) {
+    if (!worker || !task || !worker->shared_mem) {
+        return false;
+    }
+    
+    task_internal_t* curr = worker->inflight_head;
+    while (curr && curr != task) {
+        curr = curr->worker_next;
+    }
+    if (!curr) {
+        return false;
+    }
+    
+    ATOMIC_STORE_RELEASE(&worker->shared_mem->cancel_words[task->task_id % SHM_CANCEL_SLOTS],
+                         task->task_id);
+    
+    log_message(NULL, 3, "Cancellation of task %lu posted to worker %u",
+               task->task_id, worker->worker_id);
+    return true;
+}
+
+/**
+ * 查找正在执行该任务的Worker(属主或窃取者)
+ * @return 任务尚未开始或已执行完时返回NULL
+ */
+worker_internal_t* worker_find_executor(process_pool_t* pool, const task_internal_t* task) {
+    if (!pool || !pool->workers || !task) {
+        return NULL;
+    }
+    
+    // 多数任务由属主执行，先检查属主
+    uint32_t owner_id = ATOMIC_LOAD(&task->worker_id);
+    
+    for (uint32_t n = 0; n < pool->config.max_workers; n++) {
+        uint32_t i = (owner_id + n) % pool->config.max_workers;
+        worker_internal_t* worker = &pool->workers[i];
+        
+        if (ATOMIC_LOAD(&worker->state) != WORKER_INTERNAL_RUNNING || !worker->shared_mem) {
+            continue;
+        }
+        
+        if (ATOMIC_LOAD(&worker->shared_mem->running_task_id) == task->task_id) {
+            return worker;
+        }
+    }
     
     return NULL;
+}
+
+/**
+ * 收回Worker提交环中尚未被任何一方认领的任务，用于回收Worker前把无辜的
+ * 积压任务交还给Master重新分发。收回的任务恢复为PENDING，引用随之转交调用方
+ * @return 收回的任务数
+ */
+uint32_t worker_reclaim_unstarted(worker_internal_t* worker, task_internal_t** tasks,
+                                  uint32_t max_count) {
+    if (!worker || !worker->shared_mem || !tasks) {
+        return 0;
+    }
+    
+    shared_memory_t* shm = worker->shared_mem;
+    task_internal_t* prev = NULL;
+    task_internal_t* curr = worker->inflight_head;
+    uint32_t count = 0;
+    
+    while (curr && count < max_count) {
+        task_internal_t* next = curr->worker_next;
+        uint64_t seq = curr->dispatch_seq;
+        shm_steal_slot_t* slot = &shm->steal_slots[seq % SHM_STEAL_SLOTS];
+        uint64_t expected = STEAL_WORD(seq, STEAL_STATE_READY);
+        
+        // 以窃取者身份认领，属主和其他窃取者都会跳过该记录
+        if (ATOMIC_CAS(&slot->word, &expected, STEAL_WORD_PID(seq, getpid(), STEAL_STATE_STOLEN))) {
+            if (ATOMIC_LOAD_RELAXED(&slot->urgent)) {
+                ATOMIC_SUB(&shm->urgent_pending, 1);
+            }
+            ATOMIC_STORE(&slot->thief, UINT32_MAX);
+            ATOMIC_STORE_RELEASE(&slot->word, STEAL_WORD(seq, STEAL_STATE_COPIED));
+            
+            if (prev) {
+                prev->worker_next = next;
+            } else {
+                worker->inflight_head = next;
+            }
+            if (worker->inflight_tail == curr) {
+                worker->inflight_tail = prev;
+            }
+            ATOMIC_SUB(&worker->inflight_count, 1);
+            
+            curr->worker_next = NULL;
+            ATOMIC_STORE(&curr->state, TASK_STATE_PENDING);
+            tasks[count++] = curr;
+        } else {
+            prev = curr;
+        }
+        
+        curr = next;
+    }
+    
+    return count;
 }
\ No newline at end of file
@@ -0,0 +1,578 @@
+#define _GNU_SOURCE
+#include "../../include/internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <linux/sched.h>
+
+// ============================================================================
+// Zygote进程
+// ============================================================================
+
+/**
+ * zygote在pool_create中、事件循环和各类队列建立之前从Master fork出来，
+ * 只持有进程池配置的一份拷贝，执行一次worker_init后等待派生请求。
+ *
+ * 每个请求带上Worker ID，zygote在继承的共享内存arena中取得该Worker的段，
+ * 以CLONE_PARENT派生子进程。子进程的父进程仍是Master，waitpid、SIGCHLD
+ * 和pidfd都与直接fork的Worker一致。派生出的Worker继承zygote已初始化好的
+ * 处理函数状态，不再继承Master运行中积累的线程、映射和大量脏页，fork和
+ * 首次写入的代价都更小。
+ *
+ * Worker的三个eventfd和描述符套接字的Worker端随请求以SCM_RIGHTS传给zygote，
+ * zygote派生后关闭自己的拷贝。
+ *
+ * Master和zygote之间有两条SEQPACKET套接字：pool_start在调用线程上同步
+ * 派生，走带接收超时的同步套接字；事件循环重启和扩容时走非阻塞的异步
+ * 套接字，发出请求后不等待，应答到达时在事件循环上完成启动，zygote
+ * 超时未应答则被结束，尚未完成的Worker退回到fork。
+ *
+ * zygote在任一套接字读到EOF时退出，不依赖PR_SET_PDEATHSIG(它跟随的是
+ * 调用pool_create的线程而不是Master进程)。Master直接fork的Worker在子进程
+ * 中关闭这两个套接字；应用自己fork且不exec的子进程会继续持有它们，
+ * zygote要等这些进程也退出后才退出。
+ *
+ * zygote只读取启动后不再变化的配置(处理函数、共享内存环大小、忙等和
+ * 窃取设置)，运行中修改的配置不会同步给它。
+ */
+
+#define ZYGOTE_FD_COUNT 4               // task/result/control三个eventfd和描述符套接字
+#define ZYGOTE_REPLY_TIMEOUT_MS 1000    // 等待派生结果的最长时间
+
+typedef struct {
+    uint32_t worker_id;
+    uint32_t token;                     // 请求序号，原样带回应答
+    int32_t cpu;                        // 绑定的CPU(-1表示不绑定)
+} zygote_request_t;
+
+typedef struct {
+    uint32_t worker_id;
+    uint32_t token;
+    pid_t pid;                          // 派生出的Worker进程ID(失败为-1)
+    int error;                          // 失败时的errno
+} zygote_reply_t;
+
+// zygote进程中正在派生的Worker，子进程继承其拷贝
+static worker_internal_t g_zygote_worker;
+
+/**
+ * 派生一个父进程为Master的子进程，不经过glibc的fork，zygote是单线程的，
+ * 不需要atfork处理
+ */
+static pid_t zygote_clone(void) {
+    return (pid_t)syscall(SYS_clone, CLONE_PARENT | SIGCHLD, 0, NULL, NULL, 0);
+}
+
+/**
+ * 在zygote中派生一个Worker
+ * @return 子进程ID，失败返回-1并设置errno
+ */
+static pid_t zygote_fork_worker(process_pool_t* pool, const int* socks,
+                                const zygote_request_t* req, const int* fds) {
+    worker_internal_t* worker = &g_zygote_worker;
+    memset(worker, 0, sizeof(worker_internal_t));
+    
+    worker->worker_id = req->worker_id;
+    worker->pool = pool;
+    worker->task_eventfd = fds[0];
+    worker->result_eventfd = fds[1];
+    worker->control_eventfd = fds[2];
+    worker->fd_socket = -1;
+    worker->fd_socket_peer = fds[3];
+    worker->pidfd = -1;
+    worker->cpu = req->cpu;
+    worker->numa_node = -1;
+    ATOMIC_STORE(&worker->state, WORKER_INTERNAL_STARTING);
+    
+    // 段在启动zygote之前映射的arena中，Master已初始化段头和环
+    worker->shared_mem = shm_arena_segment(&pool->shm_arena, req->worker_id);
+    if (!worker->shared_mem || worker->shared_mem->magic != SHM_MAGIC) {
+        errno = ENOENT;
+        return -1;
+    }
+    worker->shared_mem_size = worker->shared_mem->size;
+    
+    pid_t pid = zygote_clone();
+    if (pid == 0) {
+        // 子进程：Worker进程，不持有与Master的套接字，zygote才能读到EOF
+        close(socks[0]);
+        close(socks[1]);
+        worker_process_main(worker);
+    }
+    
+    worker->shared_mem = NULL;
+    
+    return pid;
+}
+
+/**
+ * 接收一个派生请求
+ * @return 收到请求返回1，Master关闭套接字返回0，出错返回-1
+ */
+static int zygote_recv_request(int sock, zygote_request_t* req, int* fds) {
+    char control[CMSG_SPACE(sizeof(int) * ZYGOTE_FD_COUNT)];
+    struct iovec iov = { .iov_base = req, .iov_len = sizeof(*req) };
+    struct msghdr msg;
+    
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    
+    ssize_t n;
+    do {
+        n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    } while (n == -1 && errno == EINTR);
+    
+    if (n <= 0) {
+        return (int)n;
+    }
+    
+    int received = 0;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            received = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+            memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * (size_t)received);
+            break;
+        }
+    }
+    
+    if (n != (ssize_t)sizeof(*req) || received != ZYGOTE_FD_COUNT ||
+        (msg.msg_flags & MSG_CTRUNC)) {
+        for (int i = 0; i < received; i++) {
+            close(fds[i]);
+        }
+        errno = EPROTO;
+        return -1;
+    }
+    
+    return 1;
+}
+
+/**
+ * 处理一个套接字上的派生请求
+ * @return 继续服务返回true，套接字已关闭或出错返回false
+ */
+static bool zygote_serve(process_pool_t* pool, const int* socks, int sock) {
+    zygote_request_t req;
+    int fds[ZYGOTE_FD_COUNT];
+    
+    int ret = zygote_recv_request(sock, &req, fds);
+    if (ret == 0 || (ret < 0 && errno != EPROTO)) {
+        return false;
+    }
+    
+    zygote_reply_t reply = { .worker_id = UINT32_MAX, .token = 0, .pid = -1, .error = EPROTO };
+    if (ret > 0) {
+        reply.worker_id = req.worker_id;
+        reply.token = req.token;
+        reply.pid = zygote_fork_worker(pool, socks, &req, fds);
+        reply.error = reply.pid == -1 ? errno : 0;
+        for (int i = 0; i < ZYGOTE_FD_COUNT; i++) {
+            close(fds[i]);
+        }
+    }
+    
+    return send(sock, &reply, sizeof(reply), MSG_NOSIGNAL) == (ssize_t)sizeof(reply);
+}
+
+static void zygote_main(process_pool_t* pool, int sync_sock, int async_sock) {
+    prctl(PR_SET_NAME, "pool-zygote", 0, 0, 0);
+    
+    // 预初始化处理函数状态，派生的Worker直接继承
+    if (pool->config.worker_init) {
+        pool->config.worker_init(pool->config.user_context);
+    }
+    
+    // Master关闭(或随进程退出关闭)任一套接字时退出，已派生的Worker不受影响
+    int socks[2] = { sync_sock, async_sock };
+    struct pollfd pfds[2] = {
+        { .fd = sync_sock, .events = POLLIN },
+        { .fd = async_sock, .events = POLLIN }
+    };
+    
+    for (;;) {
+        if (poll(pfds, 2, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+    
+        bool serving = true;
+        for (int i = 0; i < 2 && serving; i++) {
+            if (pfds[i].revents) {
+                serving = zygote_serve(pool, socks, pfds[i].fd);
+            }
+        }
+        if (!serving) {
+            break;
+        }
+    }
+    
+    _exit(0);
+}
+
+// ============================================================================
+// Master端接口
+// ============================================================================
+
+/**
+ * 启动zygote进程，必须在事件循环线程和任务队列建立之前调用
+ * 启动失败不影响进程池，Worker退回到由Master直接fork
+ */
+pool_error_t zygote_start(process_pool_t* pool) {
+    if (!pool) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    pool->zygote_pid = 0;
+    pool->zygote_sock = -1;
+    pool->zygote_async_sock = -1;
+    
+    if (!pool->config.enable_zygote) {
+        return POOL_SUCCESS;
+    }
+    
+    if (pthread_mutex_init(&pool->zygote_mutex, NULL) != 0) {
+        return POOL_ERROR_SYSTEM_CALL;
+    }
+    
+    int sv[2];
+    int async_sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) == -1) {
+        log_message(pool, 1, "Failed to create zygote socket: %s", strerror(errno));
+        pthread_mutex_destroy(&pool->zygote_mutex);
+        return POOL_ERROR_SYSTEM_CALL;
+    }
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, async_sv) == -1) {
+        log_message(pool, 1, "Failed to create zygote socket: %s", strerror(errno));
+        close(sv[0]);
+        close(sv[1]);
+        pthread_mutex_destroy(&pool->zygote_mutex);
+        return POOL_ERROR_SYSTEM_CALL;
+    }
+    
+    pid_t pid = fork();
+    if (pid == -1) {
+        log_message(pool, 1, "Failed to fork zygote: %s", strerror(errno));
+        close(sv[0]);
+        close(sv[1]);
+        close(async_sv[0]);
+        close(async_sv[1]);
+        pthread_mutex_destroy(&pool->zygote_mutex);
+        return POOL_ERROR_SYSTEM_CALL;
+    }
+    
+    if (pid == 0) {
+        close(sv[0]);
+        close(async_sv[0]);
+        zygote_main(pool, sv[1], async_sv[1]);
+    }
+    
+    close(sv[1]);
+    close(async_sv[1]);
+    
+    // zygote卡住时不让pool_start无限阻塞
+    struct timeval tv = {
+        .tv_sec = ZYGOTE_REPLY_TIMEOUT_MS / 1000,
+        .tv_usec = (ZYGOTE_REPLY_TIMEOUT_MS % 1000) * 1000
+    };
+    setsockopt(sv[0], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    fcntl(async_sv[0], F_SETFL, fcntl(async_sv[0], F_GETFL) | O_NONBLOCK);
+    
+    pool->zygote_pid = pid;
+    pool->zygote_sock = sv[0];
+    pool->zygote_async_sock = async_sv[0];
+    pool->zygote_next_token = 1;
+    
+    log_message(pool, 2, "Zygote started with PID %d", pid);
+    
+    return POOL_SUCCESS;
+}
+
+/**
+ * 结束zygote进程。事件循环随后在异步套接字上读到EOF，尚未应答的派生退回到fork
+ */
+void zygote_abort(process_pool_t* pool) {
+    if (!pool || pool->zygote_pid <= 0) {
+        return;
+    }
+    
+    kill(pool->zygote_pid, SIGKILL);
+}
+
+/**
+ * 停止使用同步套接字(调用方持有zygote_mutex)
+ * 套接字只关闭读写而不释放描述符，事件循环线程此时fork的子进程按原描述符号
+ * 关闭它不会误关无关的文件，描述符在zygote_stop中释放
+ */
+static void zygote_disable(process_pool_t* pool) {
+    shutdown(pool->zygote_sock, SHUT_RDWR);
+    zygote_abort(pool);
+}
+
+/**
+ * 停止使用异步套接字，事件循环读到EOF并注销该套接字后调用，描述符同样留到zygote_stop释放
+ */
+void zygote_close_async(process_pool_t* pool) {
+    if (pool && pool->zygote_async_sock >= 0) {
+        shutdown(pool->zygote_async_sock, SHUT_RDWR);
+    }
+}
+
+/**
+ * Master直接fork的Worker在子进程中调用，不让zygote的套接字因子进程持有而收不到EOF
+ */
+void zygote_close_in_child(process_pool_t* pool) {
+    if (pool->zygote_sock >= 0) {
+        close(pool->zygote_sock);
+    }
+    if (pool->zygote_async_sock >= 0) {
+        close(pool->zygote_async_sock);
+    }
+}
+
+void zygote_stop(process_pool_t* pool) {
+    if (!pool || pool->zygote_pid <= 0) {
+        return;
+    }
+    
+    // 关闭同步套接字后zygote读到EOF自行退出
+    pthread_mutex_lock(&pool->zygote_mutex);
+    if (pool->zygote_sock >= 0) {
+        close(pool->zygote_sock);
+        pool->zygote_sock = -1;
+    }
+    pthread_mutex_unlock(&pool->zygote_mutex);
+    
+    // 事件循环的SIGCHLD处理可能已经回收了它
+    if (waitpid(pool->zygote_pid, NULL, 0) == -1 && errno != ECHILD) {
+        log_message(pool, 1, "waitpid failed for zygote: %s", strerror(errno));
+    }
+    
+    // zygote退出前发出的应答已无人认领，结束对应的进程
+    if (pool->zygote_async_sock >= 0) {
+        uint32_t worker_id;
+        uint32_t token;
+        pid_t pid;
+        while (zygote_recv_spawn(pool, &worker_id, &token, &pid) > 0) {
+            if (pid > 0) {
+                kill(pid, SIGKILL);
+                waitpid(pid, NULL, 0);
+            }
+        }
+        close(pool->zygote_async_sock);
+        pool->zygote_async_sock = -1;
+    }
+    
+    pthread_mutex_destroy(&pool->zygote_mutex);
+    pool->zygote_pid = 0;
+}
+
+/**
+ * 组装带Worker描述符的派生请求并发送
+ * @return sendmsg的返回值
+ */
+static ssize_t zygote_send_request(int sock, worker_internal_t* worker, uint32_t token) {
+    zygote_request_t req = { .worker_id = worker->worker_id, .token = token, .cpu = worker->cpu };
+    int fds[ZYGOTE_FD_COUNT] = {
+        worker->task_eventfd, worker->result_eventfd, worker->control_eventfd,
+        worker->fd_socket_peer
+    };
+    
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+    struct iovec iov = { .iov_base = &req, .iov_len = sizeof(req) };
+    struct msghdr msg;
+    
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    
+    ssize_t n;
+    do {
+        n = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (n == -1 && errno == EINTR);
+    
+    return n;
+}
+
+/**
+ * 请求zygote派生Worker进程并等待应答，只在事件循环线程之外调用(pool_start)
+ * @return 子进程ID，zygote不可用或派生失败返回-1，由调用方退回到fork
+ */
+pid_t zygote_spawn_worker(process_pool_t* pool, worker_internal_t* worker) {
+    if (!pool || !worker || pool->zygote_pid <= 0) {
+        return -1;
+    }
+    
+    pthread_mutex_lock(&pool->zygote_mutex);
+    
+    if (pool->zygote_sock < 0) {
+        pthread_mutex_unlock(&pool->zygote_mutex);
+        return -1;
+    }
+    
+    zygote_reply_t reply = { .worker_id = UINT32_MAX, .token = 0, .pid = -1, .error = 0 };
+    ssize_t n = zygote_send_request(pool->zygote_sock, worker, 0);
+    
+    if (n == (ssize_t)sizeof(zygote_request_t)) {
+        do {
+            n = recv(pool->zygote_sock, &reply, sizeof(reply), 0);
+        } while (n == -1 && errno == EINTR);
+    }
+    
+    if (n != (ssize_t)sizeof(reply) || reply.worker_id != worker->worker_id) {
+        // zygote已退出或没有按时应答，请求与应答可能已经错位，不再使用
+        log_message(pool, 1, "Zygote unavailable (%s), falling back to fork",
+                   n == -1 ? strerror(errno) : "connection closed");
+        zygote_disable(pool);
+        pthread_mutex_unlock(&pool->zygote_mutex);
+        return -1;
+    }
+    
+    pthread_mutex_unlock(&pool->zygote_mutex);
+    
+    if (reply.pid <= 0) {
+        log_message(pool, 1, "Zygote failed to spawn worker %u: %s",
+                   worker->worker_id, strerror(reply.error));
+        return -1;
+    }
+    
+    return reply.pid;
+}
+
+/**
+ * 在事件循环线程上发出异步派生请求，不等待应答
+ * 请求发出后Worker保持STARTING状态，由事件循环收到应答时调用worker_finish_start
+ * @return 请求已发出返回0，zygote不可用返回-1，由调用方直接fork
+ */
+int zygote_request_spawn(process_pool_t* pool, worker_internal_t* worker) {
+    if (!pool || !worker || pool->zygote_pid <= 0 || pool->zygote_async_sock < 0) {
+        return -1;
+    }
+    
+    uint32_t token = pool->zygote_next_token++;
+    if (zygote_send_request(pool->zygote_async_sock, worker, token) !=
+        (ssize_t)sizeof(zygote_request_t)) {
+        return -1;
+    }
+    
+    worker->spawn_token = token;
+    worker->spawn_deadline_ns = get_time_ns() + ZYGOTE_REPLY_TIMEOUT_MS * 1000000ULL;
+    
+    return 0;
+}
+
+/**
+ * 读取一个异步派生应答(非阻塞)
+ * @return 读到应答返回1，暂无应答返回0，zygote已退出返回-1
+ */
+int zygote_recv_spawn(process_pool_t* pool, uint32_t* worker_id, uint32_t* token, pid_t* pid) {
+    zygote_reply_t reply;
+    ssize_t n;
+    
+    do {
+        n = recv(pool->zygote_async_sock, &reply, sizeof(reply), MSG_DONTWAIT);
+    } while (n == -1 && errno == EINTR);
+    
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return 0;
+    }
+    if (n != (ssize_t)sizeof(reply)) {
+        return -1;
+    }
+    
+    if (reply.pid <= 0) {
+        log_message(pool, 1, "Zygote failed to spawn worker %u: %s",
+                   reply.worker_id, strerror(reply.error));
+    }
+    
+    *worker_id = reply.worker_id;
+    *token = reply.token;
+    *pid = reply.pid;
+    return 1;
+}
+
+/**
+ * 事件循环停止后收取尚未到达的派生应答，最多等待ZYGOTE_REPLY_TIMEOUT_MS
+ * 收到应答的Worker照常完成启动，由pool_stop随其他Worker一起停止；
+ * 等不到应答的槽位直接销毁，迟到的进程由zygote_stop结束
+ */
+void zygote_collect_spawns(process_pool_t* pool) {
+    if (!pool || pool->zygote_async_sock < 0) {
+        return;
+    }
+    
+    uint64_t deadline = get_time_ns() + ZYGOTE_REPLY_TIMEOUT_MS * 1000000ULL;
+    
+    for (;;) {
+        bool waiting = false;
+        for (uint32_t i = 0; i < pool->config.max_workers; i++) {
+            if (pool->workers[i].spawn_deadline_ns > 0) {
+                waiting = true;
+                break;
+            }
+        }
+    
+        uint64_t now = get_time_ns();
+        if (!waiting || now >= deadline) {
+            break;
+        }
+    
+        struct pollfd pfd = { .fd = pool->zygote_async_sock, .events = POLLIN };
+        int timeout_ms = (int)((deadline - now + 999999) / 1000000);
+        if (poll(&pfd, 1, timeout_ms) <= 0) {
+            continue;
+        }
+    
+        uint32_t worker_id;
+        uint32_t token;
+        pid_t pid;
+        int ret = zygote_recv_spawn(pool, &worker_id, &token, &pid);
+        if (ret < 0) {
+            break;
+        }
+        if (ret == 0) {
+            continue;
+        }
+    
+        worker_internal_t* worker = worker_id < pool->config.max_workers ?
+                                    &pool->workers[worker_id] : NULL;
+        if (!worker || worker->spawn_deadline_ns == 0 || worker->spawn_token != token) {
+            if (pid > 0) {
+                kill(pid, SIGKILL);
+                waitpid(pid, NULL, 0);
+            }
+        } else if (pid > 0) {
+            worker_finish_start(worker, pid);
+        } else {
+            worker_destroy(worker);
+        }
+    }
+    
+    for (uint32_t i = 0; i < pool->config.max_workers; i++) {
+        if (pool->workers[i].spawn_deadline_ns > 0) {
+            worker_destroy(&pool->workers[i]);
+        }
+    }
+}
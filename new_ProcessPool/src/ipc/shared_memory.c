@@ -1,226 +1,863 @@
+#define _GNU_SOURCE
 #include "../../include/internal.h"
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
 #include <sys/mman.h>
-#include <sys/stat.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 
 // ============================================================================
-// 共享内存管理
+// 共享内存arena
 // ============================================================================
 
-shared_memory_t* shm_create(const char* name, size_t size) {
-    if (!name || size == 0) {
+/**
+ * 每个进程池只有一个匿名memfd，pool_create时一次映射，按槽位切成
+ * max_workers个等长的段。arena在zygote启动和任何Worker派生之前映射，
+ * fork和zygote派生的Worker都继承同一映射，段地址在所有进程中相同：
+ * 窃取任务时直接按槽位访问其他Worker的段，不需要按名称打开。
+ * Worker创建和重启只初始化段头，不再有shm_open/ftruncate/mmap，
+ * 进程崩溃也不会在/dev/shm留下残留，同名进程池之间互不冲突
+ */
+
+// 透明大页默认大小，读不到hpage_pmd_size时使用
+#define SHM_THP_DEFAULT_SIZE (2UL * 1024 * 1024)
+
+static size_t shm_round_up(size_t size, size_t align) {
+    return (size + align - 1) / align * align;
+}
+
+/**
+ * 默认hugetlb大页大小(/proc/meminfo的Hugepagesize)，MFD_HUGETLB按该大小分配
+ * @return 大页字节数，内核不支持hugetlb时返回0
+ */
+static size_t shm_hugetlb_size(void) {
+    FILE* fp = fopen("/proc/meminfo", "r");
+    if (!fp) {
+        return 0;
+    }
+    
+    char line[256];
+    unsigned long size_kb = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "Hugepagesize: %lu kB", &size_kb) == 1) {
+            break;
+        }
+    }
+    
+    fclose(fp);
+    return (size_t)size_kb * 1024;
+}
+
+static size_t shm_thp_size(void) {
+    FILE* fp = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+    if (!fp) {
+        return SHM_THP_DEFAULT_SIZE;
+    }
+    
+    unsigned long size = 0;
+    if (fscanf(fp, "%lu", &size) != 1 || size == 0) {
+        size = SHM_THP_DEFAULT_SIZE;
+    }
+    
+    fclose(fp);
+    return size;
+}
+
+/**
+ * shmem是否可能使用透明大页：shmem_enabled为never或deny时MADV_HUGEPAGE不生效
+ */
+static bool shm_thp_shmem_enabled(void) {
+    FILE* fp = fopen("/sys/kernel/mm/transparent_hugepage/shmem_enabled", "r");
+    if (!fp) {
+        return false;
+    }
+    
+    char mode[256] = {0};
+    bool enabled = fgets(mode, sizeof(mode), fp) != NULL &&
+                   !strstr(mode, "[never]") && !strstr(mode, "[deny]");
+    
+    fclose(fp);
+    return enabled;
+}
+
+/**
+ * 创建memfd并整体映射。MFD_HUGETLB的MAP_SHARED映射会立即预留全部大页，
+ * 大页不足时在这里失败，而不是在首次访问时SIGBUS
+ * @return 映射地址，失败返回NULL；成功时*fd为memfd
+ */
+static void* shm_arena_map(const char* label, size_t size, unsigned int flags, int* fd) {
+    int memfd = memfd_create(label, MFD_CLOEXEC | MFD_ALLOW_SEALING | flags);
+    if (memfd == -1) {
+        return NULL;
+    }
+    
+    if (ftruncate(memfd, (off_t)size) == -1) {
+        close(memfd);
+        return NULL;
+    }
+    
+    void* addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (addr == MAP_FAILED) {
+        close(memfd);
         return NULL;
     }
     
-    // 创建共享内存对象
-    int shm_fd = shm_open(name, O_CREAT | O_RDWR | O_EXCL, 0666);
-    if (shm_fd == -1) {
-        if (errno == EEXIST) {
-            // 共享内存已存在，先删除再创建
-            shm_unlink(name);
-            shm_fd = shm_open(name, O_CREAT | O_RDWR | O_EXCL, 0666);
+    *fd = memfd;
+    return addr;
+}
+
+/**
+ * 创建进程池的共享内存arena
+ * huge_pages为AUTO时优先使用MFD_HUGETLB大页，大页不足时与THP一样退回
+ * 普通memfd并用MADV_HUGEPAGE建议透明大页(需要shmem_enabled为advise或
+ * always)。启用大页时每个段按大页取整。普通页只在首次写入时分配，
+ * arena按max_workers切分并不会预先占用内存；hugetlb大页在映射时即全部预留
+ * @param segment_size 每个段至少需要的字节数
+ * @param slots 段数(max_workers)
+ * @param seal 是否封印arena大小(F_SEAL_SHRINK/F_SEAL_GROW)
+ */
+pool_error_t shm_arena_create(shm_arena_t* arena, const char* name, size_t segment_size,
+                              uint32_t slots, pool_huge_pages_t huge_pages, bool seal) {
+    if (!arena || !name || segment_size == 0 || slots == 0) {
+        return POOL_ERROR_INVALID_PARAM;
+    }
+    
+    memset(arena, 0, sizeof(shm_arena_t));
+    arena->fd = -1;
+    
+    // memfd名称只出现在/proc/<pid>/fd和maps中，便于排查
+    char label[80];
+    snprintf(label, sizeof(label), "pool_%s", name);
+    
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    shm_page_kind_t page_kind = SHM_PAGES_NORMAL;
+    size_t stride = 0;
+    void* addr = NULL;
+    
+    if (huge_pages == POOL_HUGE_PAGES_AUTO) {
+        size_t huge_size = shm_hugetlb_size();
+        if (huge_size > 0) {
+            stride = shm_round_up(segment_size, huge_size);
+            addr = shm_arena_map(label, stride * slots, MFD_HUGETLB, &arena->fd);
+            if (addr) {
+                page_kind = SHM_PAGES_HUGETLB;
+                page_size = huge_size;
+            }
         }
-        
-        if (shm_fd == -1) {
-            return NULL;
+    }
+    
+    if (!addr) {
+        size_t thp_size = shm_thp_size();
+        stride = shm_round_up(segment_size,
+                              huge_pages != POOL_HUGE_PAGES_OFF ? thp_size : page_size);
+    
+        addr = shm_arena_map(label, stride * slots, 0, &arena->fd);
+        if (!addr) {
+            return POOL_ERROR_SYSTEM_CALL;
+        }
+    
+        if (huge_pages != POOL_HUGE_PAGES_OFF && shm_thp_shmem_enabled() &&
+            madvise(addr, stride * slots, MADV_HUGEPAGE) == 0) {
+            page_kind = SHM_PAGES_THP;
+            page_size = thp_size;
         }
     }
     
-    // 设置共享内存大小
-    if (ftruncate(shm_fd, size) == -1) {
-        close(shm_fd);
-        shm_unlink(name);
+    // 封印后即使有人经/proc/<pid>/fd拿到memfd也无法截断arena，各进程的映射不会SIGBUS
+    if (seal && fcntl(arena->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1) {
+        log_message(NULL, 1, "Failed to seal shared memory arena: %s", strerror(errno));
+    }
+    
+    arena->base = addr;
+    arena->size = stride * slots;
+    arena->stride = stride;
+    arena->slots = slots;
+    arena->page_size = (uint32_t)page_size;
+    arena->page_kind = page_kind;
+    
+    return POOL_SUCCESS;
+}
+
+void shm_arena_destroy(shm_arena_t* arena) {
+    if (!arena) {
+        return;
+    }
+    
+    if (arena->base) {
+        munmap(arena->base, arena->size);
+        arena->base = NULL;
+    }
+    
+    if (arena->fd >= 0) {
+        close(arena->fd);
+        arena->fd = -1;
+    }
+}
+
+/**
+ * 按槽位取段地址，不检查段是否已初始化
+ */
+shared_memory_t* shm_arena_segment(const shm_arena_t* arena, uint32_t slot) {
+    if (!arena || !arena->base || slot >= arena->slots) {
         return NULL;
     }
     
-    // 映射共享内存
-    void* addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    if (addr == MAP_FAILED) {
-        close(shm_fd);
-        shm_unlink(name);
+    return (shared_memory_t*)((char*)arena->base + (size_t)slot * arena->stride);
+}
+
+/**
+ * 初始化槽位上的段头，环由shm_init_rings另行初始化
+ */
+shared_memory_t* shm_segment_init(shm_arena_t* arena, uint32_t slot, int numa_node) {
+    shared_memory_t* shm = shm_arena_segment(arena, slot);
+    if (!shm) {
         return NULL;
     }
     
-    close(shm_fd); // 映射后可以关闭文件描述符
+    // 段的页面尚未分配(或已在释放时归还)，先设置NUMA策略，之后的首次写入都落在指定节点
+    if (affinity_bind_memory(shm, arena->stride, numa_node) != 0) {
+        log_message(NULL, 1, "mbind to node %d failed for segment %u: %s",
+                   numa_node, slot, strerror(errno));
+    }
     
     // 初始化共享内存结构
-    shared_memory_t* shm = (shared_memory_t*)addr;
     memset(shm, 0, sizeof(shared_memory_t));
     
-    // 设置魔数和版本
-    shm->magic = SHM_MAGIC;
     shm->version = SHM_VERSION;
-    shm->size = size;
+    shm->size = arena->stride;
+    shm->page_size = arena->page_size;
+    shm->page_kind = arena->page_kind;
     
     // 初始化原子变量
-    ATOMIC_STORE(&shm->producer_pos, 0);
-    ATOMIC_STORE(&shm->consumer_pos, 0);
     ATOMIC_STORE(&shm->total_submitted, 0);
     ATOMIC_STORE(&shm->total_completed, 0);
     ATOMIC_STORE(&shm->total_failed, 0);
+    ATOMIC_STORE(&shm->total_stolen, 0);
+    ATOMIC_STORE(&shm->total_stolen_from, 0);
+    ATOMIC_STORE(&shm->total_cancelled, 0);
+    ATOMIC_STORE(&shm->urgent_pending, 0);
+    ATOMIC_STORE(&shm->running_task_id, 0);
+    ATOMIC_STORE(&shm->heartbeat_ns, 0);
+    ATOMIC_STORE(&shm->master_reaping, 0);
+    ATOMIC_STORE(&shm->result_signalled, 0);
+    ATOMIC_STORE(&shm->worker_awake, 0);
+    ATOMIC_STORE(&shm->peer_slots, 0);
+    
+    // 取消表为空
+    for (uint32_t i = 0; i < SHM_CANCEL_SLOTS; i++) {
+        ATOMIC_STORE(&shm->cancel_words[i], 0);
+    }
+    
+    // 任务表初始为已释放状态，登记前不会被任何一方认领
+    for (uint32_t i = 0; i < SHM_STEAL_SLOTS; i++) {
+        ATOMIC_STORE(&shm->steal_slots[i].word, STEAL_WORD(0, STEAL_STATE_COPIED));
+    }
+    
+    // 最后设置魔数，其他Worker看到魔数时任务表已经初始化
+    MEMORY_BARRIER();
+    shm->magic = SHM_MAGIC;
+    
+    return shm;
+}
+
+/**
+ * 释放槽位上的段，arena映射保持不变
+ */
+void shm_segment_release(shm_arena_t* arena, shared_memory_t* shm) {
+    if (!arena || !shm) {
+        return;
+    }
+    
+    // 清除魔数，其他Worker据此不再访问该段
+    shm->magic = 0;
+    MEMORY_BARRIER();
+    
+    // 销毁同步原语
+    pthread_mutex_destroy(&shm->submit_ring.mutex);
+    pthread_cond_destroy(&shm->submit_ring.not_empty);
+    pthread_cond_destroy(&shm->submit_ring.not_full);
+    pthread_mutex_destroy(&shm->complete_ring.mutex);
+    pthread_cond_destroy(&shm->complete_ring.not_empty);
+    pthread_cond_destroy(&shm->complete_ring.not_full);
+    
+    // 归还段的物理页，缩容后空闲的槽位不再占用内存。hugetlb段保留已预留的
+    // 大页，否则重新创建时可能因大页被占用而在首次访问时SIGBUS
+    if (arena->page_kind != SHM_PAGES_HUGETLB &&
+        madvise(shm, arena->stride, MADV_REMOVE) != 0) {
+        log_message(NULL, 3, "MADV_REMOVE failed for shared memory segment: %s", strerror(errno));
+    }
+}
+
+// ============================================================================
+// 共享内存布局
+// ============================================================================
+
+// 记录头必须能放进一个对齐单元，环尾剩余空间才总能写下回绕标记
+_Static_assert(sizeof(shm_record_t) <= SHM_RECORD_ALIGN,
+               "shm_record_t must fit in one record alignment unit");
+
+static inline size_t shm_align_up(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+static inline size_t shm_ring_bytes(size_t ring_size) {
+    if (ring_size == 0) {
+        ring_size = DEFAULT_SHM_RING_SIZE;
+    }
+    if (ring_size < SHM_RING_MIN_SIZE) {
+        ring_size = SHM_RING_MIN_SIZE;
+    }
+    return shm_align_up(ring_size, SHM_RECORD_ALIGN);
+}
+
+static inline size_t shm_header_size(void) {
+    return shm_align_up(sizeof(shared_memory_t), SHM_RECORD_ALIGN);
+}
+
+/**
+ * 计算共享内存段大小
+ * 段大小只取决于配置的环字节数，与单条记录的最大负载无关；
+ * 流通道的管道页面只在执行流式任务时才被写入
+ */
+size_t shm_segment_size(size_t ring_size) {
+    return shm_header_size() + 2 * shm_ring_bytes(ring_size) + 2 * SHM_STREAM_PIPE_SIZE;
+}
+
+static void shm_pipe_init(shm_pipe_t* pipe, char* area) {
+    pipe->capacity = SHM_STREAM_PIPE_SIZE;
+    pipe->data_offset = (size_t)(area - (char*)pipe);
+    ATOMIC_STORE(&pipe->write_pos, 0);
+    ATOMIC_STORE(&pipe->closed, 0);
+    ATOMIC_STORE(&pipe->read_pos, 0);
+    ATOMIC_STORE(&pipe->abandoned, 0);
+    ATOMIC_STORE(&pipe->seq, 0);
+    ATOMIC_STORE(&pipe->waiters, 0);
+}
+
+static int shm_ring_init(shm_ring_t* ring, size_t capacity, char* area,
+                         shm_ring_mode_t mode) {
+    ring->mode = mode;
+    ATOMIC_STORE(&ring->producer_pos, 0);
+    ATOMIC_STORE(&ring->consumer_pos, 0);
+    ATOMIC_STORE(&ring->records_produced, 0);
+    ATOMIC_STORE(&ring->records_consumed, 0);
+    ATOMIC_STORE(&ring->data_seq, 0);
+    ATOMIC_STORE(&ring->consumer_sleeping, 0);
+    ATOMIC_STORE(&ring->space_seq, 0);
+    ATOMIC_STORE(&ring->producer_sleeping, 0);
+    ATOMIC_STORE(&ring->space_wake_pos, 0);
+    ring->reserve_pos = 0;
+    ring->cached_consumer_pos = 0;
+    ring->cached_producer_pos = 0;
+    ring->capacity = capacity;
+    ring->data_offset = (size_t)(area - (char*)ring);
     
     // 初始化互斥锁（进程间共享）
     pthread_mutexattr_t mutex_attr;
-    if (pthread_mutexattr_init(&mutex_attr) == 0) {
-        pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
-        pthread_mutex_init(&shm->mutex, &mutex_attr);
-        pthread_mutexattr_destroy(&mutex_attr);
+    if (pthread_mutexattr_init(&mutex_attr) != 0) {
+        return -1;
+    }
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    int ret = pthread_mutex_init(&ring->mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+    if (ret != 0) {
+        return -1;
     }
     
     // 初始化条件变量（进程间共享）
     pthread_condattr_t cond_attr;
-    if (pthread_condattr_init(&cond_attr) == 0) {
-        pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
-        pthread_cond_init(&shm->not_empty, &cond_attr);
-        pthread_cond_init(&shm->not_full, &cond_attr);
-        pthread_condattr_destroy(&cond_attr);
+    if (pthread_condattr_init(&cond_attr) != 0) {
+        pthread_mutex_destroy(&ring->mutex);
+        return -1;
     }
+    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&ring->not_empty, &cond_attr);
+    pthread_cond_init(&ring->not_full, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
     
-    return shm;
+    return 0;
 }
 
-shared_memory_t* shm_open_existing(const char* name, size_t size) {
-    if (!name || size == 0) {
-        return NULL;
+int shm_init_rings(shared_memory_t* shm, size_t ring_size, shm_ring_mode_t mode) {
+    if (!shm || shm_segment_size(ring_size) > shm->size) {
+        return -1;
     }
     
-    // 打开现有的共享内存对象
-    int shm_fd = shm_open(name, O_RDWR, 0666);
-    if (shm_fd == -1) {
-        return NULL;
-    }
+    // 提交环在前，完成环紧随其后，两者起始地址都按缓存行对齐
+    size_t capacity = shm_ring_bytes(ring_size);
+    char* submit_area = (char*)shm + shm_header_size();
+    char* complete_area = submit_area + capacity;
     
-    // 映射共享内存
-    void* addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    if (addr == MAP_FAILED) {
-        close(shm_fd);
-        return NULL;
+    if (shm_ring_init(&shm->submit_ring, capacity, submit_area, mode) != 0) {
+        return -1;
     }
     
-    close(shm_fd);
+    if (shm_ring_init(&shm->complete_ring, capacity, complete_area, mode) != 0) {
+        pthread_mutex_destroy(&shm->submit_ring.mutex);
+        pthread_cond_destroy(&shm->submit_ring.not_empty);
+        pthread_cond_destroy(&shm->submit_ring.not_full);
+        return -1;
+    }
     
-    shared_memory_t* shm = (shared_memory_t*)addr;
+    // 流通道的两个管道在完成环之后
+    char* input_area = complete_area + capacity;
+    shm_pipe_init(&shm->stream.input, input_area);
+    shm_pipe_init(&shm->stream.output, input_area + SHM_STREAM_PIPE_SIZE);
+    ATOMIC_STORE(&shm->stream.task_id, 0);
+    ATOMIC_STORE(&shm->stream.master_busy, 0);
     
-    // 验证魔数和版本
-    if (shm->magic != SHM_MAGIC || shm->version != SHM_VERSION) {
-        munmap(addr, size);
-        return NULL;
+    return 0;
+}
+
+// ============================================================================
+// 共享内存环基础操作
+// ============================================================================
+
+static inline shm_record_t* shm_ring_at(shm_ring_t* ring, uint64_t pos) {
+    char* area = (char*)ring + ring->data_offset;
+    return (shm_record_t*)(area + pos % ring->capacity);
+}
+
+/**
+ * 按字节位置取记录(供窃取者定位已登记的记录)
+ */
+shm_record_t* shm_ring_record_at(shm_ring_t* ring, uint64_t pos) {
+    return ring ? shm_ring_at(ring, pos) : NULL;
+}
+
+static inline size_t shm_record_size(size_t data_size) {
+    return shm_align_up(sizeof(shm_record_t) + data_size, SHM_RECORD_ALIGN);
+}
+
+static inline size_t shm_ring_used(shm_ring_t* ring) {
+    uint64_t producer_pos = ATOMIC_LOAD(&ring->producer_pos);
+    uint64_t consumer_pos = ATOMIC_LOAD(&ring->consumer_pos);
+    return (size_t)(producer_pos - consumer_pos);
+}
+
+static inline bool shm_queue_is_full(shm_ring_t* ring) {
+    // 剩余空间放不下一条最小记录即视为满
+    return ring->capacity - shm_ring_used(ring) < SHM_RECORD_ALIGN;
+}
+
+static inline bool shm_queue_is_empty(shm_ring_t* ring) {
+    uint64_t producer_pos = ATOMIC_LOAD(&ring->producer_pos);
+    uint64_t consumer_pos = ATOMIC_LOAD(&ring->consumer_pos);
+    return producer_pos == consumer_pos;
+}
+
+static inline uint32_t shm_queue_size(shm_ring_t* ring) {
+    uint64_t consumed = ATOMIC_LOAD(&ring->records_consumed);
+    uint64_t produced = ATOMIC_LOAD(&ring->records_produced);
+    return (uint32_t)(produced - consumed);
+}
+
+// ============================================================================
+// futex休眠唤醒
+// ============================================================================
+
+/**
+ * 在共享字上等待(跨进程，不能使用FUTEX_PRIVATE_FLAG)
+ * timeout为NULL表示无限等待；返回-1且errno为ETIMEDOUT表示超时
+ */
+static int shm_futex_wait(atomic_uint* addr, uint32_t expected,
+                          const struct timespec* timeout) {
+    return (int)syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAIT, expected,
+                        timeout, NULL, 0);
+}
+
+static void shm_futex_wake(atomic_uint* addr) {
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+ * 生产者发布记录
+ * 与等待方的"声明休眠-屏障-复查"配对：发布位置后先做全屏障再读休眠标志，
+ * 双方至少有一方能看到对方的写入，因此不会丢失唤醒，也不会在无人等待时
+ * 陷入内核。唤醒方清除休眠标志，对端被调度前的后续发布不再重复唤醒
+ */
+static inline void shm_ring_publish_producer(shm_ring_t* ring, uint64_t producer_pos) {
+    ATOMIC_STORE_RELEASE(&ring->producer_pos, producer_pos);
+    MEMORY_BARRIER();
+    if (ATOMIC_LOAD(&ring->consumer_sleeping) &&
+        ATOMIC_EXCHANGE(&ring->consumer_sleeping, 0)) {
+        ATOMIC_ADD(&ring->data_seq, 1);
+        shm_futex_wake(&ring->data_seq);
     }
-    
-    return shm;
 }
 
-void shm_destroy(shared_memory_t* shm, const char* name, size_t size) {
-    if (!shm || !name) {
-        return;
+/**
+ * 消费者归还空间(配对方式同上)
+ * 休眠的生产者只在释放量达到其唤醒水位后才被唤醒，避免满环时每条记录
+ * 都触发一次唤醒和上下文切换
+ */
+static inline void shm_ring_publish_consumer(shm_ring_t* ring, uint64_t consumer_pos) {
+    ATOMIC_STORE_RELEASE(&ring->consumer_pos, consumer_pos);
+    MEMORY_BARRIER();
+    if (ATOMIC_LOAD(&ring->producer_sleeping) &&
+        consumer_pos >= ATOMIC_LOAD_RELAXED(&ring->space_wake_pos) &&
+        ATOMIC_EXCHANGE(&ring->producer_sleeping, 0)) {
+        ATOMIC_ADD(&ring->space_seq, 1);
+        shm_futex_wake(&ring->space_seq);
     }
+}
+
+static inline bool shm_ring_has_space(shm_ring_t* ring, uint64_t end_pos) {
+    ring->cached_consumer_pos = ATOMIC_LOAD_ACQUIRE(&ring->consumer_pos);
+    return end_pos <= ring->cached_consumer_pos + ring->capacity;
+}
+
+static inline bool shm_ring_has_data(shm_ring_t* ring, uint64_t consumer_pos) {
+    ring->cached_producer_pos = ATOMIC_LOAD_ACQUIRE(&ring->producer_pos);
+    return consumer_pos != ring->cached_producer_pos;
+}
+
+/**
+ * 生产者等待消费者释放空间直到end_pos可写
+ */
+static void shm_ring_wait_space(shm_ring_t* ring, uint64_t end_pos) {
+    // 唤醒水位：至少能放下本条记录，且最好等到半个环空闲再批量写入
+    uint64_t producer_pos = ATOMIC_LOAD_RELAXED(&ring->producer_pos);
+    uint64_t wake_pos = end_pos - ring->capacity;
+    if (producer_pos > ring->capacity / 2 &&
+        producer_pos - ring->capacity / 2 > wake_pos) {
+        wake_pos = producer_pos - ring->capacity / 2;
+    }
+    ATOMIC_STORE_RELAXED(&ring->space_wake_pos, wake_pos);
     
-    // 销毁同步原语
-    pthread_mutex_destroy(&shm->mutex);
-    pthread_cond_destroy(&shm->not_empty);
-    pthread_cond_destroy(&shm->not_full);
-    
-    // 取消映射
-    munmap(shm, size);
+    while (!shm_ring_has_space(ring, end_pos)) {
+        uint32_t seq = ATOMIC_LOAD(&ring->space_seq);
+        ATOMIC_STORE(&ring->producer_sleeping, 1);
+        MEMORY_BARRIER();
+        
+        if (!shm_ring_has_space(ring, end_pos)) {
+            shm_futex_wait(&ring->space_seq, seq, NULL);
+        }
+        
+        ATOMIC_STORE(&ring->producer_sleeping, 0);
+    }
+}
+
+/**
+ * 消费者等待数据到达
+ * timeout_ms为0表示无限等待；超时返回-1
+ */
+static int shm_ring_wait_data(shm_ring_t* ring, uint32_t timeout_ms) {
+    uint64_t consumer_pos = ATOMIC_LOAD_RELAXED(&ring->consumer_pos);
+    uint64_t deadline = get_time_ns() + (uint64_t)timeout_ms * 1000000ULL;
+    
+    while (!shm_ring_has_data(ring, consumer_pos)) {
+        struct timespec remaining;
+        struct timespec* timeout = NULL;
+        
+        if (timeout_ms > 0) {
+            uint64_t now = get_time_ns();
+            if (now >= deadline) {
+                return -1;
+            }
+            remaining.tv_sec = (deadline - now) / 1000000000ULL;
+            remaining.tv_nsec = (deadline - now) % 1000000000ULL;
+            timeout = &remaining;
+        }
+        
+        uint32_t seq = ATOMIC_LOAD(&ring->data_seq);
+        ATOMIC_STORE(&ring->consumer_sleeping, 1);
+        MEMORY_BARRIER();
+        
+        if (!shm_ring_has_data(ring, consumer_pos)) {
+            shm_futex_wait(&ring->data_seq, seq, timeout);
+        }
+        
+        ATOMIC_STORE(&ring->consumer_sleeping, 0);
+    }
     
-    // 删除共享内存对象
-    shm_unlink(name);
+    return 0;
 }
 
 // ============================================================================
 // 共享内存队列操作
 // ============================================================================
 
-static inline uint32_t shm_queue_next_pos(uint32_t pos, uint32_t size) {
-    return (pos + 1) % size;
+/**
+ * 取队首记录，跳过回绕标记(队列非空；互斥模式下调用方持有ring->mutex)
+ * 回绕标记总是与其后的记录一起提交，跳过后队列不会变空
+ */
+static shm_record_t* shm_ring_front(shm_ring_t* ring) {
+    uint64_t consumer_pos = ATOMIC_LOAD_RELAXED(&ring->consumer_pos);
+    shm_record_t* rec = shm_ring_at(ring, consumer_pos);
+    
+    if (rec->flags & SHM_RECORD_WRAP) {
+        consumer_pos += rec->record_size;
+        if (ring->mode == SHM_RING_SPSC) {
+            shm_ring_publish_consumer(ring, consumer_pos);
+        } else {
+            ATOMIC_STORE(&ring->consumer_pos, consumer_pos);
+            pthread_cond_signal(&ring->not_full);
+        }
+        rec = shm_ring_at(ring, consumer_pos);
+    }
+    
+    return rec;
+}
+
+/**
+ * 预留生产者记录
+ * 记录长度按负载大小计算并对齐到缓存行；环尾剩余空间不足时先写入
+ * 回绕标记再从记录区开头分配。单生产者模型下，预留的字节在提交前
+ * 只属于生产者，因此调用方可以直接在返回的记录中构造数据，无需额外拷贝。
+ * 新记录紧接在上一条预留记录之后，可以连续预留多条再一次提交
+ */
+shm_record_t* shm_ring_reserve(shm_ring_t* ring, size_t data_size, bool wait) {
+    if (!ring || data_size > SHM_RECORD_MAX_DATA) {
+        return NULL;
+    }
+    
+    size_t need = shm_record_size(data_size);
+    uint64_t producer_pos = ring->reserve_pos;
+    size_t offset = producer_pos % ring->capacity;
+    size_t wrap = (offset + need > ring->capacity) ? ring->capacity - offset : 0;
+    uint64_t end_pos = producer_pos + wrap + need;
+    
+    if (ring->mode == SHM_RING_SPSC) {
+        // 先用缓存的消费者位置判断，空间不足时才读取消费者缓存行
+        if (end_pos > ring->cached_consumer_pos + ring->capacity &&
+            !shm_ring_has_space(ring, end_pos)) {
+            if (!wait) {
+                return NULL;
+            }
+            shm_ring_wait_space(ring, end_pos);
+        }
+    } else {
+        pthread_mutex_lock(&ring->mutex);
+        
+        while (end_pos > ATOMIC_LOAD(&ring->consumer_pos) + ring->capacity) {
+            if (!wait) {
+                pthread_mutex_unlock(&ring->mutex);
+                return NULL;
+            }
+            pthread_cond_wait(&ring->not_full, &ring->mutex);
+        }
+        
+        pthread_mutex_unlock(&ring->mutex);
+    }
+    
+    if (wrap > 0) {
+        shm_record_t* marker = shm_ring_at(ring, producer_pos);
+        marker->record_size = (uint32_t)wrap;
+        marker->flags = SHM_RECORD_WRAP;
+        marker->data_size = 0;
+        producer_pos += wrap;
+    }
+    
+    shm_record_t* rec = shm_ring_at(ring, producer_pos);
+    rec->record_size = (uint32_t)need;
+    rec->flags = 0;
+    rec->data_size = (uint32_t)data_size;
+    ring->reserve_pos = end_pos;
+    
+    return rec;
+}
+
+/**
+ * 撤销mark(预留前的reserve_pos)之后预留但尚未提交的记录
+ */
+void shm_ring_unreserve(shm_ring_t* ring, uint64_t mark) {
+    ring->reserve_pos = mark;
 }
 
-static inline bool shm_queue_is_full(shared_memory_t* shm) {
-    uint32_t producer_pos = ATOMIC_LOAD(&shm->producer_pos);
-    uint32_t consumer_pos = ATOMIC_LOAD(&shm->consumer_pos);
-    return shm_queue_next_pos(producer_pos, shm->queue_size) == consumer_pos;
+/**
+ * 发布已预留的记录
+ */
+void shm_ring_commit(shm_ring_t* ring) {
+    shm_ring_commit_batch(ring, 1);
 }
 
-static inline bool shm_queue_is_empty(shared_memory_t* shm) {
-    uint32_t producer_pos = ATOMIC_LOAD(&shm->producer_pos);
-    uint32_t consumer_pos = ATOMIC_LOAD(&shm->consumer_pos);
-    return producer_pos == consumer_pos;
+/**
+ * 一次发布连续预留的count条记录，消费者只观察到一次生产者位置推进
+ */
+void shm_ring_commit_batch(shm_ring_t* ring, uint32_t count) {
+    uint64_t produced = ATOMIC_LOAD_RELAXED(&ring->records_produced);
+    
+    if (ring->mode == SHM_RING_SPSC) {
+        // release语义保证记录内容和任务表登记先于计数可见，窃取者以acquire读取计数
+        ATOMIC_STORE_RELEASE(&ring->records_produced, produced + count);
+        shm_ring_publish_producer(ring, ring->reserve_pos);
+        return;
+    }
+    
+    pthread_mutex_lock(&ring->mutex);
+    
+    // 内存屏障确保记录写入完成
+    MEMORY_BARRIER();
+    
+    // 更新生产者位置
+    ATOMIC_STORE(&ring->producer_pos, ring->reserve_pos);
+    ATOMIC_STORE(&ring->records_produced, produced + count);
+    
+    // 通知消费者
+    pthread_cond_signal(&ring->not_empty);
+    
+    pthread_mutex_unlock(&ring->mutex);
 }
 
-static inline uint32_t shm_queue_size(shared_memory_t* shm) {
-    uint32_t producer_pos = ATOMIC_LOAD(&shm->producer_pos);
-    uint32_t consumer_pos = ATOMIC_LOAD(&shm->consumer_pos);
+/**
+ * 查看队首记录(不出队)
+ * 返回的记录在shm_ring_release之前一直有效，消费者可以原地处理
+ */
+shm_record_t* shm_ring_peek(shm_ring_t* ring) {
+    if (!ring) {
+        return NULL;
+    }
     
-    if (producer_pos >= consumer_pos) {
-        return producer_pos - consumer_pos;
-    } else {
-        return shm->queue_size - consumer_pos + producer_pos;
+    if (ring->mode == SHM_RING_SPSC) {
+        // 先用缓存的生产者位置判断，追上缓存值时才读取生产者缓存行
+        uint64_t consumer_pos = ATOMIC_LOAD_RELAXED(&ring->consumer_pos);
+        if (consumer_pos == ring->cached_producer_pos &&
+            !shm_ring_has_data(ring, consumer_pos)) {
+            return NULL;
+        }
+        return shm_ring_front(ring);
+    }
+    
+    pthread_mutex_lock(&ring->mutex);
+    
+    shm_record_t* rec = NULL;
+    if (!shm_queue_is_empty(ring)) {
+        rec = shm_ring_front(ring);
     }
+    
+    pthread_mutex_unlock(&ring->mutex);
+    
+    return rec;
 }
 
-int shm_queue_enqueue(shared_memory_t* shm, const void* data, size_t data_size) {
-    if (!shm || !data || data_size == 0 || data_size > MAX_TASK_DATA_SIZE) {
-        return -1;
+/**
+ * 释放队首记录，其字节归还给生产者
+ */
+void shm_ring_release(shm_ring_t* ring) {
+    uint64_t consumer_pos = ATOMIC_LOAD_RELAXED(&ring->consumer_pos);
+    uint64_t consumed = ATOMIC_LOAD_RELAXED(&ring->records_consumed);
+    shm_record_t* rec = shm_ring_at(ring, consumer_pos);
+    
+    if (ring->mode == SHM_RING_SPSC) {
+        // release语义保证记录读取先于空间归还
+        ATOMIC_STORE_RELAXED(&ring->records_consumed, consumed + 1);
+        shm_ring_publish_consumer(ring, consumer_pos + rec->record_size);
+        return;
     }
     
-    pthread_mutex_lock(&shm->mutex);
+    pthread_mutex_lock(&ring->mutex);
+    
+    // 内存屏障确保记录读取完成
+    MEMORY_BARRIER();
+    
+    // 更新消费者位置
+    ATOMIC_STORE(&ring->consumer_pos, consumer_pos + rec->record_size);
+    ATOMIC_STORE(&ring->records_consumed, consumed + 1);
+    
+    // 通知生产者
+    pthread_cond_signal(&ring->not_full);
     
-    // 等待队列有空间
-    while (shm_queue_is_full(shm)) {
-        pthread_cond_wait(&shm->not_full, &shm->mutex);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+/**
+ * 批量消费：把最多max_count条已提交的记录依次交给consume原地处理，
+ * 处理完后一次归还整批空间，生产者只观察到一次消费者位置推进
+ * @return 处理的记录数
+ */
+uint32_t shm_ring_consume_batch(shm_ring_t* ring, uint32_t max_count,
+                                shm_consume_fn consume, void* arg) {
+    if (!ring || !consume || max_count == 0) {
+        return 0;
     }
     
-    uint32_t producer_pos = ATOMIC_LOAD(&shm->producer_pos);
+    uint64_t start_pos = ATOMIC_LOAD_RELAXED(&ring->consumer_pos);
+    uint64_t consumer_pos = start_pos;
+    uint64_t producer_pos;
     
-    // 计算数据存储位置
-    char* queue_data = (char*)shm + sizeof(shared_memory_t);
-    char* slot = queue_data + producer_pos * MAX_TASK_DATA_SIZE;
+    // 只读取一次生产者位置，之后提交的记录留给下一批
+    if (ring->mode == SHM_RING_SPSC) {
+        producer_pos = ATOMIC_LOAD_ACQUIRE(&ring->producer_pos);
+        ring->cached_producer_pos = producer_pos;
+    } else {
+        pthread_mutex_lock(&ring->mutex);
+        producer_pos = ATOMIC_LOAD(&ring->producer_pos);
+        pthread_mutex_unlock(&ring->mutex);
+    }
     
-    // 存储数据大小（前4字节）
-    *(uint32_t*)slot = (uint32_t)data_size;
+    uint32_t count = 0;
+    while (count < max_count && consumer_pos != producer_pos) {
+        shm_record_t* rec = shm_ring_at(ring, consumer_pos);
+        if (!(rec->flags & SHM_RECORD_WRAP)) {
+            consume(rec, arg);
+            count++;
+        }
+        consumer_pos += rec->record_size;
+    }
     
-    // 存储数据内容
-    memcpy(slot + sizeof(uint32_t), data, data_size);
+    if (consumer_pos == start_pos) {
+        return 0;
+    }
     
-    // 内存屏障确保数据写入完成
-    MEMORY_BARRIER();
+    uint64_t consumed = ATOMIC_LOAD_RELAXED(&ring->records_consumed);
     
-    // 更新生产者位置
-    ATOMIC_STORE(&shm->producer_pos, shm_queue_next_pos(producer_pos, shm->queue_size));
+    if (ring->mode == SHM_RING_SPSC) {
+        ATOMIC_STORE_RELAXED(&ring->records_consumed, consumed + count);
+        shm_ring_publish_consumer(ring, consumer_pos);
+        return count;
+    }
     
-    // 更新统计信息
-    ATOMIC_ADD(&shm->total_submitted, 1);
+    pthread_mutex_lock(&ring->mutex);
     
-    // 通知消费者
-    pthread_cond_signal(&shm->not_empty);
+    MEMORY_BARRIER();
+    ATOMIC_STORE(&ring->consumer_pos, consumer_pos);
+    ATOMIC_STORE(&ring->records_consumed, consumed + count);
+    pthread_cond_broadcast(&ring->not_full);
     
-    pthread_mutex_unlock(&shm->mutex);
+    pthread_mutex_unlock(&ring->mutex);
     
-    return 0;
+    return count;
 }
 
-int shm_queue_dequeue(shared_memory_t* shm, void* data, size_t* data_size, uint32_t timeout_ms) {
-    if (!shm || !data || !data_size) {
+int shm_queue_enqueue(shm_ring_t* ring, const void* data, size_t data_size) {
+    if (!ring || !data || data_size == 0) {
+        return -1;
+    }
+    
+    shm_record_t* rec = shm_ring_reserve(ring, data_size, true);
+    if (!rec) {
         return -1;
     }
     
-    pthread_mutex_lock(&shm->mutex);
+    memcpy(SHM_RECORD_DATA(rec), data, data_size);
+    shm_ring_commit(ring);
     
-    int result = 0;
+    return 0;
+}
+
+/**
+ * 互斥模式下等待并取队首记录
+ * timeout_ms为0表示无限等待；超时返回NULL
+ */
+static shm_record_t* shm_ring_wait_front_locked(shm_ring_t* ring, uint32_t timeout_ms) {
+    pthread_mutex_lock(&ring->mutex);
     
     if (timeout_ms == 0) {
         // 无限等待
-        while (shm_queue_is_empty(shm)) {
-            pthread_cond_wait(&shm->not_empty, &shm->mutex);
+        while (shm_queue_is_empty(ring)) {
+            pthread_cond_wait(&ring->not_empty, &ring->mutex);
         }
     } else {
         // 超时等待
         struct timespec abs_timeout;
-        clock_gettime(CLOCK_REALTIME, &abs_timeout);
+        clock_gettime(CLOCK_MONOTONIC, &abs_timeout);
         
         abs_timeout.tv_sec += timeout_ms / 1000;
         abs_timeout.tv_nsec += (timeout_ms % 1000) * 1000000;
@@ -229,131 +866,214 @@ int shm_queue_dequeue(shared_memory_t* shm, void* data, size_t* data_size, uint3
             abs_timeout.tv_nsec -= 1000000000;
         }
         
-        while (shm_queue_is_empty(shm)) {
-            int ret = pthread_cond_timedwait(&shm->not_empty, &shm->mutex, &abs_timeout);
-            if (ret == ETIMEDOUT) {
-                result = -1;
-                goto cleanup;
-            } else if (ret != 0) {
-                result = -1;
-                goto cleanup;
+        while (shm_queue_is_empty(ring)) {
+            int ret = pthread_cond_timedwait(&ring->not_empty, &ring->mutex, &abs_timeout);
+            if (ret != 0) {
+                pthread_mutex_unlock(&ring->mutex);
+                return NULL;
             }
         }
     }
     
-    uint32_t consumer_pos = ATOMIC_LOAD(&shm->consumer_pos);
+    shm_record_t* rec = shm_ring_front(ring);
+    
+    pthread_mutex_unlock(&ring->mutex);
+    
+    return rec;
+}
+
+int shm_queue_dequeue(shm_ring_t* ring, void* data, size_t* data_size, uint32_t timeout_ms) {
+    if (!ring || !data || !data_size) {
+        return -1;
+    }
     
-    // 计算数据读取位置
-    char* queue_data = (char*)shm + sizeof(shared_memory_t);
-    char* slot = queue_data + consumer_pos * MAX_TASK_DATA_SIZE;
+    shm_record_t* rec;
     
-    // 读取数据大小
-    uint32_t stored_size = *(uint32_t*)slot;
+    if (ring->mode == SHM_RING_SPSC) {
+        if (shm_ring_wait_data(ring, timeout_ms) != 0) {
+            return -1;
+        }
+        rec = shm_ring_front(ring);
+    } else {
+        rec = shm_ring_wait_front_locked(ring, timeout_ms);
+        if (!rec) {
+            return -1;
+        }
+    }
     
-    if (stored_size > *data_size) {
+    if (rec->data_size > *data_size) {
         // 缓冲区太小
-        *data_size = stored_size;
-        result = -1;
-        goto cleanup;
+        *data_size = rec->data_size;
+        return -1;
     }
     
     // 读取数据内容
-    memcpy(data, slot + sizeof(uint32_t), stored_size);
-    *data_size = stored_size;
+    memcpy(data, SHM_RECORD_DATA(rec), rec->data_size);
+    *data_size = rec->data_size;
     
-    // 内存屏障确保数据读取完成
-    MEMORY_BARRIER();
+    shm_ring_release(ring);
     
-    // 更新消费者位置
-    ATOMIC_STORE(&shm->consumer_pos, shm_queue_next_pos(consumer_pos, shm->queue_size));
+    return 0;
+}
+
+int shm_queue_try_enqueue(shm_ring_t* ring, const void* data, size_t data_size) {
+    if (!ring || !data || data_size == 0) {
+        return -1;
+    }
     
-    // 通知生产者
-    pthread_cond_signal(&shm->not_full);
+    shm_record_t* rec = shm_ring_reserve(ring, data_size, false);
+    if (!rec) {
+        return -1;
+    }
     
-cleanup:
-    pthread_mutex_unlock(&shm->mutex);
-    return result;
+    memcpy(SHM_RECORD_DATA(rec), data, data_size);
+    shm_ring_commit(ring);
+    
+    return 0;
 }
 
-int shm_queue_try_enqueue(shared_memory_t* shm, const void* data, size_t data_size) {
-    if (!shm || !data || data_size == 0 || data_size > MAX_TASK_DATA_SIZE) {
+int shm_queue_try_dequeue(shm_ring_t* ring, void* data, size_t* data_size) {
+    if (!ring || !data || !data_size) {
         return -1;
     }
     
-    if (pthread_mutex_trylock(&shm->mutex) != 0) {
-        return -1; // 无法获取锁
+    shm_record_t* rec = shm_ring_peek(ring);
+    if (!rec) {
+        return -1;
     }
     
-    int result = -1;
-    
-    if (!shm_queue_is_full(shm)) {
-        uint32_t producer_pos = ATOMIC_LOAD(&shm->producer_pos);
-        
-        // 计算数据存储位置
-        char* queue_data = (char*)shm + sizeof(shared_memory_t);
-        char* slot = queue_data + producer_pos * MAX_TASK_DATA_SIZE;
-        
-        // 存储数据
-        *(uint32_t*)slot = (uint32_t)data_size;
-        memcpy(slot + sizeof(uint32_t), data, data_size);
-        
-        MEMORY_BARRIER();
-        
-        // 更新位置
-        ATOMIC_STORE(&shm->producer_pos, shm_queue_next_pos(producer_pos, shm->queue_size));
-        ATOMIC_ADD(&shm->total_submitted, 1);
-        
-        // 通知消费者
-        pthread_cond_signal(&shm->not_empty);
-        
-        result = 0;
+    if (rec->data_size > *data_size) {
+        *data_size = rec->data_size; // 返回所需大小
+        return -1;
     }
     
-    pthread_mutex_unlock(&shm->mutex);
-    return result;
+    memcpy(data, SHM_RECORD_DATA(rec), rec->data_size);
+    *data_size = rec->data_size;
+    
+    shm_ring_release(ring);
+    
+    return 0;
 }
 
-int shm_queue_try_dequeue(shared_memory_t* shm, void* data, size_t* data_size) {
-    if (!shm || !data || !data_size) {
-        return -1;
+// ============================================================================
+// 流式任务管道
+// ============================================================================
+
+static void shm_pipe_notify(shm_pipe_t* pipe) {
+    ATOMIC_ADD(&pipe->seq, 1);
+    if (ATOMIC_LOAD(&pipe->waiters) > 0) {
+        shm_futex_wake(&pipe->seq);
+    }
+}
+
+/**
+ * Worker开始执行流式任务：重置两个管道后写入task_id，再唤醒等待通道的
+ * Master线程。seq和waiters保持不变，等待者不会错过唤醒
+ */
+void shm_stream_open(shm_stream_t* stream, uint64_t task_id) {
+    shm_pipe_t* pipes[2] = { &stream->input, &stream->output };
+    
+    for (int i = 0; i < 2; i++) {
+        ATOMIC_STORE(&pipes[i]->write_pos, 0);
+        ATOMIC_STORE(&pipes[i]->read_pos, 0);
+        ATOMIC_STORE(&pipes[i]->closed, 0);
+        ATOMIC_STORE(&pipes[i]->abandoned, 0);
     }
     
-    if (pthread_mutex_trylock(&shm->mutex) != 0) {
-        return -1; // 无法获取锁
+    ATOMIC_STORE(&stream->task_id, task_id);
+    
+    for (int i = 0; i < 2; i++) {
+        shm_pipe_notify(pipes[i]);
+    }
+}
+
+/**
+ * 写入尽可能多的数据，不等待
+ * @return 写入的字节数，管道满时为0
+ */
+size_t shm_pipe_write(shm_pipe_t* pipe, const void* data, size_t size) {
+    uint64_t write_pos = ATOMIC_LOAD_RELAXED(&pipe->write_pos);
+    uint64_t read_pos = ATOMIC_LOAD_ACQUIRE(&pipe->read_pos);
+    size_t space = pipe->capacity - (size_t)(write_pos - read_pos);
+    size_t n = size < space ? size : space;
+    
+    if (n == 0) {
+        return 0;
     }
     
-    int result = -1;
+    char* area = (char*)pipe + pipe->data_offset;
+    size_t offset = write_pos % pipe->capacity;
+    size_t first = pipe->capacity - offset < n ? pipe->capacity - offset : n;
     
-    if (!shm_queue_is_empty(shm)) {
-        uint32_t consumer_pos = ATOMIC_LOAD(&shm->consumer_pos);
-        
-        // 计算数据读取位置
-        char* queue_data = (char*)shm + sizeof(shared_memory_t);
-        char* slot = queue_data + consumer_pos * MAX_TASK_DATA_SIZE;
-        
-        // 读取数据
-        uint32_t stored_size = *(uint32_t*)slot;
-        
-        if (stored_size <= *data_size) {
-            memcpy(data, slot + sizeof(uint32_t), stored_size);
-            *data_size = stored_size;
-            
-            MEMORY_BARRIER();
-            
-            // 更新位置
-            ATOMIC_STORE(&shm->consumer_pos, shm_queue_next_pos(consumer_pos, shm->queue_size));
-            
-            // 通知生产者
-            pthread_cond_signal(&shm->not_full);
-            
-            result = 0;
-        } else {
-            *data_size = stored_size; // 返回所需大小
-        }
+    memcpy(area + offset, data, first);
+    memcpy(area, (const char*)data + first, n - first);
+    
+    ATOMIC_STORE_RELEASE(&pipe->write_pos, write_pos + n);
+    shm_pipe_notify(pipe);
+    return n;
+}
+
+/**
+ * 读取尽可能多的数据，不等待
+ * @return 读取的字节数，管道空时为0
+ */
+size_t shm_pipe_read(shm_pipe_t* pipe, void* buffer, size_t size) {
+    uint64_t read_pos = ATOMIC_LOAD_RELAXED(&pipe->read_pos);
+    uint64_t write_pos = ATOMIC_LOAD_ACQUIRE(&pipe->write_pos);
+    size_t available = (size_t)(write_pos - read_pos);
+    size_t n = size < available ? size : available;
+    
+    if (n == 0) {
+        return 0;
     }
     
-    pthread_mutex_unlock(&shm->mutex);
-    return result;
+    char* area = (char*)pipe + pipe->data_offset;
+    size_t offset = read_pos % pipe->capacity;
+    size_t first = pipe->capacity - offset < n ? pipe->capacity - offset : n;
+    
+    memcpy(buffer, area + offset, first);
+    memcpy((char*)buffer + first, area, n - first);
+    
+    ATOMIC_STORE_RELEASE(&pipe->read_pos, read_pos + n);
+    shm_pipe_notify(pipe);
+    return n;
+}
+
+bool shm_pipe_empty(shm_pipe_t* pipe) {
+    return ATOMIC_LOAD(&pipe->read_pos) == ATOMIC_LOAD(&pipe->write_pos);
+}
+
+/**
+ * 写端结束，读端读完剩余数据后读到结束
+ */
+void shm_pipe_close(shm_pipe_t* pipe) {
+    ATOMIC_STORE(&pipe->closed, 1);
+    shm_pipe_notify(pipe);
+}
+
+/**
+ * 读端放弃，写端随后的写入失败
+ */
+void shm_pipe_abandon(shm_pipe_t* pipe) {
+    ATOMIC_STORE(&pipe->abandoned, 1);
+    shm_pipe_notify(pipe);
+}
+
+/**
+ * 等待管道状态变化。seq须在检查条件之前读取，之后有任何变化时立即返回；
+ * 最多等待timeout_ms，调用方据此轮询取消等外部条件
+ */
+void shm_pipe_wait(shm_pipe_t* pipe, uint32_t seq, uint32_t timeout_ms) {
+    struct timespec timeout = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_nsec = (long)(timeout_ms % 1000) * 1000000L
+    };
+    
+    ATOMIC_ADD(&pipe->waiters, 1);
+    if (ATOMIC_LOAD(&pipe->seq) == seq) {
+        shm_futex_wait(&pipe->seq, seq, &timeout);
+    }
+    ATOMIC_SUB(&pipe->waiters, 1);
 }
 
 // ============================================================================
@@ -365,17 +1085,16 @@ void shm_get_stats(shared_memory_t* shm, shm_stats_t* stats) {
         return;
     }
     
-    pthread_mutex_lock(&shm->mutex);
-    
-    stats->queue_size = shm->queue_size;
-    stats->current_size = shm_queue_size(shm);
-    stats->is_full = shm_queue_is_full(shm);
-    stats->is_empty = shm_queue_is_empty(shm);
+    // 各字段均为原子快照，SPSC模式下不经过互斥锁
+    stats->ring_capacity = shm->submit_ring.capacity;
+    stats->bytes_used = shm_ring_used(&shm->submit_ring);
+    stats->current_size = shm_queue_size(&shm->submit_ring);
+    stats->is_full = shm_queue_is_full(&shm->submit_ring);
+    stats->is_empty = shm_queue_is_empty(&shm->submit_ring);
     stats->total_submitted = ATOMIC_LOAD(&shm->total_submitted);
     stats->total_completed = ATOMIC_LOAD(&shm->total_completed);
     stats->total_failed = ATOMIC_LOAD(&shm->total_failed);
-    
-    pthread_mutex_unlock(&shm->mutex);
+    stats->completion_size = shm_queue_size(&shm->complete_ring);
 }
 
 void shm_reset_stats(shared_memory_t* shm) {
@@ -386,12 +1105,26 @@ void shm_reset_stats(shared_memory_t* shm) {
     ATOMIC_STORE(&shm->total_submitted, 0);
     ATOMIC_STORE(&shm->total_completed, 0);
     ATOMIC_STORE(&shm->total_failed, 0);
+    ATOMIC_STORE(&shm->total_stolen, 0);
+    ATOMIC_STORE(&shm->total_stolen_from, 0);
+    ATOMIC_STORE(&shm->total_cancelled, 0);
 }
 
 // ============================================================================
 // 共享内存调试和诊断
 // ============================================================================
 
+static void shm_dump_ring(shm_ring_t* ring, const char* label) {
+    printf("%s Ring: capacity=%zu bytes mode=%s\n", label, ring->capacity,
+           ring->mode == SHM_RING_SPSC ? "spsc" : "mutex");
+    printf("  Producer Position: %lu\n", ATOMIC_LOAD(&ring->producer_pos));
+    printf("  Consumer Position: %lu\n", ATOMIC_LOAD(&ring->consumer_pos));
+    printf("  Used: %zu bytes\n", shm_ring_used(ring));
+    printf("  Current Size: %u\n", shm_queue_size(ring));
+    printf("  Full: %s\n", shm_queue_is_full(ring) ? "Yes" : "No");
+    printf("  Empty: %s\n", shm_queue_is_empty(ring) ? "Yes" : "No");
+}
+
 void shm_dump_info(shared_memory_t* shm, const char* name) {
     if (!shm) {
         return;
@@ -401,24 +1134,46 @@ void shm_dump_info(shared_memory_t* shm, const char* name) {
     printf("Magic: 0x%08x\n", shm->magic);
     printf("Version: %u\n", shm->version);
     printf("Size: %zu bytes\n", shm->size);
-    printf("Queue Size: %u\n", shm->queue_size);
+    printf("Page Size: %u KB (%s)\n", shm->page_size / 1024,
+           shm->page_kind == SHM_PAGES_HUGETLB ? "hugetlb" :
+           shm->page_kind == SHM_PAGES_THP ? "THP advised" : "normal");
     
-    pthread_mutex_lock(&shm->mutex);
+    shm_dump_ring(&shm->submit_ring, "Submit");
+    shm_dump_ring(&shm->complete_ring, "Complete");
     
-    printf("Producer Position: %u\n", ATOMIC_LOAD(&shm->producer_pos));
-    printf("Consumer Position: %u\n", ATOMIC_LOAD(&shm->consumer_pos));
-    printf("Current Queue Size: %u\n", shm_queue_size(shm));
-    printf("Queue Full: %s\n", shm_queue_is_full(shm) ? "Yes" : "No");
-    printf("Queue Empty: %s\n", shm_queue_is_empty(shm) ? "Yes" : "No");
     printf("Total Submitted: %lu\n", ATOMIC_LOAD(&shm->total_submitted));
     printf("Total Completed: %lu\n", ATOMIC_LOAD(&shm->total_completed));
     printf("Total Failed: %lu\n", ATOMIC_LOAD(&shm->total_failed));
-    
-    pthread_mutex_unlock(&shm->mutex);
+    printf("Total Stolen: %lu\n", ATOMIC_LOAD(&shm->total_stolen));
+    printf("Total Stolen From: %lu\n", ATOMIC_LOAD(&shm->total_stolen_from));
+    printf("Total Cancelled: %lu\n", ATOMIC_LOAD(&shm->total_cancelled));
+    printf("Urgent Pending: %u\n", ATOMIC_LOAD(&shm->urgent_pending));
+    printf("Running Task: %lu\n", ATOMIC_LOAD(&shm->running_task_id));
+    printf("Heartbeat: %lu ns\n", ATOMIC_LOAD(&shm->heartbeat_ns));
+    printf("Master Reaping: %u, Result Signalled: %u\n",
+           ATOMIC_LOAD(&shm->master_reaping), ATOMIC_LOAD(&shm->result_signalled));
+    printf("Worker Awake: %u\n", ATOMIC_LOAD(&shm->worker_awake));
     
     printf("================================\n");
 }
 
+static bool shm_ring_validate(shm_ring_t* ring) {
+    // 检查记录区大小
+    if (ring->capacity < SHM_RING_MIN_SIZE || ring->capacity > SHM_RING_MAX_SIZE ||
+        ring->capacity % SHM_RECORD_ALIGN != 0) {
+        return false;
+    }
+    
+    // 检查位置有效性
+    uint64_t producer_pos = ATOMIC_LOAD(&ring->producer_pos);
+    uint64_t consumer_pos = ATOMIC_LOAD(&ring->consumer_pos);
+    
+    return consumer_pos <= producer_pos &&
+           producer_pos - consumer_pos <= ring->capacity &&
+           consumer_pos % SHM_RECORD_ALIGN == 0 &&
+           producer_pos % SHM_RECORD_ALIGN == 0;
+}
+
 bool shm_validate(shared_memory_t* shm) {
     if (!shm) {
         return false;
@@ -429,20 +1184,31 @@ bool shm_validate(shared_memory_t* shm) {
         return false;
     }
     
-    // 检查队列大小
-    if (shm->queue_size == 0 || shm->queue_size > MAX_QUEUE_SIZE) {
-        return false;
+    return shm_ring_validate(&shm->submit_ring) &&
+           shm_ring_validate(&shm->complete_ring);
+}
+
+static int shm_ring_repair(shm_ring_t* ring) {
+    uint64_t producer_pos = ATOMIC_LOAD(&ring->producer_pos);
+    uint64_t consumer_pos = ATOMIC_LOAD(&ring->consumer_pos);
+    
+    if (consumer_pos <= producer_pos &&
+        producer_pos - consumer_pos <= ring->capacity &&
+        consumer_pos % SHM_RECORD_ALIGN == 0 &&
+        producer_pos % SHM_RECORD_ALIGN == 0) {
+        return 0;
     }
     
-    // 检查位置有效性
-    uint32_t producer_pos = ATOMIC_LOAD(&shm->producer_pos);
-    uint32_t consumer_pos = ATOMIC_LOAD(&shm->consumer_pos);
-    
-    if (producer_pos >= shm->queue_size || consumer_pos >= shm->queue_size) {
-        return false;
-    }
+    // 位置损坏时无法再定位记录边界，只能清空整个环
+    ATOMIC_STORE(&ring->producer_pos, 0);
+    ATOMIC_STORE(&ring->consumer_pos, 0);
+    ATOMIC_STORE(&ring->records_produced, 0);
+    ATOMIC_STORE(&ring->records_consumed, 0);
+    ring->reserve_pos = 0;
+    ring->cached_consumer_pos = 0;
+    ring->cached_producer_pos = 0;
     
-    return true;
+    return 1;
 }
 
 int shm_repair(shared_memory_t* shm) {
@@ -465,18 +1231,8 @@ int shm_repair(shared_memory_t* shm) {
     }
     
     // 修复队列位置
-    uint32_t producer_pos = ATOMIC_LOAD(&shm->producer_pos);
-    uint32_t consumer_pos = ATOMIC_LOAD(&shm->consumer_pos);
-    
-    if (producer_pos >= shm->queue_size) {
-        ATOMIC_STORE(&shm->producer_pos, 0);
-        repairs++;
-    }
-    
-    if (consumer_pos >= shm->queue_size) {
-        ATOMIC_STORE(&shm->consumer_pos, 0);
-        repairs++;
-    }
+    repairs += shm_ring_repair(&shm->submit_ring);
+    repairs += shm_ring_repair(&shm->complete_ring);
     
     return repairs;
 }
@@ -485,65 +1241,163 @@ int shm_repair(shared_memory_t* shm) {
 // 共享内存性能测试
 // ============================================================================
 
-int shm_benchmark(shared_memory_t* shm, size_t num_operations, size_t data_size) {
-    if (!shm || num_operations == 0 || data_size == 0 || data_size > MAX_TASK_DATA_SIZE) {
+typedef struct {
+    shm_ring_t* ring;               // 被测环
+    size_t num_operations;          // 消息数量
+    size_t data_size;               // 消息大小
+    uint64_t* latencies;            // 每条消息的交接延迟
+} shm_bench_consumer_t;
+
+typedef struct {
+    double msgs_per_sec;            // 吞吐量
+    uint64_t p50_ns;                // 交接延迟P50
+    uint64_t p99_ns;                // 交接延迟P99
+} shm_bench_result_t;
+
+static int shm_bench_compare(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void* shm_bench_consumer(void* arg) {
+    shm_bench_consumer_t* ctx = (shm_bench_consumer_t*)arg;
+    char* buffer = malloc(ctx->data_size);
+    if (!buffer) {
+        return NULL;
+    }
+    
+    for (size_t i = 0; i < ctx->num_operations; i++) {
+        size_t read_size = ctx->data_size;
+        if (shm_queue_dequeue(ctx->ring, buffer, &read_size, 0) != 0) {
+            break;
+        }
+        
+        // 负载开头是生产者写入的发送时间
+        uint64_t sent_ns;
+        memcpy(&sent_ns, buffer, sizeof(sent_ns));
+        ctx->latencies[i] = get_time_ns() - sent_ns;
+    }
+    
+    free(buffer);
+    return NULL;
+}
+
+/**
+ * 在私有匿名共享映射上测一种模式：生产者线程入队，消费者线程阻塞出队
+ * paced为false时连续发送测吞吐量，为true时逐条交接测延迟
+ */
+static int shm_bench_run(shm_ring_mode_t mode, size_t num_operations, size_t data_size,
+                         bool paced, shm_bench_result_t* result) {
+    size_t size = shm_segment_size(0);
+    void* addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
         return -1;
     }
     
-    char* test_data = malloc(data_size);
-    if (!test_data) {
+    shared_memory_t* shm = (shared_memory_t*)addr;
+    shm->size = size;
+    if (shm_init_rings(shm, 0, mode) != 0) {
+        munmap(addr, size);
         return -1;
     }
     
-    // 填充测试数据
-    memset(test_data, 0xAA, data_size);
+    char* buffer = calloc(1, data_size);
+    uint64_t* latencies = calloc(num_operations, sizeof(uint64_t));
+    if (!buffer || !latencies) {
+        free(buffer);
+        free(latencies);
+        munmap(addr, size);
+        return -1;
+    }
+    
+    shm_bench_consumer_t ctx = {
+        .ring = &shm->submit_ring,
+        .num_operations = num_operations,
+        .data_size = data_size,
+        .latencies = latencies
+    };
+    
+    pthread_t consumer;
+    if (pthread_create(&consumer, NULL, shm_bench_consumer, &ctx) != 0) {
+        free(buffer);
+        free(latencies);
+        munmap(addr, size);
+        return -1;
+    }
     
     uint64_t start_time = get_time_ns();
     
-    // 写入测试
     for (size_t i = 0; i < num_operations; i++) {
-        if (shm_queue_try_enqueue(shm, test_data, data_size) != 0) {
-            // 队列满，等待一下
-            usleep(1000);
-            i--; // 重试
+        // 测延迟时逐条交接，等上一条被消费后再发送，避免把排队时间计入延迟
+        while (paced && shm_queue_size(&shm->submit_ring) > 0) {
+            sched_yield();
         }
+        
+        uint64_t now = get_time_ns();
+        memcpy(buffer, &now, sizeof(now));
+        shm_queue_enqueue(&shm->submit_ring, buffer, data_size);
+    }
+    
+    pthread_join(consumer, NULL);
+    
+    uint64_t end_time = get_time_ns();
+    
+    if (paced) {
+        qsort(latencies, num_operations, sizeof(uint64_t), shm_bench_compare);
+        result->p50_ns = latencies[num_operations / 2];
+        result->p99_ns = latencies[(num_operations * 99) / 100];
+    } else {
+        result->msgs_per_sec = (double)num_operations * 1000000000.0 / (end_time - start_time);
     }
     
-    uint64_t write_time = get_time_ns();
+    pthread_mutex_destroy(&shm->submit_ring.mutex);
+    pthread_cond_destroy(&shm->submit_ring.not_empty);
+    pthread_cond_destroy(&shm->submit_ring.not_full);
+    pthread_mutex_destroy(&shm->complete_ring.mutex);
+    pthread_cond_destroy(&shm->complete_ring.not_empty);
+    pthread_cond_destroy(&shm->complete_ring.not_full);
     
-    // 读取测试
-    char* read_buffer = malloc(data_size);
-    if (!read_buffer) {
-        free(test_data);
+    free(buffer);
+    free(latencies);
+    munmap(addr, size);
+    
+    return 0;
+}
+
+/**
+ * 对比互斥模式与SPSC模式的消息吞吐量和交接延迟
+ */
+int shm_benchmark(size_t num_operations, size_t data_size) {
+    if (num_operations == 0 || data_size > MAX_TASK_DATA_SIZE) {
         return -1;
     }
     
-    for (size_t i = 0; i < num_operations; i++) {
-        size_t read_size = data_size;
-        if (shm_queue_try_dequeue(shm, read_buffer, &read_size) != 0) {
-            // 队列空，等待一下
-            usleep(1000);
-            i--; // 重试
-        }
+    // 负载至少要能放下发送时间戳
+    if (data_size < sizeof(uint64_t)) {
+        data_size = sizeof(uint64_t);
     }
     
-    uint64_t end_time = get_time_ns();
+    shm_bench_result_t mutex_result;
+    shm_bench_result_t spsc_result;
     
-    // 计算性能指标
-    double write_ops_per_sec = (double)num_operations * 1000000000.0 / (write_time - start_time);
-    double read_ops_per_sec = (double)num_operations * 1000000000.0 / (end_time - write_time);
-    double total_ops_per_sec = (double)(num_operations * 2) * 1000000000.0 / (end_time - start_time);
+    if (shm_bench_run(SHM_RING_MUTEX, num_operations, data_size, false, &mutex_result) != 0 ||
+        shm_bench_run(SHM_RING_MUTEX, num_operations, data_size, true, &mutex_result) != 0 ||
+        shm_bench_run(SHM_RING_SPSC, num_operations, data_size, false, &spsc_result) != 0 ||
+        shm_bench_run(SHM_RING_SPSC, num_operations, data_size, true, &spsc_result) != 0) {
+        return -1;
+    }
     
     printf("=== Shared Memory Benchmark ===\n");
     printf("Operations: %zu\n", num_operations);
     printf("Data Size: %zu bytes\n", data_size);
-    printf("Write OPS: %.2f ops/sec\n", write_ops_per_sec);
-    printf("Read OPS: %.2f ops/sec\n", read_ops_per_sec);
-    printf("Total OPS: %.2f ops/sec\n", total_ops_per_sec);
+    printf("Mutex: %.2f msgs/sec, p50 %lu ns, p99 %lu ns\n",
+           mutex_result.msgs_per_sec, mutex_result.p50_ns, mutex_result.p99_ns);
+    printf("SPSC:  %.2f msgs/sec, p50 %lu ns, p99 %lu ns\n",
+           spsc_result.msgs_per_sec, spsc_result.p50_ns, spsc_result.p99_ns);
+    printf("Speedup: %.2fx\n", spsc_result.msgs_per_sec / mutex_result.msgs_per_sec);
     printf("==============================\n");
     
-    free(test_data);
-    free(read_buffer);
-    
     return 0;
-}
\ No newline at end of file
+}
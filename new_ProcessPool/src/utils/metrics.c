@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include "../../include/internal.h"
 #include <stdlib.h>
 #include <string.h>
@@ -143,7 +144,7 @@ void metrics_counter_inc(int counter_id) {
         return;
     }
     
-    ATOMIC_FETCH_ADD(&g_metrics.counters[counter_id].value, 1);
+    ATOMIC_ADD(&g_metrics.counters[counter_id].value, 1);
 }
 
 void metrics_counter_add(int counter_id, uint64_t value) {
@@ -151,7 +152,7 @@ void metrics_counter_add(int counter_id, uint64_t value) {
         return;
     }
     
-    ATOMIC_FETCH_ADD(&g_metrics.counters[counter_id].value, value);
+    ATOMIC_ADD(&g_metrics.counters[counter_id].value, value);
 }
 
 uint64_t metrics_counter_get(int counter_id) {
@@ -217,13 +218,13 @@ void metrics_latency_record(int latency_id, uint64_t latency_ns) {
     
     latency_tracker_t* tracker = &g_metrics.latencies[latency_id];
     
-    ATOMIC_FETCH_ADD(&tracker->count, 1);
-    ATOMIC_FETCH_ADD(&tracker->total_time, latency_ns);
+    ATOMIC_ADD(&tracker->count, 1);
+    ATOMIC_ADD(&tracker->total_time, latency_ns);
     
     // 更新最小值
     uint64_t current_min = ATOMIC_LOAD(&tracker->min_time);
     while (latency_ns < current_min) {
-        if (ATOMIC_COMPARE_EXCHANGE_WEAK(&tracker->min_time, &current_min, latency_ns)) {
+        if (ATOMIC_CAS(&tracker->min_time, &current_min, latency_ns)) {
             break;
         }
     }
@@ -231,7 +232,7 @@ void metrics_latency_record(int latency_id, uint64_t latency_ns) {
     // 更新最大值
     uint64_t current_max = ATOMIC_LOAD(&tracker->max_time);
     while (latency_ns > current_max) {
-        if (ATOMIC_COMPARE_EXCHANGE_WEAK(&tracker->max_time, &current_max, latency_ns)) {
+        if (ATOMIC_CAS(&tracker->max_time, &current_max, latency_ns)) {
             break;
         }
     }
@@ -350,8 +351,8 @@ void metrics_histogram_observe(int histogram_id, uint64_t value) {
     
     pthread_mutex_unlock(&hist->mutex);
     
-    ATOMIC_FETCH_ADD(&hist->total_count, 1);
-    ATOMIC_FETCH_ADD(&hist->total_sum, value);
+    ATOMIC_ADD(&hist->total_count, 1);
+    ATOMIC_ADD(&hist->total_sum, value);
 }
 
 histogram_stats_t metrics_histogram_get(int histogram_id) {
@@ -456,12 +457,13 @@ process_stats_t get_process_stats(pid_t pid) {
     char state;
     int ppid, pgrp, session, tty_nr, tpgid;
     unsigned long flags, minflt, cminflt, majflt, cmajflt;
-    unsigned long utime, stime, cutime, cstime, priority, nice;
+    unsigned long utime, stime, cutime, cstime;
+    long priority, nice;
     long num_threads, itrealvalue;
     unsigned long long starttime, vsize;
     long rss;
     
-    int ret = fscanf(stat_file, "%d %s %c %d %d %d %d %d %lu %lu %lu %lu %lu %lu %lu %lu %lu %ld %ld %ld %ld %lld %llu %ld",
+    int ret = fscanf(stat_file, "%d %s %c %d %d %d %d %d %lu %lu %lu %lu %lu %lu %lu %lu %lu %ld %ld %ld %ld %llu %llu %ld",
                      &stats.pid, comm, &state, &ppid, &pgrp, &session, &tty_nr, &tpgid,
                      &flags, &minflt, &cminflt, &majflt, &cmajflt,
                      &utime, &stime, &cutime, &cstime, &priority, &nice,
@@ -701,6 +703,7 @@ static int g_worker_created_counter = -1;
 static int g_worker_destroyed_counter = -1;
 static int g_task_latency_tracker = -1;
 static int g_queue_latency_tracker = -1;
+static int g_spawn_latency_tracker = -1;
 
 void metrics_init_pool_metrics(void) {
     g_task_submitted_counter = metrics_counter_register("tasks_submitted");
@@ -711,6 +714,7 @@ void metrics_init_pool_metrics(void) {
     g_worker_destroyed_counter = metrics_counter_register("workers_destroyed");
     g_task_latency_tracker = metrics_latency_register("task_execution_time");
     g_queue_latency_tracker = metrics_latency_register("task_queue_time");
+    g_spawn_latency_tracker = metrics_latency_register("worker_spawn_time");
 }
 
 void metrics_task_submitted(void) {
@@ -756,4 +760,265 @@ void metrics_task_queue_time(uint64_t queue_time_ns) {
     if (g_queue_latency_tracker >= 0) {
         metrics_latency_record(g_queue_latency_tracker, queue_time_ns);
     }
-}
\ No newline at end of file
+}
+// ============================================================================
+// 进程池统计信息
+// ============================================================================
+
+void stats_task_submitted(process_pool_t* pool) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->stats_mutex);
+    pool->stats.total_submitted++;
+    pthread_mutex_unlock(&pool->stats_mutex);
+    
+    metrics_task_submitted();
+}
+
+void stats_task_submitted_batch(process_pool_t* pool, uint32_t count) {
+    if (!pool || count == 0) return;
+    
+    pthread_mutex_lock(&pool->stats_mutex);
+    pool->stats.total_submitted += count;
+    pthread_mutex_unlock(&pool->stats_mutex);
+    
+    if (g_task_submitted_counter >= 0) {
+        metrics_counter_add(g_task_submitted_counter, count);
+    }
+}
+
+void stats_task_completed(process_pool_t* pool, uint64_t duration_ns) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->stats_mutex);
+    
+    pool->stats.total_completed++;
+    
+    // 增量计算平均处理时间
+    uint64_t n = pool->stats.total_completed;
+    pool->stats.avg_task_time_ns += ((int64_t)duration_ns - (int64_t)pool->stats.avg_task_time_ns) / (int64_t)n;
+    
+    if (duration_ns > pool->stats.max_task_time_ns) {
+        pool->stats.max_task_time_ns = duration_ns;
+    }
+    
+    pthread_mutex_unlock(&pool->stats_mutex);
+    
+    metrics_task_completed(duration_ns);
+}
+
+void stats_task_failed(process_pool_t* pool) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->stats_mutex);
+    pool->stats.total_failed++;
+    pthread_mutex_unlock(&pool->stats_mutex);
+    
+    metrics_task_failed();
+}
+
+void stats_task_timeout(process_pool_t* pool) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->stats_mutex);
+    pool->stats.total_timeout++;
+    pthread_mutex_unlock(&pool->stats_mutex);
+    
+    metrics_task_failed();
+}
+
+void stats_task_cancelled(process_pool_t* pool) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->stats_mutex);
+    pool->stats.total_cancelled++;
+    pthread_mutex_unlock(&pool->stats_mutex);
+    
+    metrics_task_cancelled();
+}
+
+/**
+ * 记录一次取消升级：recycled为false表示发送了SIGUSR1，为true表示回收了Worker
+ */
+void stats_cancel_escalated(process_pool_t* pool, bool recycled) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->stats_mutex);
+    if (recycled) {
+        pool->stats.cancel_recycles++;
+    } else {
+        pool->stats.cancel_signals++;
+    }
+    pthread_mutex_unlock(&pool->stats_mutex);
+}
+
+void stats_worker_spawned(process_pool_t* pool, uint64_t duration_ns, bool via_zygote) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->stats_mutex);
+    
+    pool->stats.workers_spawned++;
+    if (via_zygote) {
+        pool->stats.zygote_spawns++;
+    }
+    
+    // 增量计算平均派生耗时
+    uint64_t n = pool->stats.workers_spawned;
+    pool->stats.avg_spawn_ns += ((int64_t)duration_ns - (int64_t)pool->stats.avg_spawn_ns) / (int64_t)n;
+    
+    if (duration_ns > pool->stats.max_spawn_ns) {
+        pool->stats.max_spawn_ns = duration_ns;
+    }
+    
+    pthread_mutex_unlock(&pool->stats_mutex);
+    
+    metrics_worker_created();
+    if (g_spawn_latency_tracker >= 0) {
+        metrics_latency_record(g_spawn_latency_tracker, duration_ns);
+    }
+}
+
+void stats_task_deadline(process_pool_t* pool, pool_sched_policy_t policy,
+                         bool met, bool dropped) {
+    if (!pool || (uint32_t)policy >= POOL_SCHED_POLICY_COUNT) return;
+    
+    pthread_mutex_lock(&pool->stats_mutex);
+    
+    if (met) {
+        pool->stats.deadline_met_by_policy[policy]++;
+    } else {
+        pool->stats.deadline_missed_by_policy[policy]++;
+        if (dropped) {
+            pool->stats.deadline_dropped_by_policy[policy]++;
+        }
+    }
+    
+    pthread_mutex_unlock(&pool->stats_mutex);
+}
+
+void stats_task_dispatched(process_pool_t* pool, task_priority_t priority,
+                           uint64_t wait_ns, bool aged, task_route_t route) {
+    if (!pool || (uint32_t)priority >= TASK_PRIORITY_COUNT) return;
+    
+    pthread_mutex_lock(&pool->stats_mutex);
+    
+    uint64_t n = ++pool->stats.dispatched_by_priority[priority];
+    uint64_t* avg = &pool->stats.avg_wait_ns_by_priority[priority];
+    *avg += ((int64_t)wait_ns - (int64_t)*avg) / (int64_t)n;
+    
+    if (wait_ns > pool->stats.max_wait_ns_by_priority[priority]) {
+        pool->stats.max_wait_ns_by_priority[priority] = wait_ns;
+    }
+    
+    if (aged) {
+        pool->stats.aged_dispatches++;
+    }
+    
+    if (route != TASK_ROUTE_NONE) {
+        pool->stats.routed_dispatches++;
+        if (route == TASK_ROUTE_HIT) {
+            pool->stats.route_hits++;
+        } else {
+            pool->stats.route_spills++;
+        }
+    }
+    
+    if (pool->config.enable_auto_scaling) {
+        autoscaler_record_wait(pool, wait_ns);
+    }
+    
+    pthread_mutex_unlock(&pool->stats_mutex);
+}
+
+/**
+ * 刷新实时统计，调用方需持有stats_mutex
+ */
+void stats_update(process_pool_t* pool) {
+    if (!pool || !pool->workers) return;
+    
+    uint32_t active = 0;
+    uint32_t idle = 0;
+    uint32_t running = 0;
+    uint64_t doorbells_sent = 0;
+    uint64_t doorbells_suppressed = 0;
+    
+    for (uint32_t i = 0; i < pool->config.max_workers; i++) {
+        worker_internal_t* worker = &pool->workers[i];
+        if (ATOMIC_LOAD(&worker->state) != WORKER_INTERNAL_RUNNING) {
+            continue;
+        }
+        
+        uint32_t inflight = ATOMIC_LOAD(&worker->inflight_count);
+        if (inflight > 0) {
+            active++;
+        } else {
+            idle++;
+        }
+        running += inflight;
+        doorbells_sent += ATOMIC_LOAD(&worker->doorbells_sent);
+        doorbells_suppressed += ATOMIC_LOAD(&worker->doorbells_suppressed);
+    }
+    
+    pool->stats.doorbells_sent = doorbells_sent;
+    pool->stats.doorbells_suppressed = doorbells_suppressed;
+    pool->stats.active_workers = active;
+    pool->stats.idle_workers = idle;
+    pool->stats.running_tasks = running;
+    
+    // 待处理 = 尚未被事件循环取出的任务 + 事件循环中等待分发的任务
+    uint32_t pending = queue_size(pool->task_queue);
+    for (int i = 0; i < TASK_PRIORITY_COUNT; i++) {
+        pool->stats.pending_by_priority[i] = ATOMIC_LOAD(&pool->pending_counts[i]);
+        pending += pool->stats.pending_by_priority[i];
+    }
+    pool->stats.pending_tasks = pending;
+    pool->stats.target_workers = ATOMIC_LOAD(&pool->target_workers);
+    pool->stats.sched_policy = ATOMIC_LOAD(&pool->sched_policy);
+    pool->stats.route_hit_rate = pool->stats.routed_dispatches > 0 ?
+        (double)pool->stats.route_hits / (double)pool->stats.routed_dispatches : 0.0;
+    result_cache_get_stats(pool->result_cache, &pool->stats);
+    
+    pool->stats.event_backend = event_loop_backend();
+    event_loop_get_stats(&pool->stats.loop_events, NULL, NULL, NULL, NULL);
+    pool->stats.loop_cpu_time_ns = event_loop_cpu_time_ns();
+}
+
+// ============================================================================
+// 状态转储
+// ============================================================================
+
+void dump_worker_state(worker_internal_t* worker) {
+    if (!worker) return;
+    
+    log_message(worker->pool, 2, "  worker %u: pid=%d state=%d inflight=%u processed=%lu task=%lu",
+               worker->worker_id, worker->pid, ATOMIC_LOAD(&worker->state),
+               ATOMIC_LOAD(&worker->inflight_count),
+               ATOMIC_LOAD(&worker->tasks_processed),
+               (unsigned long)ATOMIC_LOAD(&worker->current_task_id));
+}
+
+/**
+ * 把统计信息和各Worker状态写入日志(SIGUSR1触发)
+ */
+void dump_pool_state(process_pool_t* pool) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->stats_mutex);
+    stats_update(pool);
+    pool_stats_t stats = pool->stats;
+    pthread_mutex_unlock(&pool->stats_mutex);
+    
+    log_message(pool, 2, "Pool state: workers active=%u idle=%u target=%u, "
+               "tasks pending=%u running=%u",
+               stats.active_workers, stats.idle_workers, stats.target_workers,
+               stats.pending_tasks, stats.running_tasks);
+    log_message(pool, 2, "  submitted=%lu completed=%lu failed=%lu timeout=%lu cancelled=%lu",
+               stats.total_submitted, stats.total_completed, stats.total_failed,
+               stats.total_timeout, stats.total_cancelled);
+    
+    for (uint32_t i = 0; i < pool->config.max_workers; i++) {
+        if (ATOMIC_LOAD(&pool->workers[i].state) == WORKER_INTERNAL_RUNNING) {
+            dump_worker_state(&pool->workers[i]);
+        }
+    }
+}
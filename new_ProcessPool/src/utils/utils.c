@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include "../../include/internal.h"
 #include <stdlib.h>
 #include <string.h>
@@ -176,7 +177,7 @@ void log_message(process_pool_t* pool, int level, const char* format, ...) {
         char timestamp[64];
         format_timestamp(now, timestamp, sizeof(timestamp));
         int written = snprintf(ptr, remaining, "[%s] ", timestamp);
-        if (written > 0 && written < remaining) {
+        if (written > 0 && (size_t)written < remaining) {
             ptr += written;
             remaining -= written;
         }
@@ -186,7 +187,7 @@ void log_message(process_pool_t* pool, int level, const char* format, ...) {
     if (g_log_with_thread_id) {
         pthread_t tid = pthread_self();
         int written = snprintf(ptr, remaining, "[%lu] ", (unsigned long)tid);
-        if (written > 0 && written < remaining) {
+        if (written > 0 && (size_t)written < remaining) {
             ptr += written;
             remaining -= written;
         }
@@ -195,7 +196,7 @@ void log_message(process_pool_t* pool, int level, const char* format, ...) {
     // 添加进程池名称
     if (pool && pool->config.pool_name[0]) {
         int written = snprintf(ptr, remaining, "[%s] ", pool->config.pool_name);
-        if (written > 0 && written < remaining) {
+        if (written > 0 && (size_t)written < remaining) {
             ptr += written;
             remaining -= written;
         }
@@ -203,7 +204,7 @@ void log_message(process_pool_t* pool, int level, const char* format, ...) {
     
     // 添加日志级别
     int written = snprintf(ptr, remaining, "[%s] ", log_level_names[level]);
-    if (written > 0 && written < remaining) {
+    if (written > 0 && (size_t)written < remaining) {
         ptr += written;
         remaining -= written;
     }
@@ -214,7 +215,7 @@ void log_message(process_pool_t* pool, int level, const char* format, ...) {
     written = vsnprintf(ptr, remaining, format, args);
     va_end(args);
     
-    if (written > 0 && written < remaining) {
+    if (written > 0 && (size_t)written < remaining) {
         ptr += written;
         remaining -= written;
     }
@@ -667,6 +668,32 @@ double get_random_double(void) {
     return (double)get_random_u64() / (double)UINT64_MAX;
 }
 
+// ============================================================================
+// 数值工具
+// ============================================================================
+
+bool is_power_of_2(uint32_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+/**
+ * 不小于n的最小2的幂(n为0时返回1)
+ */
+uint32_t next_power_of_2(uint32_t n) {
+    if (n <= 1) {
+        return 1;
+    }
+    
+    n--;
+    n |= n >> 1;
+    n |= n >> 2;
+    n |= n >> 4;
+    n |= n >> 8;
+    n |= n >> 16;
+    
+    return n + 1;
+}
+
 // ============================================================================
 // 哈希函数
 // ============================================================================
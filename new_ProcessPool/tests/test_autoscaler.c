@@ -0,0 +1,130 @@
+#define _GNU_SOURCE
+#include "test_common.h"
+#include "internal.h"
+#include <stdint.h>
+#include <unistd.h>
+
+#define MAX_TEST_WORKERS 2
+#define BURST 60
+
+// 输入为处理时间(毫秒)
+static int sleep_handler(const void* input_data, size_t input_size,
+                         void** output_data, size_t* output_size, void* user_context) {
+    (void)output_data;
+    (void)output_size;
+    (void)user_context;
+    
+    uint32_t delay_ms = 0;
+    if (input_size == sizeof(delay_ms)) {
+        memcpy(&delay_ms, input_data, sizeof(delay_ms));
+    }
+    usleep(delay_ms * 1000);
+    return 0;
+}
+
+static process_pool_t* g_pool;
+
+static pool_stats_t get_stats(void) {
+    pool_stats_t stats;
+    CHECK_OK(pool_get_stats(g_pool, &stats));
+    return stats;
+}
+
+static void run_task(uint32_t delay_ms) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    task_result_t result;
+    
+    CHECK_OK(pool_submit_sync(g_pool, &desc, &delay_ms, sizeof(delay_ms), &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+}
+
+/**
+ * 等待Worker规模变为expected，最多等待timeout_ms
+ */
+static void wait_workers(uint32_t expected, uint64_t timeout_ms) {
+    for (uint64_t waited = 0; waited < timeout_ms; waited += 100) {
+        if (get_stats().target_workers == expected) {
+            return;
+        }
+        usleep(100 * 1000);
+    }
+    CHECK(!"autoscaler did not reach the expected size");
+}
+
+// 串行提交、没有积压的负载不触发扩容
+static void test_steady(void) {
+    uint64_t end = get_time_ns() + (AUTOSCALE_UP_TICKS + 1) * EVENT_LOOP_HOUSEKEEPING_MS * 1000000ULL;
+    
+    while (get_time_ns() < end) {
+        run_task(5);
+    }
+    
+    pool_stats_t stats = get_stats();
+    CHECK(stats.target_workers == 1);
+    CHECK(stats.scale_ups == 0);
+}
+
+// 积压持续AUTOSCALE_UP_TICKS个周期后扩容，新Worker分担积压
+static void test_scale_up(void) {
+    task_future_t* futures[BURST];
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    uint32_t delay_ms = 100;
+    
+    for (int i = 0; i < BURST; i++) {
+        CHECK_OK(pool_submit_async(g_pool, &desc, &delay_ms, sizeof(delay_ms), &futures[i]));
+    }
+    
+    wait_workers(2, (AUTOSCALE_UP_TICKS + 2) * EVENT_LOOP_HOUSEKEEPING_MS);
+    CHECK(get_stats().scale_ups == 1);
+    
+    for (int i = 0; i < BURST; i++) {
+        task_result_t result;
+        CHECK_OK(pool_future_wait(futures[i], &result, 30000));
+        CHECK(result.state == TASK_STATE_COMPLETED);
+        pool_future_destroy(futures[i]);
+    }
+    
+    worker_info_t infos[MAX_TEST_WORKERS];
+    uint32_t count = MAX_TEST_WORKERS;
+    CHECK_OK(pool_get_workers(g_pool, infos, &count));
+    CHECK(count == 2);
+    CHECK(infos[0].tasks_processed > 0 && infos[1].tasks_processed > 0);
+    
+    // 已达max_workers，积压再多也不继续扩容
+    CHECK(get_stats().scale_ups == 1);
+}
+
+// 负载回落后，冷却时间已过且末尾Worker空闲超过worker_idle_timeout时回收，不低于min_workers
+static void test_scale_down(void) {
+    wait_workers(1, AUTOSCALE_DOWN_COOLDOWN_MS +
+                    (AUTOSCALE_DOWN_TICKS + 5) * EVENT_LOOP_HOUSEKEEPING_MS);
+    
+    pool_stats_t stats = get_stats();
+    CHECK(stats.scale_downs == 1);
+    CHECK(stats.worker_utilization < AUTOSCALE_DOWN_UTIL);
+    
+    run_task(0);
+}
+
+int main(void) {
+    pool_set_log_level(1);
+    
+    pool_config_t config = test_pool_config(1, sleep_handler);
+    config.max_workers = MAX_TEST_WORKERS;
+    config.enable_auto_scaling = true;
+    config.worker_idle_timeout = 1;
+    g_pool = pool_create(&config);
+    CHECK(g_pool != NULL);
+    CHECK_OK(pool_start(g_pool));
+    
+    RUN_TEST(test_steady);
+    RUN_TEST(test_scale_up);
+    RUN_TEST(test_scale_down);
+    
+    CHECK_OK(pool_stop(g_pool, 5000));
+    pool_destroy(g_pool);
+    
+    return 0;
+}
@@ -0,0 +1,213 @@
+#define _GNU_SOURCE
+#include "test_common.h"
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// 处理函数的行为，由输入的第一个字节选择
+enum {
+    MODE_ECHO = 'e',            // 返回执行任务的进程ID
+    MODE_COOPERATIVE = 'c',     // 轮询pool_task_is_cancelled
+    MODE_BLOCKING = 'b',        // 阻塞在sleep中，被SIGUSR1中断后返回
+    MODE_IGNORE = 'i'           // 忽略取消和SIGUSR1
+};
+
+// 与Worker进程共享的计数
+typedef struct {
+    atomic_uint started;        // 开始执行的可取消任务数
+    atomic_uint observed;       // 观察到取消后返回的任务数
+} cancel_shared_t;
+
+static cancel_shared_t* g_shared;
+
+static int cancel_handler(const void* input_data, size_t input_size,
+                          void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
+    char mode = input_size > 0 ? *(const char*)input_data : MODE_ECHO;
+    if (mode == MODE_ECHO) {
+        pid_t* out = malloc(sizeof(pid_t));
+        if (!out) {
+            return -1;
+        }
+        *out = getpid();
+        *output_data = out;
+        *output_size = sizeof(pid_t);
+        return 0;
+    }
+    
+    atomic_fetch_add(&g_shared->started, 1);
+    
+    switch (mode) {
+        case MODE_COOPERATIVE:
+            while (!pool_task_is_cancelled()) {
+                usleep(1000);
+            }
+            break;
+        case MODE_BLOCKING:
+            sleep(30);
+            if (!pool_task_is_cancelled()) {
+                return -1;
+            }
+            break;
+        default:
+            for (;;) {
+                pause();
+            }
+    }
+    
+    atomic_fetch_add(&g_shared->observed, 1);
+    return 0;
+}
+
+static process_pool_t* g_pool;
+
+static pid_t run_echo(void) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    task_result_t result;
+    pid_t pid;
+    char mode = MODE_ECHO;
+    
+    CHECK_OK(pool_submit_sync(g_pool, &desc, &mode, 1, &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+    memcpy(&pid, result.result_data, sizeof(pid));
+    free(result.result_data);
+    return pid;
+}
+
+// 提交可取消的任务，等它开始执行后取消
+static task_future_t* submit_and_cancel(char mode) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    task_future_t* future;
+    unsigned int started = atomic_load(&g_shared->started);
+    
+    CHECK_OK(pool_submit_async(g_pool, &desc, &mode, 1, &future));
+    for (int i = 0; i < 500 && atomic_load(&g_shared->started) == started; i++) {
+        usleep(10000);
+    }
+    CHECK(atomic_load(&g_shared->started) == started + 1);
+    
+    CHECK_OK(pool_future_cancel(future));
+    
+    task_result_t result;
+    CHECK_OK(pool_future_wait(future, &result, 1000));
+    CHECK(result.state == TASK_STATE_CANCELLED);
+    return future;
+}
+
+static pool_stats_t get_stats(void) {
+    pool_stats_t stats;
+    CHECK_OK(pool_get_stats(g_pool, &stats));
+    return stats;
+}
+
+// 等待观察到取消的任务数或回收次数达到预期
+static void wait_for(unsigned int observed, uint64_t recycles) {
+    for (int i = 0; i < 500; i++) {
+        if (atomic_load(&g_shared->observed) == observed &&
+            get_stats().cancel_recycles == recycles) {
+            return;
+        }
+        usleep(10000);
+    }
+    CHECK(!"cancellation did not reach the expected stage");
+}
+
+// 处理函数在宽限期内自行返回，不发送信号也不回收
+static void test_cooperative(void) {
+    pid_t pid = run_echo();
+    pool_stats_t before = get_stats();
+    unsigned int observed = atomic_load(&g_shared->observed);
+    
+    task_future_t* future = submit_and_cancel(MODE_COOPERATIVE);
+    wait_for(observed + 1, before.cancel_recycles);
+    pool_future_destroy(future);
+    
+    pool_stats_t after = get_stats();
+    CHECK(after.cancel_signals == before.cancel_signals);
+    CHECK(run_echo() == pid);
+}
+
+// 阻塞的处理函数被SIGUSR1中断，看到取消后返回，Worker继续使用
+static void test_signal(void) {
+    pid_t pid = run_echo();
+    pool_stats_t before = get_stats();
+    unsigned int observed = atomic_load(&g_shared->observed);
+    
+    task_future_t* future = submit_and_cancel(MODE_BLOCKING);
+    wait_for(observed + 1, before.cancel_recycles);
+    pool_future_destroy(future);
+    
+    pool_stats_t after = get_stats();
+    CHECK(after.cancel_signals == before.cancel_signals + 1);
+    CHECK(run_echo() == pid);
+}
+
+// 忽略SIGUSR1的处理函数：Worker被回收，排在它后面的任务转到新Worker上完成
+static void test_recycle(void) {
+    pid_t pid = run_echo();
+    pool_stats_t before = get_stats();
+    unsigned int observed = atomic_load(&g_shared->observed);
+    
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    char mode = MODE_IGNORE;
+    unsigned int started = atomic_load(&g_shared->started);
+    task_future_t* stuck;
+    CHECK_OK(pool_submit_async(g_pool, &desc, &mode, 1, &stuck));
+    for (int i = 0; i < 500 && atomic_load(&g_shared->started) == started; i++) {
+        usleep(10000);
+    }
+    CHECK(atomic_load(&g_shared->started) == started + 1);
+    
+    mode = MODE_ECHO;
+    task_future_t* queued;
+    CHECK_OK(pool_submit_async(g_pool, &desc, &mode, 1, &queued));
+    
+    CHECK_OK(pool_future_cancel(stuck));
+    wait_for(observed, before.cancel_recycles + 1);
+    pool_future_destroy(stuck);
+    
+    task_result_t result;
+    CHECK_OK(pool_future_wait(queued, &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+    pid_t new_pid;
+    memcpy(&new_pid, result.result_data, sizeof(new_pid));
+    free(result.result_data);
+    pool_future_destroy(queued);
+    
+    CHECK(new_pid != pid);
+    CHECK(get_stats().cancel_signals == before.cancel_signals + 1);
+    CHECK(run_echo() == new_pid);
+}
+
+int main(void) {
+    pool_set_log_level(1);
+    
+    g_shared = mmap(NULL, sizeof(*g_shared), PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    CHECK(g_shared != MAP_FAILED);
+    atomic_init(&g_shared->started, 0);
+    atomic_init(&g_shared->observed, 0);
+    
+    // 单个Worker，排在取消任务后面的任务必然在同一个提交环中
+    pool_config_t config = test_pool_config(1, cancel_handler);
+    config.cancel_signal_ms = 100;
+    config.cancel_kill_ms = 300;
+    g_pool = pool_create(&config);
+    CHECK(g_pool != NULL);
+    CHECK_OK(pool_start(g_pool));
+    
+    RUN_TEST(test_cooperative);
+    RUN_TEST(test_signal);
+    RUN_TEST(test_recycle);
+    
+    CHECK_OK(pool_stop(g_pool, 5000));
+    pool_destroy(g_pool);
+    
+    munmap(g_shared, sizeof(*g_shared));
+    return 0;
+}
@@ -0,0 +1,64 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "process_pool.h"
+
+// 检查失败时打印位置并以非0退出，由ctest判为失败
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        exit(1); \
+    } \
+} while (0)
+
+#define CHECK_OK(expr) do { \
+    pool_error_t check_err_ = (expr); \
+    if (check_err_ != POOL_SUCCESS) { \
+        fprintf(stderr, "%s:%d: %s returned %s\n", __FILE__, __LINE__, #expr, \
+                pool_error_string(check_err_)); \
+        exit(1); \
+    } \
+} while (0)
+
+#define RUN_TEST(fn) do { \
+    printf("[ RUN  ] %s\n", #fn); \
+    fn(); \
+    printf("[  OK  ] %s\n", #fn); \
+} while (0)
+
+// failing_handler返回的错误码
+#define TEST_FAILURE_CODE 42
+
+/**
+ * 总是失败的处理函数
+ */
+static inline int failing_handler(const void* input_data, size_t input_size,
+                                  void** output_data, size_t* output_size, void* user_context) {
+    (void)input_data;
+    (void)input_size;
+    (void)output_data;
+    (void)output_size;
+    (void)user_context;
+    return TEST_FAILURE_CODE;
+}
+
+/**
+ * 测试用的进程池配置：固定Worker数量，不启用自动扩缩容
+ */
+static inline pool_config_t test_pool_config(uint32_t workers, task_handler_t handler) {
+    pool_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.min_workers = workers;
+    config.max_workers = workers;
+    config.queue_size = 1024;
+    config.worker_queue_depth = 8;
+    config.task_timeout = 30;
+    config.pool_name = "test_pool";
+    config.default_handler = handler;
+    return config;
+}
+
+#endif // TEST_COMMON_H
@@ -0,0 +1,249 @@
+#define _GNU_SOURCE
+#include "test_common.h"
+#include <stdint.h>
+#include <unistd.h>
+
+// 默认处理函数：把输入的每个字节转成大写后返回
+static int upper_handler(const void* input_data, size_t input_size,
+                         void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
+    char* out = malloc(input_size > 0 ? input_size : 1);
+    if (!out) {
+        return -1;
+    }
+    
+    const char* in = input_data;
+    for (size_t i = 0; i < input_size; i++) {
+        out[i] = (in[i] >= 'a' && in[i] <= 'z') ? (char)(in[i] - 'a' + 'A') : in[i];
+    }
+    
+    *output_data = out;
+    *output_size = input_size;
+    return 0;
+}
+
+// 输入为uint64_t，返回其平方
+static int square_handler(const void* input_data, size_t input_size,
+                          void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
+    if (input_size != sizeof(uint64_t)) {
+        return -1;
+    }
+    
+    uint64_t* out = malloc(sizeof(uint64_t));
+    if (!out) {
+        return -1;
+    }
+    
+    uint64_t v;
+    memcpy(&v, input_data, sizeof(v));
+    *out = v * v;
+    
+    *output_data = out;
+    *output_size = sizeof(uint64_t);
+    return 0;
+}
+
+static process_pool_t* g_pool;
+
+static void test_submit_sync(void) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.priority = TASK_PRIORITY_NORMAL;
+    
+    const char input[] = "hello, process pool";
+    task_result_t result;
+    
+    CHECK_OK(pool_submit_sync(g_pool, &desc, input, sizeof(input), &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+    CHECK(result.error_code == 0);
+    CHECK(result.result_size == sizeof(input));
+    CHECK(memcmp(result.result_data, "HELLO, PROCESS POOL", sizeof(input)) == 0);
+    free(result.result_data);
+}
+
+static void test_submit_async_many(void) {
+    enum { COUNT = 500 };
+    task_future_t* futures[COUNT];
+    
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.priority = TASK_PRIORITY_NORMAL;
+    desc.handler = square_handler;
+    
+    for (uint64_t i = 0; i < COUNT; i++) {
+        CHECK_OK(pool_submit_async(g_pool, &desc, &i, sizeof(i), &futures[i]));
+    }
+    
+    for (uint64_t i = 0; i < COUNT; i++) {
+        task_result_t result;
+        CHECK_OK(pool_future_wait(futures[i], &result, 10000));
+        CHECK(result.state == TASK_STATE_COMPLETED);
+        CHECK(result.result_size == sizeof(uint64_t));
+    
+        uint64_t v;
+        memcpy(&v, result.result_data, sizeof(v));
+        CHECK(v == i * i);
+    
+        free(result.result_data);
+        pool_future_destroy(futures[i]);
+    }
+}
+
+static void test_submit_batch(void) {
+    enum { COUNT = 64 };
+    task_desc_t descs[COUNT];
+    const void* inputs[COUNT];
+    size_t sizes[COUNT];
+    uint64_t values[COUNT];
+    task_future_t* futures[COUNT];
+    
+    memset(descs, 0, sizeof(descs));
+    for (uint32_t i = 0; i < COUNT; i++) {
+        descs[i].priority = (task_priority_t)(i % TASK_PRIORITY_COUNT);
+        descs[i].handler = square_handler;
+        values[i] = 1000 + i;
+        inputs[i] = &values[i];
+        sizes[i] = sizeof(values[i]);
+    }
+    
+    CHECK_OK(pool_submit_batch(g_pool, descs, inputs, sizes, COUNT, futures));
+    
+    for (uint32_t i = 0; i < COUNT; i++) {
+        task_result_t result;
+        CHECK_OK(pool_future_wait(futures[i], &result, 10000));
+        CHECK(result.state == TASK_STATE_COMPLETED);
+    
+        uint64_t v;
+        memcpy(&v, result.result_data, sizeof(v));
+        CHECK(v == values[i] * values[i]);
+    
+        free(result.result_data);
+        pool_future_destroy(futures[i]);
+    }
+}
+
+static void test_handler_failure(void) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.handler = failing_handler;
+    
+    task_result_t result;
+    CHECK_OK(pool_submit_sync(g_pool, &desc, "x", 1, &result, 10000));
+    CHECK(result.state == TASK_STATE_FAILED);
+    CHECK(result.result_data == NULL);
+    
+    // 失败的任务不影响后续任务
+    test_submit_sync();
+}
+
+static void test_stats(void) {
+    pool_stats_t stats;
+    CHECK_OK(pool_get_stats(g_pool, &stats));
+    CHECK(stats.total_submitted >= 566);
+    CHECK(stats.total_completed >= 565);
+    CHECK(stats.total_failed >= 1);
+    
+    worker_info_t workers[4];
+    uint32_t count = 4;
+    CHECK_OK(pool_get_workers(g_pool, workers, &count));
+    CHECK(count == 2);
+}
+
+// 不计正在退出的Worker
+static uint32_t worker_count(void) {
+    worker_info_t workers[4];
+    uint32_t count = 4;
+    CHECK_OK(pool_get_workers(g_pool, workers, &count));
+    
+    uint32_t running = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (workers[i].state != WORKER_STATE_STOPPING) {
+            running++;
+        }
+    }
+    return running;
+}
+
+// 等待缩容退役的Worker退出并被回收
+static void wait_retired(uint32_t expected) {
+    for (int i = 0; i < 500; i++) {
+        worker_info_t workers[4];
+        uint32_t count = 4;
+        CHECK_OK(pool_get_workers(g_pool, workers, &count));
+        if (count == expected) {
+            return;
+        }
+        usleep(10000);
+    }
+    CHECK(!"retired workers were not reaped");
+}
+
+// 任务在途时扩容和缩容：缩容不等待Worker退出，被停止Worker上排队的任务
+// 重新分发，全部任务照常完成
+static void test_resize(void) {
+    enum { COUNT = 200 };
+    task_future_t* futures[COUNT];
+    
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.handler = square_handler;
+    
+    for (uint64_t i = 0; i < COUNT; i++) {
+        CHECK_OK(pool_submit_async(g_pool, &desc, &i, sizeof(i), &futures[i]));
+        if (i == COUNT / 4) {
+            CHECK_OK(pool_resize(g_pool, 4));
+            CHECK(worker_count() == 4);
+        } else if (i == COUNT * 3 / 4) {
+            CHECK_OK(pool_resize(g_pool, 2));
+            CHECK(worker_count() == 2);
+        }
+    }
+    
+    for (uint64_t i = 0; i < COUNT; i++) {
+        task_result_t result;
+        CHECK_OK(pool_future_wait(futures[i], &result, 10000));
+        CHECK(result.state == TASK_STATE_COMPLETED);
+        CHECK(*(uint64_t*)result.result_data == i * i);
+        free(result.result_data);
+        pool_future_destroy(futures[i]);
+    }
+    wait_retired(2);
+    
+    // 退役Worker尚未退出时复用其槽位
+    CHECK_OK(pool_resize(g_pool, 3));
+    CHECK_OK(pool_resize(g_pool, 2));
+    CHECK_OK(pool_resize(g_pool, 3));
+    CHECK(worker_count() == 3);
+    CHECK_OK(pool_resize(g_pool, 2));
+    wait_retired(2);
+    
+    CHECK(pool_resize(g_pool, 5) == POOL_ERROR_INVALID_PARAM);
+    CHECK(pool_resize(g_pool, 1) == POOL_ERROR_INVALID_PARAM);
+    
+    test_submit_sync();
+}
+
+int main(void) {
+    pool_set_log_level(1);
+    
+    pool_config_t config = test_pool_config(2, upper_handler);
+    config.max_workers = 4;
+    g_pool = pool_create(&config);
+    CHECK(g_pool != NULL);
+    CHECK_OK(pool_start(g_pool));
+    
+    RUN_TEST(test_submit_sync);
+    RUN_TEST(test_submit_async_many);
+    RUN_TEST(test_submit_batch);
+    RUN_TEST(test_handler_failure);
+    RUN_TEST(test_stats);
+    RUN_TEST(test_resize);
+    
+    CHECK_OK(pool_stop(g_pool, 5000));
+    pool_destroy(g_pool);
+    
+    return 0;
+}
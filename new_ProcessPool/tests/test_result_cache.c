@@ -0,0 +1,227 @@
+#define _GNU_SOURCE
+#include "test_common.h"
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define CACHE_BYTES 8192
+
+// 输入：输出大小、内容种子和处理时间
+typedef struct {
+    uint32_t size;
+    uint32_t seed;
+    uint32_t delay_ms;
+} cache_input_t;
+
+// 处理函数的执行次数，与Worker进程共享
+static atomic_uint* g_calls;
+
+static int pattern_handler(const void* input_data, size_t input_size,
+                           void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
+    if (input_size != sizeof(cache_input_t)) {
+        return -1;
+    }
+    
+    cache_input_t in;
+    memcpy(&in, input_data, sizeof(in));
+    atomic_fetch_add(g_calls, 1);
+    
+    if (in.delay_ms > 0) {
+        usleep(in.delay_ms * 1000);
+    }
+    
+    uint8_t* out = malloc(in.size);
+    if (!out) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < in.size; i++) {
+        out[i] = (uint8_t)(in.seed + i);
+    }
+    
+    *output_data = out;
+    *output_size = in.size;
+    return 0;
+}
+
+// 计数后失败
+static int counted_failing_handler(const void* input_data, size_t input_size,
+                                   void** output_data, size_t* output_size, void* user_context) {
+    atomic_fetch_add(g_calls, 1);
+    return failing_handler(input_data, input_size, output_data, output_size, user_context);
+}
+
+static process_pool_t* g_pool;
+
+static task_desc_t cacheable_desc(void) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.cacheable = true;
+    return desc;
+}
+
+// 同步提交并检查结果内容
+static void submit_check(const task_desc_t* desc, uint32_t size, uint32_t seed) {
+    cache_input_t in = { .size = size, .seed = seed, .delay_ms = 0 };
+    task_result_t result;
+    
+    CHECK_OK(pool_submit_sync(g_pool, desc, &in, sizeof(in), &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+    CHECK(result.result_size == size);
+    for (uint32_t i = 0; i < size; i++) {
+        CHECK(((uint8_t*)result.result_data)[i] == (uint8_t)(seed + i));
+    }
+    free(result.result_data);
+}
+
+// 相同输入第二次直接命中，不可缓存的任务和不同输入照常执行
+static void test_hit(void) {
+    task_desc_t desc = cacheable_desc();
+    pool_stats_t before, after;
+    CHECK_OK(pool_get_stats(g_pool, &before));
+    unsigned int calls = atomic_load(g_calls);
+    
+    submit_check(&desc, 100, 1);
+    submit_check(&desc, 100, 1);
+    CHECK(atomic_load(g_calls) == calls + 1);
+    
+    submit_check(&desc, 100, 2);
+    CHECK(atomic_load(g_calls) == calls + 2);
+    
+    desc.cacheable = false;
+    submit_check(&desc, 100, 1);
+    CHECK(atomic_load(g_calls) == calls + 3);
+    
+    CHECK_OK(pool_get_stats(g_pool, &after));
+    CHECK(after.result_cache_hits == before.result_cache_hits + 1);
+    CHECK(after.result_cache_misses == before.result_cache_misses + 2);
+    CHECK(after.result_cache_entries == before.result_cache_entries + 2);
+}
+
+// 失败的结果不缓存
+static void test_failure_not_cached(void) {
+    task_desc_t desc = cacheable_desc();
+    desc.handler = counted_failing_handler;
+    cache_input_t in = { .size = 1, .seed = 0, .delay_ms = 0 };
+    unsigned int calls = atomic_load(g_calls);
+    
+    for (int i = 0; i < 2; i++) {
+        task_result_t result;
+        CHECK_OK(pool_submit_sync(g_pool, &desc, &in, sizeof(in), &result, 10000));
+        CHECK(result.state == TASK_STATE_FAILED);
+    }
+    CHECK(atomic_load(g_calls) == calls + 2);
+}
+
+// 超出容量时按LRU淘汰，最久未使用的结果需要重新执行
+static void test_lru_eviction(void) {
+    enum { COUNT = 32, SIZE = 512 };
+    task_desc_t desc = cacheable_desc();
+    
+    for (uint32_t i = 0; i < COUNT; i++) {
+        submit_check(&desc, SIZE, 100 + i);
+    }
+    
+    pool_stats_t stats;
+    CHECK_OK(pool_get_stats(g_pool, &stats));
+    CHECK(stats.result_cache_evictions > 0);
+    CHECK(stats.result_cache_bytes <= CACHE_BYTES);
+    
+    // 最近的结果仍在缓存中，最早的已被淘汰
+    unsigned int calls = atomic_load(g_calls);
+    submit_check(&desc, SIZE, 100 + COUNT - 1);
+    CHECK(atomic_load(g_calls) == calls);
+    submit_check(&desc, SIZE, 100);
+    CHECK(atomic_load(g_calls) == calls + 1);
+}
+
+// 相同的在途任务合并为一次执行
+static void test_single_flight(void) {
+    enum { COUNT = 16 };
+    task_desc_t desc = cacheable_desc();
+    cache_input_t in = { .size = 64, .seed = 7, .delay_ms = 200 };
+    task_future_t* futures[COUNT];
+    unsigned int calls = atomic_load(g_calls);
+    
+    for (int i = 0; i < COUNT; i++) {
+        CHECK_OK(pool_submit_async(g_pool, &desc, &in, sizeof(in), &futures[i]));
+    }
+    
+    for (int i = 0; i < COUNT; i++) {
+        task_result_t result;
+        CHECK_OK(pool_future_wait(futures[i], &result, 10000));
+        CHECK(result.state == TASK_STATE_COMPLETED);
+        CHECK(result.result_size == 64);
+        CHECK(((uint8_t*)result.result_data)[0] == 7);
+        free(result.result_data);
+        pool_future_destroy(futures[i]);
+    }
+    
+    CHECK(atomic_load(g_calls) == calls + 1);
+}
+
+// 优先级更高或超时不同的提交不合并，各自执行
+static void test_single_flight_mismatch(void) {
+    cache_input_t in = { .size = 64, .seed = 9, .delay_ms = 200 };
+    task_desc_t descs[4];
+    task_future_t* futures[4];
+    unsigned int calls = atomic_load(g_calls);
+    pool_stats_t before;
+    CHECK_OK(pool_get_stats(g_pool, &before));
+    
+    for (int i = 0; i < 4; i++) {
+        descs[i] = cacheable_desc();
+        descs[i].priority = TASK_PRIORITY_NORMAL;
+    }
+    descs[1].priority = TASK_PRIORITY_LOW;
+    descs[2].priority = TASK_PRIORITY_HIGH;
+    descs[3].timeout_ms = 5000;
+    
+    for (int i = 0; i < 4; i++) {
+        CHECK_OK(pool_submit_async(g_pool, &descs[i], &in, sizeof(in), &futures[i]));
+    }
+    
+    for (int i = 0; i < 4; i++) {
+        task_result_t result;
+        CHECK_OK(pool_future_wait(futures[i], &result, 10000));
+        CHECK(result.state == TASK_STATE_COMPLETED);
+        CHECK(((uint8_t*)result.result_data)[0] == 9);
+        free(result.result_data);
+        pool_future_destroy(futures[i]);
+    }
+    
+    pool_stats_t after;
+    CHECK_OK(pool_get_stats(g_pool, &after));
+    CHECK(after.single_flight_joins == before.single_flight_joins + 1);
+    CHECK(atomic_load(g_calls) == calls + 3);
+}
+
+int main(void) {
+    pool_set_log_level(1);
+    
+    g_calls = mmap(NULL, sizeof(*g_calls), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    CHECK(g_calls != MAP_FAILED);
+    atomic_init(g_calls, 0);
+    
+    pool_config_t config = test_pool_config(2, pattern_handler);
+    config.result_cache_bytes = CACHE_BYTES;
+    config.enable_single_flight = true;
+    g_pool = pool_create(&config);
+    CHECK(g_pool != NULL);
+    CHECK_OK(pool_start(g_pool));
+    
+    RUN_TEST(test_hit);
+    RUN_TEST(test_failure_not_cached);
+    RUN_TEST(test_lru_eviction);
+    RUN_TEST(test_single_flight);
+    RUN_TEST(test_single_flight_mismatch);
+    
+    CHECK_OK(pool_stop(g_pool, 5000));
+    pool_destroy(g_pool);
+    
+    munmap(g_calls, sizeof(*g_calls));
+    return 0;
+}
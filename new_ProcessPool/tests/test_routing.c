@@ -0,0 +1,139 @@
+#define _GNU_SOURCE
+#include "test_common.h"
+#include <stdint.h>
+#include <unistd.h>
+
+#define WORKERS 4
+#define KEYS 32
+
+// 输入为处理时间(毫秒)，返回执行任务的进程ID
+static int pid_handler(const void* input_data, size_t input_size,
+                       void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
+    uint32_t delay_ms = 0;
+    if (input_size == sizeof(delay_ms)) {
+        memcpy(&delay_ms, input_data, sizeof(delay_ms));
+    }
+    usleep(delay_ms * 1000);
+    
+    pid_t* out = malloc(sizeof(pid_t));
+    if (!out) {
+        return -1;
+    }
+    *out = getpid();
+    *output_data = out;
+    *output_size = sizeof(pid_t);
+    return 0;
+}
+
+static process_pool_t* g_pool;
+
+static task_future_t* submit(uint64_t key, uint32_t delay_ms) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.routing_key = key;
+    task_future_t* future;
+    
+    CHECK_OK(pool_submit_async(g_pool, &desc, &delay_ms, sizeof(delay_ms), &future));
+    return future;
+}
+
+static pid_t finish(task_future_t* future) {
+    task_result_t result;
+    pid_t pid;
+    
+    CHECK_OK(pool_future_wait(future, &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+    memcpy(&pid, result.result_data, sizeof(pid));
+    free(result.result_data);
+    pool_future_destroy(future);
+    return pid;
+}
+
+static pool_stats_t get_stats(void) {
+    pool_stats_t stats;
+    CHECK_OK(pool_get_stats(g_pool, &stats));
+    return stats;
+}
+
+// 轻载时相同键的任务总在同一Worker上执行，不同的键分散到各Worker
+static void test_sticky(void) {
+    pool_stats_t before = get_stats();
+    pid_t owners[KEYS];
+    pid_t seen[WORKERS];
+    uint32_t distinct = 0;
+    
+    for (uint32_t k = 0; k < KEYS; k++) {
+        uint64_t key = pool_routing_key(&k, sizeof(k));
+        CHECK(key != 0);
+        owners[k] = finish(submit(key, 0));
+    
+        for (int i = 0; i < 4; i++) {
+            CHECK(finish(submit(key, 0)) == owners[k]);
+        }
+    
+        bool found = false;
+        for (uint32_t i = 0; i < distinct; i++) {
+            found |= seen[i] == owners[k];
+        }
+        if (!found) {
+            CHECK(distinct < WORKERS);
+            seen[distinct++] = owners[k];
+        }
+    }
+    CHECK(distinct > 1);
+    
+    pool_stats_t after = get_stats();
+    CHECK(after.routed_dispatches == before.routed_dispatches + KEYS * 5);
+    CHECK(after.route_hits == before.route_hits + KEYS * 5);
+    CHECK(after.route_spills == before.route_spills);
+}
+
+// 同一个键的突发任务使属主过载，超出的部分改派给其他Worker
+static void test_spill(void) {
+    enum { BURST = 24 };
+    pool_stats_t before = get_stats();
+    uint32_t k = 12345;
+    uint64_t key = pool_routing_key(&k, sizeof(k));
+    pid_t owner = finish(submit(key, 0));
+    
+    task_future_t* futures[BURST];
+    for (int i = 0; i < BURST; i++) {
+        futures[i] = submit(key, 50);
+    }
+    
+    uint32_t on_owner = 0;
+    for (int i = 0; i < BURST; i++) {
+        on_owner += finish(futures[i]) == owner;
+    }
+    CHECK(on_owner > 0 && on_owner < BURST);
+    
+    pool_stats_t after = get_stats();
+    uint64_t hits = after.route_hits - before.route_hits;
+    uint64_t spills = after.route_spills - before.route_spills;
+    CHECK(after.routed_dispatches - before.routed_dispatches == BURST + 1);
+    CHECK(hits + spills == BURST + 1);
+    CHECK(spills > 0);
+    CHECK(after.route_hit_rate > 0.0 && after.route_hit_rate < 1.0);
+    
+    // 过载消失后重新回到属主
+    CHECK(finish(submit(key, 0)) == owner);
+}
+
+int main(void) {
+    pool_set_log_level(1);
+    
+    pool_config_t config = test_pool_config(WORKERS, pid_handler);
+    g_pool = pool_create(&config);
+    CHECK(g_pool != NULL);
+    CHECK_OK(pool_start(g_pool));
+    
+    RUN_TEST(test_sticky);
+    RUN_TEST(test_spill);
+    
+    CHECK_OK(pool_stop(g_pool, 5000));
+    pool_destroy(g_pool);
+    
+    return 0;
+}
@@ -0,0 +1,214 @@
+#define _GNU_SOURCE
+#include "test_common.h"
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define MAX_LOG 64
+
+// 输入：任务标记和处理时间
+typedef struct {
+    char tag;
+    uint32_t delay_ms;
+} sched_input_t;
+
+// 各任务开始执行的顺序，与Worker进程共享
+typedef struct {
+    atomic_uint count;
+    char tags[MAX_LOG];
+} sched_log_t;
+
+static sched_log_t* g_log;
+
+static int log_handler(const void* input_data, size_t input_size,
+                       void** output_data, size_t* output_size, void* user_context) {
+    (void)output_data;
+    (void)output_size;
+    (void)user_context;
+    
+    if (input_size != sizeof(sched_input_t)) {
+        return -1;
+    }
+    
+    sched_input_t in;
+    memcpy(&in, input_data, sizeof(in));
+    
+    unsigned int index = atomic_fetch_add(&g_log->count, 1);
+    if (index < MAX_LOG) {
+        g_log->tags[index] = in.tag;
+    }
+    
+    if (in.delay_ms > 0) {
+        usleep(in.delay_ms * 1000);
+    }
+    return 0;
+}
+
+static process_pool_t* g_pool;
+
+/**
+ * 单个Worker且每次只接收一个任务，其余任务留在Master的待分发结构中按策略排序
+ */
+static void start_pool(pool_sched_policy_t policy, uint32_t aging_ms) {
+    pool_config_t config = test_pool_config(1, log_handler);
+    config.worker_queue_depth = 1;
+    config.sched_policy = policy;
+    config.priority_aging_ms = aging_ms;
+    g_pool = pool_create(&config);
+    CHECK(g_pool != NULL);
+    CHECK_OK(pool_start(g_pool));
+    
+    atomic_store(&g_log->count, 0);
+    memset(g_log->tags, 0, sizeof(g_log->tags));
+}
+
+static void stop_pool(void) {
+    CHECK_OK(pool_stop(g_pool, 5000));
+    pool_destroy(g_pool);
+    g_pool = NULL;
+}
+
+static task_future_t* submit(char tag, uint32_t delay_ms, task_priority_t priority, uint32_t timeout_ms) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.priority = priority;
+    desc.timeout_ms = timeout_ms;
+    sched_input_t in = { .tag = tag, .delay_ms = delay_ms };
+    task_future_t* future;
+    
+    CHECK_OK(pool_submit_async(g_pool, &desc, &in, sizeof(in), &future));
+    return future;
+}
+
+// 提交占住Worker的任务，等它开始执行
+static task_future_t* submit_blocker(uint32_t delay_ms) {
+    unsigned int count = atomic_load(&g_log->count);
+    task_future_t* future = submit('X', delay_ms, TASK_PRIORITY_NORMAL, 0);
+    
+    for (int i = 0; i < 500 && atomic_load(&g_log->count) == count; i++) {
+        usleep(10000);
+    }
+    CHECK(atomic_load(&g_log->count) == count + 1);
+    return future;
+}
+
+static task_state_t finish(task_future_t* future) {
+    task_result_t result;
+    CHECK_OK(pool_future_wait(future, &result, 10000));
+    free(result.result_data);
+    pool_future_destroy(future);
+    return result.state;
+}
+
+static pool_stats_t get_stats(void) {
+    pool_stats_t stats;
+    CHECK_OK(pool_get_stats(g_pool, &stats));
+    return stats;
+}
+
+// 不老化时严格按优先级分发，同一优先级内按提交顺序
+static void test_priority_order(void) {
+    start_pool(POOL_SCHED_PRIORITY, 0);
+    
+    task_future_t* futures[5];
+    futures[0] = submit_blocker(200);
+    futures[1] = submit('a', 0, TASK_PRIORITY_LOW, 0);
+    futures[2] = submit('b', 0, TASK_PRIORITY_NORMAL, 0);
+    futures[3] = submit('c', 0, TASK_PRIORITY_HIGH, 0);
+    futures[4] = submit('d', 0, TASK_PRIORITY_NORMAL, 0);
+    
+    for (int i = 0; i < 5; i++) {
+        CHECK(finish(futures[i]) == TASK_STATE_COMPLETED);
+    }
+    CHECK(memcmp(g_log->tags, "Xcbda", 5) == 0);
+    CHECK(get_stats().aged_dispatches == 0);
+    
+    stop_pool();
+}
+
+// 等待够久的低优先级任务逐级提升，先于后到的普通任务分发
+static void test_priority_aging(void) {
+    start_pool(POOL_SCHED_PRIORITY, 200);
+    
+    task_future_t* futures[4];
+    futures[0] = submit_blocker(600);
+    futures[1] = submit('a', 0, TASK_PRIORITY_LOW, 0);
+    usleep(500 * 1000);
+    futures[2] = submit('b', 0, TASK_PRIORITY_NORMAL, 0);
+    futures[3] = submit('c', 0, TASK_PRIORITY_HIGH, 0);
+    
+    for (int i = 0; i < 4; i++) {
+        CHECK(finish(futures[i]) == TASK_STATE_COMPLETED);
+    }
+    
+    // a最多提升到HIGH，与c相同时基础优先级高的c先分发
+    CHECK(memcmp(g_log->tags, "Xcab", 4) == 0);
+    CHECK(get_stats().aged_dispatches == 1);
+    
+    stop_pool();
+}
+
+// EDF按截止时间分发，与优先级和提交顺序无关
+static void test_edf_order(void) {
+    start_pool(POOL_SCHED_EDF, 0);
+    
+    task_future_t* futures[4];
+    futures[0] = submit_blocker(200);
+    futures[1] = submit('a', 0, TASK_PRIORITY_HIGH, 5000);
+    futures[2] = submit('b', 0, TASK_PRIORITY_LOW, 3000);
+    futures[3] = submit('c', 0, TASK_PRIORITY_NORMAL, 4000);
+    
+    for (int i = 0; i < 4; i++) {
+        CHECK(finish(futures[i]) == TASK_STATE_COMPLETED);
+    }
+    CHECK(memcmp(g_log->tags, "Xbca", 4) == 0);
+    
+    pool_stats_t stats = get_stats();
+    // 占位任务按配置的task_timeout同样限时
+    CHECK(stats.deadline_met_by_policy[POOL_SCHED_EDF] == 4);
+    CHECK(stats.deadline_dropped_by_policy[POOL_SCHED_EDF] == 0);
+    
+    stop_pool();
+}
+
+// 按执行时间估计已来不及的任务在分发前丢弃，Worker留给还来得及的任务
+static void test_edf_drop(void) {
+    start_pool(POOL_SCHED_EDF, 0);
+    
+    // 建立约100ms的执行时间估计
+    for (int i = 0; i < 4; i++) {
+        CHECK(finish(submit('w', 100, TASK_PRIORITY_NORMAL, 0)) == TASK_STATE_COMPLETED);
+    }
+    
+    task_future_t* blocker = submit_blocker(300);
+    task_future_t* late = submit('l', 0, TASK_PRIORITY_NORMAL, 350);
+    task_future_t* ok = submit('o', 0, TASK_PRIORITY_NORMAL, 5000);
+    
+    CHECK(finish(blocker) == TASK_STATE_COMPLETED);
+    CHECK(finish(late) == TASK_STATE_TIMEOUT);
+    CHECK(finish(ok) == TASK_STATE_COMPLETED);
+    CHECK(memcmp(g_log->tags, "wwwwXo", 6) == 0);
+    
+    pool_stats_t stats = get_stats();
+    CHECK(stats.deadline_dropped_by_policy[POOL_SCHED_EDF] == 1);
+    CHECK(stats.deadline_missed_by_policy[POOL_SCHED_EDF] == 1);
+    
+    stop_pool();
+}
+
+int main(void) {
+    pool_set_log_level(1);
+    
+    g_log = mmap(NULL, sizeof(*g_log), PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    CHECK(g_log != MAP_FAILED);
+    
+    RUN_TEST(test_priority_order);
+    RUN_TEST(test_priority_aging);
+    RUN_TEST(test_edf_order);
+    RUN_TEST(test_edf_drop);
+    
+    munmap(g_log, sizeof(*g_log));
+    return 0;
+}
@@ -0,0 +1,166 @@
+#define _GNU_SOURCE
+#include "test_common.h"
+#include <stdint.h>
+#include <unistd.h>
+
+#define MAX_TEST_WORKERS 2
+#define BACKLOG 8
+
+// 输入为处理时间(毫秒)，返回执行任务的进程ID
+static int pid_handler(const void* input_data, size_t input_size,
+                       void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
+    uint32_t delay_ms = 0;
+    if (input_size == sizeof(delay_ms)) {
+        memcpy(&delay_ms, input_data, sizeof(delay_ms));
+    }
+    usleep(delay_ms * 1000);
+    
+    pid_t* out = malloc(sizeof(pid_t));
+    if (!out) {
+        return -1;
+    }
+    *out = getpid();
+    *output_data = out;
+    *output_size = sizeof(pid_t);
+    return 0;
+}
+
+static process_pool_t* g_pool;
+
+/**
+ * 从一个Worker启动，积压全部进入它的提交环；之后扩容出的Worker没有任务，
+ * 只能通过窃取分担积压
+ */
+static void start_pool(bool stealing) {
+    pool_config_t config = test_pool_config(1, pid_handler);
+    config.max_workers = MAX_TEST_WORKERS;
+    config.worker_queue_depth = BACKLOG;
+    config.enable_work_stealing = stealing;
+    g_pool = pool_create(&config);
+    CHECK(g_pool != NULL);
+    CHECK_OK(pool_start(g_pool));
+}
+
+static void stop_pool(void) {
+    CHECK_OK(pool_stop(g_pool, 5000));
+    pool_destroy(g_pool);
+    g_pool = NULL;
+}
+
+/**
+ * 向唯一的Worker提交积压后扩容，返回在新Worker上执行的任务数
+ */
+static uint32_t run_backlog(uint64_t routing_key) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.routing_key = routing_key;
+    uint32_t delay_ms = 100;
+    task_future_t* futures[BACKLOG];
+    pid_t first = 0;
+    
+    for (int i = 0; i < BACKLOG; i++) {
+        CHECK_OK(pool_submit_async(g_pool, &desc, &delay_ms, sizeof(delay_ms), &futures[i]));
+    }
+    
+    // 所有任务都已进入Worker 0的提交环，不在Master中等待
+    pool_stats_t stats;
+    for (int i = 0; i < 500; i++) {
+        CHECK_OK(pool_get_stats(g_pool, &stats));
+        if (stats.running_tasks == BACKLOG) {
+            break;
+        }
+        usleep(1000);
+    }
+    CHECK(stats.running_tasks == BACKLOG);
+    
+    CHECK_OK(pool_resize(g_pool, MAX_TEST_WORKERS));
+    
+    uint32_t elsewhere = 0;
+    for (int i = 0; i < BACKLOG; i++) {
+        task_result_t result;
+        pid_t pid;
+        CHECK_OK(pool_future_wait(futures[i], &result, 10000));
+        CHECK(result.state == TASK_STATE_COMPLETED);
+        memcpy(&pid, result.result_data, sizeof(pid));
+        free(result.result_data);
+        pool_future_destroy(futures[i]);
+    
+        if (i == 0) {
+            first = pid;
+        }
+        elsewhere += pid != first;
+    }
+    
+    return elsewhere;
+}
+
+static void worker_steal_counts(uint64_t* stolen, uint64_t* stolen_from) {
+    worker_info_t infos[MAX_TEST_WORKERS];
+    uint32_t count = MAX_TEST_WORKERS;
+    CHECK_OK(pool_get_workers(g_pool, infos, &count));
+    CHECK(count == MAX_TEST_WORKERS);
+    
+    *stolen = 0;
+    *stolen_from = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        *stolen += infos[i].tasks_stolen;
+        *stolen_from += infos[i].tasks_stolen_from;
+    }
+    CHECK(infos[0].tasks_stolen == 0);
+    CHECK(infos[1].tasks_stolen_from == 0);
+}
+
+// 空闲的新Worker从积压的Worker窃取尚未开始的任务，结果由Master正确归还
+static void test_steal(void) {
+    start_pool(true);
+    
+    uint32_t elsewhere = run_backlog(0);
+    uint64_t stolen;
+    uint64_t stolen_from;
+    worker_steal_counts(&stolen, &stolen_from);
+    
+    CHECK(elsewhere > 0);
+    CHECK(stolen == elsewhere);
+    CHECK(stolen_from == stolen);
+    
+    stop_pool();
+}
+
+// 未启用窃取时积压留在原Worker上
+static void test_disabled(void) {
+    start_pool(false);
+    
+    CHECK(run_backlog(0) == 0);
+    uint64_t stolen;
+    uint64_t stolen_from;
+    worker_steal_counts(&stolen, &stolen_from);
+    CHECK(stolen == 0 && stolen_from == 0);
+    
+    stop_pool();
+}
+
+// 分发到路由键属主的任务被钉在属主上，不会被窃取
+static void test_pinned(void) {
+    start_pool(true);
+    
+    uint32_t k = 7;
+    CHECK(run_backlog(pool_routing_key(&k, sizeof(k))) == 0);
+    uint64_t stolen;
+    uint64_t stolen_from;
+    worker_steal_counts(&stolen, &stolen_from);
+    CHECK(stolen == 0 && stolen_from == 0);
+    
+    stop_pool();
+}
+
+int main(void) {
+    pool_set_log_level(1);
+    
+    RUN_TEST(test_steal);
+    RUN_TEST(test_disabled);
+    RUN_TEST(test_pinned);
+    
+    return 0;
+}
@@ -0,0 +1,193 @@
+#define _GNU_SOURCE
+#include "test_common.h"
+#include "internal.h"
+#include <stdint.h>
+#include <signal.h>
+#include <unistd.h>
+
+#define WORKERS 2
+
+// 处理函数的行为，由输入的第一个字节选择
+enum {
+    MODE_ECHO = 'e',            // 返回执行任务的进程ID
+    MODE_SLEEP = 's',           // 长时间阻塞
+    MODE_EXIT = 'x'             // 执行中途退出进程
+};
+
+static int supervise_handler(const void* input_data, size_t input_size,
+                             void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
+    char mode = input_size > 0 ? *(const char*)input_data : MODE_ECHO;
+    if (mode == MODE_SLEEP) {
+        sleep(30);
+    } else if (mode == MODE_EXIT) {
+        _exit(3);
+    }
+    
+    pid_t* out = malloc(sizeof(pid_t));
+    if (!out) {
+        return -1;
+    }
+    *out = getpid();
+    *output_data = out;
+    *output_size = sizeof(pid_t);
+    return 0;
+}
+
+static process_pool_t* g_pool;
+
+static task_future_t* submit(char mode) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    task_future_t* future;
+    
+    CHECK_OK(pool_submit_async(g_pool, &desc, &mode, 1, &future));
+    return future;
+}
+
+static task_result_t finish(task_future_t* future) {
+    task_result_t result;
+    CHECK_OK(pool_future_wait(future, &result, 10000));
+    free(result.result_data);
+    result.result_data = NULL;
+    pool_future_destroy(future);
+    return result;
+}
+
+static pool_stats_t get_stats(void) {
+    pool_stats_t stats;
+    CHECK_OK(pool_get_stats(g_pool, &stats));
+    return stats;
+}
+
+static pid_t worker_pid(uint32_t slot) {
+    worker_info_t infos[WORKERS];
+    uint32_t count = WORKERS;
+    CHECK_OK(pool_get_workers(g_pool, infos, &count));
+    
+    for (uint32_t i = 0; i < count; i++) {
+        if (infos[i].worker_id == slot &&
+            (infos[i].state == WORKER_STATE_IDLE || infos[i].state == WORKER_STATE_BUSY)) {
+            return infos[i].pid;
+        }
+    }
+    return -1;
+}
+
+/**
+ * 等待槽位上换成新进程，返回等待的毫秒数
+ */
+static uint64_t wait_replaced(uint32_t slot, pid_t old_pid) {
+    uint64_t start = get_time_ns();
+    
+    for (int i = 0; i < 1000; i++) {
+        pid_t pid = worker_pid(slot);
+        if (pid > 0 && pid != old_pid) {
+            return (get_time_ns() - start) / 1000000ULL;
+        }
+        usleep(2000);
+    }
+    CHECK(!"worker was not restarted");
+    return 0;
+}
+
+// 每个Worker都由pidfd监视
+static void test_pidfd_open(void) {
+    for (uint32_t i = 0; i < WORKERS; i++) {
+        CHECK(worker_pid(i) > 0);
+        CHECK(g_pool->workers[i].pidfd >= 0);
+    }
+}
+
+// 空闲Worker被杀死后立即由pidfd事件发现并重启，不等定期维护
+static void test_kill_idle(void) {
+    pool_stats_t before = get_stats();
+    pid_t old_pid = worker_pid(0);
+    
+    CHECK(kill(old_pid, SIGKILL) == 0);
+    CHECK(wait_replaced(0, old_pid) < EVENT_LOOP_HOUSEKEEPING_MS);
+    
+    CHECK(get_stats().workers_spawned == before.workers_spawned + 1);
+    CHECK(g_pool->workers[0].pidfd >= 0);
+    CHECK(finish(submit(MODE_ECHO)).state == TASK_STATE_COMPLETED);
+}
+
+// 执行中的Worker退出：在途任务以POOL_ERROR_WORKER_DEAD失败，Worker重启
+static void test_exit_busy(void) {
+    pool_stats_t before = get_stats();
+    pid_t pids[WORKERS];
+    for (uint32_t i = 0; i < WORKERS; i++) {
+        pids[i] = worker_pid(i);
+    }
+    
+    task_result_t result = finish(submit(MODE_EXIT));
+    CHECK(result.state == TASK_STATE_FAILED);
+    CHECK(result.error_code == POOL_ERROR_WORKER_DEAD);
+    
+    uint32_t slot = result.worker_id;
+    CHECK(slot < WORKERS);
+    wait_replaced(slot, pids[slot]);
+    CHECK(get_stats().workers_spawned == before.workers_spawned + 1);
+    
+    for (int i = 0; i < 4; i++) {
+        CHECK(finish(submit(MODE_ECHO)).state == TASK_STATE_COMPLETED);
+    }
+}
+
+// 阻塞中的Worker被杀死，等待结果的调用方不必等到任务超时
+static void test_kill_busy(void) {
+    task_future_t* future = submit(MODE_SLEEP);
+    
+    uint32_t slot = UINT32_MAX;
+    for (int i = 0; i < 500 && slot == UINT32_MAX; i++) {
+        worker_info_t infos[WORKERS];
+        uint32_t count = WORKERS;
+        CHECK_OK(pool_get_workers(g_pool, infos, &count));
+        for (uint32_t j = 0; j < count; j++) {
+            if (infos[j].state == WORKER_STATE_BUSY) {
+                slot = infos[j].worker_id;
+            }
+        }
+        usleep(10000);
+    }
+    CHECK(slot < WORKERS);
+    
+    pid_t old_pid = worker_pid(slot);
+    uint64_t start = get_time_ns();
+    CHECK(kill(old_pid, SIGKILL) == 0);
+    
+    task_result_t result = finish(future);
+    CHECK(result.state == TASK_STATE_FAILED);
+    CHECK(result.error_code == POOL_ERROR_WORKER_DEAD);
+    CHECK((get_time_ns() - start) / 1000000ULL < EVENT_LOOP_HOUSEKEEPING_MS);
+    
+    wait_replaced(slot, old_pid);
+    CHECK(finish(submit(MODE_ECHO)).state == TASK_STATE_COMPLETED);
+}
+
+static void run_suite(pool_event_backend_t backend) {
+    pool_config_t config = test_pool_config(WORKERS, supervise_handler);
+    config.event_backend = backend;
+    g_pool = pool_create(&config);
+    CHECK(g_pool != NULL);
+    CHECK_OK(pool_start(g_pool));
+    
+    RUN_TEST(test_pidfd_open);
+    RUN_TEST(test_kill_idle);
+    RUN_TEST(test_exit_busy);
+    RUN_TEST(test_kill_busy);
+    
+    CHECK_OK(pool_stop(g_pool, 5000));
+    pool_destroy(g_pool);
+}
+
+int main(void) {
+    pool_set_log_level(1);
+    
+    // 两种事件循环后端分别注册pidfd
+    run_suite(POOL_EVENT_BACKEND_EPOLL);
+    run_suite(POOL_EVENT_BACKEND_AUTO);
+    
+    return 0;
+}
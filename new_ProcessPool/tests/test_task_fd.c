@@ -0,0 +1,307 @@
+#define _GNU_SOURCE
+#include "test_common.h"
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+// 返回输入各字节之和
+static int sum_handler(const void* input_data, size_t input_size,
+                       void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
+    uint64_t* out = malloc(sizeof(uint64_t));
+    if (!out) {
+        return -1;
+    }
+    
+    *out = 0;
+    for (size_t i = 0; i < input_size; i++) {
+        *out += ((const uint8_t*)input_data)[i];
+    }
+    
+    *output_data = out;
+    *output_size = sizeof(uint64_t);
+    return 0;
+}
+
+// 把输入原样写入新的memfd，以描述符返回
+static int copy_handler(const void* input_data, size_t input_size,
+                        void** output_data, size_t* output_size, void* user_context) {
+    (void)output_data;
+    (void)output_size;
+    (void)user_context;
+    
+    int fd = memfd_create("test_output", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd == -1) {
+        return -1;
+    }
+    
+    int result = -1;
+    if (write(fd, input_data, input_size) == (ssize_t)input_size &&
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE) == 0 &&
+        pool_task_output_fd(fd, 0, input_size) == POOL_SUCCESS) {
+        result = 0;
+    }
+    
+    close(fd);
+    return result;
+}
+
+static int slow_handler(const void* input_data, size_t input_size,
+                        void** output_data, size_t* output_size, void* user_context) {
+    (void)input_data;
+    (void)input_size;
+    (void)output_data;
+    (void)output_size;
+    (void)user_context;
+    usleep(300000);
+    return 0;
+}
+
+static process_pool_t* g_pool;
+
+// 创建内容为pattern(i)的memfd，seals为0时不封印
+static int make_memfd(size_t size, unsigned int flags, int seals) {
+    int fd = memfd_create("test_input", MFD_CLOEXEC | flags);
+    CHECK(fd >= 0);
+    
+    uint8_t* buf = malloc(size);
+    CHECK(buf != NULL);
+    for (size_t i = 0; i < size; i++) {
+        buf[i] = (uint8_t)(i * 31 + 7);
+    }
+    CHECK(write(fd, buf, size) == (ssize_t)size);
+    free(buf);
+    
+    if (seals) {
+        CHECK(fcntl(fd, F_ADD_SEALS, seals) == 0);
+    }
+    return fd;
+}
+
+static uint64_t pattern_sum(uint64_t offset, size_t length) {
+    uint64_t sum = 0;
+    for (uint64_t i = offset; i < offset + length; i++) {
+        sum += (uint8_t)(i * 31 + 7);
+    }
+    return sum;
+}
+
+// 创建内容为pattern(i)的普通文件(已删除目录项)
+static int make_file(size_t size) {
+    char path[] = "/tmp/test_task_fd_XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    unlink(path);
+    
+    for (size_t i = 0; i < size; i++) {
+        uint8_t b = (uint8_t)(i * 31 + 7);
+        CHECK(write(fd, &b, 1) == 1);
+    }
+    return fd;
+}
+
+// 不可读、不是普通文件或越界的区域在提交时被拒绝
+static void test_rejects_invalid(void) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    task_future_t* future = NULL;
+    
+    int fd = make_memfd(4096, MFD_ALLOW_SEALING, F_SEAL_SHRINK | F_SEAL_WRITE);
+    pool_fd_region_t region = { .fd = fd, .offset = 4000, .length = 200 };
+    CHECK(pool_submit_fd(g_pool, &desc, &region, &future) == POOL_ERROR_INVALID_PARAM);
+    close(fd);
+    
+    fd = open("/dev/null", O_WRONLY);
+    CHECK(fd >= 0);
+    region = (pool_fd_region_t){ .fd = fd, .offset = 0, .length = 1 };
+    CHECK(pool_submit_fd(g_pool, &desc, &region, &future) == POOL_ERROR_INVALID_PARAM);
+    close(fd);
+    
+    fd = open("/tmp", O_RDONLY | O_DIRECTORY);
+    CHECK(fd >= 0);
+    CHECK(pool_submit_fd(g_pool, &desc, &region, &future) == POOL_ERROR_INVALID_PARAM);
+    close(fd);
+}
+
+// 未封印的memfd和普通文件由Worker复制后处理
+static void test_unsealed_files(void) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    
+    int fds[] = {
+        make_memfd(8192, 0, 0),
+        make_memfd(8192, MFD_ALLOW_SEALING, F_SEAL_SHRINK),
+        make_file(8192),
+    };
+    
+    for (size_t i = 0; i < sizeof(fds) / sizeof(fds[0]); i++) {
+        pool_fd_region_t region = { .fd = fds[i], .offset = 100, .length = 5000 };
+        task_future_t* future;
+        CHECK_OK(pool_submit_fd(g_pool, &desc, &region, &future));
+        close(fds[i]);
+    
+        task_result_t result;
+        uint64_t sum;
+        CHECK_OK(pool_future_wait(future, &result, 10000));
+        CHECK(result.state == TASK_STATE_COMPLETED);
+        memcpy(&sum, result.result_data, sizeof(sum));
+        CHECK(sum == pattern_sum(100, 5000));
+        free(result.result_data);
+        pool_future_destroy(future);
+    }
+}
+
+// 执行前被截断的文件使任务失败，Worker不会因SIGBUS退出
+static void test_truncated_file(void) {
+    task_desc_t slow;
+    memset(&slow, 0, sizeof(slow));
+    slow.handler = slow_handler;
+    task_future_t* blocker;
+    CHECK_OK(pool_submit_async(g_pool, &slow, NULL, 0, &blocker));
+    
+    int fd = make_file(8192);
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    pool_fd_region_t region = { .fd = fd, .offset = 0, .length = 8192 };
+    task_future_t* future;
+    CHECK_OK(pool_submit_fd(g_pool, &desc, &region, &future));
+    CHECK(ftruncate(fd, 100) == 0);
+    close(fd);
+    
+    task_result_t result;
+    CHECK_OK(pool_future_wait(future, &result, 10000));
+    CHECK(result.state == TASK_STATE_FAILED);
+    pool_future_destroy(future);
+    
+    CHECK_OK(pool_future_wait(blocker, &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+    pool_future_destroy(blocker);
+    
+    pool_stats_t stats;
+    CHECK_OK(pool_get_stats(g_pool, &stats));
+    CHECK(stats.cancel_recycles == 0);
+    
+    worker_info_t info;
+    uint32_t count = 1;
+    CHECK_OK(pool_get_workers(g_pool, &info, &count));
+    pid_t pid = info.pid;
+    test_unsealed_files();
+    CHECK_OK(pool_get_workers(g_pool, &info, &count));
+    CHECK(info.pid == pid);
+}
+
+// 输入和输出都以描述符传递
+static void test_roundtrip(void) {
+    enum { SIZE = 1 << 20 };
+    int fd = make_memfd(SIZE, MFD_ALLOW_SEALING, F_SEAL_SHRINK | F_SEAL_WRITE);
+    
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.handler = copy_handler;
+    
+    // 非页对齐的区域
+    pool_fd_region_t input = { .fd = fd, .offset = 1000, .length = SIZE - 5000 };
+    task_future_t* future;
+    CHECK_OK(pool_submit_fd(g_pool, &desc, &input, &future));
+    close(fd);
+    
+    task_result_t result;
+    CHECK_OK(pool_future_wait(future, &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+    free(result.result_data);
+    
+    pool_fd_region_t output;
+    CHECK_OK(pool_future_get_fd(future, &output));
+    CHECK(output.length == input.length);
+    
+    const uint8_t* data = mmap(NULL, output.length, PROT_READ, MAP_SHARED, output.fd, 0);
+    CHECK(data != MAP_FAILED);
+    for (size_t i = 0; i < output.length; i++) {
+        CHECK(data[i] == (uint8_t)((i + input.offset) * 31 + 7));
+    }
+    munmap((void*)data, output.length);
+    close(output.fd);
+    
+    pool_future_destroy(future);
+}
+
+// 紧急任务插到大量已分发的描述符任务之前，先收到的描述符全部暂存且不丢失
+static void test_urgent_overtakes(void) {
+    enum { COUNT = 200 };
+    task_future_t* futures[COUNT];
+    int fd = make_memfd(8192, MFD_ALLOW_SEALING, F_SEAL_SHRINK | F_SEAL_WRITE);
+    
+    task_desc_t slow;
+    memset(&slow, 0, sizeof(slow));
+    slow.handler = slow_handler;
+    task_future_t* blocker;
+    CHECK_OK(pool_submit_async(g_pool, &slow, NULL, 0, &blocker));
+    
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.priority = TASK_PRIORITY_NORMAL;
+    
+    for (uint32_t i = 0; i < COUNT; i++) {
+        pool_fd_region_t region = { .fd = fd, .offset = i, .length = 4096 };
+        CHECK_OK(pool_submit_fd(g_pool, &desc, &region, &futures[i]));
+    }
+    
+    // 等普通任务都进入Worker的提交环后再提交紧急任务
+    pool_stats_t stats;
+    do {
+        usleep(1000);
+        CHECK_OK(pool_get_stats(g_pool, &stats));
+    } while (stats.pending_tasks > 0);
+    
+    desc.priority = TASK_PRIORITY_URGENT;
+    pool_fd_region_t region = { .fd = fd, .offset = 0, .length = 8192 };
+    task_future_t* urgent;
+    CHECK_OK(pool_submit_fd(g_pool, &desc, &region, &urgent));
+    close(fd);
+    
+    task_result_t result;
+    uint64_t sum;
+    CHECK_OK(pool_future_wait(urgent, &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+    memcpy(&sum, result.result_data, sizeof(sum));
+    CHECK(sum == pattern_sum(0, 8192));
+    free(result.result_data);
+    pool_future_destroy(urgent);
+    
+    for (uint32_t i = 0; i < COUNT; i++) {
+        CHECK_OK(pool_future_wait(futures[i], &result, 10000));
+        CHECK(result.state == TASK_STATE_COMPLETED);
+        memcpy(&sum, result.result_data, sizeof(sum));
+        CHECK(sum == pattern_sum(i, 4096));
+        free(result.result_data);
+        pool_future_destroy(futures[i]);
+    }
+    
+    CHECK_OK(pool_future_wait(blocker, &result, 10000));
+    pool_future_destroy(blocker);
+}
+
+int main(void) {
+    pool_set_log_level(1);
+    
+    // 单个Worker，使全部任务进入同一个提交环
+    pool_config_t config = test_pool_config(1, sum_handler);
+    config.worker_queue_depth = 512;
+    config.sched_policy = POOL_SCHED_PRIORITY;
+    g_pool = pool_create(&config);
+    CHECK(g_pool != NULL);
+    CHECK_OK(pool_start(g_pool));
+    
+    RUN_TEST(test_rejects_invalid);
+    RUN_TEST(test_unsealed_files);
+    RUN_TEST(test_truncated_file);
+    RUN_TEST(test_roundtrip);
+    RUN_TEST(test_urgent_overtakes);
+    
+    CHECK_OK(pool_stop(g_pool, 5000));
+    pool_destroy(g_pool);
+    
+    return 0;
+}
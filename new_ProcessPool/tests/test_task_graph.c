@@ -0,0 +1,276 @@
+#define _GNU_SOURCE
+#include "test_common.h"
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// 输入为若干uint64_t，返回它们的和
+static int sum_handler(const void* input_data, size_t input_size,
+                       void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
+    if (input_size % sizeof(uint64_t) != 0) {
+        return -1;
+    }
+    
+    uint64_t* out = malloc(sizeof(uint64_t));
+    if (!out) {
+        return -1;
+    }
+    
+    *out = 0;
+    for (size_t i = 0; i < input_size / sizeof(uint64_t); i++) {
+        uint64_t v;
+        memcpy(&v, (const char*)input_data + i * sizeof(v), sizeof(v));
+        *out += v;
+    }
+    
+    *output_data = out;
+    *output_size = sizeof(uint64_t);
+    return 0;
+}
+
+// 输入为数量n，返回n个1
+static int ones_handler(const void* input_data, size_t input_size,
+                        void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
+    uint64_t n;
+    if (input_size != sizeof(n)) {
+        return -1;
+    }
+    memcpy(&n, input_data, sizeof(n));
+    
+    uint64_t* out = malloc(n * sizeof(uint64_t));
+    if (!out) {
+        return -1;
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        out[i] = 1;
+    }
+    
+    *output_data = out;
+    *output_size = n * sizeof(uint64_t);
+    return 0;
+}
+
+// 与ones_handler相同，但结果写入memfd以描述符返回
+static int ones_fd_handler(const void* input_data, size_t input_size,
+                           void** output_data, size_t* output_size, void* user_context) {
+    void* data;
+    size_t size;
+    if (ones_handler(input_data, input_size, &data, &size, user_context) != 0) {
+        return -1;
+    }
+    
+    int fd = memfd_create("ones", MFD_CLOEXEC);
+    bool ok = fd >= 0 && write(fd, data, size) == (ssize_t)size &&
+              pool_task_output_fd(fd, 0, size) == POOL_SUCCESS;
+    free(data);
+    if (fd >= 0) {
+        close(fd);
+    }
+    
+    *output_data = NULL;
+    *output_size = 0;
+    return ok ? 0 : -1;
+}
+
+static process_pool_t* g_pool;
+
+static task_state_t node_state(task_graph_t* graph, uint32_t index, uint64_t* value) {
+    task_future_t* future = pool_graph_node_future(graph, index);
+    CHECK(future != NULL);
+    
+    task_result_t result;
+    CHECK_OK(pool_future_wait(future, &result, 10000));
+    if (value && result.result_data) {
+        memcpy(value, result.result_data, sizeof(*value));
+    }
+    
+    free(result.result_data);
+    pool_future_destroy(future);
+    return result.state;
+}
+
+// 菱形依赖：D的输入为自身的值加上B、C的输出
+static void test_diamond(void) {
+    static const uint32_t deps_b[] = { 0 };
+    static const uint32_t deps_c[] = { 0 };
+    static const uint32_t deps_d[] = { 1, 2 };
+    uint64_t values[4] = { 1, 10, 100, 1000 };
+    task_graph_node_t nodes[4];
+    
+    memset(nodes, 0, sizeof(nodes));
+    for (uint32_t i = 0; i < 4; i++) {
+        nodes[i].input_data = &values[i];
+        nodes[i].input_size = sizeof(values[i]);
+    }
+    nodes[1].deps = deps_b;
+    nodes[1].dep_count = 1;
+    nodes[2].deps = deps_c;
+    nodes[2].dep_count = 1;
+    nodes[3].deps = deps_d;
+    nodes[3].dep_count = 2;
+    
+    task_graph_t* graph;
+    CHECK_OK(pool_submit_graph(g_pool, nodes, 4, &graph));
+    CHECK_OK(pool_graph_wait(graph, 10000));
+    
+    uint64_t result = 0;
+    CHECK(node_state(graph, 3, &result) == TASK_STATE_COMPLETED);
+    CHECK(result == 1000 + 11 + 101);
+    
+    pool_graph_timing_t timing;
+    uint32_t path[4];
+    CHECK_OK(pool_graph_get_timing(graph, &timing, path, 4));
+    CHECK(timing.completed_nodes == 4);
+    CHECK(timing.failed_nodes == 0);
+    CHECK(timing.critical_path_nodes == 3);
+    CHECK(path[0] == 0 && path[2] == 3);
+    
+    pool_graph_destroy(graph);
+}
+
+// 根节点在事件循环线程上完成，一次释放的子节点远多于任务队列容量
+static void test_wide_fanout(void) {
+    enum { CHILDREN = 500 };
+    static task_graph_node_t nodes[CHILDREN + 1];
+    static const uint32_t deps[] = { 0 };
+    uint64_t root = 5;
+    
+    memset(nodes, 0, sizeof(nodes));
+    nodes[0].input_data = &root;
+    nodes[0].input_size = sizeof(root);
+    for (uint32_t i = 1; i <= CHILDREN; i++) {
+        nodes[i].deps = deps;
+        nodes[i].dep_count = 1;
+    }
+    
+    task_graph_t* graph;
+    CHECK_OK(pool_submit_graph(g_pool, nodes, CHILDREN + 1, &graph));
+    CHECK_OK(pool_graph_wait(graph, 30000));
+    
+    pool_graph_timing_t timing;
+    CHECK_OK(pool_graph_get_timing(graph, &timing, NULL, 0));
+    CHECK(timing.completed_nodes == CHILDREN + 1);
+    CHECK(timing.failed_nodes == 0);
+    
+    uint64_t result = 0;
+    CHECK(node_state(graph, CHILDREN, &result) == TASK_STATE_COMPLETED);
+    CHECK(result == root);
+    
+    pool_graph_destroy(graph);
+}
+
+// 长依赖链的根节点失败，其余节点依次以取消结束
+static void test_failure_chain(void) {
+    enum { COUNT = 50000 };
+    static task_graph_node_t nodes[COUNT];
+    static uint32_t deps[COUNT];
+    
+    memset(nodes, 0, sizeof(nodes));
+    nodes[0].desc.handler = failing_handler;
+    for (uint32_t i = 1; i < COUNT; i++) {
+        deps[i] = i - 1;
+        nodes[i].deps = &deps[i];
+        nodes[i].dep_count = 1;
+    }
+    
+    task_graph_t* graph;
+    CHECK_OK(pool_submit_graph(g_pool, nodes, COUNT, &graph));
+    CHECK_OK(pool_graph_wait(graph, 30000));
+    
+    pool_graph_timing_t timing;
+    CHECK_OK(pool_graph_get_timing(graph, &timing, NULL, 0));
+    CHECK(timing.completed_nodes == 0);
+    CHECK(timing.failed_nodes == COUNT);
+    
+    CHECK(node_state(graph, 0, NULL) == TASK_STATE_FAILED);
+    CHECK(node_state(graph, COUNT - 1, NULL) == TASK_STATE_CANCELLED);
+    
+    pool_graph_destroy(graph);
+}
+
+// 依赖的输出合计超过MAX_TASK_DATA_SIZE时以描述符传给子节点
+static void test_large_outputs(void) {
+    static const uint32_t deps[] = { 0, 1 };
+    uint64_t counts[2] = { 5000, 6000 };
+    uint64_t extra = 7;
+    task_graph_node_t nodes[3];
+    
+    memset(nodes, 0, sizeof(nodes));
+    for (uint32_t i = 0; i < 2; i++) {
+        nodes[i].desc.handler = ones_handler;
+        nodes[i].input_data = &counts[i];
+        nodes[i].input_size = sizeof(counts[i]);
+    }
+    nodes[2].input_data = &extra;
+    nodes[2].input_size = sizeof(extra);
+    nodes[2].deps = deps;
+    nodes[2].dep_count = 2;
+    CHECK((counts[0] + counts[1]) * sizeof(uint64_t) > MAX_TASK_DATA_SIZE);
+    
+    task_graph_t* graph;
+    CHECK_OK(pool_submit_graph(g_pool, nodes, 3, &graph));
+    CHECK_OK(pool_graph_wait(graph, 10000));
+    
+    uint64_t result = 0;
+    CHECK(node_state(graph, 2, &result) == TASK_STATE_COMPLETED);
+    CHECK(result == 7 + 5000 + 6000);
+    
+    pool_graph_destroy(graph);
+}
+
+// 以描述符返回的结果：唯一依赖时直接转交，与常规输出混合时拼接
+static void test_fd_outputs(void) {
+    static const uint32_t deps_single[] = { 0 };
+    static const uint32_t deps_mixed[] = { 1, 0 };
+    uint64_t counts[2] = { 100000, 3 };
+    task_graph_node_t nodes[4];
+    
+    memset(nodes, 0, sizeof(nodes));
+    nodes[0].desc.handler = ones_fd_handler;
+    nodes[0].input_data = &counts[0];
+    nodes[0].input_size = sizeof(counts[0]);
+    nodes[1].desc.handler = ones_handler;
+    nodes[1].input_data = &counts[1];
+    nodes[1].input_size = sizeof(counts[1]);
+    nodes[2].deps = deps_single;
+    nodes[2].dep_count = 1;
+    nodes[3].deps = deps_mixed;
+    nodes[3].dep_count = 2;
+    
+    task_graph_t* graph;
+    CHECK_OK(pool_submit_graph(g_pool, nodes, 4, &graph));
+    CHECK_OK(pool_graph_wait(graph, 10000));
+    
+    uint64_t result = 0;
+    CHECK(node_state(graph, 2, &result) == TASK_STATE_COMPLETED);
+    CHECK(result == 100000);
+    CHECK(node_state(graph, 3, &result) == TASK_STATE_COMPLETED);
+    CHECK(result == 100003);
+    
+    pool_graph_destroy(graph);
+}
+
+int main(void) {
+    pool_set_log_level(1);
+    
+    pool_config_t config = test_pool_config(2, sum_handler);
+    config.queue_size = 8;
+    g_pool = pool_create(&config);
+    CHECK(g_pool != NULL);
+    CHECK_OK(pool_start(g_pool));
+    
+    RUN_TEST(test_diamond);
+    RUN_TEST(test_wide_fanout);
+    RUN_TEST(test_failure_chain);
+    RUN_TEST(test_large_outputs);
+    RUN_TEST(test_fd_outputs);
+    
+    CHECK_OK(pool_stop(g_pool, 5000));
+    pool_destroy(g_pool);
+    
+    return 0;
+}
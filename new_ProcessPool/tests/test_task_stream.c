@@ -0,0 +1,237 @@
+#define _GNU_SOURCE
+#include "test_common.h"
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// 远大于两个方向管道容量之和，两端都会因管道满而等待
+#define STREAM_TOTAL (4 * 1024 * 1024)
+
+static uint8_t pattern(size_t i) {
+    return (uint8_t)(i * 131 + (i >> 12));
+}
+
+// 首段输入为一个字节的密钥，把流式输入逐字节异或后写回，返回处理的总字节数
+static int xor_handler(const void* input_data, size_t input_size,
+                       void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
+    if (input_size != 1) {
+        return -1;
+    }
+    uint8_t key = *(const uint8_t*)input_data;
+    
+    uint8_t buf[3000];
+    uint64_t total = 0;
+    for (;;) {
+        size_t n;
+        if (pool_task_stream_read(buf, sizeof(buf), &n) != POOL_SUCCESS) {
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+    
+        for (size_t i = 0; i < n; i++) {
+            buf[i] ^= key;
+        }
+        if (pool_task_stream_write(buf, n) != POOL_SUCCESS) {
+            return -1;
+        }
+        total += n;
+    }
+    
+    uint64_t* out = malloc(sizeof(uint64_t));
+    if (!out) {
+        return -1;
+    }
+    *out = total;
+    *output_data = out;
+    *output_size = sizeof(uint64_t);
+    return 0;
+}
+
+// 不读输入，持续输出直到调用方放弃读取
+static int endless_handler(const void* input_data, size_t input_size,
+                           void** output_data, size_t* output_size, void* user_context) {
+    (void)input_data;
+    (void)input_size;
+    (void)output_data;
+    (void)output_size;
+    (void)user_context;
+    
+    uint8_t buf[4096];
+    memset(buf, 0x5A, sizeof(buf));
+    while (pool_task_stream_write(buf, sizeof(buf)) == POOL_SUCCESS) {
+    }
+    return -1;
+}
+
+static int echo_handler(const void* input_data, size_t input_size,
+                        void** output_data, size_t* output_size, void* user_context) {
+    (void)user_context;
+    
+    void* out = malloc(input_size);
+    if (!out) {
+        return -1;
+    }
+    memcpy(out, input_data, input_size);
+    *output_data = out;
+    *output_size = input_size;
+    return 0;
+}
+
+static process_pool_t* g_pool;
+
+// 以不规则的块大小写入全部输入后结束
+static void* writer_thread(void* arg) {
+    task_stream_t* stream = arg;
+    uint8_t buf[7001];
+    size_t offset = 0;
+    
+    while (offset < STREAM_TOTAL) {
+        size_t n = 1 + offset % sizeof(buf);
+        if (n > STREAM_TOTAL - offset) {
+            n = STREAM_TOTAL - offset;
+        }
+        for (size_t i = 0; i < n; i++) {
+            buf[i] = pattern(offset + i);
+        }
+        CHECK_OK(pool_stream_write(stream, buf, n, 10000));
+        offset += n;
+    }
+    
+    CHECK_OK(pool_stream_close(stream));
+    return NULL;
+}
+
+// 输入输出同时进行，总量超过MAX_TASK_DATA_SIZE和管道容量
+static void test_transform(void) {
+    const uint8_t key = 0xA5;
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.handler = xor_handler;
+    
+    task_stream_t* stream;
+    CHECK_OK(pool_submit_stream(g_pool, &desc, &key, 1, &stream));
+    
+    pthread_t writer;
+    CHECK(pthread_create(&writer, NULL, writer_thread, stream) == 0);
+    
+    static uint8_t buf[65536];
+    size_t received = 0;
+    for (;;) {
+        size_t n;
+        CHECK_OK(pool_stream_read(stream, buf, sizeof(buf), &n, 10000));
+        if (n == 0) {
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            CHECK((uint8_t)(buf[i] ^ key) == pattern(received + i));
+        }
+        received += n;
+    }
+    CHECK(pthread_join(writer, NULL) == 0);
+    CHECK(received == STREAM_TOTAL);
+    
+    task_result_t result;
+    uint64_t total;
+    CHECK_OK(pool_future_wait(pool_stream_future(stream), &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+    CHECK(result.result_size == sizeof(total));
+    memcpy(&total, result.result_data, sizeof(total));
+    CHECK(total == STREAM_TOTAL);
+    free(result.result_data);
+    
+    // 输入已结束，再写入被拒绝
+    CHECK(pool_stream_write(stream, &key, 1, 1000) == POOL_ERROR_INVALID_PARAM);
+    pool_stream_destroy(stream);
+}
+
+// 输出未读完时释放流句柄，任务被取消，Worker随后继续处理其他任务
+static void test_destroy_cancels(void) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.handler = endless_handler;
+    
+    task_stream_t* stream;
+    CHECK_OK(pool_submit_stream(g_pool, &desc, NULL, 0, &stream));
+    
+    uint8_t buf[1024];
+    size_t n;
+    CHECK_OK(pool_stream_read(stream, buf, sizeof(buf), &n, 10000));
+    CHECK(n > 0 && buf[0] == 0x5A);
+    pool_stream_destroy(stream);
+    
+    memset(&desc, 0, sizeof(desc));
+    desc.handler = echo_handler;
+    const char msg[] = "after stream";
+    task_result_t result;
+    CHECK_OK(pool_submit_sync(g_pool, &desc, msg, sizeof(msg), &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+    CHECK(result.result_size == sizeof(msg));
+    CHECK(memcmp(result.result_data, msg, sizeof(msg)) == 0);
+    free(result.result_data);
+    
+    // 同一Worker的流通道可以再次使用
+    test_transform();
+}
+
+// 流式任务的时长由调用方决定，不受配置的task_timeout(1秒)限制
+static void test_ignores_task_timeout(void) {
+    const uint8_t key = 0x3C;
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.handler = xor_handler;
+    
+    task_stream_t* stream;
+    CHECK_OK(pool_submit_stream(g_pool, &desc, &key, 1, &stream));
+    
+    uint8_t buf[16];
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = pattern(i);
+    }
+    CHECK_OK(pool_stream_write(stream, buf, sizeof(buf), 10000));
+    usleep(1500000);
+    CHECK_OK(pool_stream_close(stream));
+    
+    size_t received = 0;
+    for (;;) {
+        size_t n;
+        CHECK_OK(pool_stream_read(stream, buf, sizeof(buf), &n, 10000));
+        if (n == 0) {
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            CHECK((uint8_t)(buf[i] ^ key) == pattern(received + i));
+        }
+        received += n;
+    }
+    CHECK(received == sizeof(buf));
+    
+    task_result_t result;
+    CHECK_OK(pool_future_wait(pool_stream_future(stream), &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+    free(result.result_data);
+    pool_stream_destroy(stream);
+}
+
+int main(void) {
+    pool_set_log_level(1);
+    
+    // 单个Worker，后续任务复用同一条流通道
+    pool_config_t config = test_pool_config(1, echo_handler);
+    config.task_timeout = 1;
+    g_pool = pool_create(&config);
+    CHECK(g_pool != NULL);
+    CHECK_OK(pool_start(g_pool));
+    
+    RUN_TEST(test_transform);
+    RUN_TEST(test_destroy_cancels);
+    RUN_TEST(test_ignores_task_timeout);
+    
+    CHECK_OK(pool_stop(g_pool, 5000));
+    pool_destroy(g_pool);
+    
+    return 0;
+}
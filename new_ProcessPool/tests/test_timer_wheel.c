@@ -0,0 +1,115 @@
+#include "test_common.h"
+#include "internal.h"
+
+#define START_NS 1000000000ULL
+#define MS(n) (START_NS + (uint64_t)(n) * TIMER_WHEEL_TICK_NS)
+
+typedef struct {
+    timer_node_t node;                  // 必须是第一个成员
+    uint64_t expires;                   // 期望触发的tick
+    uint64_t fired_at;                  // 实际触发时时间轮所在的tick(0表示未触发)
+} test_timer_t;
+
+static timer_wheel_t g_wheel;
+
+static void on_expire(timer_node_t* node, void* arg) {
+    (void)arg;
+    test_timer_t* t = (test_timer_t*)node;
+    CHECK(t->fired_at == 0);
+    t->fired_at = g_wheel.current;
+}
+
+static void add_timer(test_timer_t* t, uint64_t expires) {
+    memset(t, 0, sizeof(*t));
+    t->expires = expires;
+    timer_wheel_add(&g_wheel, &t->node, MS(expires));
+}
+
+static uint64_t next_expiry_tick(void) {
+    uint64_t ns;
+    CHECK(timer_wheel_next_expiry(&g_wheel, &ns));
+    return (ns - START_NS) / TIMER_WHEEL_TICK_NS;
+}
+
+// 第0层：到期槽位在当前位置之前(下一圈)
+static void test_level0_wrap(void) {
+    timer_wheel_init(&g_wheel, START_NS);
+    timer_wheel_advance(&g_wheel, MS(250), on_expire, NULL);
+    
+    test_timer_t t;
+    add_timer(&t, 260);
+    CHECK(next_expiry_tick() == 260);
+    
+    CHECK(timer_wheel_advance(&g_wheel, MS(300), on_expire, NULL) == 1);
+    CHECK(t.fired_at == 260);
+    CHECK(g_wheel.count == 0);
+}
+
+// 第1层：cascade点在当前位置之后，以及本层回绕之后
+static void test_level1_wrap(void) {
+    timer_wheel_init(&g_wheel, START_NS);
+    timer_wheel_advance(&g_wheel, MS(250), on_expire, NULL);
+    
+    test_timer_t near;
+    add_timer(&near, 550);
+    CHECK(next_expiry_tick() == 512);
+    CHECK(timer_wheel_advance(&g_wheel, MS(520), on_expire, NULL) == 0);
+    CHECK(next_expiry_tick() == 550);
+    CHECK(timer_wheel_advance(&g_wheel, MS(600), on_expire, NULL) == 1);
+    CHECK(near.fired_at == 550);
+    
+    // 当前第1层位于253号槽位，30秒后的定时器落在本层下一圈的115号槽位
+    timer_wheel_advance(&g_wheel, MS(65000), on_expire, NULL);
+    
+    test_timer_t far;
+    add_timer(&far, 95000);
+    CHECK(next_expiry_tick() == (95000 >> TIMER_WHEEL_BITS) << TIMER_WHEEL_BITS);
+    CHECK(timer_wheel_advance(&g_wheel, MS(94000), on_expire, NULL) == 0);
+    CHECK(timer_wheel_advance(&g_wheel, MS(96000), on_expire, NULL) == 1);
+    CHECK(far.fired_at == 95000);
+}
+
+// 随机延迟和随机推进步长：每个定时器都恰好在到期tick触发
+static void test_random_exact(void) {
+    enum { COUNT = 5000 };
+    static test_timer_t timers[COUNT];
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    uint64_t now = 0;
+    
+    timer_wheel_init(&g_wheel, START_NS);
+    
+    uint32_t added = 0;
+    uint32_t fired = 0;
+    while (fired < COUNT) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+    
+        if (added < COUNT) {
+            // 延迟跨越第0层到第2层
+            static const uint64_t spans[] = { 256, 65536, 200000 };
+            uint64_t delay = 1 + seed % spans[(seed >> 32) % 3];
+            add_timer(&timers[added++], now + delay);
+        }
+    
+        uint64_t step = (seed >> 40) % 4 == 0 ? (seed >> 20) % 5000 : (seed >> 20) % 10;
+        now += step;
+        fired += timer_wheel_advance(&g_wheel, MS(now), on_expire, NULL);
+    
+        if (added == COUNT && g_wheel.count > 0) {
+            CHECK(next_expiry_tick() > now);
+        }
+    }
+    
+    CHECK(g_wheel.count == 0);
+    for (uint32_t i = 0; i < COUNT; i++) {
+        CHECK(timers[i].fired_at == timers[i].expires);
+    }
+}
+
+int main(void) {
+    RUN_TEST(test_level0_wrap);
+    RUN_TEST(test_level1_wrap);
+    RUN_TEST(test_random_exact);
+    return 0;
+}
@@ -0,0 +1,193 @@
+#define _GNU_SOURCE
+#include "test_common.h"
+#include "internal.h"
+#include <stdint.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define MAX_TEST_WORKERS 4
+
+// worker_init的执行次数，与zygote和Worker进程共享
+static atomic_uint* g_inits;
+
+static void count_init(void* user_context) {
+    (void)user_context;
+    atomic_fetch_add(g_inits, 1);
+}
+
+// 返回执行任务的进程ID
+static int pid_handler(const void* input_data, size_t input_size,
+                       void** output_data, size_t* output_size, void* user_context) {
+    (void)input_data;
+    (void)input_size;
+    (void)user_context;
+    
+    pid_t* out = malloc(sizeof(pid_t));
+    if (!out) {
+        return -1;
+    }
+    *out = getpid();
+    *output_data = out;
+    *output_size = sizeof(pid_t);
+    return 0;
+}
+
+static process_pool_t* g_pool;
+
+static pid_t run_task(void) {
+    task_desc_t desc;
+    memset(&desc, 0, sizeof(desc));
+    task_result_t result;
+    pid_t pid;
+    
+    CHECK_OK(pool_submit_sync(g_pool, &desc, NULL, 0, &result, 10000));
+    CHECK(result.state == TASK_STATE_COMPLETED);
+    CHECK(result.result_size == sizeof(pid));
+    memcpy(&pid, result.result_data, sizeof(pid));
+    free(result.result_data);
+    return pid;
+}
+
+// 等待expected个Worker处于RUNNING，返回槽位slot上的进程ID
+static pid_t wait_running(uint32_t expected, uint32_t slot) {
+    for (int i = 0; i < 500; i++) {
+        worker_info_t infos[MAX_TEST_WORKERS];
+        uint32_t count = MAX_TEST_WORKERS;
+        CHECK_OK(pool_get_workers(g_pool, infos, &count));
+    
+        uint32_t running = 0;
+        pid_t pid = -1;
+        for (uint32_t j = 0; j < count; j++) {
+            if (infos[j].state == WORKER_STATE_IDLE || infos[j].state == WORKER_STATE_BUSY) {
+                running++;
+                if (infos[j].worker_id == slot) {
+                    pid = infos[j].pid;
+                }
+            }
+        }
+        if (running == expected && pid > 0) {
+            return pid;
+        }
+        usleep(10000);
+    }
+    CHECK(!"workers did not reach the expected state");
+    return -1;
+}
+
+static pool_stats_t get_stats(void) {
+    pool_stats_t stats;
+    CHECK_OK(pool_get_stats(g_pool, &stats));
+    return stats;
+}
+
+// 初始Worker都由zygote派生，worker_init只在zygote中执行一次
+static void test_start(void) {
+    pool_stats_t stats = get_stats();
+    CHECK(stats.workers_spawned == 2);
+    CHECK(stats.zygote_spawns == 2);
+    CHECK(atomic_load(g_inits) == 1);
+    
+    pid_t pid = run_task();
+    CHECK(pid == wait_running(2, 0) || pid == wait_running(2, 1));
+}
+
+// 事件循环重启被杀死的Worker：请求发给zygote后不等待，应答到达时完成启动
+static void test_restart(void) {
+    pool_stats_t before = get_stats();
+    pid_t old_pid = wait_running(2, 0);
+    
+    CHECK(kill(old_pid, SIGKILL) == 0);
+    pid_t new_pid = old_pid;
+    for (int i = 0; i < 500 && new_pid == old_pid; i++) {
+        usleep(10000);
+        new_pid = wait_running(2, 0);
+    }
+    CHECK(new_pid != old_pid);
+    
+    pool_stats_t after = get_stats();
+    CHECK(after.zygote_spawns == before.zygote_spawns + 1);
+    CHECK(atomic_load(g_inits) == 1);
+    run_task();
+}
+
+// 扩容同样走异步派生，缩容后再扩容复用槽位
+static void test_resize(void) {
+    pool_stats_t before = get_stats();
+    
+    CHECK_OK(pool_resize(g_pool, 4));
+    wait_running(4, 3);
+    CHECK(get_stats().zygote_spawns == before.zygote_spawns + 2);
+    
+    CHECK_OK(pool_resize(g_pool, 2));
+    CHECK_OK(pool_resize(g_pool, 3));
+    wait_running(3, 2);
+    CHECK_OK(pool_resize(g_pool, 2));
+    
+    CHECK(atomic_load(g_inits) == 1);
+    run_task();
+}
+
+// zygote退出后Worker退回到直接fork，每个Worker各自执行worker_init
+static void test_zygote_lost(void) {
+    CHECK(kill(g_pool->zygote_pid, SIGKILL) == 0);
+    
+    pool_stats_t before = get_stats();
+    pid_t old_pid = wait_running(2, 1);
+    CHECK(kill(old_pid, SIGKILL) == 0);
+    
+    pid_t new_pid = old_pid;
+    for (int i = 0; i < 500 && new_pid == old_pid; i++) {
+        usleep(10000);
+        new_pid = wait_running(2, 1);
+    }
+    CHECK(new_pid != old_pid);
+    
+    pool_stats_t after = get_stats();
+    CHECK(after.workers_spawned == before.workers_spawned + 1);
+    CHECK(after.zygote_spawns == before.zygote_spawns);
+    
+    // 子进程中的worker_init与任务执行无先后保证，执行一次任务后再检查
+    run_task();
+    for (int i = 0; i < 100 && atomic_load(g_inits) < 2; i++) {
+        usleep(10000);
+    }
+    CHECK(atomic_load(g_inits) == 2);
+}
+
+static void run_suite(pool_event_backend_t backend) {
+    atomic_store(g_inits, 0);
+    
+    pool_config_t config = test_pool_config(2, pid_handler);
+    config.max_workers = MAX_TEST_WORKERS;
+    config.enable_zygote = true;
+    config.worker_init = count_init;
+    config.event_backend = backend;
+    g_pool = pool_create(&config);
+    CHECK(g_pool != NULL);
+    CHECK_OK(pool_start(g_pool));
+    
+    RUN_TEST(test_start);
+    RUN_TEST(test_restart);
+    RUN_TEST(test_resize);
+    RUN_TEST(test_zygote_lost);
+    
+    CHECK_OK(pool_stop(g_pool, 5000));
+    pool_destroy(g_pool);
+}
+
+int main(void) {
+    pool_set_log_level(1);
+    
+    g_inits = mmap(NULL, sizeof(*g_inits), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    CHECK(g_inits != MAP_FAILED);
+    
+    // 两种事件循环后端分别注册zygote套接字
+    run_suite(POOL_EVENT_BACKEND_EPOLL);
+    run_suite(POOL_EVENT_BACKEND_AUTO);
+    
+    munmap(g_inits, sizeof(*g_inits));
+    return 0;
+}